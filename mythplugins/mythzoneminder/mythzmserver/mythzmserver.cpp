@@ -16,6 +16,7 @@
 #include <arpa/inet.h>
 #include <algorithm>
 #include <array>
+#include <cerrno>
 #include <csignal>
 #include <cstdio>
 #include <cstdlib>
@@ -29,6 +30,13 @@
 #include <sys/time.h>
 #include <sys/types.h>
 #include <unistd.h>
+#include <vector>
+
+#ifdef __linux__
+#  include <sys/epoll.h>
+#else
+#  include <poll.h>
+#endif
 
 #include "zmserver.h"
 
@@ -53,13 +61,171 @@ enum EXIT_CODES : std::uint8_t {
     EXIT_VERSION_ERROR             = 136,
 };
 
+struct SocketEvent
+{
+    int  m_fd       {-1};
+    bool m_readable {false};        // also set for errors and hang ups
+    bool m_writable {false};
+};
+
+// Waits for the sockets to become readable, or writable while a client has
+// output queued. Uses epoll on linux so the cost of waking up doesn't grow
+// with the number of connections, and poll() elsewhere.
+class EventLoop
+{
+  public:
+    EventLoop(void);
+    ~EventLoop(void);
+
+    bool isValid(void) const;
+    void add(int fd);
+    void remove(int fd);
+    void setWantWrite(int fd, bool want);
+    int  wait(std::chrono::milliseconds timeout, std::vector<SocketEvent> &events);
+
+  private:
+    std::map<int, bool>  m_wantWrite;
+#ifdef __linux__
+    int                  m_epollFd {-1};
+    std::array<epoll_event, 64> m_events {};
+#else
+    std::vector<pollfd>  m_pollFds;
+#endif
+};
+
+#ifdef __linux__
+
+EventLoop::EventLoop(void)
+  : m_epollFd(epoll_create1(EPOLL_CLOEXEC))
+{
+}
+
+EventLoop::~EventLoop(void)
+{
+    if (m_epollFd != -1)
+        close(m_epollFd);
+}
+
+bool EventLoop::isValid(void) const
+{
+    return m_epollFd != -1;
+}
+
+void EventLoop::add(int fd)
+{
+    epoll_event ev {};
+    ev.events = EPOLLIN;
+    ev.data.fd = fd;
+    if (epoll_ctl(m_epollFd, EPOLL_CTL_ADD, fd, &ev) == -1)
+        perror("epoll_ctl");
+    m_wantWrite[fd] = false;
+}
+
+void EventLoop::remove(int fd)
+{
+    epoll_ctl(m_epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    m_wantWrite.erase(fd);
+}
+
+void EventLoop::setWantWrite(int fd, bool want)
+{
+    auto it = m_wantWrite.find(fd);
+    if (it == m_wantWrite.end() || it->second == want)
+        return;
+    it->second = want;
+
+    epoll_event ev {};
+    ev.events = want ? (EPOLLIN | EPOLLOUT) : EPOLLIN;
+    ev.data.fd = fd;
+    if (epoll_ctl(m_epollFd, EPOLL_CTL_MOD, fd, &ev) == -1)
+        perror("epoll_ctl");
+}
+
+int EventLoop::wait(std::chrono::milliseconds timeout, std::vector<SocketEvent> &events)
+{
+    events.clear();
+    int res = epoll_wait(m_epollFd, m_events.data(), m_events.size(), timeout.count());
+    for (int i = 0; i < res; i++)
+    {
+        SocketEvent event;
+        event.m_fd = m_events[i].data.fd;
+        event.m_readable = (m_events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP)) != 0;
+        event.m_writable = (m_events[i].events & EPOLLOUT) != 0;
+        events.push_back(event);
+    }
+    return res;
+}
+
+#else // !__linux__
+
+EventLoop::EventLoop(void) = default;
+
+EventLoop::~EventLoop(void) = default;
+
+bool EventLoop::isValid(void) const
+{
+    return true;
+}
+
+void EventLoop::add(int fd)
+{
+    pollfd pfd {};
+    pfd.fd = fd;
+    pfd.events = POLLIN;
+    m_pollFds.push_back(pfd);
+    m_wantWrite[fd] = false;
+}
+
+void EventLoop::remove(int fd)
+{
+    m_pollFds.erase(std::remove_if(m_pollFds.begin(), m_pollFds.end(),
+                                   [fd](const pollfd &pfd) { return pfd.fd == fd; }),
+                    m_pollFds.end());
+    m_wantWrite.erase(fd);
+}
+
+void EventLoop::setWantWrite(int fd, bool want)
+{
+    auto it = m_wantWrite.find(fd);
+    if (it == m_wantWrite.end() || it->second == want)
+        return;
+    it->second = want;
+
+    for (auto & pfd : m_pollFds)
+    {
+        if (pfd.fd == fd)
+            pfd.events = want ? (POLLIN | POLLOUT) : POLLIN;
+    }
+}
+
+int EventLoop::wait(std::chrono::milliseconds timeout, std::vector<SocketEvent> &events)
+{
+    events.clear();
+    int res = poll(m_pollFds.data(), m_pollFds.size(), timeout.count());
+    if (res <= 0)
+        return res;
+
+    for (const auto & pfd : m_pollFds)
+    {
+        if (pfd.revents == 0)
+            continue;
+        SocketEvent event;
+        event.m_fd = pfd.fd;
+        event.m_readable = (pfd.revents & (POLLIN | POLLERR | POLLHUP | POLLNVAL)) != 0;
+        event.m_writable = (pfd.revents & POLLOUT) != 0;
+        events.push_back(event);
+    }
+    return res;
+}
+
+#endif // !__linux__
+
 int main(int argc, char **argv)
 {
-    fd_set master;                  // master file descriptor list
-    fd_set read_fds;                // temp file descriptor list for select()
+    EventLoop eventLoop;            // the sockets we are waiting on
+    std::vector<SocketEvent> events;// the sockets that are ready
     struct sockaddr_in myaddr {};   // server address
     struct sockaddr_in remoteaddr {};// client address
-    int fdmax = -1;                 // maximum file descriptor number
     int listener = -1;              // listening socket descriptor
     int newfd = -1;                 // newly accept()ed socket descriptor
     std::array<char,4096> buf {};   // buffer for client data
@@ -260,9 +426,11 @@ int main(int argc, char **argv)
     // connect to the DB
     connectToDatabase();
 
-    // clear the master and temp sets
-    FD_ZERO(&master);   // NOLINT(readability-isolate-declaration)
-    FD_ZERO(&read_fds); // NOLINT(readability-isolate-declaration)
+    if (!eventLoop.isValid())
+    {
+        perror("epoll_create1");
+        return EXIT_SOCKET_ERROR;
+    }
 
     // get the listener
     listener = socket(AF_INET, SOCK_STREAM, 0);
@@ -300,98 +468,132 @@ int main(int argc, char **argv)
 
     std::cout << "Listening on port: " << port << std::endl;
 
-    // add the listener to the master set
-    FD_SET(listener, &master);
-
-    // keep track of the biggest file descriptor
-    fdmax = listener; // so far, it's this one
+    // add the listener to the event loop
+    eventLoop.add(listener);
 
     // main loop
     while (!quit)
     {
-        // the maximum time select() should wait
-        struct timeval timeout {DB_CHECK_TIME.count(), 0};
+        // the maximum time to wait, short while a client is waiting for
+        // frames to be pushed to it
+        std::chrono::milliseconds timeout { DB_CHECK_TIME };
+        for (auto & server : serverList)
+        {
+            if (server.second->hasSubscriptions())
+            {
+                timeout = LIVE_FRAME_POLL_TIME;
+                break;
+            }
+        }
 
-        read_fds = master; // copy it
-        int res = select(fdmax+1, &read_fds, nullptr, nullptr, &timeout);
+        int res = eventLoop.wait(timeout, events);
 
         if (res == -1)
         {
-            perror("select");
+            if (errno == EINTR)
+                continue;
+            perror("wait");
             return EXIT_SOCKET_ERROR;
         }
-        if (res == 0)
-        {
-            // select timed out
-            // just kick the DB connection to keep it alive
-            kickDatabase(debug);
-            continue;
-        }
 
-        // run through the existing connections looking for data to read
-        for (int i = 0; i <= fdmax; i++)
+        // kick the DB connection to keep it alive, this only does
+        // something every DB_CHECK_TIME
+        kickDatabase(debug);
+
+        // run through the ready connections
+        for (const auto & event : events)
         {
-            if (FD_ISSET(i, &read_fds))
+            int i = event.m_fd;
+
+            if (i == listener)
             {
-                // we got one!!
-                if (i == listener) 
+                // handle new connections
+                socklen_t addrlen = sizeof(remoteaddr);
+                newfd = accept(listener, (struct sockaddr *) &remoteaddr,
+                               &addrlen);
+                if (newfd == -1)
                 {
-                    // handle new connections
-                    socklen_t addrlen = sizeof(remoteaddr);
-                    newfd = accept(listener, (struct sockaddr *) &remoteaddr,
-                                   &addrlen);
-                    if (newfd == -1)
-                    {
-                        perror("accept");
-                    }
-                    else
-                    {
-                        // add to master set
-                        FD_SET(newfd, &master);
-                        fdmax = std::max(newfd, fdmax); // keep track of the maximum
+                    perror("accept");
+                    continue;
+                }
 
-                        // create new ZMServer and add to map
-                        auto *server = new ZMServer(newfd, debug);
-                        serverList[newfd] = server;
+                // replies and pushed frames are queued instead of
+                // blocking the other clients
+                fcntl(newfd, F_SETFL, fcntl(newfd, F_GETFL) | O_NONBLOCK);
 
-                        printf("new connection from %s on socket %d\n",
-                               inet_ntoa(remoteaddr.sin_addr), newfd);
-                    }
+                // add to the event loop
+                eventLoop.add(newfd);
+
+                // create new ZMServer and add to map
+                auto *server = new ZMServer(newfd, debug);
+                serverList[newfd] = server;
+
+                printf("new connection from %s on socket %d\n",
+                       inet_ntoa(remoteaddr.sin_addr), newfd);
+                continue;
+            }
+
+            auto it = serverList.find(i);
+            if (it == serverList.end())
+                continue;
+            ZMServer *server = it->second;
+            bool closeConnection = false;
+
+            if (event.m_writable && !server->flush())
+            {
+                perror("send");
+                closeConnection = true;
+            }
+
+            if (!closeConnection && event.m_readable)
+            {
+                // handle data from a client
+                int nbytes = recv(i, buf.data(), buf.size() - 1, 0);
+                if (nbytes == 0)
+                {
+                    // connection closed
+                    printf("socket %d hung up\n", i);
+                    closeConnection = true;
                 }
-                else
+                else if (nbytes == -1)
                 {
-                    // handle data from a client
-                    int nbytes = recv(i, buf.data(), buf.size(), 0);
-                    if (nbytes <= 0)
-                    {
-                        // got error or connection closed by client
-                        if (nbytes == 0)
-                        {
-                            // connection closed
-                            printf("socket %d hung up\n", i);
-                        }
-                        else
-                        {
-                            perror("recv");
-                        }
-
-                        // remove from master set
-                        FD_CLR(i, &master);
-
-                        close(i);
-
-                        // remove from server list
-                        ZMServer *server = serverList[i];
-                        delete server;
-                        serverList.erase(i);
-                    }
-                    else
+                    // nothing to read after all
+                    if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
                     {
-                        ZMServer *server = serverList[i];
-                        quit = server->processRequest(buf.data(), nbytes);
+                        perror("recv");
+                        closeConnection = true;
                     }
                 }
+                else
+                {
+                    quit = server->processRequest(buf.data(), nbytes);
+                }
+            }
+
+            if (closeConnection)
+            {
+                // got error or connection closed by client
+                eventLoop.remove(i);
+
+                close(i);
+
+                // remove from server list
+                delete server;
+                serverList.erase(it);
             }
+            else
+            {
+                eventLoop.setWantWrite(i, server->hasPendingOutput());
+            }
+        }
+
+        // push any new frames to the subscribers
+        for (auto & server : serverList)
+        {
+            if (!server.second->hasSubscriptions())
+                continue;
+            server.second->pushLiveFrames();
+            eventLoop.setWantWrite(server.first, server.second->hasPendingOutput());
         }
     }
 
@@ -21,6 +21,12 @@ macx {
     QMAKE_LIBS += $$system(mysql_config --libs)
 }
 
+# JPEG compression of pushed live frames is optional
+packagesExist(libjpeg) {
+    DEFINES += HAVE_LIBJPEG
+    QMAKE_LIBS += -ljpeg
+}
+
 # Input
 HEADERS += zmserver.h
 
@@ -47,6 +47,10 @@
 static constexpr int MSG_NOSIGNAL { 0 };  // Apple also has SO_NOSIGPIPE?
 #endif
 
+#ifdef HAVE_LIBJPEG
+#  include <jpeglib.h>
+#endif
+
 #include "zmserver.h"
 
 // the version of the protocol we understand
@@ -67,6 +71,7 @@ static constexpr const char* ERROR_INVALID_POINTERS { "Cannot get shared memory
 static constexpr const char* ERROR_INVALID_MONITOR_FUNCTION  { "Invalid Monitor Function" };
 static constexpr const char* ERROR_INVALID_MONITOR_ENABLE_VALUE { "Invalid Monitor Enable Value" };
 static constexpr const char* ERROR_NO_FRAMES         { "No frames found for event" };
+static constexpr const char* ERROR_INVALID_FORMAT    { "Invalid Frame Format" };
 
 // Subpixel ordering (from zm_rgb.h)
 // Based on byte order naming. For example, for ARGB (on both little endian or big endian)
@@ -455,6 +460,23 @@ int MONITOR::getLastWriteIndex(void)
     return 0;
 }
 
+time_t MONITOR::getLastWriteTime(void)
+{
+    if (m_sharedData)
+        return m_sharedData->last_write_time;
+
+    if (m_sharedData26)
+        return m_sharedData26->last_write_time;
+
+    if (m_sharedData32)
+        return m_sharedData32->last_write_time;
+
+    if (m_sharedData34)
+        return m_sharedData34->last_write_time;
+
+    return 0;
+}
+
 int MONITOR::getState(void)
 {
     if (m_sharedData)
@@ -672,6 +694,10 @@ bool ZMServer::processRequest(char* buf, int nbytes)
         handleGetAnalysisFrame(tokens);
     else if (tokens[0] == "GET_LIVE_FRAME")
         handleGetLiveFrame(tokens);
+    else if (tokens[0] == "SUBSCRIBE_LIVE_FRAMES")
+        handleSubscribeLiveFrames(tokens);
+    else if (tokens[0] == "UNSUBSCRIBE_LIVE_FRAMES")
+        handleUnsubscribeLiveFrames(tokens);
     else if (tokens[0] == "GET_FRAME_LIST")
         handleGetFrameList(tokens);
     else if (tokens[0] == "GET_CAMERA_LIST")
@@ -692,37 +718,78 @@ bool ZMServer::processRequest(char* buf, int nbytes)
     return false;
 }
 
-bool ZMServer::send(const std::string &s) const
+// queues what can't be sent without blocking, returns false on a socket error
+bool ZMServer::write(const char *data, size_t dataLen)
 {
-    // send length
-    std::string str = "0000000" + std::to_string(s.size());
-    str.erase(0, str.size()-8);
-    int status = ::send(m_sock, str.data(), 8, MSG_NOSIGNAL);
-    if (status == -1)
-        return false;
+    if (!m_outBuf.empty())
+    {
+        m_outBuf.append(data, dataLen);
+        return true;
+    }
 
-    // send message
-    status = ::send(m_sock, s.c_str(), s.size(), MSG_NOSIGNAL);
-    return status != -1;
+    while (dataLen > 0)
+    {
+        ssize_t status = ::send(m_sock, data, dataLen, MSG_NOSIGNAL);
+        if (status == -1)
+        {
+            if (errno == EINTR)
+                continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+                return false;
+            break;
+        }
+        data += status;
+        dataLen -= status;
+    }
+
+    m_outBuf.append(data, dataLen);
+    return true;
 }
 
-bool ZMServer::send(const std::string &s, const unsigned char *buffer, int dataLen) const
+// sends as much of the queued data as the socket takes now
+bool ZMServer::flush(void)
+{
+    size_t sent = 0;
+    while (sent < m_outBuf.size())
+    {
+        ssize_t status = ::send(m_sock, m_outBuf.data() + sent,
+                                m_outBuf.size() - sent, MSG_NOSIGNAL);
+        if (status == -1)
+        {
+            if (errno == EINTR)
+                continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+                return false;
+            break;
+        }
+        sent += status;
+    }
+
+    m_outBuf.erase(0, sent);
+    return true;
+}
+
+bool ZMServer::send(const std::string &s)
+{
+    return send(s, nullptr, 0);
+}
+
+bool ZMServer::send(const std::string &s, const unsigned char *buffer, int dataLen)
 {
     // send length
     std::string str = "0000000" + std::to_string(s.size());
     str.erase(0, str.size()-8);
-    int status = ::send(m_sock, str.data(), 8, MSG_NOSIGNAL);
-    if (status == -1)
+    if (!write(str.data(), 8))
         return false;
 
     // send message
-    status = ::send(m_sock, s.c_str(), s.size(), MSG_NOSIGNAL);
-    if ( status == -1 )
+    if (!write(s.data(), s.size()))
         return false;
 
     // send data
-    status = ::send(m_sock, buffer, dataLen, MSG_NOSIGNAL);
-    return status != -1;
+    if (dataLen <= 0)
+        return true;
+    return write(reinterpret_cast<const char *>(buffer), dataLen);
 }
 
 void ZMServer::sendError(const std::string &error)
@@ -1784,47 +1851,31 @@ void ZMServer::getMonitorList(void)
     mysql_free_result(res);
 }
 
-int ZMServer::getFrame(FrameData &buffer, MONITOR *monitor)
+static const char *getStateName(int state)
 {
-    // is there a new frame available?
-    if (monitor->getLastWriteIndex() == monitor->m_lastRead )
-        return 0;
-
-    // sanity check last_read
-    if (monitor->getLastWriteIndex() < 0 ||
-            monitor->getLastWriteIndex() >= (monitor->m_imageBufferCount - 1))
-        return 0;
-
-    monitor->m_lastRead = monitor->getLastWriteIndex();
-
-    switch (monitor->getState())
+    switch (state)
     {
         case IDLE:
-            monitor->m_status = "Idle";
-            break;
+            return "Idle";
         case PREALARM:
-            monitor->m_status = "Pre Alarm";
-            break;
+            return "Pre Alarm";
         case ALARM:
-            monitor->m_status = "Alarm";
-            break;
+            return "Alarm";
         case ALERT:
-            monitor->m_status = "Alert";
-            break;
+            return "Alert";
         case TAPE:
-            monitor->m_status = "Tape";
-            break;
+            return "Tape";
         default:
-            monitor->m_status = "Unknown";
-            break;
+            return "Unknown";
     }
+}
 
-    // FIXME: should do some sort of compression JPEG??
-    // just copy the data to our buffer for now
-
+// copies the image at index in the shared memory of monitor to buffer as RGB24
+static void copyFrame(unsigned char *buffer, MONITOR *monitor, int index)
+{
     // fixup the colours if necessary we aim to always send RGB24 images
     unsigned char *data = monitor->m_sharedImages +
-        (static_cast<ptrdiff_t>(monitor->getFrameSize()) * monitor->m_lastRead);
+        (static_cast<ptrdiff_t>(monitor->getFrameSize()) * index);
     unsigned int rpos = 0;
     unsigned int wpos = 0;
 
@@ -1914,9 +1965,393 @@ int ZMServer::getFrame(FrameData &buffer, MONITOR *monitor)
         }
     }
 
+}
+
+int ZMServer::getFrame(FrameData &buffer, MONITOR *monitor)
+{
+    // is there a new frame available?
+    if (monitor->getLastWriteIndex() == monitor->m_lastRead )
+        return 0;
+
+    // sanity check last_read
+    if (monitor->getLastWriteIndex() < 0 ||
+            monitor->getLastWriteIndex() >= (monitor->m_imageBufferCount - 1))
+        return 0;
+
+    monitor->m_lastRead = monitor->getLastWriteIndex();
+    monitor->m_status = getStateName(monitor->getState());
+
+    copyFrame(buffer.data(), monitor, monitor->m_lastRead);
+
     return monitor->m_width * monitor->m_height * 3;
 }
 
+// The newest frame of a monitor. It is converted to RGB24, and scaled or
+// compressed for the subscribers, only once however many clients watch it.
+struct LiveFrame
+{
+    int                  m_index     {-1};
+    time_t               m_writeTime {0};
+    std::string          m_status;
+    int                  m_width   {0};
+    int                  m_height  {0};
+    std::vector<uint8_t> m_rgb;
+    // scaled and JPEG versions of m_rgb by format, width, height and quality
+    std::map<std::array<int,4>, std::vector<uint8_t>> m_variants;
+};
+
+static std::map<int, LiveFrame> s_liveFrames;
+
+static LiveFrame &getLiveFrame(MONITOR *monitor, int index, time_t writeTime)
+{
+    LiveFrame &frame = s_liveFrames[monitor->m_monId];
+
+    // the image buffer is a ring so the index alone doesn't tell whether
+    // the cached frame is still the one in the shared memory, the time
+    // ZoneMinder wrote it does
+    if (frame.m_index == index && frame.m_writeTime == writeTime)
+        return frame;
+
+    frame.m_index = index;
+    frame.m_writeTime = writeTime;
+    frame.m_status = getStateName(monitor->getState());
+    frame.m_width = monitor->m_width;
+    frame.m_height = monitor->m_height;
+    frame.m_rgb.resize(static_cast<size_t>(frame.m_width) * frame.m_height * 3);
+    frame.m_variants.clear();
+    copyFrame(frame.m_rgb.data(), monitor, index);
+
+    return frame;
+}
+
+// shrinks an RGB24 image averaging all the source pixels of each new pixel
+static void scaleFrame(const uint8_t *src, int srcWidth, int srcHeight,
+                       uint8_t *dst, int dstWidth, int dstHeight)
+{
+    std::vector<int> xStart(dstWidth + 1);
+    for (int x = 0; x <= dstWidth; x++)
+        xStart[x] = static_cast<int>(static_cast<int64_t>(x) * srcWidth / dstWidth);
+
+    for (int y = 0; y < dstHeight; y++)
+    {
+        int y0 = static_cast<int>(static_cast<int64_t>(y) * srcHeight / dstHeight);
+        int y1 = std::max(y0 + 1, static_cast<int>(static_cast<int64_t>(y + 1) * srcHeight / dstHeight));
+
+        for (int x = 0; x < dstWidth; x++)
+        {
+            int x0 = xStart[x];
+            int x1 = std::max(x0 + 1, xStart[x + 1]);
+            std::array<uint32_t,3> sum {0, 0, 0};
+
+            for (int sy = y0; sy < y1; sy++)
+            {
+                const uint8_t *p = src + ((static_cast<ptrdiff_t>(sy) * srcWidth + x0) * 3);
+                for (int sx = x0; sx < x1; sx++, p += 3)
+                {
+                    sum[0] += p[0];
+                    sum[1] += p[1];
+                    sum[2] += p[2];
+                }
+            }
+
+            uint32_t count = (x1 - x0) * (y1 - y0);
+            uint8_t *d = dst + ((static_cast<ptrdiff_t>(y) * dstWidth + x) * 3);
+            d[0] = (sum[0] + (count / 2)) / count;
+            d[1] = (sum[1] + (count / 2)) / count;
+            d[2] = (sum[2] + (count / 2)) / count;
+        }
+    }
+}
+
+#ifdef HAVE_LIBJPEG
+static void encodeJpeg(const std::vector<uint8_t> &image, int width, int height,
+                       int quality, std::vector<uint8_t> &out)
+{
+    jpeg_compress_struct cinfo {};
+    jpeg_error_mgr jerr {};
+    unsigned char *mem = nullptr;
+    unsigned long memSize = 0;
+
+    cinfo.err = jpeg_std_error(&jerr);
+    jpeg_create_compress(&cinfo);
+    jpeg_mem_dest(&cinfo, &mem, &memSize);
+
+    cinfo.image_width = width;
+    cinfo.image_height = height;
+    cinfo.input_components = 3;
+    cinfo.in_color_space = JCS_RGB;
+    jpeg_set_defaults(&cinfo);
+    jpeg_set_quality(&cinfo, quality, TRUE);
+    jpeg_start_compress(&cinfo, TRUE);
+
+    while (cinfo.next_scanline < cinfo.image_height)
+    {
+        // libjpeg doesn't write to the scanlines
+        JSAMPROW row = const_cast<uint8_t *>(image.data()) +
+            (static_cast<ptrdiff_t>(cinfo.next_scanline) * width * 3);
+        jpeg_write_scanlines(&cinfo, &row, 1);
+    }
+
+    jpeg_finish_compress(&cinfo);
+    out.assign(mem, mem + memSize);
+    free(mem);
+    jpeg_destroy_compress(&cinfo);
+}
+#endif
+
+// returns the frame scaled to width x height in the requested format
+static const std::vector<uint8_t> &getLiveFrameData(LiveFrame &frame,
+                                                    LiveFrameFormat format,
+                                                    int width, int height,
+                                                    int quality)
+{
+    if (format != LIVE_FRAME_JPEG)
+        quality = 0;
+
+    if (format == LIVE_FRAME_DELTA)
+        format = LIVE_FRAME_RAW;
+
+    if (format == LIVE_FRAME_RAW && width == frame.m_width && height == frame.m_height)
+        return frame.m_rgb;
+
+    std::array<int,4> key {format, width, height, quality};
+    auto it = frame.m_variants.find(key);
+    if (it != frame.m_variants.end())
+        return it->second;
+
+    std::vector<uint8_t> &data = frame.m_variants[key];
+
+    if (format == LIVE_FRAME_RAW)
+    {
+        data.resize(static_cast<size_t>(width) * height * 3);
+        scaleFrame(frame.m_rgb.data(), frame.m_width, frame.m_height,
+                   data.data(), width, height);
+    }
+#ifdef HAVE_LIBJPEG
+    else
+    {
+        encodeJpeg(getLiveFrameData(frame, LIVE_FRAME_RAW, width, height, 0),
+                   width, height, quality, data);
+    }
+#endif
+
+    return data;
+}
+
+static void addDeltaRun(std::vector<uint8_t> &delta, const std::vector<uint8_t> &image,
+                        std::vector<uint8_t> &previous, size_t start, size_t end)
+{
+    for (uint32_t value : {static_cast<uint32_t>(start), static_cast<uint32_t>(end - start)})
+    {
+        delta.push_back(value >> 24);
+        delta.push_back(value >> 16);
+        delta.push_back(value >> 8);
+        delta.push_back(value);
+    }
+    delta.insert(delta.end(), image.begin() + start, image.begin() + end);
+    std::copy(image.begin() + start, image.begin() + end, previous.begin() + start);
+}
+
+// Encodes the parts of image that differ from previous, the frame the client
+// already has, and updates previous to what the client will have. Returns
+// false if sending the whole image is better.
+static bool encodeDelta(const std::vector<uint8_t> &image, std::vector<uint8_t> &previous,
+                        std::vector<uint8_t> &delta)
+{
+    // 16 RGB24 pixels, each one gets sent if any byte in it changed by more
+    // than the threshold so sensor noise doesn't make every block change
+    static constexpr size_t kBlockSize { 48 };
+    static constexpr int kThreshold { 6 };
+
+    delta.clear();
+    if (previous.size() != image.size())
+        return false;
+
+    size_t size = image.size();
+    size_t runStart = 0;
+    bool inRun = false;
+
+    for (size_t pos = 0; pos < size; pos += kBlockSize)
+    {
+        size_t end = std::min(pos + kBlockSize, size);
+        bool changed = false;
+        for (size_t i = pos; i < end && !changed; i++)
+            changed = std::abs(image[i] - previous[i]) > kThreshold;
+
+        if (changed && !inRun)
+        {
+            runStart = pos;
+            inRun = true;
+        }
+        else if (!changed && inRun)
+        {
+            addDeltaRun(delta, image, previous, runStart, pos);
+            inRun = false;
+
+            if (delta.size() > size / 2)
+                return false;
+        }
+    }
+
+    if (inRun)
+        addDeltaRun(delta, image, previous, runStart, size);
+
+    return delta.size() <= size / 2;
+}
+
+void ZMServer::handleSubscribeLiveFrames(std::vector<std::string> tokens)
+{
+    if (tokens.size() != 6)
+    {
+        sendError(ERROR_TOKEN_COUNT);
+        return;
+    }
+
+    int monitorID = atoi(tokens[1].c_str());
+
+    if (m_debug)
+        std::cout << "Subscribing to live frames from monitor: " << monitorID << std::endl;
+
+    // try to find the correct MONITOR
+    if (m_monitorMap.find(monitorID) == m_monitorMap.end())
+    {
+        sendError(ERROR_INVALID_MONITOR);
+        return;
+    }
+
+    LiveSubscription sub;
+
+    if (tokens[2] == "RAW")
+        sub.m_format = LIVE_FRAME_RAW;
+#ifdef HAVE_LIBJPEG
+    else if (tokens[2] == "JPEG")
+        sub.m_format = LIVE_FRAME_JPEG;
+#endif
+    else if (tokens[2] == "DELTA")
+        sub.m_format = LIVE_FRAME_DELTA;
+    else
+    {
+        sendError(ERROR_INVALID_FORMAT);
+        return;
+    }
+
+    sub.m_maxWidth = std::max(0, atoi(tokens[3].c_str()));
+    sub.m_maxHeight = std::max(0, atoi(tokens[4].c_str()));
+    sub.m_quality = std::clamp(atoi(tokens[5].c_str()), 1, 100);
+
+    // a new subscription to the same monitor replaces the old one
+    m_subscriptions[monitorID] = sub;
+
+    std::string outStr;
+    ADD_STR(outStr, "OK");
+    ADD_INT(outStr, monitorID);
+    send(outStr);
+}
+
+void ZMServer::handleUnsubscribeLiveFrames(std::vector<std::string> tokens)
+{
+    if (tokens.size() != 2)
+    {
+        sendError(ERROR_TOKEN_COUNT);
+        return;
+    }
+
+    int monitorID = atoi(tokens[1].c_str());
+
+    if (m_debug)
+        std::cout << "Unsubscribing from live frames of monitor: " << monitorID << std::endl;
+
+    // -1 unsubscribes from all monitors
+    if (monitorID == -1)
+        m_subscriptions.clear();
+    else
+        m_subscriptions.erase(monitorID);
+
+    std::string outStr;
+    ADD_STR(outStr, "OK");
+    ADD_INT(outStr, monitorID);
+    send(outStr);
+}
+
+// sends the subscribed monitors that have a new frame in the shared memory
+void ZMServer::pushLiveFrames(void)
+{
+    std::vector<uint8_t> delta;
+
+    for (auto & [monitorID, sub] : m_subscriptions)
+    {
+        // the client isn't keeping up, skip frames until it has caught up
+        if (m_outBuf.size() > MAX_QUEUED_DATA)
+            return;
+
+        MONITOR *monitor = m_monitorMap[monitorID];
+        if (!monitor->isValid())
+            continue;
+
+        int index = monitor->getLastWriteIndex();
+        time_t writeTime = monitor->getLastWriteTime();
+        if ((index == sub.m_lastIndex && writeTime == sub.m_lastWriteTime) ||
+            index < 0 || index >= (monitor->m_imageBufferCount - 1))
+            continue;
+
+        sub.m_lastIndex = index;
+        sub.m_lastWriteTime = writeTime;
+        LiveFrame &frame = getLiveFrame(monitor, index, writeTime);
+        if (frame.m_width <= 0 || frame.m_height <= 0)
+            continue;
+
+        // fit the frame into the requested size keeping the aspect ratio
+        int width = frame.m_width;
+        int height = frame.m_height;
+        if (sub.m_maxWidth > 0 && width > sub.m_maxWidth)
+        {
+            height = std::max(1, height * sub.m_maxWidth / width);
+            width = sub.m_maxWidth;
+        }
+        if (sub.m_maxHeight > 0 && height > sub.m_maxHeight)
+        {
+            width = std::max(1, width * sub.m_maxHeight / height);
+            height = sub.m_maxHeight;
+        }
+
+        const std::vector<uint8_t> *data =
+            &getLiveFrameData(frame, sub.m_format, width, height, sub.m_quality);
+        std::string format = "RAW";
+
+        if (sub.m_format == LIVE_FRAME_JPEG)
+        {
+            format = "JPEG";
+        }
+        else if (sub.m_format == LIVE_FRAME_DELTA)
+        {
+            if (width == sub.m_previousWidth && height == sub.m_previousHeight &&
+                encodeDelta(*data, sub.m_previous, delta))
+            {
+                format = "DELTA";
+                data = &delta;
+            }
+            else
+            {
+                sub.m_previous = *data;
+                sub.m_previousWidth = width;
+                sub.m_previousHeight = height;
+            }
+        }
+
+        std::string outStr;
+        ADD_STR(outStr, "LIVE_FRAME");
+        ADD_INT(outStr, monitorID);
+        ADD_STR(outStr, frame.m_status);
+        ADD_STR(outStr, format);
+        ADD_INT(outStr, width);
+        ADD_INT(outStr, height);
+        ADD_INT(outStr, static_cast<int>(data->size()));
+
+        if (!send(outStr, data->data(), static_cast<int>(data->size())))
+            return;
+    }
+}
+
 std::string ZMServer::getZMSetting(const std::string &setting) const
 {
     std::string result;
@@ -54,6 +54,12 @@ extern int     g_revisionVersion;
 static constexpr std::chrono::seconds DB_CHECK_TIME { 60s };
 extern TimePoint g_lastDBKick;
 
+// how often the shared memory of subscribed monitors is checked for new frames
+static constexpr std::chrono::milliseconds LIVE_FRAME_POLL_TIME { 20ms };
+
+// new frames are dropped while more than this is waiting to be sent to a client
+static constexpr size_t MAX_QUEUED_DATA { MAX_IMAGE_SIZE };
+
 const std::string FUNCTION_MONITOR = "Monitor";
 const std::string FUNCTION_MODECT  = "Modect";
 const std::string FUNCTION_NODECT  = "Nodect";
@@ -220,6 +226,13 @@ struct SharedData34
 
 
 
+enum LiveFrameFormat : std::uint8_t
+{
+    LIVE_FRAME_RAW,
+    LIVE_FRAME_JPEG,
+    LIVE_FRAME_DELTA
+};
+
 enum TriggerState : std::uint8_t { TRIGGER_CANCEL, TRIGGER_ON, TRIGGER_OFF };
 
 // Triggerdata for ZM version 1.24.x and 1.25.x
@@ -268,6 +281,7 @@ class MONITOR
 
     std::string getIdStr(void);
     int getLastWriteIndex(void);
+    time_t getLastWriteTime(void);
     int getSubpixelOrder(void);
     int getState(void);
     int getFrameSize(void);
@@ -299,6 +313,21 @@ class MONITOR
     std::string    m_id;
 };
 
+// a monitor a client wants new frames of pushed to it
+struct LiveSubscription
+{
+    LiveFrameFormat      m_format          {LIVE_FRAME_RAW};
+    int                  m_maxWidth        {0};
+    int                  m_maxHeight       {0};
+    int                  m_quality         {75};
+    int                  m_lastIndex       {-1};
+    time_t               m_lastWriteTime   {0};
+    // the last frame sent in LIVE_FRAME_DELTA format as the client has it
+    std::vector<uint8_t> m_previous;
+    int                  m_previousWidth   {0};
+    int                  m_previousHeight  {0};
+};
+
 class ZMServer
 {
   public:
@@ -306,11 +335,16 @@ class ZMServer
     ~ZMServer();
 
     bool processRequest(char* buf, int nbytes);
+    void pushLiveFrames(void);
+    bool flush(void);
+    bool hasSubscriptions(void) const { return !m_subscriptions.empty(); }
+    bool hasPendingOutput(void) const { return !m_outBuf.empty(); }
 
   private:
     std::string getZMSetting(const std::string &setting) const;
-    bool send(const std::string &s) const;
-    bool send(const std::string &s, const unsigned char *buffer, int dataLen) const;
+    bool write(const char *data, size_t dataLen);
+    bool send(const std::string &s);
+    bool send(const std::string &s, const unsigned char *buffer, int dataLen);
     void sendError(const std::string &error);
     void getMonitorList(void);
     static int  getFrame(FrameData &buffer, MONITOR *monitor);
@@ -332,6 +366,8 @@ class ZMServer
     void handleGetEventFrame(std::vector<std::string> tokens);
     void handleGetAnalysisFrame(std::vector<std::string> tokens);
     void handleGetLiveFrame(std::vector<std::string> tokens);
+    void handleSubscribeLiveFrames(std::vector<std::string> tokens);
+    void handleUnsubscribeLiveFrames(std::vector<std::string> tokens);
     void handleGetFrameList(std::vector<std::string> tokens);
     void handleDeleteEvent(std::vector<std::string> tokens);
     void handleDeleteEventList(std::vector<std::string> tokens);
@@ -351,6 +387,8 @@ class ZMServer
     std::string          m_analysisFileFormat;
     key_t                m_shmKey;
     std::string          m_mmapPath;
+    std::map<int, LiveSubscription> m_subscriptions;
+    std::string          m_outBuf;
 };
 
 
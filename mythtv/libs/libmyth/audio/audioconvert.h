@@ -65,7 +65,8 @@ public:
                            int data_size);
 
     // static utilities
-    static int  toFloat(AudioFormat format, void* out, const void* in, int bytes);
+    static int  toFloat(AudioFormat format, void* out, const void* in, int bytes,
+                        float gain = 1.0F);
     static int  fromFloat(AudioFormat format, void* out, const void* in, int bytes);
     static void MonoToStereo(void* dst, const void* src, int samples);
     static void DeinterleaveSamples(AudioFormat format, int channels,
@@ -0,0 +1,921 @@
+#include "audiokernels.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+#include <QtGlobal>
+
+#include "libmythbase/mythconfig.h"
+
+extern "C" {
+#include "libavutil/cpu.h"
+}
+
+#ifdef Q_PROCESSOR_X86_64
+#   include <emmintrin.h>
+#   define AK_HAVE_SSE2 1
+#   if defined(__GNUC__) || defined(__clang__)
+#       include <immintrin.h>
+#       define AK_HAVE_AVX2 1
+#       define AK_TARGET_AVX2 __attribute__((target("avx2")))
+#   endif
+#elif HAVE_INTRINSICS_NEON && defined(__aarch64__)
+// vcvtnq (round to nearest) and vtrn1q/vtrn2q are AArch64 only
+#   include <arm_neon.h>
+#   define AK_HAVE_NEON 1
+#endif
+
+/*
+ Scalar reference versions. The vector versions below process whole vectors
+ and hand any remainder to these.
+ */
+
+static void toFloatU8_C(float *out, const uint8_t *in, int len, float scale)
+{
+    for (int i = 0; i < len; i++)
+        out[i] = (in[i] - 0x80) * scale;
+}
+
+static void toFloatS16_C(float *out, const int16_t *in, int len, float scale)
+{
+    for (int i = 0; i < len; i++)
+        out[i] = in[i] * scale;
+}
+
+static void toFloatS32_C(float *out, const int32_t *in, int len, int shift, float scale)
+{
+    for (int i = 0; i < len; i++)
+        out[i] = (in[i] >> shift) * scale;
+}
+
+static inline uint8_t clip_uint8(long a)
+{
+    if (a&(~0xFF))
+        return (-a)>>31;
+    return a;
+}
+
+static void fromFloatU8_C(uint8_t *out, const float *in, int len)
+{
+    float f = (1<<7);
+    for (int i = 0; i < len; i++)
+        out[i] = clip_uint8(lrintf(in[i] * f) + 0x80);
+}
+
+static inline int16_t clip_short(long a)
+{
+    if ((a+0x8000) & ~0xFFFF)
+        return (a>>31) ^ 0x7FFF;
+    return a;
+}
+
+static void fromFloatS16_C(int16_t *out, const float *in, int len)
+{
+    float f = (1<<15);
+    for (int i = 0; i < len; i++)
+        out[i] = clip_short(lrintf(in[i] * f));
+}
+
+static void fromFloatS32_C(int32_t *out, const float *in, int len, int bits, int shift)
+{
+    uint range = 1U<<(bits-1);
+    auto f = static_cast<float>(range);
+    for (int i = 0; i < len; i++)
+    {
+        float valf = in[i];
+
+        if (valf >= 1.0F)
+            out[i] = (range - 128) << shift;
+        else if (valf <= -1.0F)
+            out[i] = (-range) << shift;
+        else
+            out[i] = static_cast<uint>(lrintf(valf * f)) << shift;
+    }
+}
+
+static void clipFloat_C(float *out, const float *in, int len)
+{
+    for (int i = 0; i < len; i++)
+        out[i] = std::clamp(in[i], -1.0F, 1.0F);
+}
+
+static void scaleFloat_C(float *out, const float *in, int len, float gain)
+{
+    for (int i = 0; i < len; i++)
+        out[i] = in[i] * gain;
+}
+
+static void downmix_C(float *out, const float *in, int frames,
+                      int channels_in, int channels_out, const float *matrix)
+{
+    for (int n = 0; n < frames; n++)
+    {
+        // Keep the whole output frame in registers, out may overlap in
+        std::array<float,8> tmp {};
+        for (int j = 0; j < channels_in; j++)
+            for (int i = 0; i < channels_out; i++)
+                tmp[i] += in[j] * matrix[(j * channels_out) + i];
+        std::copy(tmp.cbegin(), tmp.cbegin() + channels_out, out);
+        in  += channels_in;
+        out += channels_out;
+    }
+}
+
+template <class AudioDataType>
+static void muteStereo_C(AudioDataType *buffer, int frames, int ch)
+{
+    AudioDataType *s1 = buffer + ch;
+    AudioDataType *s2 = buffer - ch + 1;
+
+    for (int i = 0; i < frames; i++)
+    {
+        *s1 = *s2;
+        s1 += 2;
+        s2 += 2;
+    }
+}
+
+#ifdef AK_HAVE_SSE2
+static void toFloatU8_SSE2(float *out, const uint8_t *in, int len, float scale)
+{
+    const __m128i bias = _mm_set1_epi8(static_cast<char>(0x80));
+    const __m128  f    = _mm_set1_ps(scale);
+    int i = 0;
+    for ( ; i + 16 <= len; i += 16)
+    {
+        // Unsigned to signed, then sign extend by unpacking into the top byte
+        __m128i v  = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i)), bias);
+        __m128i lo = _mm_unpacklo_epi8(_mm_setzero_si128(), v);
+        __m128i hi = _mm_unpackhi_epi8(_mm_setzero_si128(), v);
+        __m128i a  = _mm_srai_epi32(_mm_unpacklo_epi16(_mm_setzero_si128(), lo), 24);
+        __m128i b  = _mm_srai_epi32(_mm_unpackhi_epi16(_mm_setzero_si128(), lo), 24);
+        __m128i c  = _mm_srai_epi32(_mm_unpacklo_epi16(_mm_setzero_si128(), hi), 24);
+        __m128i d  = _mm_srai_epi32(_mm_unpackhi_epi16(_mm_setzero_si128(), hi), 24);
+        _mm_storeu_ps(out + i,      _mm_mul_ps(_mm_cvtepi32_ps(a), f));
+        _mm_storeu_ps(out + i + 4,  _mm_mul_ps(_mm_cvtepi32_ps(b), f));
+        _mm_storeu_ps(out + i + 8,  _mm_mul_ps(_mm_cvtepi32_ps(c), f));
+        _mm_storeu_ps(out + i + 12, _mm_mul_ps(_mm_cvtepi32_ps(d), f));
+    }
+    toFloatU8_C(out + i, in + i, len - i, scale);
+}
+
+static void toFloatS16_SSE2(float *out, const int16_t *in, int len, float scale)
+{
+    const __m128 f = _mm_set1_ps(scale);
+    int i = 0;
+    for ( ; i + 8 <= len; i += 8)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        __m128i a = _mm_srai_epi32(_mm_unpacklo_epi16(_mm_setzero_si128(), v), 16);
+        __m128i b = _mm_srai_epi32(_mm_unpackhi_epi16(_mm_setzero_si128(), v), 16);
+        _mm_storeu_ps(out + i,     _mm_mul_ps(_mm_cvtepi32_ps(a), f));
+        _mm_storeu_ps(out + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(b), f));
+    }
+    toFloatS16_C(out + i, in + i, len - i, scale);
+}
+
+static void toFloatS32_SSE2(float *out, const int32_t *in, int len, int shift, float scale)
+{
+    const __m128  f     = _mm_set1_ps(scale);
+    const __m128i count = _mm_cvtsi32_si128(shift);
+    int i = 0;
+    for ( ; i + 4 <= len; i += 4)
+    {
+        __m128i v = _mm_sra_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i)), count);
+        _mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(v), f));
+    }
+    toFloatS32_C(out + i, in + i, len - i, shift, scale);
+}
+
+// Clamping before the conversion gives the same result as rounding first and
+// clipping the integer, without the conversion overflowing for large values.
+static inline __m128i toInt8Range_SSE2(const float *in)
+{
+    __m128 x = _mm_mul_ps(_mm_loadu_ps(in), _mm_set1_ps(1<<7));
+    return _mm_cvtps_epi32(_mm_max_ps(_mm_min_ps(x, _mm_set1_ps(127.0F)), _mm_set1_ps(-128.0F)));
+}
+
+static void fromFloatU8_SSE2(uint8_t *out, const float *in, int len)
+{
+    const __m128i bias = _mm_set1_epi8(static_cast<char>(0x80));
+    int i = 0;
+    for ( ; i + 16 <= len; i += 16)
+    {
+        __m128i r = _mm_packs_epi16(_mm_packs_epi32(toInt8Range_SSE2(in + i),
+                                                    toInt8Range_SSE2(in + i + 4)),
+                                    _mm_packs_epi32(toInt8Range_SSE2(in + i + 8),
+                                                    toInt8Range_SSE2(in + i + 12)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_xor_si128(r, bias));
+    }
+    fromFloatU8_C(out + i, in + i, len - i);
+}
+
+static void fromFloatS16_SSE2(int16_t *out, const float *in, int len)
+{
+    const __m128 f   = _mm_set1_ps(1<<15);
+    const __m128 max = _mm_set1_ps(32767.0F);
+    const __m128 min = _mm_set1_ps(-32768.0F);
+    int i = 0;
+    for ( ; i + 8 <= len; i += 8)
+    {
+        __m128 a = _mm_mul_ps(_mm_loadu_ps(in + i), f);
+        __m128 b = _mm_mul_ps(_mm_loadu_ps(in + i + 4), f);
+        __m128i ia = _mm_cvtps_epi32(_mm_max_ps(_mm_min_ps(a, max), min));
+        __m128i ib = _mm_cvtps_epi32(_mm_max_ps(_mm_min_ps(b, max), min));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_packs_epi32(ia, ib));
+    }
+    fromFloatS16_C(out + i, in + i, len - i);
+}
+
+static void fromFloatS32_SSE2(int32_t *out, const float *in, int len, int bits, int shift)
+{
+    uint range = 1U<<(bits-1);
+    const __m128  f     = _mm_set1_ps(static_cast<float>(range));
+    const __m128  one   = _mm_set1_ps(1.0F);
+    const __m128  mone  = _mm_set1_ps(-1.0F);
+    const __m128i top   = _mm_set1_epi32(static_cast<int>(range - 128));
+    const __m128i bot   = _mm_set1_epi32(static_cast<int>(-range));
+    const __m128i count = _mm_cvtsi32_si128(shift);
+    int i = 0;
+    for ( ; i + 4 <= len; i += 4)
+    {
+        __m128  x  = _mm_loadu_ps(in + i);
+        __m128i hi = _mm_castps_si128(_mm_cmpge_ps(x, one));
+        __m128i lo = _mm_castps_si128(_mm_cmple_ps(x, mone));
+        __m128i v  = _mm_cvtps_epi32(_mm_mul_ps(x, f));
+        v = _mm_or_si128(_mm_andnot_si128(hi, v), _mm_and_si128(hi, top));
+        v = _mm_or_si128(_mm_andnot_si128(lo, v), _mm_and_si128(lo, bot));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_sll_epi32(v, count));
+    }
+    fromFloatS32_C(out + i, in + i, len - i, bits, shift);
+}
+
+static void clipFloat_SSE2(float *out, const float *in, int len)
+{
+    const __m128 one  = _mm_set1_ps(1.0F);
+    const __m128 mone = _mm_set1_ps(-1.0F);
+    int i = 0;
+    for ( ; i + 4 <= len; i += 4)
+        _mm_storeu_ps(out + i, _mm_max_ps(_mm_min_ps(_mm_loadu_ps(in + i), one), mone));
+    clipFloat_C(out + i, in + i, len - i);
+}
+
+static void scaleFloat_SSE2(float *out, const float *in, int len, float gain)
+{
+    const __m128 g = _mm_set1_ps(gain);
+    int i = 0;
+    for ( ; i + 4 <= len; i += 4)
+        _mm_storeu_ps(out + i, _mm_mul_ps(_mm_loadu_ps(in + i), g));
+    scaleFloat_C(out + i, in + i, len - i, gain);
+}
+
+/*
+ The matrix rows are accumulated in the same order as the scalar version so
+ the results are identical. Stereo output packs two frames per vector, 5.1
+ output uses one vector for L R C LFE and half of another for LS RS.
+ Every frame is read before it is written, so this works in place.
+ */
+static void downmix_SSE2(float *out, const float *in, int frames,
+                         int channels_in, int channels_out, const float *matrix)
+{
+    if (channels_in > 8 || (channels_out != 2 && channels_out != 6))
+    {
+        downmix_C(out, in, frames, channels_in, channels_out, matrix);
+        return;
+    }
+
+    int n = 0;
+    if (channels_out == 2)
+    {
+        __m128 rows[8]; // NOLINT(modernize-avoid-c-arrays)
+        for (int j = 0; j < channels_in; j++)
+        {
+            __m128 row = _mm_castpd_ps(_mm_load_sd(reinterpret_cast<const double*>(matrix + (j * 2))));
+            rows[j] = _mm_movelh_ps(row, row);
+        }
+        for ( ; n + 2 <= frames; n += 2)
+        {
+            const float *in2 = in + channels_in;
+            __m128 acc = _mm_setzero_ps();
+            for (int j = 0; j < channels_in; j++)
+            {
+                __m128 s = _mm_movelh_ps(_mm_set1_ps(in[j]), _mm_set1_ps(in2[j]));
+                acc = _mm_add_ps(acc, _mm_mul_ps(s, rows[j]));
+            }
+            _mm_storeu_ps(out, acc);
+            in  += channels_in * 2;
+            out += 4;
+        }
+    }
+    else
+    {
+        __m128 rows0[8]; // NOLINT(modernize-avoid-c-arrays)
+        __m128 rows1[8]; // NOLINT(modernize-avoid-c-arrays)
+        for (int j = 0; j < channels_in; j++)
+        {
+            rows0[j] = _mm_loadu_ps(matrix + (j * 6));
+            rows1[j] = _mm_castpd_ps(_mm_load_sd(reinterpret_cast<const double*>(matrix + (j * 6) + 4)));
+        }
+        for ( ; n < frames; n++)
+        {
+            __m128 acc0 = _mm_setzero_ps();
+            __m128 acc1 = _mm_setzero_ps();
+            for (int j = 0; j < channels_in; j++)
+            {
+                __m128 s = _mm_set1_ps(in[j]);
+                acc0 = _mm_add_ps(acc0, _mm_mul_ps(s, rows0[j]));
+                acc1 = _mm_add_ps(acc1, _mm_mul_ps(s, rows1[j]));
+            }
+            _mm_storeu_ps(out, acc0);
+            _mm_storel_pi(reinterpret_cast<__m64*>(out + 4), acc1);
+            in  += channels_in;
+            out += 6;
+        }
+    }
+    downmix_C(out, in, frames - n, channels_in, channels_out, matrix);
+}
+
+static void muteStereo16_SSE2(int16_t *buffer, int frames, int ch)
+{
+    int i = 0;
+    for ( ; i + 4 <= frames; i += 4)
+    {
+        auto *p = reinterpret_cast<__m128i*>(buffer + (i * 2));
+        __m128i v = _mm_loadu_si128(p);
+        if (ch == 0)
+            v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, _MM_SHUFFLE(3,3,1,1)), _MM_SHUFFLE(3,3,1,1));
+        else
+            v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, _MM_SHUFFLE(2,2,0,0)), _MM_SHUFFLE(2,2,0,0));
+        _mm_storeu_si128(p, v);
+    }
+    muteStereo_C(buffer + (i * 2), frames - i, ch);
+}
+
+static void muteStereo32_SSE2(int32_t *buffer, int frames, int ch)
+{
+    int i = 0;
+    for ( ; i + 2 <= frames; i += 2)
+    {
+        auto *p = reinterpret_cast<__m128i*>(buffer + (i * 2));
+        __m128i v = _mm_loadu_si128(p);
+        if (ch == 0)
+            v = _mm_shuffle_epi32(v, _MM_SHUFFLE(3,3,1,1));
+        else
+            v = _mm_shuffle_epi32(v, _MM_SHUFFLE(2,2,0,0));
+        _mm_storeu_si128(p, v);
+    }
+    muteStereo_C(buffer + (i * 2), frames - i, ch);
+}
+#endif // AK_HAVE_SSE2
+
+#ifdef AK_HAVE_AVX2
+AK_TARGET_AVX2
+static void toFloatU8_AVX2(float *out, const uint8_t *in, int len, float scale)
+{
+    const __m128i bias = _mm_set1_epi8(static_cast<char>(0x80));
+    const __m256  f    = _mm256_set1_ps(scale);
+    int i = 0;
+    for ( ; i + 16 <= len; i += 16)
+    {
+        __m128i v = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i)), bias);
+        __m256i a = _mm256_cvtepi8_epi32(v);
+        __m256i b = _mm256_cvtepi8_epi32(_mm_srli_si128(v, 8));
+        _mm256_storeu_ps(out + i,     _mm256_mul_ps(_mm256_cvtepi32_ps(a), f));
+        _mm256_storeu_ps(out + i + 8, _mm256_mul_ps(_mm256_cvtepi32_ps(b), f));
+    }
+    toFloatU8_C(out + i, in + i, len - i, scale);
+}
+
+AK_TARGET_AVX2
+static void toFloatS16_AVX2(float *out, const int16_t *in, int len, float scale)
+{
+    const __m256 f = _mm256_set1_ps(scale);
+    int i = 0;
+    for ( ; i + 16 <= len; i += 16)
+    {
+        __m256i a = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i)));
+        __m256i b = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i + 8)));
+        _mm256_storeu_ps(out + i,     _mm256_mul_ps(_mm256_cvtepi32_ps(a), f));
+        _mm256_storeu_ps(out + i + 8, _mm256_mul_ps(_mm256_cvtepi32_ps(b), f));
+    }
+    toFloatS16_C(out + i, in + i, len - i, scale);
+}
+
+AK_TARGET_AVX2
+static void toFloatS32_AVX2(float *out, const int32_t *in, int len, int shift, float scale)
+{
+    const __m256  f     = _mm256_set1_ps(scale);
+    const __m128i count = _mm_cvtsi32_si128(shift);
+    int i = 0;
+    for ( ; i + 8 <= len; i += 8)
+    {
+        __m256i v = _mm256_sra_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i)), count);
+        _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_cvtepi32_ps(v), f));
+    }
+    toFloatS32_C(out + i, in + i, len - i, shift, scale);
+}
+
+AK_TARGET_AVX2
+static inline __m256i toInt8Range_AVX2(const float *in)
+{
+    __m256 x = _mm256_mul_ps(_mm256_loadu_ps(in), _mm256_set1_ps(1<<7));
+    return _mm256_cvtps_epi32(_mm256_max_ps(_mm256_min_ps(x, _mm256_set1_ps(127.0F)),
+                                            _mm256_set1_ps(-128.0F)));
+}
+
+AK_TARGET_AVX2
+static void fromFloatU8_AVX2(uint8_t *out, const float *in, int len)
+{
+    const __m256i bias = _mm256_set1_epi8(static_cast<char>(0x80));
+    // The packs work within 128 bit lanes, this puts the dwords back in order
+    const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    int i = 0;
+    for ( ; i + 32 <= len; i += 32)
+    {
+        __m256i r = _mm256_packs_epi16(_mm256_packs_epi32(toInt8Range_AVX2(in + i),
+                                                          toInt8Range_AVX2(in + i + 8)),
+                                       _mm256_packs_epi32(toInt8Range_AVX2(in + i + 16),
+                                                          toInt8Range_AVX2(in + i + 24)));
+        r = _mm256_permutevar8x32_epi32(r, order);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_xor_si256(r, bias));
+    }
+    fromFloatU8_C(out + i, in + i, len - i);
+}
+
+AK_TARGET_AVX2
+static void fromFloatS16_AVX2(int16_t *out, const float *in, int len)
+{
+    const __m256 f   = _mm256_set1_ps(1<<15);
+    const __m256 max = _mm256_set1_ps(32767.0F);
+    const __m256 min = _mm256_set1_ps(-32768.0F);
+    int i = 0;
+    for ( ; i + 16 <= len; i += 16)
+    {
+        __m256 a = _mm256_mul_ps(_mm256_loadu_ps(in + i), f);
+        __m256 b = _mm256_mul_ps(_mm256_loadu_ps(in + i + 8), f);
+        __m256i ia = _mm256_cvtps_epi32(_mm256_max_ps(_mm256_min_ps(a, max), min));
+        __m256i ib = _mm256_cvtps_epi32(_mm256_max_ps(_mm256_min_ps(b, max), min));
+        __m256i r  = _mm256_permute4x64_epi64(_mm256_packs_epi32(ia, ib), _MM_SHUFFLE(3,1,2,0));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), r);
+    }
+    fromFloatS16_C(out + i, in + i, len - i);
+}
+
+AK_TARGET_AVX2
+static void fromFloatS32_AVX2(int32_t *out, const float *in, int len, int bits, int shift)
+{
+    uint range = 1U<<(bits-1);
+    const __m256  f     = _mm256_set1_ps(static_cast<float>(range));
+    const __m256  one   = _mm256_set1_ps(1.0F);
+    const __m256  mone  = _mm256_set1_ps(-1.0F);
+    const __m256  top   = _mm256_castsi256_ps(_mm256_set1_epi32(static_cast<int>(range - 128)));
+    const __m256  bot   = _mm256_castsi256_ps(_mm256_set1_epi32(static_cast<int>(-range)));
+    const __m128i count = _mm_cvtsi32_si128(shift);
+    int i = 0;
+    for ( ; i + 8 <= len; i += 8)
+    {
+        __m256 x = _mm256_loadu_ps(in + i);
+        __m256 v = _mm256_castsi256_ps(_mm256_cvtps_epi32(_mm256_mul_ps(x, f)));
+        v = _mm256_blendv_ps(v, top, _mm256_cmp_ps(x, one, _CMP_GE_OQ));
+        v = _mm256_blendv_ps(v, bot, _mm256_cmp_ps(x, mone, _CMP_LE_OQ));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i),
+                            _mm256_sll_epi32(_mm256_castps_si256(v), count));
+    }
+    fromFloatS32_C(out + i, in + i, len - i, bits, shift);
+}
+
+AK_TARGET_AVX2
+static void clipFloat_AVX2(float *out, const float *in, int len)
+{
+    const __m256 one  = _mm256_set1_ps(1.0F);
+    const __m256 mone = _mm256_set1_ps(-1.0F);
+    int i = 0;
+    for ( ; i + 8 <= len; i += 8)
+        _mm256_storeu_ps(out + i, _mm256_max_ps(_mm256_min_ps(_mm256_loadu_ps(in + i), one), mone));
+    clipFloat_C(out + i, in + i, len - i);
+}
+
+AK_TARGET_AVX2
+static void scaleFloat_AVX2(float *out, const float *in, int len, float gain)
+{
+    const __m256 g = _mm256_set1_ps(gain);
+    int i = 0;
+    for ( ; i + 8 <= len; i += 8)
+        _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_loadu_ps(in + i), g));
+    scaleFloat_C(out + i, in + i, len - i, gain);
+}
+
+// Four stereo frames per vector, 5.1 output is left to the SSE2 version
+AK_TARGET_AVX2
+static void downmix_AVX2(float *out, const float *in, int frames,
+                         int channels_in, int channels_out, const float *matrix)
+{
+    if (channels_in > 8 || channels_out != 2)
+    {
+        downmix_SSE2(out, in, frames, channels_in, channels_out, matrix);
+        return;
+    }
+
+    __m256 rows[8]; // NOLINT(modernize-avoid-c-arrays)
+    for (int j = 0; j < channels_in; j++)
+    {
+        __m128 row = _mm_castpd_ps(_mm_load_sd(reinterpret_cast<const double*>(matrix + (j * 2))));
+        row = _mm_movelh_ps(row, row);
+        rows[j] = _mm256_insertf128_ps(_mm256_castps128_ps256(row), row, 1);
+    }
+
+    int n = 0;
+    for ( ; n + 4 <= frames; n += 4)
+    {
+        __m256 acc = _mm256_setzero_ps();
+        for (int j = 0; j < channels_in; j++)
+        {
+            __m128 s01 = _mm_movelh_ps(_mm_set1_ps(in[j]), _mm_set1_ps(in[channels_in + j]));
+            __m128 s23 = _mm_movelh_ps(_mm_set1_ps(in[(channels_in * 2) + j]),
+                                       _mm_set1_ps(in[(channels_in * 3) + j]));
+            __m256 s = _mm256_insertf128_ps(_mm256_castps128_ps256(s01), s23, 1);
+            acc = _mm256_add_ps(acc, _mm256_mul_ps(s, rows[j]));
+        }
+        _mm256_storeu_ps(out, acc);
+        in  += channels_in * 4;
+        out += 8;
+    }
+    downmix_SSE2(out, in, frames - n, channels_in, channels_out, matrix);
+}
+
+AK_TARGET_AVX2
+static void muteStereo16_AVX2(int16_t *buffer, int frames, int ch)
+{
+    int i = 0;
+    for ( ; i + 8 <= frames; i += 8)
+    {
+        auto *p = reinterpret_cast<__m256i*>(buffer + (i * 2));
+        __m256i v = _mm256_loadu_si256(p);
+        if (ch == 0)
+            v = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(v, _MM_SHUFFLE(3,3,1,1)), _MM_SHUFFLE(3,3,1,1));
+        else
+            v = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(v, _MM_SHUFFLE(2,2,0,0)), _MM_SHUFFLE(2,2,0,0));
+        _mm256_storeu_si256(p, v);
+    }
+    muteStereo_C(buffer + (i * 2), frames - i, ch);
+}
+
+AK_TARGET_AVX2
+static void muteStereo32_AVX2(int32_t *buffer, int frames, int ch)
+{
+    int i = 0;
+    for ( ; i + 4 <= frames; i += 4)
+    {
+        auto *p = reinterpret_cast<__m256i*>(buffer + (i * 2));
+        __m256i v = _mm256_loadu_si256(p);
+        if (ch == 0)
+            v = _mm256_shuffle_epi32(v, _MM_SHUFFLE(3,3,1,1));
+        else
+            v = _mm256_shuffle_epi32(v, _MM_SHUFFLE(2,2,0,0));
+        _mm256_storeu_si256(p, v);
+    }
+    muteStereo_C(buffer + (i * 2), frames - i, ch);
+}
+#endif // AK_HAVE_AVX2
+
+#ifdef AK_HAVE_NEON
+static void toFloatU8_NEON(float *out, const uint8_t *in, int len, float scale)
+{
+    const uint8x16_t bias = vdupq_n_u8(0x80);
+    int i = 0;
+    for ( ; i + 16 <= len; i += 16)
+    {
+        int8x16_t v  = vreinterpretq_s8_u8(veorq_u8(vld1q_u8(in + i), bias));
+        int16x8_t lo = vmovl_s8(vget_low_s8(v));
+        int16x8_t hi = vmovl_s8(vget_high_s8(v));
+        vst1q_f32(out + i,      vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(lo))), scale));
+        vst1q_f32(out + i + 4,  vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(lo))), scale));
+        vst1q_f32(out + i + 8,  vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(hi))), scale));
+        vst1q_f32(out + i + 12, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(hi))), scale));
+    }
+    toFloatU8_C(out + i, in + i, len - i, scale);
+}
+
+static void toFloatS16_NEON(float *out, const int16_t *in, int len, float scale)
+{
+    int i = 0;
+    for ( ; i + 8 <= len; i += 8)
+    {
+        int16x8_t v = vld1q_s16(in + i);
+        vst1q_f32(out + i,     vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(v))), scale));
+        vst1q_f32(out + i + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(v))), scale));
+    }
+    toFloatS16_C(out + i, in + i, len - i, scale);
+}
+
+static void toFloatS32_NEON(float *out, const int32_t *in, int len, int shift, float scale)
+{
+    // Shifting left by a negative count is an arithmetic right shift
+    const int32x4_t count = vdupq_n_s32(-shift);
+    int i = 0;
+    for ( ; i + 4 <= len; i += 4)
+    {
+        int32x4_t v = vshlq_s32(vld1q_s32(in + i), count);
+        vst1q_f32(out + i, vmulq_n_f32(vcvtq_f32_s32(v), scale));
+    }
+    toFloatS32_C(out + i, in + i, len - i, shift, scale);
+}
+
+static void fromFloatU8_NEON(uint8_t *out, const float *in, int len)
+{
+    const float32x4_t max  = vdupq_n_f32(127.0F);
+    const float32x4_t min  = vdupq_n_f32(-128.0F);
+    const uint8x16_t  bias = vdupq_n_u8(0x80);
+    int i = 0;
+    for ( ; i + 16 <= len; i += 16)
+    {
+        std::array<int32x4_t,4> v {};
+        for (size_t j = 0; j < v.size(); j++)
+        {
+            float32x4_t x = vmulq_n_f32(vld1q_f32(in + i + (j * 4)), 1<<7);
+            v[j] = vcvtnq_s32_f32(vmaxq_f32(vminq_f32(x, max), min));
+        }
+        int16x8_t a = vcombine_s16(vqmovn_s32(v[0]), vqmovn_s32(v[1]));
+        int16x8_t b = vcombine_s16(vqmovn_s32(v[2]), vqmovn_s32(v[3]));
+        int8x16_t r = vcombine_s8(vqmovn_s16(a), vqmovn_s16(b));
+        vst1q_u8(out + i, veorq_u8(vreinterpretq_u8_s8(r), bias));
+    }
+    fromFloatU8_C(out + i, in + i, len - i);
+}
+
+static void fromFloatS16_NEON(int16_t *out, const float *in, int len)
+{
+    int i = 0;
+    for ( ; i + 8 <= len; i += 8)
+    {
+        // Both the conversion and the narrowing saturate, no clamp needed
+        int32x4_t a = vcvtnq_s32_f32(vmulq_n_f32(vld1q_f32(in + i), 1<<15));
+        int32x4_t b = vcvtnq_s32_f32(vmulq_n_f32(vld1q_f32(in + i + 4), 1<<15));
+        vst1q_s16(out + i, vcombine_s16(vqmovn_s32(a), vqmovn_s32(b)));
+    }
+    fromFloatS16_C(out + i, in + i, len - i);
+}
+
+static void fromFloatS32_NEON(int32_t *out, const float *in, int len, int bits, int shift)
+{
+    uint range = 1U<<(bits-1);
+    auto f = static_cast<float>(range);
+    const int32x4_t top   = vdupq_n_s32(static_cast<int>(range - 128));
+    const int32x4_t bot   = vdupq_n_s32(static_cast<int>(-range));
+    const int32x4_t count = vdupq_n_s32(shift);
+    int i = 0;
+    for ( ; i + 4 <= len; i += 4)
+    {
+        float32x4_t x = vld1q_f32(in + i);
+        int32x4_t   v = vcvtnq_s32_f32(vmulq_n_f32(x, f));
+        v = vbslq_s32(vcgeq_f32(x, vdupq_n_f32(1.0F)), top, v);
+        v = vbslq_s32(vcleq_f32(x, vdupq_n_f32(-1.0F)), bot, v);
+        vst1q_s32(out + i, vshlq_s32(v, count));
+    }
+    fromFloatS32_C(out + i, in + i, len - i, bits, shift);
+}
+
+static void clipFloat_NEON(float *out, const float *in, int len)
+{
+    const float32x4_t one  = vdupq_n_f32(1.0F);
+    const float32x4_t mone = vdupq_n_f32(-1.0F);
+    int i = 0;
+    for ( ; i + 4 <= len; i += 4)
+        vst1q_f32(out + i, vmaxq_f32(vminq_f32(vld1q_f32(in + i), one), mone));
+    clipFloat_C(out + i, in + i, len - i);
+}
+
+static void scaleFloat_NEON(float *out, const float *in, int len, float gain)
+{
+    int i = 0;
+    for ( ; i + 4 <= len; i += 4)
+        vst1q_f32(out + i, vmulq_n_f32(vld1q_f32(in + i), gain));
+    scaleFloat_C(out + i, in + i, len - i, gain);
+}
+
+static void downmix_NEON(float *out, const float *in, int frames,
+                         int channels_in, int channels_out, const float *matrix)
+{
+    if (channels_in > 8 || (channels_out != 2 && channels_out != 6))
+    {
+        downmix_C(out, in, frames, channels_in, channels_out, matrix);
+        return;
+    }
+
+    int n = 0;
+    if (channels_out == 2)
+    {
+        std::array<float32x4_t,8> rows {};
+        for (int j = 0; j < channels_in; j++)
+        {
+            float32x2_t row = vld1_f32(matrix + (j * 2));
+            rows[j] = vcombine_f32(row, row);
+        }
+        for ( ; n + 2 <= frames; n += 2)
+        {
+            const float *in2 = in + channels_in;
+            float32x4_t acc = vdupq_n_f32(0.0F);
+            for (int j = 0; j < channels_in; j++)
+            {
+                float32x4_t s = vcombine_f32(vdup_n_f32(in[j]), vdup_n_f32(in2[j]));
+                acc = vaddq_f32(acc, vmulq_f32(s, rows[j]));
+            }
+            vst1q_f32(out, acc);
+            in  += channels_in * 2;
+            out += 4;
+        }
+    }
+    else
+    {
+        std::array<float32x4_t,8> rows0 {};
+        std::array<float32x2_t,8> rows1 {};
+        for (int j = 0; j < channels_in; j++)
+        {
+            rows0[j] = vld1q_f32(matrix + (j * 6));
+            rows1[j] = vld1_f32(matrix + (j * 6) + 4);
+        }
+        for ( ; n < frames; n++)
+        {
+            float32x4_t acc0 = vdupq_n_f32(0.0F);
+            float32x2_t acc1 = vdup_n_f32(0.0F);
+            for (int j = 0; j < channels_in; j++)
+            {
+                acc0 = vaddq_f32(acc0, vmulq_n_f32(rows0[j], in[j]));
+                acc1 = vadd_f32(acc1, vmul_n_f32(rows1[j], in[j]));
+            }
+            vst1q_f32(out, acc0);
+            vst1_f32(out + 4, acc1);
+            in  += channels_in;
+            out += 6;
+        }
+    }
+    downmix_C(out, in, frames - n, channels_in, channels_out, matrix);
+}
+
+static void muteStereo16_NEON(int16_t *buffer, int frames, int ch)
+{
+    int i = 0;
+    for ( ; i + 4 <= frames; i += 4)
+    {
+        int16_t *p = buffer + (i * 2);
+        int16x8_t v = vld1q_s16(p);
+        vst1q_s16(p, (ch == 0) ? vtrn2q_s16(v, v) : vtrn1q_s16(v, v));
+    }
+    muteStereo_C(buffer + (i * 2), frames - i, ch);
+}
+
+static void muteStereo32_NEON(int32_t *buffer, int frames, int ch)
+{
+    int i = 0;
+    for ( ; i + 2 <= frames; i += 2)
+    {
+        int32_t *p = buffer + (i * 2);
+        int32x4_t v = vld1q_s32(p);
+        vst1q_s32(p, (ch == 0) ? vtrn2q_s32(v, v) : vtrn1q_s32(v, v));
+    }
+    muteStereo_C(buffer + (i * 2), frames - i, ch);
+}
+#endif // AK_HAVE_NEON
+
+static AudioKernels MakeScalar(void)
+{
+    AudioKernels k;
+    k.m_level         = AudioKernels::kScalar;
+    k.m_toFloatU8     = toFloatU8_C;
+    k.m_toFloatS16    = toFloatS16_C;
+    k.m_toFloatS32    = toFloatS32_C;
+    k.m_fromFloatU8   = fromFloatU8_C;
+    k.m_fromFloatS16  = fromFloatS16_C;
+    k.m_fromFloatS32  = fromFloatS32_C;
+    k.m_clipFloat     = clipFloat_C;
+    k.m_scaleFloat    = scaleFloat_C;
+    k.m_downmix       = downmix_C;
+    k.m_muteStereo16  = muteStereo_C<int16_t>;
+    k.m_muteStereo32  = muteStereo_C<int32_t>;
+    return k;
+}
+
+#ifdef AK_HAVE_SSE2
+static AudioKernels MakeSSE2(void)
+{
+    AudioKernels k;
+    k.m_level         = AudioKernels::kSSE2;
+    k.m_toFloatU8     = toFloatU8_SSE2;
+    k.m_toFloatS16    = toFloatS16_SSE2;
+    k.m_toFloatS32    = toFloatS32_SSE2;
+    k.m_fromFloatU8   = fromFloatU8_SSE2;
+    k.m_fromFloatS16  = fromFloatS16_SSE2;
+    k.m_fromFloatS32  = fromFloatS32_SSE2;
+    k.m_clipFloat     = clipFloat_SSE2;
+    k.m_scaleFloat    = scaleFloat_SSE2;
+    k.m_downmix       = downmix_SSE2;
+    k.m_muteStereo16  = muteStereo16_SSE2;
+    k.m_muteStereo32  = muteStereo32_SSE2;
+    return k;
+}
+#endif
+
+#ifdef AK_HAVE_AVX2
+static AudioKernels MakeAVX2(void)
+{
+    AudioKernels k;
+    k.m_level         = AudioKernels::kAVX2;
+    k.m_toFloatU8     = toFloatU8_AVX2;
+    k.m_toFloatS16    = toFloatS16_AVX2;
+    k.m_toFloatS32    = toFloatS32_AVX2;
+    k.m_fromFloatU8   = fromFloatU8_AVX2;
+    k.m_fromFloatS16  = fromFloatS16_AVX2;
+    k.m_fromFloatS32  = fromFloatS32_AVX2;
+    k.m_clipFloat     = clipFloat_AVX2;
+    k.m_scaleFloat    = scaleFloat_AVX2;
+    k.m_downmix       = downmix_AVX2;
+    k.m_muteStereo16  = muteStereo16_AVX2;
+    k.m_muteStereo32  = muteStereo32_AVX2;
+    return k;
+}
+#endif
+
+#ifdef AK_HAVE_NEON
+static AudioKernels MakeNEON(void)
+{
+    AudioKernels k;
+    k.m_level         = AudioKernels::kNEON;
+    k.m_toFloatU8     = toFloatU8_NEON;
+    k.m_toFloatS16    = toFloatS16_NEON;
+    k.m_toFloatS32    = toFloatS32_NEON;
+    k.m_fromFloatU8   = fromFloatU8_NEON;
+    k.m_fromFloatS16  = fromFloatS16_NEON;
+    k.m_fromFloatS32  = fromFloatS32_NEON;
+    k.m_clipFloat     = clipFloat_NEON;
+    k.m_scaleFloat    = scaleFloat_NEON;
+    k.m_downmix       = downmix_NEON;
+    k.m_muteStereo16  = muteStereo16_NEON;
+    k.m_muteStereo32  = muteStereo32_NEON;
+    return k;
+}
+#endif
+
+/**
+ * Returns the table for the given level, or nullptr if this build or this
+ * CPU doesn't support it.
+ */
+const AudioKernels* AudioKernels::Get(Level level)
+{
+    static const AudioKernels s_scalar = MakeScalar();
+#ifdef AK_HAVE_SSE2
+    static const AudioKernels s_sse2 = MakeSSE2();
+#endif
+#ifdef AK_HAVE_AVX2
+    static const AudioKernels s_avx2 = MakeAVX2();
+    static const bool s_haveAVX2 = (av_get_cpu_flags() & AV_CPU_FLAG_AVX2) != 0;
+#endif
+#ifdef AK_HAVE_NEON
+    static const AudioKernels s_neon = MakeNEON();
+    static const bool s_haveNEON = (av_get_cpu_flags() & AV_CPU_FLAG_NEON) != 0;
+#endif
+
+    switch (level)
+    {
+        case kScalar:
+            return &s_scalar;
+#ifdef AK_HAVE_SSE2
+        case kSSE2:
+            return &s_sse2;
+#endif
+#ifdef AK_HAVE_AVX2
+        case kAVX2:
+            return s_haveAVX2 ? &s_avx2 : nullptr;
+#endif
+#ifdef AK_HAVE_NEON
+        case kNEON:
+            return s_haveNEON ? &s_neon : nullptr;
+#endif
+        default:
+            return nullptr;
+    }
+}
+
+/// Returns the fastest table this CPU supports
+const AudioKernels& AudioKernels::Get(void)
+{
+    static const AudioKernels* s_best = []()
+    {
+        for (auto level : { kAVX2, kSSE2, kNEON })
+            if (const auto *kernels = Get(level); kernels)
+                return kernels;
+        return Get(kScalar);
+    }();
+    return *s_best;
+}
+
+const char* AudioKernels::LevelName(Level level)
+{
+    switch (level)
+    {
+        case kSSE2: return "SSE2";
+        case kAVX2: return "AVX2";
+        case kNEON: return "NEON";
+        default:    return "C";
+    }
+}
@@ -0,0 +1,62 @@
+#ifndef AUDIOKERNELS_H
+#define AUDIOKERNELS_H
+
+#include <cstdint>
+
+#include "libmyth/mythexp.h"
+
+/**
+ * Inner loops of the audio sample processing, one table per instruction set.
+ *
+ * Get() returns the best table the CPU supports. The scalar table is the
+ * reference, every other table gives bit identical results except downmix on
+ * NEON, where the compiler may fuse the scalar multiply and add.
+ *
+ * Lengths are in samples, buffers need no particular alignment.
+ */
+class MPUBLIC AudioKernels
+{
+  public:
+    enum Level : std::uint8_t
+    {
+        kScalar = 0,
+        kSSE2,
+        kAVX2,
+        kNEON,
+    };
+
+    static const AudioKernels& Get(void);
+    static const AudioKernels* Get(Level level);
+    static const char*         LevelName(Level level);
+
+    Level m_level { kScalar };
+
+    /// out = (in - 128) * scale
+    void (*m_toFloatU8)   (float *out, const uint8_t *in, int len, float scale) { nullptr };
+    /// out = in * scale
+    void (*m_toFloatS16)  (float *out, const int16_t *in, int len, float scale) { nullptr };
+    /// out = (in >> shift) * scale
+    void (*m_toFloatS32)  (float *out, const int32_t *in, int len, int shift, float scale) { nullptr };
+    /// out = clip(round(in * 128)) + 128
+    void (*m_fromFloatU8) (uint8_t *out, const float *in, int len) { nullptr };
+    /// out = clip(round(in * 32768))
+    void (*m_fromFloatS16)(int16_t *out, const float *in, int len) { nullptr };
+    /// out = clip(round(in * 2^(bits-1))) << shift
+    void (*m_fromFloatS32)(int32_t *out, const float *in, int len, int bits, int shift) { nullptr };
+    /// out = clamp(in, -1, 1)
+    void (*m_clipFloat)   (float *out, const float *in, int len) { nullptr };
+    /// out = in * gain
+    void (*m_scaleFloat)  (float *out, const float *in, int len, float gain) { nullptr };
+    /**
+     * out[n][o] = sum over i of in[n][i] * matrix[i][o], for channels_out 2 or 6
+     * (anything else is handled by the scalar loop). out may be in, as long as
+     * channels_out <= channels_in.
+     */
+    void (*m_downmix)     (float *out, const float *in, int frames,
+                           int channels_in, int channels_out, const float *matrix) { nullptr };
+    /// Copy the other channel of stereo frames over channel ch
+    void (*m_muteStereo16)(int16_t *buffer, int frames, int ch) { nullptr };
+    void (*m_muteStereo32)(int32_t *buffer, int frames, int ch) { nullptr };
+};
+
+#endif
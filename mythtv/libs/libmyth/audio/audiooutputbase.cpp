@@ -1454,6 +1454,13 @@ bool AudioOutputBase::AddData(void *in_buffer, int in_len,
     int maxframes = (kAudioSRCInputSize / m_sourceChannels) & ~0xf;
     int offset = 0;
 
+    // Apply the software volume while converting to float rather than in a
+    // separate pass, unless the upmixer adds its own gain
+    bool fused_volume = m_processing && m_internalVol && SWVolume() &&
+        !m_needsUpmix;
+    float gain = fused_volume ?
+        AudioOutputUtil::VolumeGain(m_volume, music, false) : 1.0F;
+
     while(frames_remaining > 0)
     {
         void *buffer = (char *)in_buffer + offset;
@@ -1468,21 +1475,23 @@ bool AudioOutputBase::AddData(void *in_buffer, int in_len,
                 len = frames * m_sourceBytesPerFrame;
                 offset += len;
             }
-            // Convert to floats
-            AudioOutputUtil::toFloat(m_format, m_srcIn, buffer, len);
+            // Convert to floats, downmix if necessary
+            if (m_needsDownmix)
+            {
+                if (AudioOutputDownmix::DownmixFrames(m_sourceChannels,
+                                                      m_configuredChannels,
+                                                      m_srcIn, m_format, buffer,
+                                                      frames, gain) < 0)
+                    LOG(VB_GENERAL, LOG_ERR, LOC + "Error occurred while downmixing");
+            }
+            else
+            {
+                AudioOutputUtil::toFloat(m_format, m_srcIn, buffer, len, gain);
+            }
         }
 
         frames_remaining -= frames;
 
-        // Perform downmix if necessary
-        if (m_needsDownmix)
-        {
-            if(AudioOutputDownmix::DownmixFrames(m_sourceChannels,
-                                                 m_configuredChannels,
-                                                 m_srcIn, m_srcIn, frames) < 0)
-                LOG(VB_GENERAL, LOG_ERR, LOC + "Error occurred while downmixing");
-        }
-
         // Resample if necessary
         if (m_needResampler && m_srcCtx)
         {
@@ -1564,7 +1573,7 @@ bool AudioOutputBase::AddData(void *in_buffer, int in_len,
             org_waud = (org_waud + nFrames * bpf) % kAudioRingBufferSize;
         }
 
-        if (m_internalVol && SWVolume())
+        if (m_internalVol && SWVolume() && !fused_volume)
         {
             org_waud    = m_waud;
             int num     = len;
@@ -19,10 +19,14 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "audiooutputbase.h"
 #include "audiooutputdownmix.h"
 
+#include <algorithm>
 #include <cstring>
 
 #include "libmythbase/mythlogging.h"
 
+#include "audioconvert.h"
+#include "audiokernels.h"
+
 #define LOC QString("Downmixer: ")
 
 /*
@@ -168,48 +172,71 @@ static const std::array<six_speaker_set,3> s51_matrix
     }}
 }};
 
+static const float *DownmixMatrix(int channels_in, int channels_out)
+{
+    if (channels_in < channels_out || channels_in > 8)
+        return nullptr;
+    if (channels_out == 2)
+        return stereo_matrix[channels_in - 1][0].data();
+    if (channels_out == 6 && channels_in >= 6)
+        return s51_matrix[channels_in - 6][0].data();
+    return nullptr;
+}
+
 int AudioOutputDownmix::DownmixFrames(int channels_in, int  channels_out,
                                       float *dst, const float *src, int frames)
 {
-    if (channels_in < channels_out)
+    const float *matrix = DownmixMatrix(channels_in, channels_out);
+    if (!matrix)
         return -1;
 
     //LOG(VB_AUDIO, LOG_INFO, LOC + LOC + QString("Downmixing %1 frames (in:%2 out:%3)")
     //    .arg(frames).arg(channels_in).arg(channels_out));
-    if (channels_out == 2)
-    {
-        int index = channels_in - 1;
-        for (int n=0; n < frames; n++)
-        {
-            for (int i=0; i < channels_out; i++)
-            {
-                float tmp = 0.0F;
-                for (int j=0; j < channels_in; j++)
-                    tmp += src[j] * stereo_matrix[index][j][i];
-                *dst++ = tmp;
-            }
-            src += channels_in;
-        }
-    }
-    else if (channels_out == 6)
+    AudioKernels::Get().m_downmix(dst, src, frames, channels_in, channels_out, matrix);
+    return frames;
+}
+
+/**
+ * Convert samples of the given format to float, downmix them and scale them by
+ * gain in one pass.
+ *
+ * The samples are converted a few frames at a time into a buffer that stays in
+ * the L1 cache, and the gain is folded into the downmix matrix.
+ * dst must not overlap src.
+ */
+int AudioOutputDownmix::DownmixFrames(int channels_in, int channels_out,
+                                      float *dst, AudioFormat format,
+                                      const void *src, int frames, float gain)
+{
+    const float *matrix = DownmixMatrix(channels_in, channels_out);
+    int sample_size = AudioOutputSettings::SampleSize(format);
+    if (!matrix || sample_size <= 0)
+        return -1;
+
+    std::array<float,8*6> scaled {};
+    for (int i = 0; i < channels_in * channels_out; i++)
+        scaled[i] = matrix[i] * gain;
+
+    const AudioKernels &kernels = AudioKernels::Get();
+    if (format == FORMAT_FLT)
     {
-        int index = channels_in - 6;
-        for (int n=0; n < frames; n++)
-        {
-            for (int i=0; i < channels_out; i++)
-            {
-                float tmp = 0.0F;
-                for (int j=0; j < channels_in; j++)
-                    tmp += src[j] * s51_matrix[index][j][i];
-                *dst++ = tmp;
-            }
-            src += channels_in;
-        }
+        kernels.m_downmix(dst, (const float *)src, frames, channels_in,
+                          channels_out, scaled.data());
+        return frames;
     }
-    else
+
+    alignas(16) std::array<float,1024> tile {};
+    int tile_frames = static_cast<int>(tile.size()) / channels_in;
+    const auto *in = (const uint8_t *)src;
+    for (int n = 0; n < frames; n += tile_frames)
     {
-        return -1;
+        int count = std::min(tile_frames, frames - n);
+        int bytes = count * channels_in * sample_size;
+        AudioConvert::toFloat(format, tile.data(), in, bytes);
+        kernels.m_downmix(dst, tile.data(), count, channels_in, channels_out,
+                          scaled.data());
+        in  += bytes;
+        dst += count * channels_out;
     }
-
     return frames;
 }
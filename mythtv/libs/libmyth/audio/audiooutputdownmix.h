@@ -1,11 +1,16 @@
 #ifndef AUDIOOUTPUTDOWNMIX
 #define AUDIOOUTPUTDOWNMIX
 
+#include "audiooutputsettings.h"
+
 class AudioOutputDownmix
 {
 public:
     static int DownmixFrames(int channels_in, int  channels_out,
                              float *dst, const float *src, int frames);
+    static int DownmixFrames(int channels_in, int  channels_out,
+                             float *dst, AudioFormat format, const void *src,
+                             int frames, float gain);
 };
 
 #endif
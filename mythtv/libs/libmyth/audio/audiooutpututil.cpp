@@ -9,6 +9,7 @@
 #include "libmythbase/mythlogging.h"
 
 #include "audioconvert.h"
+#include "audiokernels.h"
 #include "mythaverror.h"
 #include "mythavframe.h"
 
@@ -19,43 +20,13 @@ extern "C" {
 
 #define LOC QString("AOUtil: ")
 
-#ifdef Q_PROCESSOR_X86
-// Check cpuid for SSE2 support on x86 / x86_64
-static inline bool sse2_check()
-{
-#ifdef Q_PROCESSOR_X86_64
-    return true;
-#else
-    static int has_sse2 = -1;
-    if (has_sse2 != -1)
-        return (bool)has_sse2;
-    __asm__(
-        // -fPIC - we may not clobber ebx/rbx
-        "push       %%ebx               \n\t"
-        "mov        $1, %%eax           \n\t"
-        "cpuid                          \n\t"
-        "and        $0x4000000, %%edx   \n\t"
-        "shr        $26, %%edx          \n\t"
-        "pop        %%ebx               \n\t"
-        :"=d"(has_sse2)
-        ::"%eax","%ecx"
-    );
-    return (bool)has_sse2;
-#endif
-}
-#endif //Q_PROCESSOR_X86
-
 /**
  * Returns true if the processor supports MythTV's optimized SIMD for AudioOutputUtil/AudioConvert.
- * Currently, only SSE2 is implemented.
+ * SSE2 and AVX2 on x86-64, NEON on AArch64.
  */
 bool AudioOutputUtil::has_optimized_SIMD()
 {
-#ifdef Q_PROCESSOR_X86
-    return sse2_check();
-#else
-    return false;
-#endif
+    return AudioKernels::Get().m_level != AudioKernels::kScalar;
 }
 
 /**
@@ -64,9 +35,9 @@ bool AudioOutputUtil::has_optimized_SIMD()
  * Consumes 'bytes' bytes from in and returns the numer of bytes written to out
  */
 int AudioOutputUtil::toFloat(AudioFormat format, void *out, const void *in,
-                             int bytes)
+                             int bytes, float gain)
 {
-    return AudioConvert::toFloat(format, out, in, bytes);
+    return AudioConvert::toFloat(format, out, in, bytes, gain);
 }
 
 /**
@@ -89,18 +60,14 @@ void AudioOutputUtil::MonoToStereo(void *dst, const void *src, int samples)
 }
 
 /**
- * Adjust the volume of samples
+ * Gain AdjustVolume applies for the given volume
  *
  * Makes a crude attempt to normalise the relative volumes of
  * PCM from mythmusic, PCM from video and upmixed AC-3
  */
-void AudioOutputUtil::AdjustVolume(void *buf, int len, int volume,
-                                   bool music, bool upmix)
+float AudioOutputUtil::VolumeGain(int volume, bool music, bool upmix)
 {
-    float g     = volume / 100.0F;
-    auto *fptr  = (float *)buf;
-    int samples = len >> 2;
-    int i       = 0;
+    float g = volume / 100.0F;
 
     // Should be exponential - this'll do
     g *= g;
@@ -113,43 +80,22 @@ void AudioOutputUtil::AdjustVolume(void *buf, int len, int volume,
     if (music)
         g *= 0.4F;
 
+    return g;
+}
+
+/**
+ * Adjust the volume of samples
+ */
+void AudioOutputUtil::AdjustVolume(void *buf, int len, int volume,
+                                   bool music, bool upmix)
+{
+    float g = VolumeGain(volume, music, upmix);
+
     if (g == 1.0F)
         return;
 
-#ifdef Q_PROCESSOR_X86
-    if (sse2_check() && samples >= 16)
-    {
-        int loops = samples >> 4;
-        i = loops << 4;
-
-        __asm__ volatile (
-            "movss      %2, %%xmm0          \n\t"
-            "punpckldq  %%xmm0, %%xmm0      \n\t"
-            "punpckldq  %%xmm0, %%xmm0      \n\t"
-            "1:                             \n\t"
-            "movups     (%0), %%xmm1        \n\t"
-            "movups     16(%0), %%xmm2      \n\t"
-            "mulps      %%xmm0, %%xmm1      \n\t"
-            "movups     32(%0), %%xmm3      \n\t"
-            "mulps      %%xmm0, %%xmm2      \n\t"
-            "movups     48(%0), %%xmm4      \n\t"
-            "mulps      %%xmm0, %%xmm3      \n\t"
-            "movups     %%xmm1, (%0)        \n\t"
-            "mulps      %%xmm0, %%xmm4      \n\t"
-            "movups     %%xmm2, 16(%0)      \n\t"
-            "movups     %%xmm3, 32(%0)      \n\t"
-            "movups     %%xmm4, 48(%0)      \n\t"
-            "add        $64,    %0          \n\t"
-            "sub        $1, %%ecx           \n\t"
-            "jnz        1b                  \n\t"
-            :"+r"(fptr)
-            :"c"(loops),"m"(g)
-            :"xmm0","xmm1","xmm2","xmm3","xmm4"
-        );
-    }
-#endif //Q_PROCESSOR_X86
-    for (; i < samples; i++)
-        *fptr++ *= g;
+    auto *fptr = (float *)buf;
+    AudioKernels::Get().m_scaleFloat(fptr, fptr, len >> 2, g);
 }
 
 template <class AudioDataType>
@@ -176,11 +122,16 @@ void AudioOutputUtil::MuteChannel(int obits, int channels, int ch,
                                   void *buffer, int bytes)
 {
     int frames = bytes / ((obits >> 3) * channels);
+    const AudioKernels &kernels = AudioKernels::Get();
 
     if (obits == 8)
         tMuteChannel((uint8_t *)buffer, channels, ch, frames);
+    else if (obits == 16 && channels == 2)
+        kernels.m_muteStereo16((int16_t *)buffer, frames, ch);
     else if (obits == 16)
         tMuteChannel((short *)buffer, channels, ch, frames);
+    else if (channels == 2)
+        kernels.m_muteStereo32((int32_t *)buffer, frames, ch);
     else
         tMuteChannel((int *)buffer, channels, ch, frames);
 }
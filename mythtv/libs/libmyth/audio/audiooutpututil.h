@@ -5,14 +5,13 @@
 
 
 /**
- * All toFloat variants require 16 byte aligned input and output buffers on x86 for SSE optimised operation
- * The SSE code processes 16 bytes at a time and leaves any remainder for the C
- * - there is no remainder in practice
+ * The sample loops are in AudioKernels, which picks the SIMD version at runtime
  */
 class MPUBLIC AudioOutputUtil
 {
  public:
     static bool has_optimized_SIMD();
+    static float VolumeGain(int volume, bool music, bool upmix);
     static void AdjustVolume(void *buffer, int len, int volume,
                              bool music, bool upmix);
     static void MuteChannel(int obits, int channels, int ch,
@@ -24,7 +23,8 @@ class MPUBLIC AudioOutputUtil
                            const AVPacket *pkt);
 
     // Actually now in AudioConvert class, kept here for compatibility
-    static int  toFloat(AudioFormat format, void *out, const void *in, int bytes);
+    static int  toFloat(AudioFormat format, void *out, const void *in, int bytes,
+                        float gain = 1.0F);
     static int  fromFloat(AudioFormat format, void *out, const void *in, int bytes);
     static void MonoToStereo(void *dst, const void *src, int samples);
     static void DeinterleaveSamples(AudioFormat format, int channels,
@@ -0,0 +1,3 @@
+#include "test_audiokernels.h"
+
+QTEST_APPLESS_MAIN(TestAudioKernels)
@@ -0,0 +1,298 @@
+/*
+ *  Class TestAudioKernels
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include <QTest>
+
+#include "libmyth/audio/audioconvert.h"
+#include "libmyth/audio/audiokernels.h"
+
+class TestAudioKernels: public QObject
+{
+    Q_OBJECT
+
+    // Odd length so every kernel also runs its scalar tail
+    static constexpr int kSamples { 4099 };
+
+    static std::vector<float> RandomFloats(int count, float range)
+    {
+        std::mt19937 rng(count);
+        std::uniform_real_distribution<float> dist(-range, range);
+        std::vector<float> result(count);
+        for (auto & value : result)
+            value = dist(rng);
+        return result;
+    }
+
+    template <class T>
+    static std::vector<T> RandomInts(int count)
+    {
+        std::mt19937 rng(count);
+        std::vector<T> result(count);
+        for (auto & value : result)
+            value = static_cast<T>(rng());
+        return result;
+    }
+
+    static void AddLevels(void)
+    {
+        QTest::addColumn<int>("level");
+        for (auto level : { AudioKernels::kSSE2, AudioKernels::kAVX2, AudioKernels::kNEON })
+            if (AudioKernels::Get(level))
+                QTest::newRow(AudioKernels::LevelName(level)) << static_cast<int>(level);
+    }
+
+    static const AudioKernels* Kernels(void)
+    {
+        QFETCH(int, level);
+        return AudioKernels::Get(static_cast<AudioKernels::Level>(level));
+    }
+
+    static const AudioKernels* Scalar(void)
+    {
+        return AudioKernels::Get(AudioKernels::kScalar);
+    }
+
+  private slots:
+    static void ScalarAlwaysAvailable(void)
+    {
+        QVERIFY(AudioKernels::Get(AudioKernels::kScalar) != nullptr);
+        QVERIFY(AudioKernels::Get(AudioKernels::Get().m_level) == &AudioKernels::Get());
+    }
+
+    static void ToFloat_data(void) { AddLevels(); }
+    static void ToFloat(void)
+    {
+        const AudioKernels *simd = Kernels();
+        std::vector<float> expected(kSamples);
+        std::vector<float> actual(kSamples);
+
+        auto u8 = RandomInts<uint8_t>(kSamples);
+        Scalar()->m_toFloatU8(expected.data(), u8.data(), kSamples, 0.7F / 128);
+        simd->m_toFloatU8(actual.data(), u8.data(), kSamples, 0.7F / 128);
+        QCOMPARE(actual, expected);
+
+        auto s16 = RandomInts<int16_t>(kSamples);
+        Scalar()->m_toFloatS16(expected.data(), s16.data(), kSamples, 0.7F / 32768);
+        simd->m_toFloatS16(actual.data(), s16.data(), kSamples, 0.7F / 32768);
+        QCOMPARE(actual, expected);
+
+        auto s32 = RandomInts<int32_t>(kSamples);
+        for (int shift : { 0, 8 })
+        {
+            Scalar()->m_toFloatS32(expected.data(), s32.data(), kSamples, shift, 0.7F / (1U << 31));
+            simd->m_toFloatS32(actual.data(), s32.data(), kSamples, shift, 0.7F / (1U << 31));
+            QCOMPARE(actual, expected);
+        }
+    }
+
+    // Includes values out of range and exactly on the limits
+    static void FromFloat_data(void) { AddLevels(); }
+    static void FromFloat(void)
+    {
+        const AudioKernels *simd = Kernels();
+        auto in = RandomFloats(kSamples, 1.2F);
+        in[0] = 1.0F;
+        in[1] = -1.0F;
+        in[2] = 0.5F / 128;
+        in[3] = 1.5F / 32768;
+
+        std::vector<uint8_t> u8a(kSamples);
+        std::vector<uint8_t> u8b(kSamples);
+        Scalar()->m_fromFloatU8(u8a.data(), in.data(), kSamples);
+        simd->m_fromFloatU8(u8b.data(), in.data(), kSamples);
+        QCOMPARE(u8b, u8a);
+
+        std::vector<int16_t> s16a(kSamples);
+        std::vector<int16_t> s16b(kSamples);
+        Scalar()->m_fromFloatS16(s16a.data(), in.data(), kSamples);
+        simd->m_fromFloatS16(s16b.data(), in.data(), kSamples);
+        QCOMPARE(s16b, s16a);
+
+        std::vector<int32_t> s32a(kSamples);
+        std::vector<int32_t> s32b(kSamples);
+        for (auto [bits, shift] : { std::pair{24, 8}, {24, 0}, {32, 0} })
+        {
+            Scalar()->m_fromFloatS32(s32a.data(), in.data(), kSamples, bits, shift);
+            simd->m_fromFloatS32(s32b.data(), in.data(), kSamples, bits, shift);
+            QCOMPARE(s32b, s32a);
+        }
+
+        std::vector<float> fa(kSamples);
+        std::vector<float> fb(kSamples);
+        Scalar()->m_clipFloat(fa.data(), in.data(), kSamples);
+        simd->m_clipFloat(fb.data(), in.data(), kSamples);
+        QCOMPARE(fb, fa);
+
+        Scalar()->m_scaleFloat(fa.data(), in.data(), kSamples, 0.37F);
+        simd->m_scaleFloat(fb.data(), in.data(), kSamples, 0.37F);
+        QCOMPARE(fb, fa);
+    }
+
+    static void MuteStereo_data(void) { AddLevels(); }
+    static void MuteStereo(void)
+    {
+        const AudioKernels *simd = Kernels();
+        int frames = kSamples / 2;
+        for (int ch : { 0, 1 })
+        {
+            auto s16a = RandomInts<int16_t>(frames * 2);
+            auto s16b = s16a;
+            Scalar()->m_muteStereo16(s16a.data(), frames, ch);
+            simd->m_muteStereo16(s16b.data(), frames, ch);
+            QCOMPARE(s16b, s16a);
+            QCOMPARE(s16b[ch], s16b[1 - ch]);
+
+            auto s32a = RandomInts<int32_t>(frames * 2);
+            auto s32b = s32a;
+            Scalar()->m_muteStereo32(s32a.data(), frames, ch);
+            simd->m_muteStereo32(s32b.data(), frames, ch);
+            QCOMPARE(s32b, s32a);
+            QCOMPARE(s32b[ch], s32b[1 - ch]);
+        }
+    }
+
+    static void Downmix_data(void)
+    {
+        QTest::addColumn<int>("level");
+        QTest::addColumn<int>("channels_in");
+        QTest::addColumn<int>("channels_out");
+        for (auto level : { AudioKernels::kSSE2, AudioKernels::kAVX2, AudioKernels::kNEON })
+        {
+            if (!AudioKernels::Get(level))
+                continue;
+            for (int in = 2; in <= 8; in++)
+            {
+                for (int out : { 2, 6 })
+                {
+                    if (out > in)
+                        continue;
+                    QTest::addRow("%s %d->%d", AudioKernels::LevelName(level), in, out)
+                        << static_cast<int>(level) << in << out;
+                }
+            }
+        }
+    }
+
+    static void Downmix(void)
+    {
+        const AudioKernels *simd = Kernels();
+        QFETCH(int, channels_in);
+        QFETCH(int, channels_out);
+        int frames = kSamples / channels_in;
+        auto matrix = RandomFloats(channels_in * channels_out, 1.0F);
+        auto in = RandomFloats(frames * channels_in, 1.0F);
+
+        std::vector<float> expected(frames * channels_out);
+        std::vector<float> actual(frames * channels_out);
+        Scalar()->m_downmix(expected.data(), in.data(), frames, channels_in,
+                            channels_out, matrix.data());
+        simd->m_downmix(actual.data(), in.data(), frames, channels_in,
+                        channels_out, matrix.data());
+
+        // In place, as AudioOutputBase used to do
+        simd->m_downmix(in.data(), in.data(), frames, channels_in,
+                        channels_out, matrix.data());
+
+        for (size_t i = 0; i < expected.size(); i++)
+        {
+            // The scalar version may use fused multiply-add
+            QVERIFY(std::abs(actual[i] - expected[i]) < 1e-5F);
+            QCOMPARE(in[i], actual[i]);
+        }
+    }
+
+    static void ToFloatGain(void)
+    {
+        auto s16 = RandomInts<int16_t>(kSamples);
+        std::vector<float> unity(kSamples);
+        std::vector<float> half(kSamples);
+        int bytes = kSamples * sizeof(int16_t);
+        QCOMPARE(AudioConvert::toFloat(FORMAT_S16, unity.data(), s16.data(), bytes),
+                 kSamples * static_cast<int>(sizeof(float)));
+        AudioConvert::toFloat(FORMAT_S16, half.data(), s16.data(), bytes, 0.5F);
+        for (int i = 0; i < kSamples; i++)
+            QCOMPARE(half[i], unity[i] * 0.5F);
+
+        AudioConvert::toFloat(FORMAT_FLT, half.data(), unity.data(),
+                              kSamples * sizeof(float), 0.5F);
+        for (int i = 0; i < kSamples; i++)
+            QCOMPARE(half[i], unity[i] * 0.5F);
+    }
+
+    static void Benchmark_data(void)
+    {
+        QTest::addColumn<int>("level");
+        QTest::addColumn<QString>("kernel");
+        std::vector<AudioKernels::Level> levels { AudioKernels::kScalar };
+        for (auto level : { AudioKernels::kSSE2, AudioKernels::kAVX2, AudioKernels::kNEON })
+            if (AudioKernels::Get(level))
+                levels.push_back(level);
+        for (const auto *kernel : { "toFloatS16", "fromFloatS16", "fromFloatS32",
+                                    "scaleFloat", "downmix51", "muteStereo16" })
+        {
+            for (auto level : levels)
+            {
+                QTest::addRow("%s %s", kernel, AudioKernels::LevelName(level))
+                    << static_cast<int>(level) << QString(kernel);
+            }
+        }
+    }
+
+    // One second of 48kHz 5.1 audio per iteration
+    static void Benchmark(void)
+    {
+        const AudioKernels *k = Kernels();
+        QFETCH(QString, kernel);
+        static constexpr int kFrames { 48000 };
+        static constexpr int kLen { kFrames * 6 };
+        auto floats = RandomFloats(kLen, 1.0F);
+        auto s16 = RandomInts<int16_t>(kLen);
+        std::vector<int32_t> s32(kLen);
+        std::vector<float> out(kLen);
+        auto matrix = RandomFloats(6 * 2, 1.0F);
+
+        if (kernel == "toFloatS16")
+        {
+            QBENCHMARK { k->m_toFloatS16(out.data(), s16.data(), kLen, 1.0F / 32768); }
+        }
+        else if (kernel == "fromFloatS16")
+        {
+            QBENCHMARK { k->m_fromFloatS16(s16.data(), floats.data(), kLen); }
+        }
+        else if (kernel == "fromFloatS32")
+        {
+            QBENCHMARK { k->m_fromFloatS32(s32.data(), floats.data(), kLen, 24, 8); }
+        }
+        else if (kernel == "scaleFloat")
+        {
+            QBENCHMARK { k->m_scaleFloat(out.data(), floats.data(), kLen, 0.5F); }
+        }
+        else if (kernel == "downmix51")
+        {
+            QBENCHMARK { k->m_downmix(out.data(), floats.data(), kFrames, 6, 2, matrix.data()); }
+        }
+        else if (kernel == "muteStereo16")
+        {
+            QBENCHMARK { k->m_muteStereo16(s16.data(), kLen / 2, 0); }
+        }
+    }
+};
@@ -42,6 +42,9 @@
  * be considered accurate enough for our needs - and more accurate than Last-Modified
  * as we use millisecond accuracy for our hash generation.
  *
+ * \note In memory data that already carries an ETag (see MythHTTPService::CheckETag)
+ * is not hashed again.
+ *
  * \note It is recommended that Etags vary depending on the content encoding (e.g. gzipped).
  * We do not currently support this as our decision to compress depends on content
  * size, type, and the client range and encoding requests. It should not however
@@ -84,7 +87,7 @@ void MythHTTPCache::PreConditionCheck(const HTTPResponse& Response)
             QByteArray hashdata = ((*file)->fileName() + lastmodified.toString("ddMMyyyyhhmmsszzz")).toLocal8Bit().constData();
             etag = QCryptographicHash::hash(hashdata, QCryptographicHash::Sha224).toHex();
         }
-        else
+        else if (etag.isEmpty())
         {
             etag = QCryptographicHash::hash((*data)->constData(), QCryptographicHash::Sha224).toHex();
         }
@@ -32,6 +32,7 @@ HTTPResponse MythHTTPService::HTTPRequest(const HTTPRequest2& Request)
     if (method.isEmpty())
         return nullptr;
     m_request = Request;
+    m_etag.clear();
     // WSDL
     if (method == "wsdl") {
         MythWSDL wsdl( m_staticMetaService );
@@ -235,6 +236,7 @@ HTTPResponse MythHTTPService::HTTPRequest(const HTTPRequest2& Request)
             auto accept = MythHTTPEncoding::GetMimeTypes(MythHTTP::GetHeader(Request->m_headers, "accept"));
             HTTPData content = MythSerialiser::Serialise(handler->m_returnTypeName, returnvalue, accept);
             content->m_cacheType = HTTPETag | HTTPShortLife;
+            content->m_etag = m_etag;
             result = MythHTTPResponse::DataResponse(Request, content);
 
             // If the return type is QObject* we need to cleanup
@@ -272,6 +274,24 @@ HTTPResponse MythHTTPService::HTTPRequest(const HTTPRequest2& Request)
     return result;
 }
 
+/*! \brief Set the ETag for the current response from a cheap validator.
+ *
+ * Services whose result is expensive to build can derive an ETag from
+ * whatever decides their content (e.g. a cache generation and the request
+ * parameters) instead of having the serialised result hashed. If this
+ * returns true the client already holds the current version, the service
+ * may return an empty result and the client gets a 304 Not Modified.
+*/
+bool MythHTTPService::CheckETag(const QByteArray& ETag)
+{
+    m_etag = ETag;
+    // Must match MythHTTPCache::PreConditionCheck(), which ignores
+    // If-None-Match (and never sends a 304) when If-Range is present
+    if (!MythHTTP::GetHeader(m_request->m_headers, "if-range").isEmpty())
+        return false;
+    QString nonematch = MythHTTP::GetHeader(m_request->m_headers, "if-none-match");
+    return !nonematch.isEmpty() && nonematch.contains(ETag);
+}
 
 QString& MythHTTPService::Name()
 {
@@ -35,6 +35,8 @@ class MBASE_PUBLIC MythHTTPService : public QObject
     HTTPRequest2 m_request{nullptr};
     bool HAS_PARAMv2(const QString& p)
         { return m_request->m_queries.contains(p.toLower()); }
+    bool CheckETag(const QByteArray& ETag);
+    QByteArray m_etag;
 };
 
 class MBASE_PUBLIC V2HttpRedirectException
@@ -52,6 +52,7 @@ HEADERS += recordingtypes.h
 HEADERS += remoteutil.h
 HEADERS += rssmanager.h
 HEADERS += rssparse.h
+HEADERS += seekindexfile.h
 HEADERS += unziputil.h
 HEADERS += sizetliteral.h
 
@@ -90,6 +91,7 @@ SOURCES += recordingtypes.cpp
 SOURCES += remoteutil.cpp
 SOURCES += rssmanager.cpp
 SOURCES += rssparse.cpp
+SOURCES += seekindexfile.cpp
 SOURCES += unziputil.cpp
 
 HEADERS += http/mythhttpcommon.h
@@ -200,7 +202,7 @@ inc.files += mythsorthelper.h mythdbcheck.h
 inc.files += mythrandom.h
 inc.files += netgrabbermanager.h
 inc.files += netutils.h
-inc.files += programinfo.h
+inc.files += programinfo.h seekindexfile.h
 inc.files += programtypes.h
 inc.files += programtypeflags.h
 inc.files += recordingstatus.h
@@ -31,7 +31,10 @@
 #include <fcntl.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <algorithm>
+#include <memory>
 #include <utility>
+#include <vector>
 #if HAVE_GETTIMEOFDAY
 #include <sys/time.h>
 #endif
@@ -60,6 +63,11 @@ extern "C" {
 static QMutex                  logQueueMutex;
 static QQueue<LoggingItem *>   logQueue;
 
+// Per thread rings of the LOG() fast path, see LogPrintLine()
+static QMutex                  logRingsMutex;
+static std::vector<std::shared_ptr<LogRing>> logRings;
+static std::atomic<bool>       logFastPath {true};
+
 static LoggerThread           *logThread = nullptr;
 static QMutex                  logThreadMutex;
 static QHash<uint64_t, QString> logThreadHash;
@@ -67,7 +75,7 @@ static QHash<uint64_t, QString> logThreadHash;
 static QMutex                   logThreadTidMutex;
 static QHash<uint64_t, int64_t> logThreadTidHash;
 
-static bool                    logThreadFinished = false;
+static std::atomic<bool>       logThreadFinished {false};
 static bool                    debugRegistration = false;
 
 struct LogPropagateOpts {
@@ -132,6 +140,43 @@ LoggingItem::LoggingItem(const char *_file, const char *_function,
     setThreadTid();
 }
 
+LoggingItem::LoggingItem(LogRecord &record, uint64_t threadId, int64_t tid) :
+        ReferenceCounter("LoggingItem", false),
+        m_tid(tid), m_threadId(threadId),
+        m_line(record.m_line), m_type(record.m_type), m_level(record.m_level),
+        m_epoch(record.m_epoch), m_function(record.m_function),
+        m_message(std::move(record.m_message))
+{
+    const char *slash = std::strrchr(record.m_file, '/');
+    m_file = (slash != nullptr) ? slash+1 : record.m_file;
+}
+
+/// \brief Look up or determine the system thread ID of the calling thread
+static int64_t currentThreadTid(uint64_t threadId)
+{
+    QMutexLocker locker(&logThreadTidMutex);
+
+    int64_t tid = logThreadTidHash.value(threadId, -1);
+    if (tid == -1)
+    {
+        tid = 0;
+
+#if defined(Q_OS_ANDROID)
+        tid = (int64_t)gettid();
+#elif defined(__linux__)
+        tid = syscall(SYS_gettid);
+#elif defined(__FreeBSD__)
+        long lwpid;
+        [[maybe_unused]] int dummy = thr_self( &lwpid );
+        tid = (int64_t)lwpid;
+#elif defined(Q_OS_DARWIN)
+        tid = (int64_t)mach_thread_self();
+#endif
+        logThreadTidHash[threadId] = tid;
+    }
+    return tid;
+}
+
 /// \brief Get the name of the thread that produced the LoggingItem
 /// \return C-string of the thread name
 QString LoggingItem::getThreadName(void)
@@ -165,26 +210,7 @@ int64_t LoggingItem::getThreadTid(void)
 ///        shown in gdb.
 void LoggingItem::setThreadTid(void)
 {
-    QMutexLocker locker(&logThreadTidMutex);
-
-    m_tid = logThreadTidHash.value(m_threadId, -1);
-    if (m_tid == -1)
-    {
-        m_tid = 0;
-
-#if defined(Q_OS_ANDROID)
-        m_tid = (int64_t)gettid();
-#elif defined(__linux__)
-        m_tid = syscall(SYS_gettid);
-#elif defined(__FreeBSD__)
-        long lwpid;
-        [[maybe_unused]] int dummy = thr_self( &lwpid );
-        m_tid = (int64_t)lwpid;
-#elif defined(Q_OS_DARWIN)
-        m_tid = (int64_t)mach_thread_self();
-#endif
-        logThreadTidHash[m_threadId] = m_tid;
-    }
+    m_tid = currentThreadTid(m_threadId);
 }
 
 /// \brief Convert numerical timestamp to a readable date and time.
@@ -240,6 +266,85 @@ std::string LoggingItem::toStringShort()
                               ));
 }
 
+namespace {
+/// \brief Marks the ring of a thread as closed when the thread exits, the
+///        logger thread frees it once it is empty.
+struct LogRingOwner
+{
+    LogRingOwner() = default;
+    ~LogRingOwner();
+    Q_DISABLE_COPY(LogRingOwner);
+
+    std::shared_ptr<LogRing> m_ring;
+};
+} // namespace
+
+static thread_local LogRing *t_logRing       = nullptr;
+static thread_local bool     t_logRingClosed = false;
+
+LogRingOwner::~LogRingOwner()
+{
+    t_logRing = nullptr;
+    t_logRingClosed = true;
+    if (m_ring)
+        m_ring->m_closed.store(true, std::memory_order_release);
+}
+
+/// \brief Return the LOG() ring of the calling thread, creating it on first
+///        use.  Returns nullptr while the thread is exiting.
+static LogRing *logRingForThisThread(void)
+{
+    if (t_logRing || t_logRingClosed)
+        return t_logRing;
+
+    static thread_local LogRingOwner t_owner;
+    auto threadId = (uint64_t)(QThread::currentThreadId());
+    t_owner.m_ring = std::make_shared<LogRing>(threadId, currentThreadTid(threadId));
+    {
+        QMutexLocker locker(&logRingsMutex);
+        logRings.push_back(t_owner.m_ring);
+    }
+    t_logRing = t_owner.m_ring.get();
+    return t_logRing;
+}
+
+/// \brief Move the records of all LOG() rings into batch as LoggingItems,
+///        sorted by time together with what is already in batch.
+static void logRingsDrain(QList<LoggingItem *> &batch)
+{
+    QMutexLocker locker(&logRingsMutex);
+
+    uint32_t drained = 0;
+    for (auto it = logRings.begin(); it != logRings.end(); )
+    {
+        LogRing *ring = it->get();
+        // Check before draining, so nothing can be added after the last drain
+        bool closed = ring->m_closed.load(std::memory_order_acquire);
+        drained += ring->drain([&batch, ring](LogRecord &record)
+        {
+            batch.append(LoggingItem::create(record, ring->threadId(), ring->tid()));
+        });
+        if (closed)
+            it = logRings.erase(it);
+        else
+            ++it;
+    }
+
+    if (drained)
+    {
+        std::stable_sort(batch.begin(), batch.end(),
+                         [](const LoggingItem *a, const LoggingItem *b)
+                         { return a->epoch() < b->epoch(); });
+    }
+}
+
+static bool logRingsEmpty(void)
+{
+    QMutexLocker locker(&logRingsMutex);
+    return std::all_of(logRings.cbegin(), logRings.cend(),
+                       [](const auto &ring) { return ring->size() == 0; });
+}
+
 /// \brief LoggerThread constructor.  Enables debugging of thread registration
 ///        and deregistration if the VERBOSE_THREADS environment variable is
 ///        set.
@@ -294,27 +399,39 @@ void LoggerThread::run(void)
 
     QMutexLocker qLock(&logQueueMutex);
 
-    while (!m_aborted || !logQueue.isEmpty())
+    while (!m_aborted || !logQueue.isEmpty() || !logRingsEmpty())
     {
         qLock.unlock();
         qApp->processEvents(QEventLoop::AllEvents, 10);
         qApp->sendPostedEvents(nullptr, QEvent::DeferredDelete);
 
+        // Take everything queued so far in one go, the rings are drained
+        // after the queue so a batch is always complete up to the swap.
         qLock.relock();
-        if (logQueue.isEmpty())
+        QList<LoggingItem *> batch;
+        batch.swap(logQueue);
+        qLock.unlock();
+
+        logRingsDrain(batch);
+
+        if (batch.isEmpty())
         {
-            m_waitEmpty->wakeAll();
-            m_waitNotEmpty->wait(qLock.mutex(), 100);
+            qLock.relock();
+            if (logQueue.isEmpty())
+            {
+                m_waitEmpty->wakeAll();
+                m_waitNotEmpty->wait(qLock.mutex(), 100);
+            }
             continue;
         }
 
-        LoggingItem *item = logQueue.dequeue();
-        qLock.unlock();
-
-        fillItem(item);
-        handleItem(item);
-        logConsole(item);
-        item->DecrRef();
+        for (auto *item : std::as_const(batch))
+        {
+            fillItem(item);
+            handleItem(item);
+            logConsole(item);
+            item->DecrRef();
+        }
 
         qLock.relock();
     }
@@ -324,6 +441,20 @@ void LoggerThread::run(void)
     // This must be before the timer stop below or we deadlock when the timer
     // thread tries to deregister, and we wait for it.
     logThreadFinished = true;
+    // Pairs with the fence in LogPrintLine(), a thread that pushed to its
+    // ring after the drain below sees logThreadFinished and drains it itself
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    // Anything a thread managed to put in its ring while we were finishing
+    QList<LoggingItem *> batch;
+    logRingsDrain(batch);
+    for (auto *item : std::as_const(batch))
+    {
+        fillItem(item);
+        handleItem(item);
+        logConsole(item);
+        item->DecrRef();
+    }
 
     RunEpilog();
 
@@ -486,14 +617,15 @@ bool LoggerThread::flush(int timeoutMS)
 {
     QElapsedTimer t;
     t.start();
-    while (!m_aborted && !logQueue.isEmpty() && !t.hasExpired(timeoutMS))
+    while (!m_aborted && (!logQueue.isEmpty() || !logRingsEmpty()) &&
+           !t.hasExpired(timeoutMS))
     {
         m_waitNotEmpty->wakeAll();
         int left = timeoutMS - t.elapsed();
         if (left > 0)
             m_waitEmpty->wait(&logQueueMutex, left);
     }
-    return logQueue.isEmpty();
+    return logQueue.isEmpty() && logRingsEmpty();
 }
 
 void LoggerThread::fillItem(LoggingItem *item)
@@ -526,6 +658,17 @@ LoggingItem *LoggingItem::create(const char *_file,
     return item;
 }
 
+/// \brief  Create a LoggingItem from a record of the LOG() fast path
+/// \param  record   the record, its message is moved into the item
+/// \param  threadId Qt thread ID of the thread that logged the record
+/// \param  tid      system thread ID of the thread that logged the record
+/// \return LoggingItem that was created
+LoggingItem *LoggingItem::create(LogRecord &record, uint64_t threadId,
+                                 int64_t tid)
+{
+    return new LoggingItem(record, threadId, tid);
+}
+
 /// \brief  Format and send a log message into the queue.  This is called from
 ///         the LOG() macro.  The intention is minimal blocking of the caller.
 /// \param  mask    Verbosity mask of the message (VB_*)
@@ -540,6 +683,49 @@ void LogPrintLine( uint64_t mask, LogLevel_t level, const char *file, int line,
     int type = kMessage;
     type |= (mask & VB_FLUSH) ? kFlush : 0;
     type |= (mask & VB_STDIO) ? kStandardIO : 0;
+
+    // Fast path, put the message into the ring of this thread and leave
+    // everything else to the logger thread.  Flushes, and messages logged
+    // while the logger thread isn't running or while the ring is full, take
+    // the slow path through logQueue.
+    if (!(type & kFlush) && logFastPath.load(std::memory_order_relaxed) &&
+        logThread && !logThreadFinished)
+    {
+        LogRing *ring = logRingForThisThread();
+        if (ring)
+        {
+            LogRecord record { file, function, line, level, (LoggingType)type,
+                               nowAsDuration<std::chrono::microseconds>(),
+                               std::move(message) };
+            if (ring->push(std::move(record)))
+            {
+                // The logger thread may have finished, and taken its last
+                // look at the rings, since the check above
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (!logThreadFinished)
+                {
+                    // Don't let a busy thread wait for the logger's next poll
+                    if (ring->size() == LogRing::kSize / 4)
+                        logThread->m_waitNotEmpty->wakeAll();
+                    return;
+                }
+
+                // It has, so nobody else will handle what is left
+                QList<LoggingItem *> batch;
+                logRingsDrain(batch);
+                for (auto *item : std::as_const(batch))
+                {
+                    logThread->fillItem(item);
+                    LoggerThread::handleItem(item);
+                    logThread->logConsole(item);
+                    item->DecrRef();
+                }
+                return;
+            }
+            message = std::move(record.m_message); // NOLINT(bugprone-use-after-move)
+        }
+    }
+
     LoggingItem *item = LoggingItem::create(file, function, line, level,
                                             (LoggingType)type);
     if (!item)
@@ -575,6 +761,14 @@ void LogPrintLine( uint64_t mask, LogLevel_t level, const char *file, int line,
 }
 
 
+/// \brief Enable or disable the lock free LOG() fast path.  It is on by
+///        default, turning it off queues every message through one mutex
+///        as before.
+void logSetFastPath(bool enable)
+{
+    logFastPath.store(enable, std::memory_order_relaxed);
+}
+
 /// \brief Generate the logPropagateArgs global with the latest logging
 ///        level, mask, etc to propagate to all of the mythtv programs
 ///        spawned from this one.
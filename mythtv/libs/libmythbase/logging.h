@@ -6,7 +6,10 @@
 #include <QQueue>
 #include <QPointer>
 #include <QCoreApplication>
+#include <QString>
 
+#include <array>
+#include <atomic>
 #include <cstdint>
 #include <cstdlib>
 #include <string>
@@ -49,6 +52,77 @@ class LoggerThread;
 
 using tmType = struct tm;
 
+/// \brief A LOG() call waiting in a LogRing for the logger thread.  Only
+///        the message is formatted, by the caller of LOG().
+struct LogRecord
+{
+    const char               *m_file     {nullptr};
+    const char               *m_function {nullptr};
+    int                       m_line     {0};
+    LogLevel_t                m_level    {LOG_INFO};
+    LoggingType               m_type     {kMessage};
+    std::chrono::microseconds m_epoch    {0us};
+    QString                   m_message;
+};
+
+/// \brief Fixed size queue of LogRecords from one thread to the logger thread
+///
+/// Each thread that logs gets its own ring, so the LOG() fast path neither
+/// locks nor allocates.  The owning thread is the only producer and the
+/// logger thread the only consumer.
+class LogRing
+{
+  public:
+    static constexpr uint32_t kSize { 512 }; ///< must be a power of two
+
+    LogRing(uint64_t threadId, int64_t tid)
+        : m_threadId(threadId), m_tid(tid) {}
+
+    /// \brief Append a record, returns false if the ring is full
+    bool push(LogRecord &&record)
+    {
+        uint32_t head = m_head.load(std::memory_order_relaxed);
+        if (head - m_tail.load(std::memory_order_acquire) >= kSize)
+            return false;
+        m_records[head & (kSize - 1)] = std::move(record);
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// \brief Hand the records that are in the ring now to func, oldest first
+    template <typename Func>
+    uint32_t drain(Func func)
+    {
+        uint32_t tail = m_tail.load(std::memory_order_relaxed);
+        uint32_t head = m_head.load(std::memory_order_acquire);
+        for (uint32_t i = tail; i != head; i++)
+        {
+            func(m_records[i & (kSize - 1)]);
+            m_tail.store(i + 1, std::memory_order_release);
+        }
+        return head - tail;
+    }
+
+    uint32_t size(void) const
+    {
+        return m_head.load(std::memory_order_acquire) -
+               m_tail.load(std::memory_order_acquire);
+    }
+
+    uint64_t threadId(void) const { return m_threadId; }
+    int64_t  tid(void) const      { return m_tid; }
+
+    std::atomic<bool> m_closed {false}; ///< the owning thread has exited
+
+  private:
+    Q_DISABLE_COPY(LogRing);
+    const uint64_t                  m_threadId;
+    const int64_t                   m_tid;
+    std::atomic<uint32_t>           m_head {0}; ///< written by the producer
+    std::atomic<uint32_t>           m_tail {0}; ///< written by the consumer
+    std::array<LogRecord,kSize>     m_records;
+};
+
 /// \brief The logging items that are generated by LOG() and are sent to the
 ///        console
 class LoggingItem: public QObject, public ReferenceCounter
@@ -80,6 +154,7 @@ class LoggingItem: public QObject, public ReferenceCounter
     void setThreadTid(void);
     static LoggingItem *create(const char *_file, const char *_function, int _line, LogLevel_t _level,
                                LoggingType _type);
+    static LoggingItem *create(LogRecord &record, uint64_t threadId, int64_t tid);
     QString getTimestamp(const char *format = "yyyy-MM-dd HH:mm:ss") const;
     QString getTimestampUs(const char *format = "yyyy-MM-dd HH:mm:ss") const;
     char getLevelChar(void);
@@ -140,6 +215,7 @@ class LoggingItem: public QObject, public ReferenceCounter
         : ReferenceCounter("LoggingItem", false) {};
     LoggingItem(const char *_file, const char *_function,
                 int _line, LogLevel_t _level, LoggingType _type);
+    LoggingItem(LogRecord &record, uint64_t threadId, int64_t tid);
     Q_DISABLE_COPY(LoggingItem);
 };
 
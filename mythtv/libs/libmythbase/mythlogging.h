@@ -55,6 +55,7 @@ MBASE_PUBLIC void logStart(const QString& logfile, bool progress = false,
                            bool loglong = false,
                            bool testHarness = false);
 MBASE_PUBLIC void logStop(void);
+MBASE_PUBLIC void logSetFastPath(bool enable);
 MBASE_PUBLIC void logPropagateCalc(void);
 MBASE_PUBLIC bool logPropagateQuiet(void);
 
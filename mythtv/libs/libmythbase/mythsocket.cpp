@@ -17,12 +17,17 @@
 #else
 #include <sys/socket.h>
 #endif
+#ifdef __linux__
+#include <poll.h>
+#include <sys/sendfile.h>
+#endif
 #include <unistd.h> // for usleep (and socket code on Q_OS_WIN)
 #include <algorithm> // for max
 #include <vector> // for vector
 
 // MythTV
 #include "mythsocket.h"
+#include "mythchrono.h"
 #include "mythtimer.h"
 #include "mythevent.h"
 #include "mythversion.h"
@@ -38,6 +43,7 @@ QHash<QString, QHostAddress::SpecialAddress> MythSocket::s_loopbackCache;
 QMutex MythSocket::s_thread_lock;
 MThread *MythSocket::s_thread = nullptr;
 int MythSocket::s_thread_cnt = 0;
+MythSocket::Counters MythSocket::s_counters;
 
 Q_DECLARE_METATYPE ( const QStringList * );
 Q_DECLARE_METATYPE ( QStringList * );
@@ -145,6 +151,19 @@ MythSocket::~MythSocket()
     if (IsConnected())
         DisconnectFromHost();
 
+    if (VERBOSE_LEVEL_CHECK(VB_SOCKET, LOG_INFO))
+    {
+        MythSocketStats stats = GetStats();
+        LOG(VB_SOCKET, LOG_INFO, LOC() +
+            QString("%1 calls, %2 bytes read, %3 bytes written, "
+                    "queue wait %4 us avg %5 us max")
+            .arg(stats.m_calls).arg(stats.m_bytesRead)
+            .arg(stats.m_bytesWritten)
+            .arg(stats.m_calls ?
+                 stats.m_queueWait.count() / stats.m_calls : 0)
+            .arg(stats.m_maxQueueWait.count()));
+    }
+
     if (!m_useSharedThread)
     {
         if (m_thread)
@@ -290,8 +309,7 @@ bool MythSocket::ConnectToHost(
     bool ret = false;
     QMetaObject::invokeMethod(
         this, "ConnectToHostReal",
-        (QThread::currentThread() != m_thread->qthread()) ?
-        Qt::BlockingQueuedConnection : Qt::DirectConnection,
+        BeginCall(),
         Q_ARG(QHostAddress, address),
         Q_ARG(quint16, port),
         Q_ARG(bool*, &ret));
@@ -303,8 +321,7 @@ bool MythSocket::WriteStringList(const QStringList &list)
     bool ret = false;
     QMetaObject::invokeMethod(
         this, "WriteStringListReal",
-        (QThread::currentThread() != m_thread->qthread()) ?
-        Qt::BlockingQueuedConnection : Qt::DirectConnection,
+        BeginCall(),
         Q_ARG(const QStringList*, &list),
         Q_ARG(bool*, &ret));
     return ret;
@@ -315,8 +332,7 @@ bool MythSocket::ReadStringList(QStringList &list, std::chrono::milliseconds tim
     bool ret = false;
     QMetaObject::invokeMethod(
         this, "ReadStringListReal",
-        (QThread::currentThread() != m_thread->qthread()) ?
-        Qt::BlockingQueuedConnection : Qt::DirectConnection,
+        BeginCall(),
         Q_ARG(QStringList*, &list),
         Q_ARG(std::chrono::milliseconds, timeoutMS),
         Q_ARG(bool*, &ret));
@@ -507,8 +523,7 @@ void MythSocket::DisconnectFromHost(void)
     }
     QMetaObject::invokeMethod(
         this, "DisconnectFromHostReal",
-        (QThread::currentThread() != m_thread->qthread()) ?
-        Qt::BlockingQueuedConnection : Qt::DirectConnection);
+        BeginCall());
 }
 
 int MythSocket::Write(const char *data, int size)
@@ -516,8 +531,7 @@ int MythSocket::Write(const char *data, int size)
     int ret = -1;
     QMetaObject::invokeMethod(
         this, "WriteReal",
-        (QThread::currentThread() != m_thread->qthread()) ?
-        Qt::BlockingQueuedConnection : Qt::DirectConnection,
+        BeginCall(),
         Q_ARG(const char*, data),
         Q_ARG(int, size),
         Q_ARG(int*, &ret));
@@ -529,8 +543,7 @@ int MythSocket::Read(char *data, int size,  std::chrono::milliseconds max_wait)
     int ret = -1;
     QMetaObject::invokeMethod(
         this, "ReadReal",
-        (QThread::currentThread() != m_thread->qthread()) ?
-        Qt::BlockingQueuedConnection : Qt::DirectConnection,
+        BeginCall(),
         Q_ARG(char*, data),
         Q_ARG(int, size),
         Q_ARG(std::chrono::milliseconds, max_wait),
@@ -542,8 +555,77 @@ void MythSocket::Reset(void)
 {
     QMetaObject::invokeMethod(
         this, "ResetReal",
-        (QThread::currentThread() != m_thread->qthread()) ?
-        Qt::BlockingQueuedConnection : Qt::DirectConnection);
+        BeginCall());
+}
+
+/** \brief Sends \a size bytes from offset \a offset of file \a fd
+ *         to the peer, without copying them through user space.
+ *
+ *  Any data still buffered by earlier Write() or WriteStringList()
+ *  calls is sent first. The data itself is written to the socket
+ *  from the calling thread, so this does not block the socket thread.
+ *
+ *  \return number of bytes sent, 0 at the end of the file, or -1 on
+ *          error or where sendfile() is not supported. Callers should
+ *          fall back to Write() on -1.
+ */
+int MythSocket::SendFile([[maybe_unused]] int fd,
+                         [[maybe_unused]] long long offset,
+                         [[maybe_unused]] int size,
+                         [[maybe_unused]] std::chrono::milliseconds max_wait)
+{
+#ifdef __linux__
+    if (!m_directWriteReady.testAndSetOrdered(1, 1))
+    {
+        bool flushed = false;
+        QMetaObject::invokeMethod(
+            this, "FlushWritesReal",
+            BeginCall(),
+            Q_ARG(bool*, &flushed));
+        if (!flushed)
+            return -1;
+    }
+
+    int sock = GetSocketDescriptor();
+    if (sock < 0)
+        return -1;
+
+    auto off = static_cast<off_t>(offset);
+    int sent = 0;
+    MythTimer t;
+    t.start();
+    while (sent < size)
+    {
+        ssize_t ret = sendfile(sock, fd, &off, static_cast<size_t>(size - sent));
+        if (ret > 0)
+        {
+            sent += static_cast<int>(ret);
+            continue;
+        }
+        if (ret == 0)
+            break; // end of file
+        if (errno == EINTR)
+            continue;
+        if (errno != EAGAIN)
+        {
+            LOG(VB_NETWORK, LOG_ERR, LOC() + "SendFile failed" + ENO);
+            return (sent > 0) ? sent : -1;
+        }
+
+        // The socket is non-blocking, wait until the peer catches up
+        std::chrono::milliseconds left = max_wait - t.elapsed();
+        if (left <= 0ms)
+            break;
+        struct pollfd pfd { sock, POLLOUT, 0 };
+        if (poll(&pfd, 1, static_cast<int>(left.count())) <= 0 ||
+            (pfd.revents & (POLLERR | POLLHUP | POLLNVAL)))
+            break;
+    }
+    AddBytesWritten(sent);
+    return sent;
+#else
+    return -1;
+#endif
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -566,7 +648,7 @@ bool MythSocket::IsDataAvailable(void)
 
     QMetaObject::invokeMethod(
         this, "IsDataAvailableReal",
-        Qt::BlockingQueuedConnection,
+        BeginCall(),
         Q_ARG(bool*, &ret));
 
     return ret;
@@ -590,16 +672,100 @@ int MythSocket::GetPeerPort(void) const
     return m_peerPort;
 }
 
+/// Returns the I/O counters of this socket
+MythSocketStats MythSocket::GetStats(void) const
+{
+    return m_counters.Get();
+}
+
+/// Returns the I/O counters summed over all sockets of this process
+MythSocketStats MythSocket::GetTotalStats(void)
+{
+    return s_counters.Get();
+}
+
+void MythSocket::Counters::Add(std::chrono::microseconds wait)
+{
+    m_calls++;
+    m_queueWait += wait.count();
+    int64_t max = m_maxQueueWait;
+    while (wait.count() > max &&
+           !m_maxQueueWait.compare_exchange_weak(max, wait.count()))
+    {
+    }
+}
+
+MythSocketStats MythSocket::Counters::Get(void) const
+{
+    MythSocketStats stats;
+    stats.m_calls        = m_calls;
+    stats.m_bytesRead    = m_bytesRead;
+    stats.m_bytesWritten = m_bytesWritten;
+    stats.m_queueWait    = std::chrono::microseconds(m_queueWait.load());
+    stats.m_maxQueueWait = std::chrono::microseconds(m_maxQueueWait.load());
+    return stats;
+}
+
+/// Returns the connection type for running a call on the I/O thread,
+/// and notes when it was queued.
+Qt::ConnectionType MythSocket::BeginCall(void) const
+{
+    if (QThread::currentThread() == m_thread->qthread())
+    {
+        m_callQueuedAt.store(0us);
+        return Qt::DirectConnection;
+    }
+    m_callQueuedAt.store(nowAsDuration<std::chrono::microseconds>());
+    return Qt::BlockingQueuedConnection;
+}
+
+/// Called on the I/O thread when a call queued by BeginCall() starts
+void MythSocket::CallStarted(void) const
+{
+    std::chrono::microseconds queuedAt = m_callQueuedAt.exchange(-1us);
+    if (queuedAt < 0us)
+        return; // nested call, already counted
+
+    std::chrono::microseconds wait { 0us };
+    if (queuedAt > 0us)
+    {
+        wait = std::max(nowAsDuration<std::chrono::microseconds>() -
+                        queuedAt, 0us);
+    }
+
+    m_counters.Add(wait);
+    s_counters.Add(wait);
+}
+
+void MythSocket::AddBytesRead(int64_t bytes) const
+{
+    if (bytes <= 0)
+        return;
+    m_counters.m_bytesRead += bytes;
+    s_counters.m_bytesRead += bytes;
+}
+
+void MythSocket::AddBytesWritten(int64_t bytes) const
+{
+    if (bytes <= 0)
+        return;
+    m_counters.m_bytesWritten += bytes;
+    s_counters.m_bytesWritten += bytes;
+}
+
 //////////////////////////////////////////////////////////////////////////
 
 void MythSocket::IsDataAvailableReal(bool *ret) const
 {
+    CallStarted();
     *ret = (m_tcpSocket->bytesAvailable() > 0);
     m_dataAvailable.fetchAndStoreOrdered((*ret) ? 1 : 0);
 }
 
 void MythSocket::ConnectToHostReal(const QHostAddress& _addr, quint16 port, bool *ret)
 {
+    CallStarted();
+
     if (m_tcpSocket->state() == QAbstractSocket::ConnectedState)
     {
         LOG(VB_SOCKET, LOG_ERR, LOC() +
@@ -683,11 +849,15 @@ void MythSocket::ConnectToHostReal(const QHostAddress& _addr, quint16 port, bool
 
 void MythSocket::DisconnectFromHostReal(void)
 {
+    CallStarted();
     m_tcpSocket->disconnectFromHost();
 }
 
 void MythSocket::WriteStringListReal(const QStringList *list, bool *ret)
 {
+    CallStarted();
+    m_directWriteReady.fetchAndStoreOrdered(0);
+
     if (list->empty())
     {
         LOG(VB_GENERAL, LOG_ERR, LOC() +
@@ -783,6 +953,7 @@ void MythSocket::WriteStringListReal(const QStringList *list, bool *ret)
     }
 
     m_tcpSocket->flush();
+    AddBytesWritten(written);
 
     *ret = true;
 }
@@ -790,6 +961,7 @@ void MythSocket::WriteStringListReal(const QStringList *list, bool *ret)
 void MythSocket::ReadStringListReal(
     QStringList *list, std::chrono::milliseconds timeoutMS, bool *ret)
 {
+    CallStarted();
     list->clear();
     *ret = false;
 
@@ -918,6 +1090,8 @@ void MythSocket::ReadStringListReal(
         }
     }
 
+    AddBytesRead(sizestr.size() + readoffset);
+
     QString str = QString::fromUtf8(utf8.data());
 
     if (VERBOSE_LEVEL_CHECK(VB_NETWORK, LOG_INFO))
@@ -950,11 +1124,31 @@ void MythSocket::ReadStringListReal(
 
 void MythSocket::WriteReal(const char *data, int size, int *ret)
 {
+    CallStarted();
+    m_directWriteReady.fetchAndStoreOrdered(0);
     *ret = m_tcpSocket->write(data, size);
+    AddBytesWritten(*ret);
+}
+
+void MythSocket::FlushWritesReal(bool *ret)
+{
+    CallStarted();
+    MythTimer t;
+    t.start();
+    while ((m_tcpSocket->bytesToWrite() > 0) &&
+           (m_tcpSocket->state() == QAbstractSocket::ConnectedState) &&
+           (t.elapsed() < kLongTimeout))
+    {
+        m_tcpSocket->waitForBytesWritten(100);
+    }
+    *ret = (m_tcpSocket->bytesToWrite() == 0) &&
+        (m_tcpSocket->state() == QAbstractSocket::ConnectedState);
+    m_directWriteReady.fetchAndStoreOrdered((*ret) ? 1 : 0);
 }
 
 void MythSocket::ReadReal(char *data, int size, std::chrono::milliseconds max_wait_ms, int *ret)
 {
+    CallStarted();
     MythTimer t; t.start();
     while ((m_tcpSocket->state() == QAbstractSocket::ConnectedState) &&
            (m_tcpSocket->bytesAvailable() < size) &&
@@ -963,6 +1157,7 @@ void MythSocket::ReadReal(char *data, int size, std::chrono::milliseconds max_wa
         m_tcpSocket->waitForReadyRead(max(2ms, max_wait_ms - t.elapsed()).count());
     }
     *ret = m_tcpSocket->read(data, size);
+    AddBytesRead(*ret);
 
     if (t.elapsed() > 50ms)
     {
@@ -978,6 +1173,7 @@ void MythSocket::ReadReal(char *data, int size, std::chrono::milliseconds max_wa
 
 void MythSocket::ResetReal(void)
 {
+    CallStarted();
     uint avail {0};
     std::vector<char> trash;
 
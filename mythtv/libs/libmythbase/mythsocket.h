@@ -8,6 +8,8 @@
 #include <QMutex>
 #include <QHash>
 
+#include <atomic>
+
 #include "referencecounter.h"
 #include "mythsocket_cb.h"
 #include "mythbaseexp.h"
@@ -15,6 +17,17 @@
 
 class QTcpSocket;
 
+/// Protocol I/O counters, see MythSocket::GetStats()
+struct MythSocketStats
+{
+    uint64_t m_calls        {0}; ///< calls run on the socket's I/O thread
+    uint64_t m_bytesRead    {0};
+    uint64_t m_bytesWritten {0};
+    /// Total and worst time a call waited for the socket's I/O thread
+    std::chrono::microseconds m_queueWait    {0us};
+    std::chrono::microseconds m_maxQueueWait {0us};
+};
+
 /** \brief Class for communcating between myth backends and frontends
  *
  *  \note Access to the methods of MythSocket must be externally
@@ -66,6 +79,11 @@ class MBASE_PUBLIC MythSocket : public QObject, public ReferenceCounter
     int Write(const char *data, int size);
     int Read(char *data, int size,  std::chrono::milliseconds max_wait);
     void Reset(void);
+    int SendFile(int fd, long long offset, int size,
+                 std::chrono::milliseconds max_wait = kLongTimeout);
+
+    MythSocketStats GetStats(void) const;
+    static MythSocketStats GetTotalStats(void);
 
     static constexpr std::chrono::milliseconds kShortTimeout { kMythSocketShortTimeout };
     static constexpr std::chrono::milliseconds kLongTimeout  { kMythSocketLongTimeout };
@@ -77,6 +95,24 @@ class MBASE_PUBLIC MythSocket : public QObject, public ReferenceCounter
             .arg((intptr_t)(this), 0, 16).arg(GetSocketDescriptor());
     }
 
+    /// Counters shared by a socket and the process wide totals
+    struct Counters
+    {
+        std::atomic<uint64_t> m_calls        {0};
+        std::atomic<uint64_t> m_bytesRead    {0};
+        std::atomic<uint64_t> m_bytesWritten {0};
+        std::atomic<int64_t>  m_queueWait    {0}; // usecs
+        std::atomic<int64_t>  m_maxQueueWait {0}; // usecs
+
+        void Add(std::chrono::microseconds wait);
+        MythSocketStats Get(void) const;
+    };
+
+    Qt::ConnectionType BeginCall(void) const;
+    void CallStarted(void) const;
+    void AddBytesRead(int64_t bytes) const;
+    void AddBytesWritten(int64_t bytes) const;
+
 
   signals:
     void CallReadyRead(void);
@@ -95,6 +131,7 @@ class MBASE_PUBLIC MythSocket : public QObject, public ReferenceCounter
     void DisconnectFromHostReal(void);
 
     void WriteReal(const char *data, int size, int *ret);
+    void FlushWritesReal(bool *ret);
     void ReadReal(char *data, int size, std::chrono::milliseconds max_wait_ms, int *ret);
     void ResetReal(void);
 
@@ -116,9 +153,16 @@ class MBASE_PUBLIC MythSocket : public QObject, public ReferenceCounter
     /// This is used internally as a hint that there might be
     /// data available for reading.
     mutable QAtomicInt m_dataAvailable {0};
+    /// Set when QTcpSocket has no buffered data left to write, so
+    /// SendFile() can write to the socket descriptor directly.
+    QAtomicInt      m_directWriteReady {0};
     bool            m_isValidated      {false}; // only set in thread using MythSocket
     bool            m_isAnnounced      {false}; // only set in thread using MythSocket
     QStringList     m_announce; // only set in thread using MythSocket
+    /// Set by the calling thread before a call is queued on m_thread,
+    /// and reset by m_thread when the call starts
+    mutable std::atomic<std::chrono::microseconds> m_callQueuedAt {-1us};
+    mutable Counters m_counters;
 
     static const int kSocketReceiveBufferSize;
 
@@ -128,6 +172,7 @@ class MBASE_PUBLIC MythSocket : public QObject, public ReferenceCounter
     static QMutex s_thread_lock;
     static MThread *s_thread; // protected by s_thread_lock
     static int s_thread_cnt;  // protected by s_thread_lock
+    static Counters s_counters;
 
   private:
     Q_DISABLE_COPY(MythSocket)
@@ -11,6 +11,7 @@
 #include <QUrl>
 #include <QFile>
 #include <QFileInfo>
+#include <QDataStream>
 #include <QDir>
 #include <QTimeZone>
 
@@ -24,6 +25,7 @@
 #include "libmythbase/mythscheduler.h"
 #include "libmythbase/mythsorthelper.h"
 #include "libmythbase/remotefile.h"
+#include "libmythbase/seekindexfile.h"
 #include "libmythbase/storagegroup.h"
 #include "libmythbase/stringutil.h"
 
@@ -1454,6 +1456,162 @@ bool ProgramInfo::FromStringList(QStringList::const_iterator &it,
     return true;
 }
 
+static inline qint64 DateTimeToBinary(const QDateTime& x)
+{
+    return x.isValid() ? x.toSecsSinceEpoch() : -1;
+}
+
+static inline QDateTime DateTimeFromBinary(qint64 secs)
+{
+    return (secs < 0) ? QDateTime() : MythDate::fromSecsSinceEpoch(secs);
+}
+
+/** \fn ProgramInfo::ToBinary(QDataStream&) const
+ *  \brief Serializes ProgramInfo into a QDataStream.
+ *
+ *  This carries the same fields as ToStringList(), but numbers and dates are
+ *  written in binary, so reading it back needs no string conversions. The
+ *  stream version must be kBinaryStreamVersion on both ends.
+ *  \sa FromBinary(QDataStream&)
+ */
+void ProgramInfo::ToBinary(QDataStream &stream) const
+{
+    stream << m_title << m_subtitle << m_description
+           << quint32(m_season) << quint32(m_episode)
+           << quint32(m_totalEpisodes) << m_syndicatedEpisode << m_category
+           << quint32(m_chanId) << m_chanStr << m_chanSign << m_chanName
+           << m_pathname << quint64(m_fileSize)
+           << DateTimeToBinary(m_startTs) << DateTimeToBinary(m_endTs)
+           << quint32(m_findId) << m_hostname << quint32(m_sourceId)
+           << quint32(m_inputId) << qint32(m_recPriority)
+           << qint8(m_recStatus) << quint32(m_recordId)
+           << quint8(m_recType) << quint8(m_dupIn) << quint8(m_dupMethod)
+           << DateTimeToBinary(m_recStartTs) << DateTimeToBinary(m_recEndTs)
+           << quint32(m_programFlags)
+           << (!m_recGroup.isEmpty() ? m_recGroup : "Default")
+           << m_chanPlaybackFilters << m_seriesId << m_programId << m_inetRef
+           << DateTimeToBinary(m_lastModified) << m_stars << m_originalAirDate
+           << (!m_playGroup.isEmpty() ? m_playGroup : "Default")
+           << qint32(m_recPriority2) << quint32(m_parentId)
+           << (!m_storageGroup.isEmpty() ? m_storageGroup : "Default")
+           << quint8(m_audioProperties) << quint16(m_videoProperties)
+           << quint8(m_subtitleProperties)
+           << quint16(m_year) << quint16(m_partNumber) << quint16(m_partTotal)
+           << quint8(m_catType) << quint32(m_recordedId) << m_inputName
+           << DateTimeToBinary(m_bookmarkUpdate);
+}
+
+/** \fn ProgramInfo::FromBinary(QDataStream&)
+ *  \brief Initializes this ProgramInfo from the output of ToBinary().
+ *  \return true if it succeeds, false if the stream ran out of data.
+ *  \sa ToBinary(QDataStream&) const
+ */
+bool ProgramInfo::FromBinary(QDataStream &stream)
+{
+    uint      origChanid     = m_chanId;
+    QDateTime origRecstartts = m_recStartTs;
+
+    quint32 season {0};
+    quint32 episode {0};
+    quint32 totalEpisodes {0};
+    quint32 chanId {0};
+    quint64 fileSize {0};
+    qint64  startTs {-1};
+    qint64  endTs {-1};
+    quint32 findId {0};
+    quint32 sourceId {0};
+    quint32 inputId {0};
+    qint32  recPriority {0};
+    qint8   recStatus {0};
+    quint32 recordId {0};
+    quint8  recType {0};
+    quint8  dupIn {0};
+    quint8  dupMethod {0};
+    qint64  recStartTs {-1};
+    qint64  recEndTs {-1};
+    quint32 programFlags {0};
+    qint64  lastModified {-1};
+    qint32  recPriority2 {0};
+    quint32 parentId {0};
+    quint8  audioProperties {0};
+    quint16 videoProperties {0};
+    quint8  subtitleProperties {0};
+    quint16 year {0};
+    quint16 partNumber {0};
+    quint16 partTotal {0};
+    quint8  catType {0};
+    quint32 recordedId {0};
+    qint64  bookmarkUpdate {-1};
+
+    stream >> m_title >> m_subtitle >> m_description
+           >> season >> episode >> totalEpisodes
+           >> m_syndicatedEpisode >> m_category
+           >> chanId >> m_chanStr >> m_chanSign >> m_chanName
+           >> m_pathname >> fileSize >> startTs >> endTs
+           >> findId >> m_hostname >> sourceId >> inputId >> recPriority
+           >> recStatus >> recordId >> recType >> dupIn >> dupMethod
+           >> recStartTs >> recEndTs >> programFlags >> m_recGroup
+           >> m_chanPlaybackFilters >> m_seriesId >> m_programId >> m_inetRef
+           >> lastModified >> m_stars >> m_originalAirDate >> m_playGroup
+           >> recPriority2 >> parentId >> m_storageGroup
+           >> audioProperties >> videoProperties >> subtitleProperties
+           >> year >> partNumber >> partTotal
+           >> catType >> recordedId >> m_inputName >> bookmarkUpdate;
+
+    if (stream.status() != QDataStream::Ok)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "FromBinary, not enough data.");
+        clear();
+        return false;
+    }
+
+    m_season             = season;
+    m_episode            = episode;
+    m_totalEpisodes      = totalEpisodes;
+    m_chanId             = chanId;
+    m_fileSize           = fileSize;
+    m_startTs            = DateTimeFromBinary(startTs);
+    m_endTs              = DateTimeFromBinary(endTs);
+    m_findId             = findId;
+    m_sourceId           = sourceId;
+    m_inputId            = inputId;
+    m_recPriority        = recPriority;
+    m_recStatus          = recStatus;
+    m_recordId           = recordId;
+    m_recType            = recType;
+    m_dupIn              = dupIn;
+    m_dupMethod          = dupMethod;
+    m_recStartTs         = DateTimeFromBinary(recStartTs);
+    m_recEndTs           = DateTimeFromBinary(recEndTs);
+    m_programFlags       = programFlags;
+    m_lastModified       = DateTimeFromBinary(lastModified);
+    m_recPriority2       = recPriority2;
+    m_parentId           = parentId;
+    m_audioProperties    = audioProperties;
+    m_videoProperties    = videoProperties;
+    m_subtitleProperties = subtitleProperties;
+    m_year               = year;
+    m_partNumber         = partNumber;
+    m_partTotal          = partTotal;
+    m_catType            = (CategoryType)catType;
+    m_recordedId         = recordedId;
+    m_bookmarkUpdate     = DateTimeFromBinary(bookmarkUpdate);
+
+    if (!origChanid || !origRecstartts.isValid() ||
+        (origChanid != m_chanId) || (origRecstartts != m_recStartTs))
+    {
+        m_availableStatus = asAvailable;
+        m_spread = -1;
+        m_startCol = -1;
+        m_inUseForWhat = QString();
+        m_positionMapDBReplacement = nullptr;
+    }
+
+    ensureSortFields();
+
+    return true;
+}
+
 template <typename T>
 QString propsValueToString (const QString& name, QMap<T,QString> propNames,
                             T props)
@@ -3803,6 +3961,11 @@ void ProgramInfo::QueryPositionMap(
     }
 
     posMap.clear();
+
+    // A local recording's seek index file saves the database round trip.
+    if (IsRecording() && !IsVideo() && SeekIndexFile::Load(m_pathname, type, posMap))
+        return;
+
     MSqlQuery query(MSqlQuery::InitCon());
 
     if (IsVideo())
@@ -3857,6 +4020,7 @@ void ProgramInfo::ClearPositionMap(MarkTypes type) const
     }
     else if (IsRecording())
     {
+        SeekIndexFile::Clear(m_pathname, type);
         query.prepare("DELETE FROM recordedseek"
                       " WHERE chanid = :CHANID"
                       " AND starttime = :STARTTIME"
@@ -3942,6 +4106,16 @@ void ProgramInfo::SavePositionMap(
     }
     else if (IsRecording())
     {
+        // A partial replacement would need the index merged, so only a
+        // full one is mirrored into it.
+        if ((min_frame >= 0) || (max_frame >= 0))
+        {
+            SeekIndexFile::Remove(m_pathname);
+        }
+        else if (SeekIndexFile::Clear(m_pathname, type))
+        {
+            SeekIndexFile::Append(m_pathname, type, posMap);
+        }
         query.prepare("DELETE FROM recordedseek"
                       " WHERE chanid = :CHANID"
                       " AND starttime = :STARTTIME"
@@ -4048,6 +4222,7 @@ void ProgramInfo::SavePositionMapDelta(
     }
     else if (IsRecording())
     {
+        SeekIndexFile::Append(m_pathname, type, posMap);
         q << "recordedseek (chanid, starttime, type, mark, `offset`)";
         qfields = QString("(%1,'%2',%3,") .
             arg(m_chanId) .
@@ -4903,6 +5078,7 @@ void ProgramInfo::SaveMarkup(const QVector<MarkupEntry> &mapMark,
         }
         else
         {
+            SeekIndexFile::Remove(m_pathname);
             query.prepare("DELETE FROM recordedseek"
                           " WHERE chanid = :CHANID"
                           " AND starttime = :STARTTIME");
@@ -9,6 +9,7 @@
 #include <vector> // for GetNextRecordingList
 
 #include <QStringList>
+#include <QDataStream>
 #include <QDateTime>
 
 // MythTV headers
@@ -296,6 +297,11 @@ class MBASE_PUBLIC ProgramInfo
         if (!FromStringList(it, list.end()))
             ProgramInfo::clear();
     }
+    explicit ProgramInfo(QDataStream &stream)
+    {
+        if (!FromBinary(stream))
+            ProgramInfo::clear();
+    }
 
     bool operator==(const ProgramInfo& rhs);
     ProgramInfo &operator=(const ProgramInfo &other);
@@ -310,6 +316,9 @@ class MBASE_PUBLIC ProgramInfo
 
     // Serializers
     void ToStringList(QStringList &list) const;
+    void ToBinary(QDataStream &stream) const;
+    /// QDataStream version used by ToBinary() and FromBinary()
+    static constexpr int kBinaryStreamVersion { QDataStream::Qt_5_15 };
     virtual void ToMap(InfoMap &progMap,
                        bool showrerecord = false,
                        uint star_range = 10,
@@ -558,6 +567,23 @@ class MBASE_PUBLIC ProgramInfo
         m_programFlags &= ~FL_COMMFLAG;
         m_programFlags |= (flagging) ? FL_COMMFLAG : FL_NONE;
     }
+    /// \brief Replaces all flags, e.g. with those of an up to date copy.
+    void SetProgramFlags(uint32_t flags) { m_programFlags = flags; }
+    /// \brief Replaces the FL_INUSE* flags, e.g. with a QueryInUseMap() value.
+    void SetInUseFlags(uint32_t inuse)
+    {
+        static constexpr uint32_t kInUseMask
+            { FL_INUSERECORDING | FL_INUSEPLAYING | FL_INUSEOTHER };
+        m_programFlags &= ~kInUseMask;
+        m_programFlags |= (inuse & kInUseMask);
+    }
+    /// \brief Clears FL_COMMPROCESSING unless a commercial flagging job is
+    ///        running, e.g. according to QueryJobsRunning(JOB_COMMFLAG).
+    void SetCommFlagJobRunning(bool running)
+    {
+        if (!running)
+            m_programFlags &= ~FL_COMMPROCESSING;
+    }
     /// \brief If "ignore" is true GetBookmark() will return 0, otherwise
     ///        GetBookmark() will return the bookmark position if it exists.
     void SetIgnoreBookmark(bool ignore)
@@ -754,6 +780,7 @@ class MBASE_PUBLIC ProgramInfo
 
     bool FromStringList(QStringList::const_iterator &it,
                         const QStringList::const_iterator&  end);
+    bool FromBinary(QDataStream &stream);
 
     static void QueryMarkupMap(
         const QString &video_pathname,
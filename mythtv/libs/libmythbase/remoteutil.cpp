@@ -1,5 +1,6 @@
 #include "remoteutil.h"
 
+#include <algorithm>
 #include <unistd.h>
 
 #include <QFileInfo>
@@ -39,6 +40,97 @@ std::vector<ProgramInfo *> *RemoteGetRecordedList(int sort)
     return info;
 }
 
+/**
+ * \brief Get the recordings that changed since an earlier list.
+ *
+ * Uses QUERY_RECORDINGS_SINCE, which sends the recordings in binary and
+ * only those that changed, so callers can keep the list between calls.
+ * \param generation Generation of the list the caller has, 0 for none.
+ *                   Set to the generation of the list after the changes.
+ * \param full       Set if changed holds all recordings and whatever the
+ *                   caller had before must be dropped.
+ * \param changed    Recordings that are new or changed.
+ * \param deleted    Ids of recordings that have been deleted.
+ * \param states     Current flags, status and size of all recordings,
+ *                   including those that did not change.
+ * \return false if the backend did not give a valid answer.
+ */
+bool RemoteGetRecordedListSince(uint64_t &generation, bool &full,
+                                std::vector<ProgramInfo> &changed,
+                                std::vector<uint> &deleted,
+                                std::vector<RecordedState> &states)
+{
+    QStringList strlist(QString("QUERY_RECORDINGS_SINCE %1").arg(generation));
+
+    if (!gCoreContext->SendReceiveStringList(strlist) || strlist.size() != 5)
+        return false;
+
+    bool ok = false;
+    uint64_t newGeneration = strlist[0].toULongLong(&ok);
+    int count = strlist[2].toInt();
+    if (!ok || count < 0 ||
+        (strlist[1] != "FULL" && strlist[1] != "DELTA"))
+    {
+        LOG(VB_GENERAL, LOG_ERR,
+            "RemoteGetRecordedListSince() bad reply: " + strlist[0]);
+        return false;
+    }
+
+    QByteArray data = qUncompress(QByteArray::fromBase64(strlist[4].toLatin1()));
+    QDataStream stream(data);
+    stream.setVersion(ProgramInfo::kBinaryStreamVersion);
+
+    // Don't trust the counts for the allocations, every recording takes far
+    // more than kMinRecordingSize bytes and every state kStateSize bytes.
+    static constexpr qsizetype kMinRecordingSize { 64 };
+    static constexpr qsizetype kStateSize { 4 + 4 + 1 + 8 };
+    changed.clear();
+    changed.reserve(std::min<qsizetype>(count, data.size() / kMinRecordingSize));
+    for (int i = 0; i < count; i++)
+    {
+        changed.emplace_back(stream);
+        if (stream.status() != QDataStream::Ok)
+        {
+            LOG(VB_GENERAL, LOG_ERR,
+                "RemoteGetRecordedListSince() recording data is truncated.");
+            changed.clear();
+            return false;
+        }
+    }
+
+    quint32 nstates {0};
+    stream >> nstates;
+    states.clear();
+    states.reserve(std::min<qsizetype>(nstates, data.size() / kStateSize));
+    for (quint32 i = 0; i < nstates && stream.status() == QDataStream::Ok; i++)
+    {
+        quint32 recordedid {0};
+        quint32 flags {0};
+        qint8   recstatus {0};
+        quint64 filesize {0};
+        stream >> recordedid >> flags >> recstatus >> filesize;
+        states.push_back({recordedid, flags,
+                          static_cast<RecStatus::Type>(recstatus), filesize});
+    }
+    if (stream.status() != QDataStream::Ok)
+    {
+        LOG(VB_GENERAL, LOG_ERR,
+            "RemoteGetRecordedListSince() recording state is truncated.");
+        changed.clear();
+        states.clear();
+        return false;
+    }
+
+    deleted.clear();
+    const QStringList ids = strlist[3].split(',', Qt::SkipEmptyParts);
+    for (const auto & id : ids)
+        deleted.push_back(id.toUInt());
+
+    generation = newGeneration;
+    full = (strlist[1] == "FULL");
+    return true;
+}
+
 bool RemoteGetLoad(system_load_array& load)
 {
     QStringList strlist(QString("QUERY_LOAD"));
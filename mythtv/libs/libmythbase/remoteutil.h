@@ -2,6 +2,7 @@
 #define REMOTEUTIL_H_
 
 #include <array>
+#include <cstdint>
 #include <vector>
 
 #include <QDateTime>
@@ -9,6 +10,7 @@
 #include <QStringList>
 
 #include "libmythbase/mythchrono.h"
+#include "libmythbase/recordingstatus.h"
 
 #include "mythbaseexp.h"
 
@@ -17,7 +19,19 @@ class MythEvent;
 
 using system_load_array = std::array<double,3>;
 
+/// State of a recording that changes without a recording list change event.
+struct RecordedState
+{
+    uint            m_recordedId { 0 };
+    uint32_t        m_flags      { 0 };
+    RecStatus::Type m_recStatus  { RecStatus::Unknown };
+    uint64_t        m_filesize   { 0 };
+};
+
 MBASE_PUBLIC std::vector<ProgramInfo *> *RemoteGetRecordedList(int sort);
+MBASE_PUBLIC bool RemoteGetRecordedListSince(
+    uint64_t &generation, bool &full, std::vector<ProgramInfo> &changed,
+    std::vector<uint> &deleted, std::vector<RecordedState> &states);
 MBASE_PUBLIC bool RemoteGetLoad(system_load_array &load);
 MBASE_PUBLIC bool RemoteGetUptime(std::chrono::seconds &uptime);
 MBASE_PUBLIC
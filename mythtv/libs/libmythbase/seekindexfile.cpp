@@ -0,0 +1,260 @@
+// C++ headers
+#include <cstring>
+
+#ifndef _WIN32
+#include <sys/file.h>
+#include <sys/stat.h>
+#endif
+
+// Qt headers
+#include <QByteArray>
+#include <QFile>
+#include <QSaveFile>
+#include <QtEndian>
+
+// MythTV headers
+#include "mythlogging.h"
+#include "seekindexfile.h"
+
+#define LOC QString("SeekIndex: ")
+
+static constexpr char     kMagic[]  { "MYTHSEEK" };
+static constexpr uint32_t kVersion  { 1 };
+
+/*
+ * Layout, all numbers little endian:
+ *
+ *   header: char magic[8], uint32 version, uint32 entry size
+ *   entry:  int64 mark, int64 offset, int32 mark type, int32 reserved
+ *
+ * Entries are only ever appended. A reader may see a partially written
+ * last entry while the recorder is appending; it is simply ignored.
+ *
+ * Writers hold an exclusive flock() on the file. Clear() replaces the file
+ * while holding the lock on the old one, so an Append() that was waiting
+ * for that lock finds the file replaced and appends to the new one.
+ */
+
+static constexpr int kLockAttempts { 3 };
+
+/** \brief Takes an exclusive lock on the open index file.
+ *
+ *  The lock is released when the file is closed.
+ *  \return false if the index was replaced or removed while waiting for
+ *          the lock, the caller should open it again.
+ */
+static bool lock_index([[maybe_unused]] QFile &file)
+{
+#ifndef _WIN32
+    if (flock(file.handle(), LOCK_EX) != 0)
+        return false;
+
+    struct stat opened {};
+    struct stat current {};
+    if ((fstat(file.handle(), &opened) != 0) ||
+        (stat(QFile::encodeName(file.fileName()).constData(), &current) != 0))
+        return false;
+    return (opened.st_dev == current.st_dev) && (opened.st_ino == current.st_ino);
+#else
+    return true;
+#endif
+}
+
+QString SeekIndexFile::FileName(const QString &recording)
+{
+    return recording + ".seek";
+}
+
+/** \brief Creates an empty index, replacing any existing one.
+ *
+ *  Call this only right after the seek table in the database has been
+ *  emptied, the new file is considered complete from then on.
+ */
+bool SeekIndexFile::Create(const QString &recording)
+{
+    if (!IsUsable(recording))
+        return false;
+
+    QFile file(FileName(recording));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        LOG(VB_FILE, LOG_WARNING, LOC + QString("Unable to create '%1': %2")
+            .arg(file.fileName(), file.errorString()));
+        return false;
+    }
+
+    QByteArray header(kHeaderSize, '\0');
+    memcpy(header.data(), kMagic, 8);
+    qToLittleEndian<quint32>(kVersion, header.data() + 8);
+    qToLittleEndian<quint32>(kEntrySize, header.data() + 12);
+
+    if (file.write(header) != kHeaderSize)
+    {
+        file.remove();
+        return false;
+    }
+    return true;
+}
+
+/** \brief Appends a position map delta to an existing index.
+ *
+ *  Nothing is written unless the index exists, an index that was never
+ *  created when the recording started would be incomplete.
+ */
+bool SeekIndexFile::Append(const QString &recording, MarkTypes type,
+                           const frm_pos_map_t &posMap)
+{
+    if (!IsUsable(recording) || posMap.isEmpty())
+        return false;
+
+    QByteArray data(static_cast<int>(posMap.size()) * kEntrySize, '\0');
+    char *ptr = data.data();
+    for (auto it = posMap.cbegin(); it != posMap.cend(); ++it)
+    {
+        qToLittleEndian<qint64>(it.key(), ptr);
+        qToLittleEndian<qint64>(*it, ptr + 8);
+        qToLittleEndian<qint32>(type, ptr + 16);
+        ptr += kEntrySize;
+    }
+
+    for (int attempt = 0; attempt < kLockAttempts; attempt++)
+    {
+        QFile file(FileName(recording));
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Append |
+                       QIODevice::ExistingOnly))
+            return false;
+        if (!lock_index(file))
+            continue;
+
+        // A single write of whole entries, so concurrent readers see either
+        // all of an entry or a short tail they ignore.
+        if (file.write(data) != data.size())
+        {
+            LOG(VB_FILE, LOG_WARNING, LOC + QString("Unable to append to "
+                                                    "'%1': %2, removing it")
+                .arg(file.fileName(), file.errorString()));
+            file.remove();
+            return false;
+        }
+        return true;
+    }
+
+    LOG(VB_FILE, LOG_WARNING, LOC + QString("Unable to lock '%1', removing it")
+        .arg(FileName(recording)));
+    Remove(recording);
+    return false;
+}
+
+/** \brief Fills posMap with all entries of the given type.
+ *
+ *  \return false if there is no usable index, the caller should then
+ *          query the database instead.
+ */
+bool SeekIndexFile::Load(const QString &recording, MarkTypes type,
+                         frm_pos_map_t &posMap)
+{
+    if (!IsUsable(recording))
+        return false;
+
+    QFile file(FileName(recording));
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QByteArray buffer = file.readAll();
+    qint64 size = buffer.size();
+    if (size < kHeaderSize)
+        return false;
+    const auto *base = reinterpret_cast<const uchar*>(buffer.constData());
+
+    if ((memcmp(base, kMagic, 8) != 0) ||
+        (qFromLittleEndian<quint32>(base + 8) != kVersion) ||
+        (qFromLittleEndian<quint32>(base + 12) != kEntrySize))
+    {
+        LOG(VB_GENERAL, LOG_WARNING, LOC +
+            QString("Ignoring '%1', unknown format").arg(file.fileName()));
+        return false;
+    }
+
+    posMap.clear();
+    qint64 count = (size - kHeaderSize) / kEntrySize;
+    const uchar *ptr = base + kHeaderSize;
+    for (qint64 i = 0; i < count; i++, ptr += kEntrySize)
+    {
+        // Marks are normally appended in increasing order, so hint
+        // the insert at the end of the map.
+        if (qFromLittleEndian<qint32>(ptr + 16) == type)
+        {
+            posMap.insert(posMap.cend(), qFromLittleEndian<qint64>(ptr),
+                          qFromLittleEndian<qint64>(ptr + 8));
+        }
+    }
+    return true;
+}
+
+/** \brief Drops all entries of the given type from an existing index.
+ *
+ *  The index is replaced by a copy without them, so it stays complete for
+ *  the other types. The old file stays locked until the copy has replaced
+ *  it, so entries appended meanwhile by a recorder are not lost. If that
+ *  fails the index is removed instead.
+ */
+bool SeekIndexFile::Clear(const QString &recording, MarkTypes type)
+{
+    if (!IsUsable(recording))
+        return false;
+
+    QFile file(FileName(recording));
+    bool locked = false;
+    for (int attempt = 0; attempt < kLockAttempts && !locked; attempt++)
+    {
+        file.close();
+        if (!file.open(QIODevice::ReadOnly))
+            return false;
+        locked = lock_index(file);
+    }
+    if (!locked)
+    {
+        LOG(VB_FILE, LOG_WARNING, LOC + QString("Unable to lock '%1', "
+                                                "removing it")
+            .arg(FileName(recording)));
+        Remove(recording);
+        return false;
+    }
+    QByteArray data = file.readAll();
+
+    if ((data.size() < kHeaderSize) ||
+        (memcmp(data.constData(), kMagic, 8) != 0))
+    {
+        Remove(recording);
+        return false;
+    }
+
+    QByteArray kept = data.left(kHeaderSize);
+    qint64 count = (data.size() - kHeaderSize) / kEntrySize;
+    kept.reserve(kHeaderSize + (count * kEntrySize));
+    const char *ptr = data.constData() + kHeaderSize;
+    for (qint64 i = 0; i < count; i++, ptr += kEntrySize)
+    {
+        if (qFromLittleEndian<qint32>(ptr + 16) != type)
+            kept.append(ptr, kEntrySize);
+    }
+
+    QSaveFile out(FileName(recording));
+    if (!out.open(QIODevice::WriteOnly) ||
+        (out.write(kept) != kept.size()) || !out.commit())
+    {
+        LOG(VB_FILE, LOG_WARNING, LOC + QString("Unable to rewrite '%1', "
+                                                "removing it")
+            .arg(FileName(recording)));
+        Remove(recording);
+        return false;
+    }
+    return true;
+}
+
+/// Removes the index, readers go back to using the database.
+void SeekIndexFile::Remove(const QString &recording)
+{
+    if (IsUsable(recording))
+        QFile::remove(FileName(recording));
+}
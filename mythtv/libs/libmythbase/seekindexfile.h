@@ -0,0 +1,41 @@
+#ifndef SEEKINDEXFILE_H
+#define SEEKINDEXFILE_H
+
+#include <QString>
+
+#include "mythbaseexp.h"
+#include "programtypes.h"
+
+/** \class SeekIndexFile
+ *  \brief Append-only binary copy of a recording's seek table.
+ *
+ *  The file lives next to the recording as "<recording>.seek". It is
+ *  created empty when a recording starts and the recorder appends every
+ *  position map delta it also writes to the database. As long as the file
+ *  exists it holds the complete seek table of every mark type, so local
+ *  readers can read it instead of querying the database. Anything
+ *  that rewrites the seek table in the database in some other way removes
+ *  the file, and readers fall back to the database again.
+ */
+class MBASE_PUBLIC SeekIndexFile
+{
+  public:
+    static QString FileName(const QString &recording);
+
+    static bool Create(const QString &recording);
+    static bool Append(const QString &recording, MarkTypes type,
+                       const frm_pos_map_t &posMap);
+    static bool Load(const QString &recording, MarkTypes type,
+                     frm_pos_map_t &posMap);
+    static bool Clear(const QString &recording, MarkTypes type);
+    static void Remove(const QString &recording);
+
+    /// Only absolute local paths have an index file next to them.
+    static bool IsUsable(const QString &recording)
+        { return recording.startsWith('/'); }
+
+    static constexpr int kHeaderSize { 16 };
+    static constexpr int kEntrySize  { 24 };
+};
+
+#endif // SEEKINDEXFILE_H
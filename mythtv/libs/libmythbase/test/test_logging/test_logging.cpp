@@ -347,4 +347,86 @@ void TestLogging::test_logPropagateCalc (void)
     QCOMPARE(logPropagateArgs.trimmed(), expectedArgs);
 }
 
-QTEST_APPLESS_MAIN(TestLogging)
+void TestLogging::test_logRing (void)
+{
+    LogRing ring(1, 2);
+    QCOMPARE(ring.threadId(), static_cast<uint64_t>(1));
+    QCOMPARE(ring.tid(), static_cast<int64_t>(2));
+
+    for (uint32_t i = 0; i < LogRing::kSize; i++)
+    {
+        LogRecord record { "file", "func", static_cast<int>(i), LOG_INFO,
+                           kMessage, 0us, QString::number(i) };
+        QVERIFY(ring.push(std::move(record)));
+    }
+    QCOMPARE(ring.size(), LogRing::kSize);
+
+    // Full, the record must be left alone for the slow path
+    LogRecord extra { "file", "func", -1, LOG_INFO, kMessage, 0us, "extra" };
+    QVERIFY(!ring.push(std::move(extra)));
+    QCOMPARE(extra.m_message, QString("extra")); // NOLINT(bugprone-use-after-move)
+
+    int expected = 0;
+    uint32_t count = ring.drain([&expected](LogRecord &record)
+    {
+        QCOMPARE(record.m_line, expected);
+        QCOMPARE(record.m_message, QString::number(expected));
+        expected++;
+    });
+    QCOMPARE(count, LogRing::kSize);
+    QCOMPARE(ring.size(), 0U);
+    QCOMPARE(ring.drain([](LogRecord &/*record*/) {}), 0U);
+}
+
+void TestLogging::test_logRing_wrap (void)
+{
+    LogRing ring(1, 2);
+    int pushed = 0;
+    int drained = 0;
+
+    // Uneven steps so the ring wraps at different positions
+    for (int round = 0; round < 10; round++)
+    {
+        for (uint32_t i = 0; i < (LogRing::kSize / 3) + round; i++)
+        {
+            LogRecord record { "file", "func", pushed++, LOG_INFO, kMessage, 0us, {} };
+            QVERIFY(ring.push(std::move(record)));
+        }
+        ring.drain([&drained](LogRecord &record)
+        {
+            QCOMPARE(record.m_line, drained++);
+        });
+    }
+    QCOMPARE(drained, pushed);
+}
+
+void TestLogging::benchmark_LogPrintLine_data (void)
+{
+    QTest::addColumn<bool>("fastPath");
+
+    QTest::newRow("fast path") << true;
+    QTest::newRow("locked queue") << false;
+}
+
+// Time one LOG() call from the point of view of the caller, with the logger
+// thread running and writing to nowhere.
+void TestLogging::benchmark_LogPrintLine (void)
+{
+    QFETCH(bool, fastPath);
+
+    resetLogging();
+    verboseArgParse("general");
+    logStart("", false, 2, -1, LOG_INFO, false, false, false);
+    logSetFastPath(fastPath);
+
+    int count = 0;
+    QBENCHMARK
+    {
+        LOG(VB_GENERAL, LOG_INFO, QString("Benchmark message %1").arg(count++));
+    }
+
+    logStop();
+    logSetFastPath(true);
+}
+
+QTEST_GUILESS_MAIN(TestLogging)
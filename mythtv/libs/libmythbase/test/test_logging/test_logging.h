@@ -41,4 +41,8 @@ private slots:
     static void test_verboseArgParse_level(void);
     static void test_logPropagateCalc_data(void);
     static void test_logPropagateCalc(void);
+    static void test_logRing(void);
+    static void test_logRing_wrap(void);
+    static void benchmark_LogPrintLine_data(void);
+    static void benchmark_LogPrintLine(void);
 };
@@ -474,6 +474,40 @@ class TestProgramInfo : public QObject
         QVERIFY(m_supergirl23 == lrigrepus23c);
     }
 
+    void programToBinary_test(void)
+    {
+        QByteArray data;
+        QDataStream out(&data, QIODevice::WriteOnly);
+        out.setVersion(ProgramInfo::kBinaryStreamVersion);
+        m_dracula.ToBinary(out);
+        m_flash34.ToBinary(out);
+        m_supergirl23.ToBinary(out);
+
+        QDataStream in(data);
+        in.setVersion(ProgramInfo::kBinaryStreamVersion);
+        ProgramInfo alucard(in);
+        QVERIFY(m_dracula == alucard);
+        ProgramInfo hsalf34(in);
+        QVERIFY(m_flash34 == hsalf34);
+        ProgramInfo lrigrepus23(in);
+        QVERIFY(m_supergirl23 == lrigrepus23);
+        QVERIFY(in.atEnd());
+
+        // The same as going through the string list
+        QStringList binary_list;
+        QStringList program_list;
+        lrigrepus23.ToStringList(binary_list);
+        m_supergirl23.ToStringList(program_list);
+        QCOMPARE(binary_list, program_list);
+
+        // Truncated data must fail and leave a cleared ProgramInfo
+        QDataStream truncated(data.left(data.size() / 6));
+        truncated.setVersion(ProgramInfo::kBinaryStreamVersion);
+        ProgramInfo partial(truncated);
+        QCOMPARE(partial.GetTitle(), QString());
+        QCOMPARE(partial.GetChanID(), 0U);
+    }
+
     void printList (const QStringList& list)
     {
         Q_UNUSED(list);
@@ -0,0 +1,130 @@
+/*
+ *  Class TestSeekIndexFile
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <QFile>
+
+#include "test_seekindexfile.h"
+#include "seekindexfile.h"
+
+void TestSeekIndexFile::initTestCase(void)
+{
+    QVERIFY(m_dir.isValid());
+    m_recording = m_dir.filePath("1001_20240101120000.ts");
+}
+
+void TestSeekIndexFile::testNoIndex(void)
+{
+    frm_pos_map_t map;
+    QVERIFY(!SeekIndexFile::Load(m_recording, MARK_GOP_BYFRAME, map));
+    QVERIFY(!SeekIndexFile::Load("myth://host/1001.ts", MARK_GOP_BYFRAME, map));
+    QVERIFY(!SeekIndexFile::Create("1001.ts"));
+}
+
+void TestSeekIndexFile::testAppendAndLoad(void)
+{
+    QVERIFY(SeekIndexFile::Create(m_recording));
+
+    frm_pos_map_t map;
+    QVERIFY(SeekIndexFile::Load(m_recording, MARK_GOP_BYFRAME, map));
+    QVERIFY(map.isEmpty());
+
+    frm_pos_map_t gops { { 0, 0 }, { 12, 188000 } };
+    frm_pos_map_t durations { { 0, 0 }, { 12, 480 } };
+    QVERIFY(SeekIndexFile::Append(m_recording, MARK_GOP_BYFRAME, gops));
+    QVERIFY(SeekIndexFile::Append(m_recording, MARK_DURATION_MS, durations));
+    frm_pos_map_t more { { 24, 0x1'0000'0000LL } };
+    QVERIFY(SeekIndexFile::Append(m_recording, MARK_GOP_BYFRAME, more));
+
+    QVERIFY(SeekIndexFile::Load(m_recording, MARK_GOP_BYFRAME, map));
+    frm_pos_map_t expected { { 0, 0 }, { 12, 188000 }, { 24, 0x1'0000'0000LL } };
+    QCOMPARE(map, expected);
+
+    QVERIFY(SeekIndexFile::Load(m_recording, MARK_DURATION_MS, map));
+    QCOMPARE(map, durations);
+}
+
+void TestSeekIndexFile::testAppendWithoutCreate(void)
+{
+    QString other = m_dir.filePath("1002_20240101120000.ts");
+    frm_pos_map_t gops { { 0, 0 } };
+    QVERIFY(!SeekIndexFile::Append(other, MARK_GOP_BYFRAME, gops));
+    QVERIFY(!QFile::exists(SeekIndexFile::FileName(other)));
+}
+
+void TestSeekIndexFile::testClear(void)
+{
+    QVERIFY(SeekIndexFile::Create(m_recording));
+    frm_pos_map_t gops { { 0, 0 }, { 12, 188000 } };
+    frm_pos_map_t durations { { 0, 0 }, { 12, 480 } };
+    QVERIFY(SeekIndexFile::Append(m_recording, MARK_GOP_BYFRAME, gops));
+    QVERIFY(SeekIndexFile::Append(m_recording, MARK_DURATION_MS, durations));
+
+    QVERIFY(SeekIndexFile::Clear(m_recording, MARK_GOP_BYFRAME));
+
+    frm_pos_map_t map;
+    QVERIFY(SeekIndexFile::Load(m_recording, MARK_GOP_BYFRAME, map));
+    QVERIFY(map.isEmpty());
+    QVERIFY(SeekIndexFile::Load(m_recording, MARK_DURATION_MS, map));
+    QCOMPARE(map, durations);
+}
+
+void TestSeekIndexFile::testAppendAfterClear(void)
+{
+    QVERIFY(SeekIndexFile::Create(m_recording));
+    frm_pos_map_t gops { { 0, 0 }, { 12, 188000 } };
+    QVERIFY(SeekIndexFile::Append(m_recording, MARK_GOP_BYFRAME, gops));
+    QVERIFY(SeekIndexFile::Clear(m_recording, MARK_DURATION_MS));
+
+    // Clear() replaced the file, appends must go to the new one.
+    frm_pos_map_t more { { 24, 376000 } };
+    QVERIFY(SeekIndexFile::Append(m_recording, MARK_GOP_BYFRAME, more));
+
+    frm_pos_map_t map;
+    QVERIFY(SeekIndexFile::Load(m_recording, MARK_GOP_BYFRAME, map));
+    frm_pos_map_t expected { { 0, 0 }, { 12, 188000 }, { 24, 376000 } };
+    QCOMPARE(map, expected);
+}
+
+void TestSeekIndexFile::testTruncatedEntry(void)
+{
+    QVERIFY(SeekIndexFile::Create(m_recording));
+    frm_pos_map_t gops { { 0, 0 }, { 12, 188000 } };
+    QVERIFY(SeekIndexFile::Append(m_recording, MARK_GOP_BYFRAME, gops));
+
+    // Simulate a reader racing a half written entry.
+    QFile file(SeekIndexFile::FileName(m_recording));
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Append));
+    QCOMPARE(file.write(QByteArray(SeekIndexFile::kEntrySize / 2, '\x7f')),
+             static_cast<qint64>(SeekIndexFile::kEntrySize / 2));
+    file.close();
+
+    frm_pos_map_t map;
+    QVERIFY(SeekIndexFile::Load(m_recording, MARK_GOP_BYFRAME, map));
+    QCOMPARE(map, gops);
+}
+
+void TestSeekIndexFile::testRemove(void)
+{
+    QVERIFY(SeekIndexFile::Create(m_recording));
+    SeekIndexFile::Remove(m_recording);
+
+    frm_pos_map_t map;
+    QVERIFY(!SeekIndexFile::Load(m_recording, MARK_GOP_BYFRAME, map));
+}
+
+QTEST_APPLESS_MAIN(TestSeekIndexFile)
@@ -0,0 +1,19 @@
+include ( ../../../../settings.pro )
+include ( ../../../../test.pro )
+
+QT += xml sql network testlib
+
+TEMPLATE = app
+TARGET = test_seekindexfile
+DEPENDPATH += . ../..
+INCLUDEPATH += . ../..
+LIBS += -L../.. -lmythbase-$$LIBVERSION
+
+# Input
+HEADERS += test_seekindexfile.h
+SOURCES += test_seekindexfile.cpp
+
+QMAKE_CLEAN += $(TARGET) $(TARGETA) $(TARGETD) $(TARGET0) $(TARGET1) $(TARGET2)
+QMAKE_CLEAN += ; ( cd $(OBJECTS_DIR) && rm -f *.gcov *.gcda *.gcno )
+
+LIBS += $$EXTRA_LIBS $$LATE_LIBS
@@ -1,4 +1,5 @@
 // C++ headers
+#include <algorithm>
 #include <cerrno>
 #include <csignal>
 #include <cstdio>
@@ -21,6 +22,10 @@
 #include "compat.h"
 #include "mythdate.h"
 
+#if defined(__linux__) && !defined(Q_OS_ANDROID)
+#define USING_SYNC_FILE_RANGE 1 // NOLINT(cppcoreguidelines-macro-usage)
+#endif
+
 #define LOC QString("TFW(%1:%2): ").arg(m_filename).arg(m_fd)
 
 /// \brief Runs ThreadedFileWriter::DiskLoop(void)
@@ -52,6 +57,13 @@ const uint ThreadedFileWriter::kMaxBlockSize    = 1 * 1024 * 1024;
  *   using another thread. The goal here so to block as little as
  *   possible when the classes using this class want to add data
  *   to the stream.
+ *
+ *   Optionally (see SetWritebackWindow()) the write thread also starts
+ *   disk writeback with sync_file_range() for every buffer it hands to
+ *   the kernel, and waits for the oldest writes to complete whenever
+ *   more than the window is in flight. This limits the dirty pages each
+ *   recording can build up, so many concurrent recordings don't cause
+ *   long writeback stalls. The written data stays in the page cache.
  */
 
 /** \fn ThreadedFileWriter::ReOpen(QString)
@@ -66,11 +78,17 @@ bool ThreadedFileWriter::ReOpen(const QString& newFilename)
 
     m_bufLock.lock();
 
+    // The write thread uses the file descriptor and the writeback ranges
+    // without the lock while it is writing a buffer.
+    while (m_writing)
+        m_bufferEmpty.wait(&m_bufLock);
+
     if (m_fd >= 0)
     {
         close(m_fd);
         m_fd = -1;
     }
+    m_writebackRanges.clear();
 
     if (m_registered)
     {
@@ -111,6 +129,12 @@ bool ThreadedFileWriter::Open(void)
     gCoreContext->RegisterFileForWrite(m_filename);
     m_registered = true;
 
+    if (m_filename != "-")
+    {
+        SetWritebackWindow(gCoreContext->GetNumSetting(
+                               "RecordWritebackWindow", 0) * 1024ULL * 1024ULL);
+    }
+
     LOG(VB_FILE, LOG_INFO, LOC + "Open() successful");
 
 #ifdef _WIN32
@@ -298,7 +322,7 @@ long long ThreadedFileWriter::Seek(long long pos, int whence)
 {
     QMutexLocker locker(&m_bufLock);
     m_flush = true;
-    while (!m_writeBuffers.empty())
+    while (!m_writeBuffers.empty() || m_writing)
     {
         m_bufferHasData.wakeAll();
         if (!m_bufferEmpty.wait(locker.mutex(), 2000))
@@ -469,6 +493,7 @@ void ThreadedFileWriter::DiskLoop(void)
 
         TFWBuffer *buf = m_writeBuffers.front();
         m_writeBuffers.pop_front();
+        m_writing = true;
         m_totalBufferUse -= buf->data.size();
         m_bufferWasFreed.wakeAll();
         minWriteTimer.start();
@@ -532,11 +557,37 @@ void ThreadedFileWriter::DiskLoop(void)
 
         //////////////////////////////////////////
 
+        auto latency = duration_cast<std::chrono::microseconds>(
+            writeTimer.nsecsElapsed());
+        m_stats.m_writes++;
+        m_stats.m_bytesWritten += tot;
+        m_totalWriteLatency += latency;
+        m_stats.m_avgWriteLatency = m_totalWriteLatency / m_stats.m_writes;
+        m_stats.m_maxWriteLatency = std::max(m_stats.m_maxWriteLatency, latency);
+
+        if (write_ok && tot && m_writebackWindow.load(std::memory_order_relaxed))
+        {
+            locker.unlock();
+            StartWriteback(tot);
+            locker.relock();
+        }
+        m_writing = false;
+        m_bufferEmpty.wakeAll();
+
         if (lastRegisterTimer.elapsed() >= 10s)
         {
             gCoreContext->RegisterFileForWrite(m_filename, total_written);
             m_registered = true;
             lastRegisterTimer.restart();
+
+            LOG(VB_FILE, LOG_INFO, LOC +
+                QString("queue %1 buffers/%2 KB, write latency avg %3 us "
+                        "max %4 us, writeback %5 KB waits %6")
+                .arg(m_writeBuffers.size()).arg(m_totalBufferUse / 1024)
+                .arg(m_stats.m_avgWriteLatency.count())
+                .arg(m_stats.m_maxWriteLatency.count())
+                .arg(m_stats.m_writebackBytes / 1024)
+                .arg(m_stats.m_writebackWaits));
         }
 
         buf->lastUsed = MythDate::current();
@@ -616,3 +667,89 @@ bool ThreadedFileWriter::SetBlocking(bool block)
     m_blocking = block;
     return old;
 }
+
+/**
+ *  \brief Limit the amount of data per file waiting for the disk.
+ *
+ *  With a non zero window the write thread starts writeback of every
+ *  buffer right after writing it and waits for the oldest buffers to
+ *  reach the disk when more than \a bytes are in flight. This is only
+ *  available on Linux, elsewhere the window is ignored.
+ *
+ *  \param bytes size of the window in bytes, 0 to disable
+ */
+void ThreadedFileWriter::SetWritebackWindow([[maybe_unused]] uint64_t bytes)
+{
+    QMutexLocker locker(&m_bufLock);
+#ifdef USING_SYNC_FILE_RANGE
+    m_writebackWindow = bytes;
+    if (bytes)
+    {
+        LOG(VB_FILE, LOG_INFO, LOC +
+            QString("Writeback window %1 KB").arg(bytes / 1024));
+    }
+#endif
+}
+
+/**
+ *  \brief Start writeback of the \a size bytes just written and wait for
+ *         the oldest writes if the writeback window is full.
+ *
+ *  \note Only called from the write thread, without m_bufLock held but
+ *        with m_writing set, so ReOpen() can't close the file meanwhile.
+ */
+void ThreadedFileWriter::StartWriteback([[maybe_unused]] uint size)
+{
+#ifdef USING_SYNC_FILE_RANGE
+    off_t end = lseek(m_fd, 0, SEEK_CUR);
+    if (end < static_cast<off_t>(size))
+        return;
+
+    WritebackRange range { end - size, size };
+    if (sync_file_range(m_fd, range.first, range.second,
+                        SYNC_FILE_RANGE_WRITE) < 0)
+    {
+        // Not supported for this file (pipe, special filesystem, ...)
+        LOG(VB_FILE, LOG_INFO, LOC + "Disabling writeback window" + ENO);
+        QMutexLocker locker(&m_bufLock);
+        m_writebackWindow = 0;
+        m_stats.m_writebackBytes = 0;
+        m_writebackRanges.clear();
+        return;
+    }
+    m_writebackRanges.push_back(range);
+
+    uint64_t inflight = 0;
+    for (const auto & r : m_writebackRanges)
+        inflight += r.second;
+
+    uint64_t waits = 0;
+    uint64_t window = m_writebackWindow.load(std::memory_order_relaxed);
+    while (inflight > window && m_writebackRanges.size() > 1)
+    {
+        WritebackRange oldest = m_writebackRanges.front();
+        m_writebackRanges.pop_front();
+        sync_file_range(m_fd, oldest.first, oldest.second,
+                        SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE |
+                        SYNC_FILE_RANGE_WAIT_AFTER);
+        inflight -= oldest.second;
+        waits++;
+    }
+
+    QMutexLocker locker(&m_bufLock);
+    m_stats.m_writebackBytes = inflight;
+    m_stats.m_writebackWaits += waits;
+#endif
+}
+
+/**
+ *  \brief Returns the queue depth and write statistics of this file.
+ */
+TFWStats ThreadedFileWriter::GetStats(void) const
+{
+    QMutexLocker locker(&m_bufLock);
+    TFWStats stats = m_stats;
+    stats.m_queueDepth = m_writeBuffers.size();
+    stats.m_queueBytes = m_totalBufferUse;
+    return stats;
+}
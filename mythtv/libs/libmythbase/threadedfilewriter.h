@@ -2,7 +2,10 @@
 #ifndef TFW_H_
 #define TFW_H_
 
+#include <atomic>
+#include <chrono>
 #include <cstdint>
+#include <deque>
 #include <fcntl.h>
 #include <utility>
 #include <vector>
@@ -39,6 +42,19 @@ class TFWSyncThread : public MThread
     ThreadedFileWriter *m_parent {nullptr};
 };
 
+/// Write statistics of a ThreadedFileWriter, see ThreadedFileWriter::GetStats()
+struct TFWStats
+{
+    uint      m_queueDepth       {0};  ///< buffers waiting to be written
+    uint      m_queueBytes       {0};  ///< bytes waiting to be written
+    uint64_t  m_bytesWritten     {0};
+    uint64_t  m_writes           {0};  ///< number of buffers written
+    std::chrono::microseconds m_avgWriteLatency {0};
+    std::chrono::microseconds m_maxWriteLatency {0};
+    uint64_t  m_writebackBytes   {0};  ///< bytes in flight to the disk
+    uint64_t  m_writebackWaits   {0};  ///< times the window was full
+};
+
 class MBASE_PUBLIC ThreadedFileWriter
 {
     friend class TFWWriteThread;
@@ -64,10 +80,14 @@ class MBASE_PUBLIC ThreadedFileWriter
     bool SetBlocking(bool block = true);
     bool WritesFailing(void) const { return m_ignoreWrites; }
 
+    void SetWritebackWindow(uint64_t bytes);
+    TFWStats GetStats(void) const;
+
   protected:
     void DiskLoop(void);
     void SyncLoop(void);
     void TrimEmptyBuffers(void);
+    void StartWriteback(uint size);
 
   private:
     // file info
@@ -80,6 +100,7 @@ class MBASE_PUBLIC ThreadedFileWriter
     bool            m_flush              {false};         // protected by buflock
     bool            m_inDtor             {false};         // protected by buflock
     bool            m_ignoreWrites       {false};         // protected by buflock
+    bool            m_writing            {false};         // protected by buflock
     uint            m_tfwMinWriteSize    {kMinWriteSize}; // protected by buflock
     uint            m_totalBufferUse     {0};             // protected by buflock
 
@@ -114,6 +135,17 @@ class MBASE_PUBLIC ThreadedFileWriter
     bool m_warned                        {false};
     bool m_blocking                      {false};
     bool m_registered                    {false};
+
+    // writeback window, set by SetWritebackWindow() and read by the write
+    // thread, the ranges are used by the write thread while m_writing is
+    // set and otherwise only with m_bufLock held
+    using WritebackRange = std::pair<off_t, off_t>;
+    std::atomic<uint64_t>      m_writebackWindow {0};
+    std::deque<WritebackRange> m_writebackRanges;
+
+    // statistics
+    TFWStats                   m_stats;              // protected by buflock
+    std::chrono::microseconds  m_totalWriteLatency {0}; // protected by buflock
 };
 
 #endif
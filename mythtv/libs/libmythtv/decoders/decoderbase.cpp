@@ -639,6 +639,7 @@ bool DecoderBase::DoRewindSeek(long long desiredFrame)
     }
 
     m_ringBuffer->Seek(e.pos, SEEK_SET);
+    PrefetchNextSkip();
 
     return true;
 }
@@ -858,9 +859,40 @@ void DecoderBase::DoFastForwardSeek(long long desiredFrame, bool &needflush)
         m_framesPlayed = m_lastKey;
         m_fpsSkip = 0;
         m_framesRead = m_lastKey;
+        PrefetchNextSkip();
     }
 }
 
+/** \brief Prefetches the key frame the next fast forward or rewind skip
+ *         is going to land on.
+ *
+ *  While skipping, every skip is a seek followed by refilling the ring
+ *  buffer from scratch. Asking the storage for the next target while the
+ *  current one is decoded hides most of that latency, in particular on
+ *  network file systems.
+ */
+void DecoderBase::PrefetchNextSkip(void)
+{
+    int skip = m_parent->GetFFRewSkip();
+    if (abs(skip) <= 1 || !m_ringBuffer)
+        return;
+
+    int pre_idx = 0;
+    int post_idx = 0;
+    FindPosition(m_lastKey + skip, m_hasKeyFrameAdjustTable, pre_idx, post_idx);
+
+    QMutexLocker locker(&m_positionMapLock);
+    if ((pre_idx < 0) || (pre_idx + 1 >= static_cast<int>(m_positionMap.size())))
+        return;
+    long long start = m_positionMap[pre_idx].pos;
+    long long end   = m_positionMap[pre_idx + 1].pos;
+    locker.unlock();
+
+    // Only the key frame at the start of this range will be decoded, but
+    // the range up to the next key frame is what bounds it.
+    m_ringBuffer->Prefetch(start, end - start);
+}
+
 void DecoderBase::UpdateFramesPlayed(void)
 {
     m_parent->SetFramesPlayed(m_framesPlayed);
@@ -261,6 +261,7 @@ class DecoderBase
     void         FileChanged(void);
     virtual bool DoRewindSeek(long long desiredFrame);
     virtual void DoFastForwardSeek(long long desiredFrame, bool &needflush);
+    void         PrefetchNextSkip(void);
 
     long long ConditionallyUpdatePosMap(long long desiredFrame);
     long long GetLastFrameInPosMap(void) const;
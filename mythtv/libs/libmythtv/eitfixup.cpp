@@ -1,8 +1,12 @@
 // C++ headers
 #include <algorithm>
 #include <array>
+#include <atomic>
+#include <memory>
 
 // Qt Headers
+#include <QHash>
+#include <QMutex>
 #include <QRegularExpression>
 
 // MythTV headers
@@ -43,7 +47,125 @@ int EITFixUp::parseRoman (QString roman)
 }
 
 
+static QMutex s_fixedEventsLock;
+static QHash<QString,std::shared_ptr<DBEventEIT> > s_fixedEvents;
+static std::atomic<uint64_t> s_fixedEventsHits {0};
+
+/** \fn EITFixUp::Fix(DBEventEIT&)
+ *  \brief Applies the fixups selected in event.m_fixup to the event.
+ *
+ *  Broadcasters bump the version of a whole EIT section whenever one of
+ *  its events changes, so the same unchanged event is typically fixed up
+ *  many times. EITCache already drops exact (serviceid, eventid, version)
+ *  repeats; on top of that the outcome of the regular fixups is remembered
+ *  keyed on the complete input event and simply copied when it is seen
+ *  again. Set EITFIXUP_NO_CACHE in the environment to disable this.
+ */
 void EITFixUp::Fix(DBEventEIT &event)
+{
+    static const bool s_noCache = qEnvironmentVariableIsSet("EITFIXUP_NO_CACHE");
+
+    bool cacheable = !s_noCache && IsCacheable(event);
+    QString key;
+    std::shared_ptr<DBEventEIT> fixed;
+    if (cacheable)
+    {
+        key = CacheKey(event);
+        QMutexLocker locker(&s_fixedEventsLock);
+        fixed = s_fixedEvents.value(key);
+    }
+
+    if (fixed)
+    {
+        event = *fixed;
+        ++s_fixedEventsHits;
+    }
+    else
+    {
+        ApplyFixups(event);
+
+        if (cacheable)
+        {
+            fixed = std::make_shared<DBEventEIT>(
+                event.m_chanid, QString(), QString(), QDateTime(), QDateTime(),
+                event.m_fixup, 0, 0, 0);
+            *fixed = event;
+            QMutexLocker locker(&s_fixedEventsLock);
+            if (s_fixedEvents.size() >= kMaxCachedEvents)
+                s_fixedEvents.clear();
+            s_fixedEvents.insert(key, fixed);
+        }
+    }
+
+    // The default authority lives in the database and may change, so it
+    // is never taken from the cache.
+    if (kFixGenericDVB & event.m_fixup)
+    {
+        event.m_programId = AddDVBEITAuthority(event.m_chanid, event.m_programId);
+        event.m_seriesId  = AddDVBEITAuthority(event.m_chanid, event.m_seriesId);
+    }
+
+    // Are any items left unhandled? report them to allow fixups improvements
+    if (!event.m_items.empty())
+    {
+        for (auto i = event.m_items.begin(); i != event.m_items.end(); ++i)
+        {
+            LOG(VB_EIT, LOG_DEBUG, QString("Unhandled item in EIT for"
+                " channel id \"%1\", \"%2\": %3").arg(event.m_chanid)
+                .arg(i.key(), i.value()));
+        }
+    }
+}
+
+uint64_t EITFixUp::CacheHits(void)
+{
+    return s_fixedEventsHits;
+}
+
+/** \fn EITFixUp::IsCacheable(const DBEventEIT&)
+ *  \brief Returns true if the outcome of ApplyFixups() depends only on the
+ *         fields included in CacheKey().
+ *
+ *  Events coming from EITHelper never carry credits, ratings, genres and
+ *  the like before they are fixed up. Events that do, and events needing
+ *  no real fixups, are handled without the cache.
+ */
+bool EITFixUp::IsCacheable(const DBEventEIT &event)
+{
+    return ((event.m_fixup & ~kFixGenericDVB) != 0) &&
+        !event.HasCredits() && event.m_ratings.isEmpty() &&
+        event.m_genres.isEmpty() && event.m_airdate == 0 &&
+        !event.m_originalairdate.isValid() &&
+        event.m_partnumber == 0 && event.m_parttotal == 0 &&
+        event.m_syndicatedepisodenumber.isEmpty() &&
+        event.m_inetref.isEmpty() && !event.m_previouslyshown;
+}
+
+QString EITFixUp::CacheKey(const DBEventEIT &event)
+{
+    QStringList parts {
+        QString::number(event.m_chanid),
+        QString::number(event.m_fixup),
+        event.m_title, event.m_subtitle, event.m_description,
+        event.m_category, QString::number(event.m_categoryType),
+        QString::number(event.m_starttime.toSecsSinceEpoch()),
+        QString::number(event.m_endtime.toSecsSinceEpoch()),
+        QString::number(event.m_subtitleType),
+        QString::number(event.m_audioProps),
+        QString::number(event.m_videoProps),
+        QString::number(event.m_stars),
+        event.m_seriesId, event.m_programId,
+        QString::number(event.m_season),
+        QString::number(event.m_episode),
+        QString::number(event.m_totalepisodes) };
+
+    for (auto i = event.m_items.cbegin(); i != event.m_items.cend(); ++i)
+        parts << i.key() << i.value();
+
+    return parts.join(QChar(0x1F));
+}
+
+void EITFixUp::ApplyFixups(DBEventEIT &event)
 {
     if (event.m_fixup)
     {
@@ -142,46 +264,36 @@ void EITFixUp::Fix(DBEventEIT &event)
         FixUnitymedia(event);
 
     // Clean up text strings after all fixups have been applied.
+    // The literal checks avoid running the regex on strings that
+    // can't possibly match.
     if (event.m_fixup)
     {
         static const QRegularExpression emptyParens { R"(\(\s*\))" };
         if (!event.m_title.isEmpty())
         {
-            event.m_title.remove(QChar('\0')).remove(emptyParens);
+            event.m_title.remove(QChar('\0'));
+            if (event.m_title.contains('('))
+                event.m_title.remove(emptyParens);
             event.m_title = event.m_title.simplified();
         }
 
         if (!event.m_subtitle.isEmpty())
         {
             event.m_subtitle.remove(QChar('\0'));
-            event.m_subtitle.remove(emptyParens);
+            if (event.m_subtitle.contains('('))
+                event.m_subtitle.remove(emptyParens);
             event.m_subtitle = event.m_subtitle.simplified();
         }
 
         if (!event.m_description.isEmpty())
         {
             event.m_description.remove(QChar('\0'));
-            event.m_description.remove(emptyParens);
+            if (event.m_description.contains('('))
+                event.m_description.remove(emptyParens);
             event.m_description = event.m_description.simplified();
         }
     }
 
-    if (kFixGenericDVB & event.m_fixup)
-    {
-        event.m_programId = AddDVBEITAuthority(event.m_chanid, event.m_programId);
-        event.m_seriesId  = AddDVBEITAuthority(event.m_chanid, event.m_seriesId);
-    }
-
-    // Are any items left unhandled? report them to allow fixups improvements
-    if (!event.m_items.empty())
-    {
-        for (auto i = event.m_items.begin(); i != event.m_items.end(); ++i)
-        {
-            LOG(VB_EIT, LOG_DEBUG, QString("Unhandled item in EIT for"
-                " channel id \"%1\", \"%2\": %3").arg(event.m_chanid)
-                .arg(i.key(), i.value()));
-        }
-    }
 }
 
 /**
@@ -659,9 +771,12 @@ void EITFixUp::FixUK(DBEventEIT &event)
         QRegularExpression::CaseInsensitiveOption };
     static const QRegularExpression ukNewTitle { R"(^(Brand New|New:)\s*)",
         QRegularExpression::CaseInsensitiveOption };
-    event.m_description = event.m_description.remove(ukThen);
-    event.m_description = event.m_description.remove(ukNew);
-    event.m_title = event.m_title.remove(ukNewTitle);
+    if (event.m_description.contains("60 Seconds", Qt::CaseInsensitive))
+        event.m_description.remove(ukThen);
+    if (event.m_description.contains("New", Qt::CaseInsensitive))
+        event.m_description.remove(ukNew);
+    if (event.m_title.contains("New", Qt::CaseInsensitive))
+        event.m_title.remove(ukNewTitle);
 
     // Removal of Class TV, CBBC and CBeebies etc..
     static const QRegularExpression ukTitleRemove { "^(?:[tT]4:|Schools\\s*?:)" };
@@ -672,24 +787,30 @@ void EITFixUp::FixUK(DBEventEIT &event)
     // Removal of BBC FOUR and BBC THREE
     static const QRegularExpression ukBBC34 { R"(BBC (?:THREE|FOUR) on BBC (?:ONE|TWO)\.)",
         QRegularExpression::CaseInsensitiveOption };
-    event.m_description = event.m_description.remove(ukBBC34);
+    if (event.m_description.contains("BBC", Qt::CaseInsensitive))
+        event.m_description.remove(ukBBC34);
 
     // BBC 7 [Rpt of ...] case.
     static const QRegularExpression ukBBC7rpt { R"(\[Rptd?[^]]+?\d{1,2}\.\d{1,2}[ap]m\]\.)" };
-    event.m_description = event.m_description.remove(ukBBC7rpt);
+    if (event.m_description.contains("[Rpt"))
+        event.m_description.remove(ukBBC7rpt);
 
     // "All New To 4Music!
     static const QRegularExpression ukAllNew { R"(All New To 4Music!\s?)" };
-    event.m_description = event.m_description.remove(ukAllNew);
+    if (event.m_description.contains("4Music"))
+        event.m_description.remove(ukAllNew);
 
     // Removal of 'Also in HD' text
     static const QRegularExpression ukAlsoInHD { R"(\s*Also in HD\.)",
         QRegularExpression::CaseInsensitiveOption };
-    event.m_description = event.m_description.remove(ukAlsoInHD);
+    if (event.m_description.contains("Also in HD", Qt::CaseInsensitive))
+        event.m_description.remove(ukAlsoInHD);
 
     // Remove [AD,S] etc.
     static const QRegularExpression ukCC { R"(\[(?:(AD|SL|S|W|HD),?)+\])" };
-    auto match = ukCC.match(event.m_description);
+    QRegularExpressionMatch match;
+    if (event.m_description.contains('['))
+        match = ukCC.match(event.m_description);
     while (match.hasMatch())
     {
         QStringList tmpCCitems = match.captured(0).remove("[").remove("]").split(",");
@@ -1623,7 +1744,10 @@ void EITFixUp::FixRTL(DBEventEIT &event)
     // Repeat
     static const QRegularExpression rtlRepeat
         { R"([\s\(]?Wiederholung.+vo[m|n].+(\d{2}\.\d{2}\.\d{4}|\d{2}[:\.]\d{2}\sUhr)\)?)" };
-    match = rtlRepeat.match(event.m_description);
+    if (event.m_description.contains("Wiederholung"))
+        match = rtlRepeat.match(event.m_description);
+    else
+        match = QRegularExpressionMatch();
     if (match.hasMatch())
     {
         // remove '.' if it matches at the beginning of the description
@@ -1641,16 +1765,10 @@ void EITFixUp::FixRTL(DBEventEIT &event)
     static const QRegularExpression rtlEpisodeNo1 { R"(^(Folge\s\d{1,4})\.*\s*)" };
     static const QRegularExpression rtlEpisodeNo2 { R"(^(\d{1,2}\/[IVX]+)\.*\s*)" };
 
-    auto match1 = rtlSubtitle1.match(event.m_description);
-    auto match2 = rtlSubtitle2.match(event.m_description);
-    auto match3 = rtlSubtitle3.match(event.m_description);
-    auto match4 = rtlSubtitle4.match(event.m_description);
-    auto match5 = rtlSubtitle5.match(event.m_description);
-    auto match6 = rtlEpisodeNo1.match(event.m_description);
-    auto match7 = rtlEpisodeNo2.match(event.m_description);
-
+    // The patterns are only tried until the first one matches.
     // subtitle with episode number: "Folge *: 'subtitle'. description
-    if (match1.hasMatch())
+    if (auto match1 = rtlSubtitle1.match(event.m_description);
+        match1.hasMatch())
     {
         event.m_syndicatedepisodenumber = match1.captured(1);
         event.m_subtitle = match1.captured(2);
@@ -1658,7 +1776,8 @@ void EITFixUp::FixRTL(DBEventEIT &event)
             event.m_description.remove(0, match1.capturedLength());
     }
     // episode number subtitle
-    else if (match2.hasMatch())
+    else if (auto match2 = rtlSubtitle2.match(event.m_description);
+             match2.hasMatch())
     {
         event.m_syndicatedepisodenumber = match2.captured(1);
         event.m_subtitle = match2.captured(2);
@@ -1666,7 +1785,8 @@ void EITFixUp::FixRTL(DBEventEIT &event)
             event.m_description.remove(0, match2.capturedLength());
     }
     // episode number subtitle
-    else if (match3.hasMatch())
+    else if (auto match3 = rtlSubtitle3.match(event.m_description);
+             match3.hasMatch())
     {
         event.m_syndicatedepisodenumber = match3.captured(1);
         event.m_subtitle = match3.captured(2);
@@ -1674,21 +1794,24 @@ void EITFixUp::FixRTL(DBEventEIT &event)
             event.m_description.remove(0, match3.capturedLength());
     }
     // "Thema..."
-    else if (match4.hasMatch())
+    else if (auto match4 = rtlSubtitle4.match(event.m_description);
+             match4.hasMatch())
     {
         event.m_subtitle = match4.captured(1);
         event.m_description =
             event.m_description.remove(0, match4.capturedLength());
     }
     // "'...'"
-    else if (match5.hasMatch())
+    else if (auto match5 = rtlSubtitle5.match(event.m_description);
+             match5.hasMatch())
     {
         event.m_subtitle = match5.captured(1);
         event.m_description =
             event.m_description.remove(0, match5.capturedLength());
     }
     // episode number
-    else if (match6.hasMatch())
+    else if (auto match6 = rtlEpisodeNo1.match(event.m_description);
+             match6.hasMatch())
     {
         event.m_syndicatedepisodenumber = match6.captured(2);
         event.m_subtitle = match6.captured(1);
@@ -1696,7 +1819,8 @@ void EITFixUp::FixRTL(DBEventEIT &event)
             event.m_description.remove(0, match6.capturedLength());
     }
     // episode number
-    else if (match7.hasMatch())
+    else if (auto match7 = rtlEpisodeNo2.match(event.m_description);
+             match7.hasMatch())
     {
         event.m_syndicatedepisodenumber = match7.captured(2);
         event.m_subtitle = match7.captured(1);
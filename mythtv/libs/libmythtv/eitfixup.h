@@ -23,6 +23,8 @@ class MTV_PUBLIC EITFixUp
     static const uint kMaxDotToColon = 5;
     // minimum duration of an event to consider it as movie
     static const int kMinMovieDuration = 75*60;
+    // max number of fixed up events remembered by Fix()
+    static const int kMaxCachedEvents = 2000;
 
   public:
     enum FixUpType : FixupValue
@@ -73,6 +75,8 @@ class MTV_PUBLIC EITFixUp
     EITFixUp() = default;
 
     static void Fix(DBEventEIT &event);
+    /// Number of events Fix() took from its cache of fixed events
+    static uint64_t CacheHits(void);
 
     static int parseRoman (QString roman);
 
@@ -90,6 +94,9 @@ class MTV_PUBLIC EITFixUp
     }
 
   private:
+    static void ApplyFixups(DBEventEIT &event);
+    static bool IsCacheable(const DBEventEIT &event);
+    static QString CacheKey(const DBEventEIT &event);
     static void FixBellExpressVu(DBEventEIT &event);// Canada DVB-S
     static void SetUKSubtitle(DBEventEIT &event);
     static void FixUK(DBEventEIT &event);           // UK DVB-T
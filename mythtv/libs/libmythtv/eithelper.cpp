@@ -23,6 +23,7 @@
 #include "scheduledrecording.h"  // for ScheduledRecording
 
 const uint EITHelper::kMaxQueueSize   = 10000;
+const int  EITHelper::kMaxRescheduleChanids = 100;
 
 EITCache *EITHelper::s_eitCache = new EITCache();
 
@@ -102,8 +103,15 @@ uint EITHelper::ProcessEvents(void)
 
         EITFixUp::Fix(*event);
 
-        insertCount += event->UpdateDB(query, 1000);
+        uint inserted = event->UpdateDB(query, 1000);
+        insertCount += inserted;
         m_maxStarttime = std::max (m_maxStarttime, event->m_starttime);
+        if (inserted)
+        {
+            if (!m_minStarttime.isValid() || event->m_starttime < m_minStarttime)
+                m_minStarttime = event->m_starttime;
+            m_changedChanids.insert(event->m_chanid);
+        }
 
         delete event;
         m_eitListLock.lock();
@@ -1364,9 +1372,33 @@ static void init_fixup(FixupMap &fix)
  */
 void EITHelper::RescheduleRecordings(void)
 {
-    ScheduledRecording::RescheduleMatch(
-        0, m_sourceid, m_seenEITother ? 0 : ChannelUtil::GetMplexID(m_channelid),
-        m_maxStarttime, "EITScanner");
+    // Nothing to match if no program was inserted or updated
+    if (m_changedChanids.isEmpty())
+    {
+        LOG(VB_EIT, LOG_DEBUG, LOC_ID + "No changed events, skipping reschedule");
+        m_seenEITother = false;
+        m_maxStarttime = QDateTime();
+        return;
+    }
+
+    uint mplexid = m_seenEITother ? 0 : ChannelUtil::GetMplexID(m_channelid);
+
+    // Only rematch the programs that changed when that is a short list,
+    // re-evaluating whole multiplexes keeps the database busy.
+    if (m_changedChanids.size() <= kMaxRescheduleChanids)
+    {
+        QList<uint> chanids(m_changedChanids.cbegin(), m_changedChanids.cend());
+        ScheduledRecording::RescheduleMatch(
+            m_sourceid, mplexid, chanids, m_minStarttime, m_maxStarttime,
+            "EITScanner");
+    }
+    else
+    {
+        ScheduledRecording::RescheduleMatch(
+            0, m_sourceid, mplexid, m_maxStarttime, "EITScanner");
+    }
     m_seenEITother = false;
     m_maxStarttime = QDateTime();
+    m_minStarttime = QDateTime();
+    m_changedChanids.clear();
 }
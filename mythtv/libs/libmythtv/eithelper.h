@@ -12,6 +12,7 @@
 #include <QMap>
 #include <QMutex>
 #include <QObject>
+#include <QSet>
 #include <QString>
 
 // MythTV includes
@@ -150,6 +151,8 @@ class EITHelper
     uint                    m_sourceid     {0};       // Video source ID
     uint                    m_channelid    {0};       // Channel ID
     QDateTime               m_maxStarttime;           // Latest starttime of changed events
+    QDateTime               m_minStarttime;           // Earliest starttime of changed events
+    QSet<uint>              m_changedChanids;         // Channels with changed events
     bool                    m_seenEITother {false};   // If false we only reschedule the active mplex
     uint                    m_chunkSize    {20};      // Maximum number of DB inserts per ProcessEvents call
     uint                    m_queueSize    {1000};    // Maximum number of events waiting to be processed
@@ -162,6 +165,7 @@ class EITHelper
     QMap<uint,uint>         m_languagePreferences;
 
     static const uint       kMaxQueueSize;            // Maximum queue size for events waiting to be processed
+    static const int        kMaxRescheduleChanids;    // Maximum number of channels in a reschedule request
 };
 
 #endif // EIT_HELPER_H
@@ -830,3 +830,14 @@ long long MythFileBuffer::SeekInternal(long long Position, int Whence)
     m_generalWait.wakeAll();
     return ret;
 }
+
+/// Asks the kernel to start reading the given range of a local file.
+void MythFileBuffer::PrefetchHint(long long Position, long long Length)
+{
+    if (m_remotefile || m_fd2 < 0)
+        return;
+#ifndef _MSC_VER
+    if (posix_fadvise(m_fd2, Position, Length, POSIX_FADV_WILLNEED) != 0)
+        LOG(VB_FILE, LOG_DEBUG, LOC + QString("PrefetchHint(): fadvise willneed failed: ") + ENO);
+#endif
+}
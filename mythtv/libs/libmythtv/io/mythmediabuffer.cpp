@@ -376,6 +376,9 @@ void MythMediaBuffer::CalcReadAheadThresh(void)
 
     estbitrate     = static_cast<uint>(std::max(abs(m_rawBitrate * m_playSpeed), 0.5F * m_rawBitrate));
     estbitrate     = std::min(m_rawBitrate * 3, estbitrate);
+    // the raw bitrate is only a guess, prefer what is actually consumed
+    estbitrate     = std::max(estbitrate, m_consumeBitrate.load());
+    m_estBitrate   = estbitrate;
     int const rbs = estbitrate_to_rbs(estbitrate);
 
     if (rbs < DEFAULT_CHUNK_SIZE)
@@ -652,6 +655,9 @@ void MythMediaBuffer::Start(void)
  */
 void MythMediaBuffer::KillReadAheadThread(void)
 {
+    if (isRunning())
+        LOG(VB_FILE, LOG_INFO, LOC + "Read ahead stats: " + GetReadAheadStats());
+
     while (isRunning())
     {
         m_rwLock.lockForWrite();
@@ -833,6 +839,14 @@ void MythMediaBuffer::run(void)
 
     auto lastread = nowAsDuration<std::chrono::milliseconds>();
 
+    // These variables are used to measure the consumption rate
+    auto     lastrate     = lastread;
+    uint64_t lastconsumed = m_bytesConsumed;
+
+    // The range the OS was last asked to read ahead of us
+    long long hintstart = -1;
+    long long hintend   = -1;
+
     CreateReadAheadBuffer();
     m_rwLock.lockForWrite();
     m_posLock.lockForWrite();
@@ -1002,6 +1016,21 @@ void MythMediaBuffer::run(void)
 
                 LOG(VB_FILE, LOG_DEBUG, LOC + QString("total read so far: %1 bytes")
                     .arg(m_internalReadPos));
+
+                // Keep the OS reading ahead of us, further ahead when
+                // fast forwarding. Only renew the hint once we are half way
+                // through the last one, or after a seek.
+                if (m_internalReadPos < hintstart ||
+                    m_internalReadPos > (hintstart + hintend) / 2)
+                {
+                    static constexpr long long kMaxHint { 32LL * 1024 * 1024 };
+                    auto window = static_cast<long long>(m_fillThreshold *
+                                                         std::max(1.0F, m_playSpeed));
+                    window = std::clamp(window, static_cast<long long>(DEFAULT_CHUNK_SIZE), kMaxHint);
+                    PrefetchHint(m_internalReadPos, window);
+                    hintstart = m_internalReadPos;
+                    hintend   = m_internalReadPos + window;
+                }
             }
         }
         else
@@ -1011,6 +1040,38 @@ void MythMediaBuffer::run(void)
                 .arg(totfree).arg(m_commsError).arg(m_ateof).arg(m_setSwitchToNext));
         }
 
+        // Measure how fast the reader actually consumes data and raise the
+        // thresholds if the bitrate estimate was too low. Fast forward and
+        // rewind read in bursts, they would only inflate the measurement.
+        auto ratenow = nowAsDuration<std::chrono::milliseconds>();
+        if ((m_playSpeed > 1.0F) || (m_playSpeed < 0.0F))
+        {
+            lastrate = ratenow;
+            lastconsumed = m_bytesConsumed;
+        }
+        else if (ratenow - lastrate >= 1s)
+        {
+            uint64_t consumed = m_bytesConsumed;
+            auto kbps = static_cast<uint>(std::min<uint64_t>(
+                ((consumed - lastconsumed) * 8) / static_cast<uint64_t>((ratenow - lastrate).count()),
+                100000));
+            uint rate = (m_consumeBitrate * 3 + kbps) / 4;
+            m_consumeBitrate = rate;
+            lastrate = ratenow;
+            lastconsumed = consumed;
+
+            if (!m_paused && rate > m_estBitrate + (m_estBitrate / 4))
+            {
+                LOG(VB_FILE, LOG_INFO, LOC + QString("Consuming %1Kb, estimate was %2Kb")
+                    .arg(rate).arg(m_estBitrate));
+                m_rwLock.unlock();
+                m_rwLock.lockForWrite();
+                CalcReadAheadThresh();
+                m_rwLock.unlock();
+                m_rwLock.lockForRead();
+            }
+        }
+
         int used = static_cast<int>(m_bufferSize) - ReadBufFree();
         bool readsWereAllowed = m_readsAllowed;
 
@@ -1368,6 +1429,8 @@ int MythMediaBuffer::ReadPriv(void *Buffer, int Count, bool Peek)
         m_rwLock.lockForRead();
     }
 
+    bool afterseek = m_recentSeek;
+    MythTimer waittimer(MythTimer::kStartRunning);
     if (!WaitForReadsAllowed())
     {
         LOG(VB_FILE, LOG_NOTICE, LOC + desc + ": !WaitForReadsAllowed()");
@@ -1379,7 +1442,11 @@ int MythMediaBuffer::ReadPriv(void *Buffer, int Count, bool Peek)
         return 0;
     }
 
+    if (afterseek)
+        m_seekWaits.Add(waittimer.elapsed());
+
     int available = ReadBufAvail();
+    bool underrun = !afterseek && !m_readInternalMode && !m_ateof && (available < Count);
     MythTimer timer(MythTimer::kStartRunning);
 
     // Wait up to 10000 ms for any data
@@ -1397,6 +1464,8 @@ int MythMediaBuffer::ReadPriv(void *Buffer, int Count, bool Peek)
         if (available > 0)
             break;
     }
+    if (underrun)
+        m_underrunWaits.Add(timer.elapsed());
     if (timer.elapsed() > 6s)
     {
         LOG(VB_GENERAL, LOG_WARNING, LOC + desc + QString(" -- waited %1 ms for avail(%2) > count(%3)")
@@ -1476,6 +1545,7 @@ int MythMediaBuffer::ReadPriv(void *Buffer, int Count, bool Peek)
         else
         {
             m_rbrPos = (m_rbrPos + Count) % static_cast<int>(m_bufferSize);
+            m_bytesConsumed += static_cast<uint64_t>(Count);
             m_generalWait.wakeAll();
         }
     }
@@ -1560,11 +1630,52 @@ QString MythMediaBuffer::GetAvailableBuffer(void)
     return QString("%1%").arg(lroundf((static_cast<float>(avail) / static_cast<float>(m_bufferSize) * 100.0F)));
 }
 
+/** \brief Describes how often, and for how long, readers had to wait for data.
+ *
+ *  Waits for the buffer to refill after a seek are counted separately from
+ *  underruns during normal playback.
+ */
+QString MythMediaBuffer::GetReadAheadStats(void) const
+{
+    return QString("underruns %1, seeks %2, consuming %3Kb")
+        .arg(m_underrunWaits.ToString(), m_seekWaits.ToString())
+        .arg(m_consumeBitrate.load());
+}
+
+void MythMediaBuffer::WaitStats::Add(std::chrono::milliseconds Wait)
+{
+    int64_t wait = Wait.count();
+    m_count++;
+    m_totalMs += wait;
+    int64_t max = m_maxMs;
+    while (wait > max && !m_maxMs.compare_exchange_weak(max, wait)) {}
+}
+
+QString MythMediaBuffer::WaitStats::ToString(void) const
+{
+    uint count = m_count;
+    return QString("%1 (avg %2 ms max %3 ms)").arg(count)
+        .arg(count ? m_totalMs / count : 0).arg(m_maxMs.load());
+}
+
 uint MythMediaBuffer::GetBufferSize(void) const
 {
     return m_bufferSize;
 }
 
+/** \brief Tells the storage layer that data will be read from here soon.
+ *
+ *  Used by the decoders to warm up the next key frame while fast forwarding
+ *  or rewinding. This is only a hint, it is ignored where unsupported.
+ */
+void MythMediaBuffer::Prefetch(long long Position, long long Length)
+{
+    if (Position < 0 || Length <= 0)
+        return;
+    QReadLocker locker(&m_rwLock);
+    PrefetchHint(Position, Length);
+}
+
 uint64_t MythMediaBuffer::UpdateDecoderRate(uint64_t Latest)
 {
     if (!m_bitrateMonitorEnabled)
@@ -1,6 +1,9 @@
 #ifndef MYTHMEDIABUFFER_H
 #define MYTHMEDIABUFFER_H
 
+// C++
+#include <atomic>
+
 // Qt
 #include <QReadWriteLock>
 #include <QWaitCondition>
@@ -89,6 +92,7 @@ class MTV_PUBLIC MythMediaBuffer : protected MThread
     QString   GetDecoderRate       (void);
     QString   GetStorageRate       (void);
     QString   GetAvailableBuffer   (void);
+    QString   GetReadAheadStats    (void) const;
     uint      GetBufferSize        (void) const;
     bool      IsNearEnd            (double Framerate, uint Frames) const;
     long long GetWritePosition     (void) const;
@@ -112,6 +116,7 @@ class MTV_PUBLIC MythMediaBuffer : protected MThread
     void      StartReads           (void);
     long long Seek                 (long long Position, int Whence, bool HasLock = false);
     long long SetAdjustFilesize    (void);
+    void      Prefetch             (long long Position, long long Length);
 
     // LiveTV used utilities
     int       GetReadBufAvail      (void) const;
@@ -165,6 +170,7 @@ class MTV_PUBLIC MythMediaBuffer : protected MThread
     virtual int       SafeRead     (void *Buffer, uint Size) = 0;
     virtual long long GetRealFileSizeInternal(void) const { return -1; }
     virtual long long SeekInternal (long long Position, int Whence) = 0;
+    virtual void      PrefetchHint (long long /*Position*/, long long /*Length*/) { }
 
 
   protected:
@@ -230,6 +236,24 @@ class MTV_PUBLIC MythMediaBuffer : protected MThread
     bool                   m_readInternalMode { false };
     // End of section protected by rwLock
 
+    /// Accumulated time readers spent waiting for the read ahead thread
+    class WaitStats
+    {
+      public:
+        void Add(std::chrono::milliseconds Wait);
+        QString ToString(void) const;
+      private:
+        std::atomic<uint>    m_count   { 0 };
+        std::atomic<int64_t> m_totalMs { 0 };
+        std::atomic<int64_t> m_maxMs   { 0 };
+    };
+
+    WaitStats              m_underrunWaits;   ///< buffer ran dry while playing
+    WaitStats              m_seekWaits;       ///< refill after a seek or open
+    std::atomic<uint64_t>  m_bytesConsumed    { 0 };
+    std::atomic<uint>      m_consumeBitrate   { 0 }; ///< measured, in Kb
+    uint                   m_estBitrate       { 0 }; ///< last CalcReadAheadThresh() estimate
+
     bool                   m_bitrateMonitorEnabled { false };
     QMutex                 m_decoderReadLock;
     QMap<std::chrono::milliseconds, uint64_t> m_decoderReads;
@@ -0,0 +1,124 @@
+#include <algorithm>
+#include <utility>
+
+#include "jobbudget.h"
+#include "jobqueue.h"
+
+JobCost JobBudget::EstimateJobCost(int jobType, std::chrono::seconds duration,
+                                   uint width, uint height, uint64_t filesize)
+{
+    // Decoding cost grows with the picture size, 720p counts as one
+    static constexpr double kRefPixels { 1280.0 * 720.0 };
+    double pixels = static_cast<double>(width) * height;
+    double scale = (pixels > 0) ? std::clamp(pixels / kRefPixels, 0.5, 4.0) : 1.0;
+
+    // Bytes per second of the recording, about 8Mb/s for 720p if unknown
+    double recMBps = scale;
+    if (filesize > 0 && duration > 0s)
+        recMBps = (filesize / 1000000.0) / duration.count();
+
+    // How many times faster than real time the job reads the recording
+    // and how many bytes it moves per byte read.
+    double cpu = 1.0;
+    double speed = 1.0;
+    double io = 1.0;
+    switch (jobType)
+    {
+        case JOB_TRANSCODE:
+            cpu = scale;
+            speed = 2.0;
+            io = 2.0;
+            break;
+        case JOB_COMMFLAG:
+            cpu = 0.5 * scale;
+            speed = 4.0;
+            break;
+        case JOB_METADATA:
+            cpu = 0.1;
+            io = 0.0;
+            break;
+        case JOB_PREVIEW:
+            cpu = 0.2;
+            io = 0.0;
+            break;
+        default:
+            // User jobs, assume the worst
+            break;
+    }
+
+    JobCost cost;
+    cost.m_cpu = cpu;
+    cost.m_diskMBps = recMBps * speed * io;
+    return cost;
+}
+
+/// Sets the CPU cores and the disk bandwidth (0 for unlimited) of the host.
+void JobBudget::SetCapacity(double cpu, double diskMBps)
+{
+    m_cpu = cpu;
+    m_diskMBps = diskMBps;
+}
+
+/// Sets the number of recordings in progress and the bandwidth they write.
+void JobBudget::SetRecordingLoad(int recordings, double diskMBps)
+{
+    m_recordings = recordings;
+    m_recDiskMBps = diskMBps;
+}
+
+/// Resources left for new jobs, may be negative.
+JobCost JobBudget::Available(void) const
+{
+    JobCost used;
+    for (const auto & cost : std::as_const(m_jobs))
+        used += cost;
+
+    JobCost avail;
+    avail.m_cpu = m_cpu - kBackendCPU - (m_recordings * kRecordingCPU) -
+        used.m_cpu;
+    avail.m_diskMBps = m_diskMBps - m_recDiskMBps - used.m_diskMBps;
+    return avail;
+}
+
+/** \brief Returns true if a job with the given cost may be started now.
+ *  \param reason set to a description of the missing resource
+ */
+bool JobBudget::CanStart(const JobCost &cost, QString *reason) const
+{
+    if (m_jobs.isEmpty())
+        return true;
+
+    JobCost avail = Available();
+    if (cost.m_cpu > avail.m_cpu)
+    {
+        if (reason)
+        {
+            *reason = QString("needs %1 CPU cores, %2 available")
+                .arg(cost.m_cpu, 0, 'f', 2).arg(std::max(avail.m_cpu, 0.0), 0, 'f', 2);
+        }
+        return false;
+    }
+    if (m_diskMBps > 0 && cost.m_diskMBps > avail.m_diskMBps)
+    {
+        if (reason)
+        {
+            *reason = QString("needs %1 MB/s disk bandwidth, %2 MB/s available")
+                .arg(cost.m_diskMBps, 0, 'f', 1)
+                .arg(std::max(avail.m_diskMBps, 0.0), 0, 'f', 1);
+        }
+        return false;
+    }
+    return true;
+}
+
+QString JobBudget::toString(void) const
+{
+    JobCost avail = Available();
+    QString disk = (m_diskMBps > 0)
+        ? QString("%1 of %2 MB/s").arg(avail.m_diskMBps, 0, 'f', 1)
+                                  .arg(m_diskMBps, 0, 'f', 1)
+        : QString("unlimited");
+    return QString("%1 job(s), %2 recording(s), CPU %3 of %4 cores, disk %5 free")
+        .arg(m_jobs.size()).arg(m_recordings)
+        .arg(avail.m_cpu, 0, 'f', 2).arg(m_cpu, 0, 'f', 2).arg(disk);
+}
@@ -0,0 +1,79 @@
+#ifndef JOBBUDGET_H_
+#define JOBBUDGET_H_
+
+#include <cstdint>
+
+#include <QMap>
+#include <QString>
+
+#include "mythtvexp.h"
+#include "libmythbase/mythchrono.h"
+
+/// Estimated resources a job or a recording keeps busy while it runs
+struct JobCost
+{
+    double m_cpu      {0.0}; ///< CPU cores
+    double m_diskMBps {0.0}; ///< disk bandwidth in MB/s
+
+    JobCost &operator+=(const JobCost &other)
+    {
+        m_cpu += other.m_cpu;
+        m_diskMBps += other.m_diskMBps;
+        return *this;
+    }
+};
+
+/** \class JobBudget
+ *  \brief Decides whether the JobQueue may start another job.
+ *
+ *  The CPU cores and the disk bandwidth of the host are shared between
+ *  the recordings in progress and the jobs. Recordings always come
+ *  first, what they use is reserved before anything is handed out to
+ *  jobs. A job is only started if its estimated cost fits into what is
+ *  left, but a single job is always allowed so the queue cannot stall
+ *  on a job that is more expensive than the whole budget.
+ *
+ *  While recordings are in progress jobs are started with the lowest
+ *  CPU and I/O priority regardless of the JobQueueCPU setting.
+ */
+class MTV_PUBLIC JobBudget
+{
+  public:
+    /// CPU kept free for the backend itself
+    static constexpr double kBackendCPU     { 0.5 };
+    /// CPU used by each recording in progress
+    static constexpr double kRecordingCPU   { 0.25 };
+
+    /** \brief Estimates the cost of a job from the recording it works on.
+     *
+     *  \param jobType  one of the JobTypes
+     *  \param duration length of the recording, 0s if unknown
+     *  \param width    video width, 0 if unknown
+     *  \param height   video height, 0 if unknown
+     *  \param filesize size of the recording in bytes, 0 if unknown
+     */
+    static JobCost EstimateJobCost(int jobType, std::chrono::seconds duration,
+                                   uint width, uint height, uint64_t filesize);
+
+    void SetCapacity(double cpu, double diskMBps);
+    void SetRecordingLoad(int recordings, double diskMBps);
+
+    void AddJob(int jobID, const JobCost &cost) { m_jobs[jobID] = cost; }
+    void RemoveJob(int jobID) { m_jobs.remove(jobID); }
+    bool HasJob(int jobID) const { return m_jobs.contains(jobID); }
+
+    bool CanStart(const JobCost &cost, QString *reason = nullptr) const;
+    bool ProtectRecordings(void) const { return m_recordings > 0; }
+
+    JobCost Available(void) const;
+    QString toString(void) const;
+
+  private:
+    double              m_cpu         {1.0};
+    double              m_diskMBps    {0.0}; ///< 0 means unlimited
+    int                 m_recordings  {0};
+    double              m_recDiskMBps {0.0};
+    QMap<int, JobCost>  m_jobs;
+};
+
+#endif
@@ -11,6 +11,7 @@
 #include <QFileInfo>
 #include <QEvent>
 #include <QCoreApplication>
+#include <QThread>
 #include <QTimeZone>
 
 #include "libmythbase/compat.h"
@@ -198,6 +199,8 @@ void JobQueue::ProcessQueue(void)
 
         if (!jobs.empty())
         {
+            UpdateBudget();
+
             bool inTimeWindow = InJobRunWindow();
             for (const auto & job : std::as_const(jobs))
             {
@@ -418,6 +421,26 @@ void JobQueue::ProcessQueue(void)
                 if (startedJobAlready)
                     continue;
 
+                // Leave enough CPU and disk bandwidth for the recordings
+                JobCost cost;
+                if (inTimeWindow)
+                {
+                    QString reason;
+                    cost = EstimateJobCost(jobs[x]);
+                    m_runningJobsLock->lock();
+                    bool canStart = m_budget.CanStart(cost, &reason);
+                    m_runningJobsLock->unlock();
+
+                    if (!canStart)
+                    {
+                        message = QString("Deferring '%1' job for %2, it %3")
+                                          .arg(JobText(jobs[x].type), logInfo,
+                                               reason);
+                        LOG(VB_JOBQUEUE, LOG_INFO, LOC + message);
+                        continue;
+                    }
+                }
+
                 if ((inTimeWindow) &&
                     (hostname.isEmpty()) &&
                     (!ChangeJobHost(jobID, m_hostname)))
@@ -444,7 +467,7 @@ void JobQueue::ProcessQueue(void)
                                        StatusText(status));
                 LOG(VB_JOBQUEUE, LOG_INFO, LOC + message);
 
-                ProcessJob(jobs[x]);
+                ProcessJob(jobs[x], cost);
 
                 startedJobAlready = true;
             }
@@ -1430,6 +1453,95 @@ bool JobQueue::ChangeJobHost(int jobID, const QString& newHostname)
     return query.numRowsAffected() > 0;
 }
 
+/** \brief Updates the resources available to jobs on this host.
+ *
+ *  The disk bandwidth used by the recordings in progress on this host is
+ *  estimated from their current size and age.
+ */
+void JobQueue::UpdateBudget(void)
+{
+    double diskMBps = gCoreContext->GetNumSetting("JobQueueDiskBandwidth", 0);
+    int recordings = 0;
+    double recDiskMBps = 0.0;
+
+    MSqlQuery query(MSqlQuery::InitCon());
+    query.prepare("SELECT DISTINCT r.recordedid, r.filesize, "
+                  "       TIMESTAMPDIFF(SECOND, r.starttime, UTC_TIMESTAMP()) "
+                  "FROM inuseprograms i, recorded r "
+                  "WHERE i.chanid = r.chanid AND i.starttime = r.starttime "
+                  "  AND i.recusage = :RECUSAGE AND i.hostname = :HOSTNAME "
+                  "  AND i.lastupdatetime > :ONEHOURAGO;");
+    query.bindValue(":RECUSAGE", kRecorderInUseID);
+    query.bindValue(":HOSTNAME", m_hostname);
+    query.bindValue(":ONEHOURAGO", MythDate::current().addSecs(-3600));
+
+    if (!query.exec())
+    {
+        MythDB::DBError("JobQueue::UpdateBudget()", query);
+    }
+    else
+    {
+        while (query.next())
+        {
+            recordings++;
+            auto filesize = query.value(1).toULongLong();
+            auto seconds  = query.value(2).toLongLong();
+            if (seconds > 0)
+                recDiskMBps += (filesize / 1000000.0) / seconds;
+        }
+    }
+
+    QMutexLocker locker(m_runningJobsLock);
+    m_budget.SetCapacity(QThread::idealThreadCount(), diskMBps);
+    m_budget.SetRecordingLoad(recordings, recDiskMBps);
+
+    LOG(VB_JOBQUEUE, LOG_INFO, LOC + "Resources: " + m_budget.toString());
+}
+
+/** \brief Estimates the resources a job needs from the recording it is for.
+ */
+JobCost JobQueue::EstimateJobCost(const JobQueueEntry& job)
+{
+    std::chrono::seconds duration = 0s;
+    uint width = 0;
+    uint height = 0;
+    uint64_t filesize = 0;
+
+    if (job.chanid)
+    {
+        MSqlQuery query(MSqlQuery::InitCon());
+        query.prepare("SELECT TIMESTAMPDIFF(SECOND, r.starttime, r.endtime), "
+                      "       r.filesize, f.width, f.height "
+                      "FROM recorded r "
+                      "LEFT JOIN recordedfile f ON r.recordedid = f.recordedid "
+                      "WHERE r.chanid = :CHANID AND r.starttime = :STARTTIME;");
+        query.bindValue(":CHANID", job.chanid);
+        query.bindValue(":STARTTIME", job.recstartts);
+
+        if (!query.exec())
+        {
+            MythDB::DBError("JobQueue::EstimateJobCost()", query);
+        }
+        else if (query.next())
+        {
+            duration = std::chrono::seconds(query.value(0).toLongLong());
+            filesize = query.value(1).toULongLong();
+            width    = query.value(2).toUInt();
+            height   = query.value(3).toUInt();
+        }
+    }
+
+    return JobBudget::EstimateJobCost(job.type, duration, width, height,
+                                      filesize);
+}
+
+/// Returns the JobQueueCPU setting, or "Low" while recordings are in progress.
+int JobQueue::GetJobCPUSetting(void)
+{
+    QMutexLocker locker(m_runningJobsLock);
+    return m_budget.ProtectRecordings() ? 0 : m_jobQueueCPU;
+}
+
 bool JobQueue::AllowedToRun(const JobQueueEntry& job)
 {
     QString allowSetting;
@@ -1687,7 +1799,7 @@ bool JobQueue::InJobRunWindow(QDateTime jobstarttsRaw)
     return true;
 }
 
-void JobQueue::ProcessJob(const JobQueueEntry& job)
+void JobQueue::ProcessJob(const JobQueueEntry& job, const JobCost& cost)
 {
     int jobID = job.id;
 
@@ -1736,6 +1848,7 @@ void JobQueue::ProcessJob(const JobQueueEntry& job)
     jInfo.pginfo  = pginfo;
 
     m_runningJobs[jobID] = jInfo;
+    m_budget.AddJob(jobID, cost);
 
     if (pginfo)
         pginfo->MarkAsInUse(true, kJobQueueInUseID);
@@ -1869,6 +1982,7 @@ void JobQueue::RemoveRunningJob(int id)
 
         m_runningJobs.remove(id);
     }
+    m_budget.RemoveJob(id);
 
     m_runningJobsLock->unlock();
 }
@@ -1974,10 +2088,11 @@ void JobQueue::DoTranscodeThread(int jobID)
     }
     m_runningJobsLock->unlock();
 
-    if (m_jobQueueCPU < 2)
+    int jobQueueCPU = GetJobCPUSetting();
+    if (jobQueueCPU < 2)
     {
         myth_nice(17);
-        myth_ioprio((0 == m_jobQueueCPU) ? 8 : 7);
+        myth_ioprio((0 == jobQueueCPU) ? 8 : 7);
     }
 
     QString transcoderName;
@@ -2310,13 +2425,16 @@ void JobQueue::DoFlagCommercialsThread(int jobID)
     uint breaksFound = 0;
     QString path;
     QString command;
+    int jobQueueCPU = GetJobCPUSetting();
 
     m_runningJobsLock->lock();
     if (m_runningJobs[jobID].command == "mythcommflag")
     {
+        // mythcommflag sets its own priority from JobQueueCPU, make it
+        // use the effective setting rather than the database value.
         path = GetAppBinDir() + "mythcommflag";
-        command = QString("%1 -j %2 --noprogress")
-                          .arg(path).arg(jobID);
+        command = QString("%1 -j %2 --noprogress -O JobQueueCPU=%3")
+                          .arg(path).arg(jobID).arg(jobQueueCPU);
         command += logPropagateArgs;
     }
     else
@@ -2325,6 +2443,12 @@ void JobQueue::DoFlagCommercialsThread(int jobID)
         QStringList tokens = command.split(" ", Qt::SkipEmptyParts);
         if (!tokens.empty())
             path = tokens[0];
+
+        if (jobQueueCPU < 2)
+        {
+            myth_nice(17);
+            myth_ioprio((0 == jobQueueCPU) ? 8 : 7);
+        }
     }
     m_runningJobsLock->unlock();
 
@@ -2434,7 +2558,7 @@ void JobQueue::DoUserJobThread(int jobID)
 
     LOG(VB_GENERAL, LOG_INFO, LOC + QString(msg.toLocal8Bit().constData()));
 
-    switch (m_jobQueueCPU)
+    switch (GetJobCPUSetting())
     {
         case  0: myth_nice(17);
                  myth_ioprio(8);
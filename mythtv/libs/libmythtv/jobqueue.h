@@ -13,6 +13,7 @@
 #include <QMap>
 
 #include "mythtvexp.h"
+#include "jobbudget.h"
 #include "libmythbase/mythchrono.h"
 
 class MThread;
@@ -229,9 +230,12 @@ class MTV_PUBLIC JobQueue : public QObject, public QRunnable
     void run(void) override; // QRunnable
     void ProcessQueue(void);
 
-    void ProcessJob(const JobQueueEntry& job);
+    void ProcessJob(const JobQueueEntry& job, const JobCost& cost);
 
     bool AllowedToRun(const JobQueueEntry& job);
+    void UpdateBudget(void);
+    static JobCost EstimateJobCost(const JobQueueEntry& job);
+    int  GetJobCPUSetting(void);
 
     static bool InJobRunWindow(std::chrono::minutes orStartsWithinMins = 0min);
 
@@ -259,6 +263,7 @@ class MTV_PUBLIC JobQueue : public QObject, public QRunnable
 
     int                        m_jobsRunning         {0};
     int                        m_jobQueueCPU         {0};
+    JobBudget                  m_budget;            // protected by m_runningJobsLock
 
     ProgramInfo               *m_pginfo              {nullptr};
 
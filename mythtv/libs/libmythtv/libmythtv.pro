@@ -80,6 +80,7 @@ QMAKE_CLEAN += $(TARGET) $(TARGETA) $(TARGETD) $(TARGET0) $(TARGET1) $(TARGET2)
 
 # Headers needed by frontend & backend
 HEADERS += mythframe.h
+HEADERS += mythframepool.h
 
 # Misc. needed by backend/frontend
 HEADERS += mythtvexp.h
@@ -89,7 +90,7 @@ HEADERS += recordinginfo.h
 HEADERS += dbcheck.h
 HEADERS += videodbcheck.h
 HEADERS += tvremoteutil.h           tv.h
-HEADERS += jobqueue.h
+HEADERS += jobqueue.h               jobbudget.h
 HEADERS += recordingprofile.h
 HEADERS += remoteencoder.h          videosource.h
 HEADERS += cardutil.h               sourceutil.h
@@ -132,7 +133,7 @@ SOURCES += recordinginfo.cpp
 SOURCES += dbcheck.cpp
 SOURCES += videodbcheck.cpp
 SOURCES += tvremoteutil.cpp         tv.cpp
-SOURCES += jobqueue.cpp
+SOURCES += jobqueue.cpp             jobbudget.cpp
 SOURCES += recordingprofile.cpp
 SOURCES += remoteencoder.cpp        videosource.cpp
 SOURCES += cardutil.cpp             sourceutil.cpp
@@ -162,6 +163,7 @@ SOURCES += io/mythinteractivebuffer.cpp
 SOURCES += io/mythopticalbuffer.cpp
 SOURCES += metadataimagehelper.cpp
 SOURCES += mythframe.cpp
+SOURCES += mythframepool.cpp
 SOURCES += mythavbufferref.cpp
 SOURCES += mythavutil.cpp
 SOURCES += recordingfile.cpp
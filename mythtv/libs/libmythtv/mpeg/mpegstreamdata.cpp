@@ -142,6 +142,7 @@ void MPEGStreamData::Reset(int desiredProgram)
     m_pidsConditionalAccess.clear();
 
     m_pidVideoSingleProgram = m_pidPmtSingleProgram = 0xffffffff;
+    m_pidFlagsDirty = true;
 
     m_patStatus.clear();
 
@@ -598,6 +599,7 @@ bool MPEGStreamData::CreatePMTSingleProgram(const ProgramMapTable &pmt)
 
     m_pidsWriting.clear();
     m_pidVideoSingleProgram = !videoPIDs.empty() ? videoPIDs[0] : 0xffffffff;
+    m_pidFlagsDirty = true;
     for (size_t i = 1; i < videoPIDs.size(); i++)
         AddWritingPID(videoPIDs[i]);
 
@@ -964,6 +966,9 @@ int MPEGStreamData::ProcessData(const unsigned char *buffer, int len)
         return 0;
     }
 
+    if (m_batchedDispatch)
+        return ProcessDataBatched(buffer, len);
+
     while (pos + int(TSPacket::kSize) <= len)
     { // while we have a whole packet left...
         if (buffer[pos] != SYNC_BYTE || resync)
@@ -1033,21 +1038,7 @@ bool MPEGStreamData::ProcessTSPacket(const TSPacket& tspacket)
     }
 
     if (VERBOSE_LEVEL_CHECK(VB_RECORD, LOG_DEBUG))
-    {
-        if (m_pmtSingleProgram && tspacket.PID() ==
-            m_pmtSingleProgram->PCRPID())
-        {
-            if (tspacket.HasPCR())
-            {
-                LOG(VB_RECORD, LOG_DEBUG, LOC +
-                    QString("PID %1 (0x%2) has PCR %3μs")
-                    .arg(m_pmtSingleProgram->PCRPID())
-                    .arg(m_pmtSingleProgram->PCRPID(), 0, 16)
-                    .arg(duration_cast<std::chrono::microseconds>
-                         (tspacket.GetPCR().time_since_epoch()).count()));
-            }
-        }
-    }
+        LogSingleProgramPCR(tspacket);
 
     if (IsVideoPID(tspacket.PID()))
     {
@@ -1087,24 +1078,379 @@ bool MPEGStreamData::ProcessTSPacket(const TSPacket& tspacket)
     return true;
 }
 
-int MPEGStreamData::ResyncStream(const unsigned char *buffer, int curr_pos,
-                                 int len)
+void MPEGStreamData::LogSingleProgramPCR(const TSPacket& tspacket) const
 {
-    // Search for two sync bytes 188 bytes apart,
-    int pos = curr_pos;
-    int nextpos = pos + TSPacket::kSize;
-    if (nextpos >= len)
-        return -1; // not enough bytes; caller should try again
+    if (m_pmtSingleProgram && tspacket.PID() ==
+        m_pmtSingleProgram->PCRPID())
+    {
+        if (tspacket.HasPCR())
+        {
+            LOG(VB_RECORD, LOG_DEBUG, LOC +
+                QString("PID %1 (0x%2) has PCR %3μs")
+                .arg(m_pmtSingleProgram->PCRPID())
+                .arg(m_pmtSingleProgram->PCRPID(), 0, 16)
+                .arg(duration_cast<std::chrono::microseconds>
+                     (tspacket.GetPCR().time_since_epoch()).count()));
+        }
+    }
+}
+
+/** \fn MPEGStreamData::ProcessDataBatched(const unsigned char*, int)
+ *  \brief Batched version of the ProcessData() packet loop.
+ *
+ *   Instead of looking up the PID maps and taking the listener lock for
+ *   every packet, each packet is classified using the flat PID flag table
+ *   and consecutive packets on the same PID are collected into a run.
+ *   The run is handed to the listeners in one call when the PID changes,
+ *   so packet order as seen by the listeners is the same as with
+ *   ProcessTSPacket(). The listener lock is taken once per buffer.
+ *
+ *  \return number of bytes left unprocessed at the end of the buffer
+ */
+int MPEGStreamData::ProcessDataBatched(const unsigned char *buffer, int len)
+{
+    QMutexLocker locker(&m_listenerLock);
+
+    static constexpr uint kBatchSize { 128 };
+    std::array<uint16_t,kBatchSize> pids {};
+    std::array<uint8_t,kBatchSize>  flags {};
+
+    TSPacketRun run;
+    int pos = 0;
+    bool resync = false;
+
+    while (pos + int(TSPacket::kSize) <= len)
+    { // while we have a whole packet left...
+        if (buffer[pos] != SYNC_BYTE || resync)
+        {
+            DispatchTSPacketRun(run);
+            int newpos = ResyncStream(buffer, pos+1, len);
+            LOG(VB_RECORD, LOG_DEBUG, LOC +
+                QString("Resyncing @ %1+1 w/len %2 -> %3")
+                .arg(pos).arg(len).arg(newpos));
+            if (newpos == -1)
+                return len - pos;
+            if (newpos == -2)
+                return TSPacket::kSize;
+            pos = newpos;
+        }
+
+        // Check the headers of the packets ahead in one go
+        uint count = std::min(uint(len - pos) / TSPacket::kSize, kBatchSize);
+        TSPacketScanner::Validate(&buffer[pos], count, pids.data(), flags.data());
+
+        for (uint i = 0; i < count; ++i)
+        {
+            // Lost sync, resync at the top of the outer loop
+            if (i && (flags[i] & TSPacketScanner::kPacketNoSync))
+                break;
+
+            if (m_pidFlagsDirty)
+            {
+                // Listeners may still depend on the old PID classification
+                DispatchTSPacketRun(run);
+                UpdatePIDFlags();
+            }
 
-    while (buffer[pos] != SYNC_BYTE || buffer[nextpos] != SYNC_BYTE)
+            const auto *pkt = reinterpret_cast<const TSPacket*>(&buffer[pos]);
+            pos += TSPacket::kSize; // Advance to next TS packet
+            resync = false;
+            if (!ClassifyTSPacket(*pkt, pids[i], flags[i], run))
+            {
+                if (pos + int(TSPacket::kSize) > len)
+                    continue;
+                if (buffer[pos] != SYNC_BYTE)
+                {
+                    // if the packet is broken, and we don't appear to be
+                    // in sync on the next packet, then resync.
+                    pos -= TSPacket::kSize;
+                    resync = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    DispatchTSPacketRun(run);
+
+    return len - pos;
+}
+
+/** \fn MPEGStreamData::ClassifyTSPacket(const TSPacket&, uint, uint8_t, TSPacketRun&)
+ *  \brief Per packet part of ProcessDataBatched().
+ *
+ *   Performs the same checks as ProcessTSPacket(), using the PID and the
+ *   TSPacketScanner flags already computed for the packet, but appends
+ *   packets for the A/V and writing listeners to \a run instead of
+ *   delivering them immediately. Table packets flush the run before
+ *   being handled.
+ *
+ *  \return false if the packet is broken, true otherwise
+ */
+bool MPEGStreamData::ClassifyTSPacket(const TSPacket& tspacket, uint pid,
+                                      uint8_t tsflags, TSPacketRun &run)
+{
+    const uint8_t flags = m_pidFlags[pid];
+
+    if (flags & kPIDFlagEncryptionTest)
+        ProcessEncryptedPacket(tspacket);
+
+    if (tsflags & TSPacketScanner::kPacketTransportError)
+        return false;
+
+    if (tsflags & TSPacketScanner::kPacketScrambled)
+        return true;
+
+    // Discard broken packets with invalid adaptation field length
+    if (tsflags & TSPacketScanner::kPacketBadAdaptation)
     {
-        pos++;
-        nextpos++;
-        if (nextpos == len)
-            return -2; // not found
+        LOG(VB_RECORD, LOG_DEBUG, QString("Invalid adaptation field, type %3, size %4")
+            .arg(tspacket.AdaptationFieldControl())
+            .arg(tspacket.AdaptationFieldSize()) + "\n" +
+            tspacket.toString());
+        return false;
     }
 
-    return pos;
+    if (VERBOSE_LEVEL_CHECK(VB_RECORD, LOG_DEBUG))
+        LogSingleProgramPCR(tspacket);
+
+    const uint8_t runflags =
+        flags & (kPIDFlagVideo | kPIDFlagAudio | kPIDFlagWriting);
+    if (runflags)
+    {
+        if (run.m_count && run.m_pid == pid &&
+            (run.m_first + run.m_count) == &tspacket)
+        {
+            run.m_count++;
+        }
+        else
+        {
+            DispatchTSPacketRun(run);
+            run.m_first = &tspacket;
+            run.m_count = 1;
+            run.m_pid   = pid;
+            run.m_flags = runflags;
+        }
+
+        if (flags & (kPIDFlagVideo | kPIDFlagAudio))
+            return true;
+    }
+
+    if (tspacket.HasPayload() && (flags & kPIDFlagTables))
+    {
+        DispatchTSPacketRun(run);
+        HandleTSTables(&tspacket);          // Table handling starts here....
+    }
+
+    return true;
+}
+
+/** \fn MPEGStreamData::DispatchTSPacketRun(TSPacketRun&)
+ *  \brief Hands a run of packets to the listeners and empties the run.
+ *
+ *  \note Caller must hold m_listenerLock.
+ */
+void MPEGStreamData::DispatchTSPacketRun(TSPacketRun &run)
+{
+    if (!run.m_count)
+        return;
+
+    if (run.m_flags & kPIDFlagVideo)
+    {
+        for (auto & listener : m_tsAvListeners)
+            listener->ProcessVideoTSPackets(run.m_first, run.m_count);
+    }
+    else if (run.m_flags & kPIDFlagAudio)
+    {
+        for (auto & listener : m_tsAvListeners)
+            listener->ProcessAudioTSPackets(run.m_first, run.m_count);
+    }
+    else if (run.m_flags & kPIDFlagWriting)
+    {
+        for (auto & listener : m_tsWritingListeners)
+            listener->ProcessTSPackets(run.m_first, run.m_count);
+    }
+
+    run.m_count = 0;
+}
+
+/** \fn MPEGStreamData::DemuxData(const unsigned char*, int, std::vector<const TSPacket*>&, std::vector<uint16_t>&, std::vector<uint8_t>&)
+ *  \brief Splits a read buffer into TS packets, their PIDs and their
+ *         TSPacketScanner flags.
+ *
+ *   This is the part of ProcessData() that does not depend on the PIDs
+ *   a stream data object is interested in, so a StreamHandler feeding
+ *   several stream data objects from the same multiplex only has to do
+ *   it once per buffer. Packets with a broken header are kept, the
+ *   consumers decide what to do with them based on \a flags.
+ *
+ *  \return number of bytes left unprocessed at the end of the buffer
+ */
+int MPEGStreamData::DemuxData(const unsigned char *buffer, int len,
+                              std::vector<const TSPacket*> &packets,
+                              std::vector<uint16_t> &pids,
+                              std::vector<uint8_t> &flags)
+{
+    static constexpr uint kBatchSize { 128 };
+
+    packets.clear();
+    pids.resize(len / TSPacket::kSize + kBatchSize);
+    flags.resize(pids.size());
+    uint npkts = 0;
+    int pos = 0;
+
+    while (pos + int(TSPacket::kSize) <= len)
+    { // while we have a whole packet left...
+        if (buffer[pos] != SYNC_BYTE)
+        {
+            int newpos = TSPacketScanner::FindSync(buffer, pos+1, len);
+            LOG(VB_RECORD, LOG_DEBUG, "MPEGStream: " +
+                QString("Resyncing @ %1+1 w/len %2 -> %3")
+                .arg(pos).arg(len).arg(newpos));
+            if (newpos == -1)
+                break;
+            if (newpos == -2)
+            {
+                pids.resize(npkts);
+                flags.resize(npkts);
+                return TSPacket::kSize;
+            }
+            pos = newpos;
+        }
+
+        uint count = std::min(uint(len - pos) / TSPacket::kSize, kBatchSize);
+        TSPacketScanner::Validate(&buffer[pos], count,
+                                  &pids[npkts], &flags[npkts]);
+
+        for (uint i = 0; i < count; ++i)
+        {
+            // Lost sync, resync at the top of the outer loop
+            if (i && (flags[npkts + i] & TSPacketScanner::kPacketNoSync))
+                break;
+            packets.push_back(reinterpret_cast<const TSPacket*>(&buffer[pos]));
+            pos += TSPacket::kSize;
+        }
+        // pids and flags of packets after a sync loss are overwritten
+        // next time
+        npkts = packets.size();
+    }
+
+    pids.resize(npkts);
+    flags.resize(npkts);
+    return len - pos;
+}
+
+/** \fn MPEGStreamData::CanProcessDemuxed(void) const
+ *  \brief Returns true if ProcessDemuxedPackets() can be used instead of
+ *         ProcessData().
+ *
+ *   Program stream listeners and stream data types which handle every
+ *   packet themselves need the complete buffer.
+ */
+bool MPEGStreamData::CanProcessDemuxed(void) const
+{
+    QMutexLocker locker(&m_listenerLock);
+    return m_batchedDispatch && m_psListeners.empty();
+}
+
+/** \fn MPEGStreamData::ProcessDemuxedPackets(const std::vector<const TSPacket*>&, const std::vector<uint16_t>&, const std::vector<uint8_t>&)
+ *  \brief Processes the packets found by DemuxData() this object needs.
+ *
+ *   This is ProcessDataBatched() without the sync search and the header
+ *   checks, which DemuxData() already did. Packets on PIDs without an
+ *   entry in the PID flag table are skipped, the others are classified
+ *   with ClassifyTSPacket() and handed to the listeners as runs pointing
+ *   into the caller's buffer, so nothing is copied or parsed twice.
+ */
+void MPEGStreamData::ProcessDemuxedPackets(
+    const std::vector<const TSPacket*> &packets,
+    const std::vector<uint16_t> &pids,
+    const std::vector<uint8_t> &flags)
+{
+    QMutexLocker locker(&m_listenerLock);
+
+    TSPacketRun run;
+    for (size_t i = 0; i < packets.size(); ++i)
+    {
+        if (m_pidFlagsDirty)
+        {
+            // Listeners may still depend on the old PID classification
+            DispatchTSPacketRun(run);
+            UpdatePIDFlags();
+        }
+
+        if (m_pidFlags[pids[i]] == kPIDFlagNone)
+            continue;
+
+        // Broken packets are dropped, DemuxData() already resynced
+        ClassifyTSPacket(*packets[i], pids[i], flags[i], run);
+    }
+
+    DispatchTSPacketRun(run);
+}
+
+/** \fn MPEGStreamData::UpdatePIDFlags(void)
+ *  \brief Rebuilds the flat PID flag table used by ProcessDataBatched()
+ *         from the PID maps.
+ *
+ *   This mirrors the precedence in ProcessTSPacket(): a video PID is
+ *   never delivered as audio or writing, and an audio PID is never
+ *   delivered to the writing listeners or the table handling.
+ */
+void MPEGStreamData::UpdatePIDFlags(void)
+{
+    m_pidFlagsDirty = false;
+    m_pidFlags.fill(kPIDFlagNone);
+
+    auto pidok = [](uint pid) { return pid < 0x2000; };
+
+    if (!m_listeningDisabled)
+    {
+        for (auto it = m_pidsListening.cbegin(); it != m_pidsListening.cend(); ++it)
+        {
+            if (pidok(it.key()))
+                m_pidFlags[it.key()] |= kPIDFlagTables;
+        }
+        for (auto it = m_pidsNotListening.cbegin(); it != m_pidsNotListening.cend(); ++it)
+        {
+            if (pidok(it.key()))
+                m_pidFlags[it.key()] &= ~kPIDFlagTables;
+        }
+        for (auto it = m_pidsConditionalAccess.cbegin(); it != m_pidsConditionalAccess.cend(); ++it)
+        {
+            if (pidok(it.key()))
+                m_pidFlags[it.key()] &= ~kPIDFlagTables;
+        }
+    }
+
+    for (auto it = m_pidsWriting.cbegin(); it != m_pidsWriting.cend(); ++it)
+    {
+        if (pidok(it.key()))
+            m_pidFlags[it.key()] |= kPIDFlagWriting;
+    }
+
+    for (auto it = m_pidsAudio.cbegin(); it != m_pidsAudio.cend(); ++it)
+    {
+        if (pidok(it.key()))
+            m_pidFlags[it.key()] = kPIDFlagAudio;
+    }
+
+    if (pidok(m_pidVideoSingleProgram))
+        m_pidFlags[m_pidVideoSingleProgram] = kPIDFlagVideo;
+
+    QMutexLocker locker(&m_encryptionLock);
+    for (auto it = m_encryptionPidToInfo.cbegin(); it != m_encryptionPidToInfo.cend(); ++it)
+    {
+        if (pidok(it.key()))
+            m_pidFlags[it.key()] |= kPIDFlagEncryptionTest;
+    }
+}
+
+int MPEGStreamData::ResyncStream(const unsigned char *buffer, int curr_pos,
+                                 int len)
+{
+    // Search for two sync bytes 188 bytes apart,
+    return TSPacketScanner::FindSync(buffer, curr_pos, len);
 }
 
 bool MPEGStreamData::IsConditionalAccessPID(uint pid) const
@@ -1787,6 +2133,7 @@ void MPEGStreamData::AddEncryptionTestPID(uint pnum, uint pid, bool isvideo)
     m_encryptionPidToPnums[pid].push_back(pnum);
     m_encryptionPnumToPids[pnum].push_back(pid);
     m_encryptionPnumToStatus[pnum] = kEncUnknown;
+    m_pidFlagsDirty = true;
 }
 
 void MPEGStreamData::RemoveEncryptionTestPIDs(uint pnum)
@@ -1829,6 +2176,7 @@ void MPEGStreamData::RemoveEncryptionTestPIDs(uint pnum)
     }
 
     m_encryptionPnumToPids.remove(pnum);
+    m_pidFlagsDirty = true;
 }
 
 bool MPEGStreamData::IsEncryptionTestPID(uint pid) const
@@ -1876,6 +2224,7 @@ void MPEGStreamData::ResetDecryptionMonitoringState(void)
     m_encryptionPidToInfo.clear();
     m_encryptionPidToPnums.clear();
     m_encryptionPnumToPids.clear();
+    m_pidFlagsDirty = true;
 }
 
 bool MPEGStreamData::IsProgramDecrypted(uint pnum) const
@@ -4,6 +4,8 @@
 #define MPEGSTREAMDATA_H_
 
 // C++
+#include <array>
+#include <atomic>
 #include <cstdint>  // uint64_t
 #include <vector>
 
@@ -82,6 +84,18 @@ enum PIDPriority : std::uint8_t
 };
 using pid_map_t = QMap<uint, PIDPriority>;
 
+/// Per-PID dispatch class flags, see MPEGStreamData::UpdatePIDFlags()
+enum PIDFlag : std::uint8_t
+{
+    kPIDFlagNone           = 0x00,
+    kPIDFlagVideo          = 0x01,
+    kPIDFlagAudio          = 0x02,
+    kPIDFlagWriting        = 0x04,
+    kPIDFlagTables         = 0x08,
+    kPIDFlagEncryptionTest = 0x10,
+};
+using pid_flag_table_t = std::array<uint8_t, 0x2000>;
+
 class MTV_PUBLIC MPEGStreamData : public EITSource
 {
   public:
@@ -89,7 +103,12 @@ class MTV_PUBLIC MPEGStreamData : public EITSource
     ~MPEGStreamData() override;
 
     void SetCaching(bool cacheTables) { m_cacheTables = cacheTables; }
-    void SetListeningDisabled(bool lt) { m_listeningDisabled = lt; }
+    void SetListeningDisabled(bool lt)
+        { m_listeningDisabled = lt; m_pidFlagsDirty = true; }
+    /// Enables classifying whole buffers into per-PID packet runs in
+    /// ProcessData() instead of calling ProcessTSPacket() per packet.
+    void SetBatchedDispatch(bool batched) { m_batchedDispatch = batched; }
+    bool IsBatchedDispatch(void) const { return m_batchedDispatch; }
 
     virtual void Reset(void) { Reset(-1); }
     virtual void Reset(int desiredProgram);
@@ -114,29 +133,42 @@ class MTV_PUBLIC MPEGStreamData : public EITSource
     virtual void HandleTSTables(const TSPacket* tspacket);
     virtual bool ProcessTSPacket(const TSPacket& tspacket);
     virtual int  ProcessData(const unsigned char *buffer, int len);
+
+    // Shared demux, see StreamHandler::ProcessStreamData()
+    static int DemuxData(const unsigned char *buffer, int len,
+                         std::vector<const TSPacket*> &packets,
+                         std::vector<uint16_t> &pids,
+                         std::vector<uint8_t> &flags);
+    bool CanProcessDemuxed(void) const;
+    void ProcessDemuxedPackets(const std::vector<const TSPacket*> &packets,
+                               const std::vector<uint16_t> &pids,
+                               const std::vector<uint8_t> &flags);
     inline  void HandleAdaptationFieldControl(const TSPacket* tspacket);
 
     // Listening
     virtual void AddListeningPID(
         uint pid, PIDPriority priority = kPIDPriorityNormal)
-        { m_pidsListening[pid] = priority; }
+        { m_pidsListening[pid] = priority; m_pidFlagsDirty = true; }
     virtual void AddNotListeningPID(uint pid)
-        { m_pidsNotListening[pid] = kPIDPriorityNormal; }
+        { m_pidsNotListening[pid] = kPIDPriorityNormal; m_pidFlagsDirty = true; }
     virtual void AddWritingPID(
         uint pid, PIDPriority priority = kPIDPriorityHigh)
-        { m_pidsWriting[pid] = priority; }
+        { m_pidsWriting[pid] = priority; m_pidFlagsDirty = true; }
     virtual void AddAudioPID(
         uint pid, PIDPriority priority = kPIDPriorityHigh)
-        { m_pidsAudio[pid] = priority; }
+        { m_pidsAudio[pid] = priority; m_pidFlagsDirty = true; }
     virtual void AddConditionalAccessPID(
         uint pid, PIDPriority priority = kPIDPriorityNormal)
-        { m_pidsConditionalAccess[pid] = priority; }
+        { m_pidsConditionalAccess[pid] = priority; m_pidFlagsDirty = true; }
 
-    virtual void RemoveListeningPID(uint pid) { m_pidsListening.remove(pid);  }
+    virtual void RemoveListeningPID(uint pid)
+        { m_pidsListening.remove(pid); m_pidFlagsDirty = true; }
     virtual void RemoveNotListeningPID(uint pid)
-        { m_pidsNotListening.remove(pid); }
-    virtual void RemoveWritingPID(uint pid) { m_pidsWriting.remove(pid);    }
-    virtual void RemoveAudioPID(uint pid)   { m_pidsAudio.remove(pid);      }
+        { m_pidsNotListening.remove(pid); m_pidFlagsDirty = true; }
+    virtual void RemoveWritingPID(uint pid)
+        { m_pidsWriting.remove(pid); m_pidFlagsDirty = true; }
+    virtual void RemoveAudioPID(uint pid)
+        { m_pidsAudio.remove(pid); m_pidFlagsDirty = true; }
 
     virtual bool IsListeningPID(uint pid) const;
     virtual bool IsNotListeningPID(uint pid) const;
@@ -279,6 +311,23 @@ class MTV_PUBLIC MPEGStreamData : public EITSource
     bool CreatePMTSingleProgram(const ProgramMapTable &pmt);
 
   protected:
+    /// A run of consecutive packets in a read buffer on a single PID
+    struct TSPacketRun
+    {
+        const TSPacket *m_first  {nullptr};
+        uint            m_count  {0};
+        uint            m_pid    {0};
+        uint8_t         m_flags  {kPIDFlagNone};
+    };
+
+    // Batched dispatch -- for internal use
+    int  ProcessDataBatched(const unsigned char *buffer, int len);
+    bool ClassifyTSPacket(const TSPacket& tspacket, uint pid,
+                          uint8_t tsflags, TSPacketRun &run);
+    void DispatchTSPacketRun(TSPacketRun &run);
+    void UpdatePIDFlags(void);
+    void LogSingleProgramPCR(const TSPacket& tspacket) const;
+
     // Table processing -- for internal use
     PSIPTable* AssemblePSIP(const TSPacket* tspacket, bool& moreTablePackets);
     bool AssemblePSIP(PSIPTable& psip, TSPacket* tspacket);
@@ -327,6 +376,11 @@ class MTV_PUBLIC MPEGStreamData : public EITSource
     pid_map_t                 m_pidsConditionalAccess;
     bool                      m_listeningDisabled           {false};
 
+    // Batched dispatch
+    bool                      m_batchedDispatch             {true};
+    std::atomic<bool>         m_pidFlagsDirty               {true};
+    pid_flag_table_t          m_pidFlags                    {};
+
     // Encryption monitoring
     mutable QRecursiveMutex   m_encryptionLock;
     QMap<uint, CryptInfo>     m_encryptionPidToInfo;
@@ -63,6 +63,13 @@ class TSPacketListener
 {
   public:
     virtual bool ProcessTSPacket(const TSPacket& tspacket) = 0;
+    /// Called with \a count consecutive packets on the same PID.
+    /// The default implementation hands each one to ProcessTSPacket().
+    virtual void ProcessTSPackets(const TSPacket *tspackets, uint count)
+    {
+        for (uint i = 0; i < count; ++i)
+            ProcessTSPacket(tspackets[i]);
+    }
 
   protected:
     virtual ~TSPacketListener() = default;
@@ -73,6 +80,18 @@ class TSPacketListenerAV
   public:
     virtual bool ProcessVideoTSPacket(const TSPacket& tspacket) = 0;
     virtual bool ProcessAudioTSPacket(const TSPacket& tspacket) = 0;
+    /// Called with \a count consecutive video packets on the same PID.
+    virtual void ProcessVideoTSPackets(const TSPacket *tspackets, uint count)
+    {
+        for (uint i = 0; i < count; ++i)
+            ProcessVideoTSPacket(tspackets[i]);
+    }
+    /// Called with \a count consecutive audio packets on the same PID.
+    virtual void ProcessAudioTSPackets(const TSPacket *tspackets, uint count)
+    {
+        for (uint i = 0; i < count; ++i)
+            ProcessAudioTSPacket(tspackets[i]);
+    }
 
   protected:
     virtual ~TSPacketListenerAV() = default;
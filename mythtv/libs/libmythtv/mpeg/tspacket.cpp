@@ -3,6 +3,27 @@
 #include <cstdint> // for intptr_t
 #include "tspacket.h"
 
+#include "libmythbase/mythconfig.h"
+
+extern "C" {
+#include "libavutil/cpu.h"
+}
+
+#include <QtGlobal>
+
+#ifdef Q_PROCESSOR_X86_64
+#   include <emmintrin.h>
+#   if defined(__GNUC__) || defined(__clang__)
+#       include <immintrin.h>
+#       define TS_HAVE_AVX2 1
+#       define TS_TARGET_AVX2 __attribute__((target("avx2")))
+static const bool s_haveAVX2 = (av_get_cpu_flags() & AV_CPU_FLAG_AVX2) != 0;
+#   endif
+#elif HAVE_INTRINSICS_NEON
+#   include <arm_neon.h>
+static const bool s_haveNEON = (av_get_cpu_flags() & AV_CPU_FLAG_NEON) != 0;
+#endif
+
 const TSHeaderArray TSHeader::kPayloadOnlyHeader
 {
     SYNC_BYTE,
@@ -45,3 +66,257 @@ QString TSPacket::toString() const
                .arg(ContinuityCounter()));
     return str;
 }
+
+int TSPacketScanner::FindSyncScalar(const unsigned char *buffer, int pos, int len)
+{
+    int nextpos = pos + TSPacket::kSize;
+    if (nextpos >= len)
+        return -1; // not enough bytes; caller should try again
+
+    while (buffer[pos] != SYNC_BYTE || buffer[nextpos] != SYNC_BYTE)
+    {
+        pos++;
+        nextpos++;
+        if (nextpos == len)
+            return -2; // not found
+    }
+
+    return pos;
+}
+
+static inline uint8_t validate_header(const unsigned char *pkt)
+{
+    uint8_t flags = TSPacketScanner::kPacketOK;
+    if (pkt[0] != SYNC_BYTE)
+        flags |= TSPacketScanner::kPacketNoSync;
+    if (pkt[1] & 0x80)
+        flags |= TSPacketScanner::kPacketTransportError;
+    if (pkt[3] & 0x80)
+        flags |= TSPacketScanner::kPacketScrambled;
+    // See ISO/IEC 13818-1 : 2000 (E). 2.4.3.5
+    if (pkt[3] & 0x20)
+    {
+        bool valid = (pkt[3] & 0x10) ? pkt[4] <= 182 : pkt[4] == 183;
+        if (!valid)
+            flags |= TSPacketScanner::kPacketBadAdaptation;
+    }
+    return flags;
+}
+
+uint TSPacketScanner::ValidateScalar(const unsigned char *buffer, uint count,
+                                     uint16_t *pids, uint8_t *flags)
+{
+    uint bad = 0;
+    for (uint i = 0; i < count; ++i)
+    {
+        const unsigned char *pkt = buffer + (i * static_cast<size_t>(TSPacket::kSize));
+        pids[i]  = ((pkt[1] << 8) | pkt[2]) & 0x1fff;
+        flags[i] = validate_header(pkt);
+        if (flags[i])
+            bad++;
+    }
+    return bad;
+}
+
+// Header bytes 0-3 of a packet as a little endian word, so that byte N
+// of the header ends up in bits 8N..8N+7 of every SIMD lane.
+static inline uint32_t load_header(const unsigned char *pkt)
+{
+    return static_cast<uint32_t>(pkt[0])        |
+           (static_cast<uint32_t>(pkt[1]) << 8)  |
+           (static_cast<uint32_t>(pkt[2]) << 16) |
+           (static_cast<uint32_t>(pkt[3]) << 24);
+}
+
+#ifdef Q_PROCESSOR_X86_64
+static inline __m128i find_sync_mask_sse2(const unsigned char *ptr)
+{
+    const __m128i sync = _mm_set1_epi8(static_cast<char>(SYNC_BYTE));
+    __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr));
+    __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr + TSPacket::kSize));
+    return _mm_and_si128(_mm_cmpeq_epi8(a, sync), _mm_cmpeq_epi8(b, sync));
+}
+
+static uint validate_sse2(const unsigned char *buffer, uint count,
+                          uint16_t *pids, uint8_t *flags)
+{
+    const __m128i one  = _mm_set1_epi32(1);
+    const __m128i sync = _mm_set1_epi32(SYNC_BYTE);
+    const __m128i ff   = _mm_set1_epi32(0xff);
+    alignas(16) std::array<uint32_t,4> pidout {};
+    alignas(16) std::array<uint32_t,4> flagout {};
+
+    uint bad = 0;
+    uint i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const unsigned char *p = buffer + (i * static_cast<size_t>(TSPacket::kSize));
+        const unsigned char *q = p + TSPacket::kSize;
+        const unsigned char *r = q + TSPacket::kSize;
+        const unsigned char *t = r + TSPacket::kSize;
+
+        __m128i hdr = _mm_set_epi32(static_cast<int>(load_header(t)), static_cast<int>(load_header(r)),
+                                    static_cast<int>(load_header(q)), static_cast<int>(load_header(p)));
+        __m128i afs = _mm_set_epi32(t[4], r[4], q[4], p[4]);
+
+        __m128i nosync = _mm_andnot_si128(_mm_cmpeq_epi32(_mm_and_si128(hdr, ff), sync), one);
+        __m128i tei    = _mm_and_si128(_mm_srli_epi32(hdr, 14), _mm_set1_epi32(TSPacketScanner::kPacketTransportError));
+        __m128i scr    = _mm_and_si128(_mm_srli_epi32(hdr, 29), _mm_set1_epi32(TSPacketScanner::kPacketScrambled));
+        __m128i hasaf  = _mm_cmpeq_epi32(_mm_and_si128(_mm_srli_epi32(hdr, 29), one), one);
+        __m128i haspl  = _mm_cmpeq_epi32(_mm_and_si128(_mm_srli_epi32(hdr, 28), one), one);
+        __m128i toobig = _mm_cmpgt_epi32(afs, _mm_set1_epi32(182));
+        __m128i not183 = _mm_andnot_si128(_mm_cmpeq_epi32(afs, _mm_set1_epi32(183)),
+                                          _mm_set1_epi32(-1));
+        __m128i badaf  = _mm_or_si128(_mm_and_si128(haspl, toobig),
+                                      _mm_andnot_si128(haspl, not183));
+        badaf = _mm_and_si128(_mm_and_si128(badaf, hasaf), _mm_set1_epi32(TSPacketScanner::kPacketBadAdaptation));
+
+        __m128i flg = _mm_or_si128(_mm_or_si128(nosync, tei), _mm_or_si128(scr, badaf));
+        __m128i pid = _mm_or_si128(_mm_and_si128(hdr, _mm_set1_epi32(0x1f00)),
+                                   _mm_and_si128(_mm_srli_epi32(hdr, 16), ff));
+
+        _mm_store_si128(reinterpret_cast<__m128i*>(pidout.data()), pid);
+        _mm_store_si128(reinterpret_cast<__m128i*>(flagout.data()), flg);
+        for (uint j = 0; j < 4; ++j)
+        {
+            pids[i + j]  = static_cast<uint16_t>(pidout[j]);
+            flags[i + j] = static_cast<uint8_t>(flagout[j]);
+            if (flagout[j])
+                bad++;
+        }
+    }
+
+    size_t done = i * static_cast<size_t>(TSPacket::kSize);
+    return bad + TSPacketScanner::ValidateScalar(buffer + done, count - i,
+                                                 pids + i, flags + i);
+}
+#endif
+
+#ifdef TS_HAVE_AVX2
+TS_TARGET_AVX2
+static int find_sync_avx2(const unsigned char *buffer, int pos, int len)
+{
+    const __m256i sync = _mm256_set1_epi8(static_cast<char>(SYNC_BYTE));
+    for (; pos + static_cast<int>(TSPacket::kSize) + 32 <= len; pos += 32)
+    {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(buffer + pos));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(buffer + pos + TSPacket::kSize));
+        auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(
+            _mm256_and_si256(_mm256_cmpeq_epi8(a, sync), _mm256_cmpeq_epi8(b, sync))));
+        if (mask)
+            return pos + __builtin_ctz(mask);
+    }
+    return pos;
+}
+#endif
+
+int TSPacketScanner::FindSync(const unsigned char *buffer, int pos, int len)
+{
+    if (pos + static_cast<int>(TSPacket::kSize) >= len)
+        return -1; // not enough bytes; caller should try again
+
+#ifdef Q_PROCESSOR_X86_64
+#ifdef TS_HAVE_AVX2
+    if (s_haveAVX2)
+    {
+        pos = find_sync_avx2(buffer, pos, len);
+        if (pos + static_cast<int>(TSPacket::kSize) < len &&
+            buffer[pos] == SYNC_BYTE && buffer[pos + TSPacket::kSize] == SYNC_BYTE)
+            return pos;
+    }
+#endif
+    for (; pos + static_cast<int>(TSPacket::kSize) + 16 <= len; pos += 16)
+    {
+        auto mask = static_cast<uint>(_mm_movemask_epi8(find_sync_mask_sse2(buffer + pos)));
+        if (mask)
+        {
+            while (!(mask & 1))
+            {
+                mask >>= 1;
+                pos++;
+            }
+            return pos;
+        }
+    }
+#elif HAVE_INTRINSICS_NEON
+    if (s_haveNEON)
+    {
+        const uint8x16_t sync = vdupq_n_u8(SYNC_BYTE);
+        for (; pos + static_cast<int>(TSPacket::kSize) + 16 <= len; pos += 16)
+        {
+            uint8x16_t a = vld1q_u8(buffer + pos);
+            uint8x16_t b = vld1q_u8(buffer + pos + TSPacket::kSize);
+            uint64x2_t m = vreinterpretq_u64_u8(vandq_u8(vceqq_u8(a, sync),
+                                                         vceqq_u8(b, sync)));
+            if (vgetq_lane_u64(m, 0) | vgetq_lane_u64(m, 1))
+                break; // the scalar search below finds the exact offset
+        }
+    }
+#endif
+
+    if (pos + static_cast<int>(TSPacket::kSize) >= len)
+        return -2; // not found
+    return FindSyncScalar(buffer, pos, len);
+}
+
+uint TSPacketScanner::Validate(const unsigned char *buffer, uint count,
+                               uint16_t *pids, uint8_t *flags)
+{
+#ifdef Q_PROCESSOR_X86_64
+    return validate_sse2(buffer, count, pids, flags);
+#elif HAVE_INTRINSICS_NEON
+    if (!s_haveNEON)
+        return ValidateScalar(buffer, count, pids, flags);
+
+    const uint32x4_t one = vdupq_n_u32(1);
+    const uint32x4_t ff  = vdupq_n_u32(0xff);
+    std::array<uint32_t,4> hdrin {};
+    std::array<uint32_t,4> afsin {};
+    std::array<uint32_t,4> pidout {};
+    std::array<uint32_t,4> flagout {};
+
+    uint bad = 0;
+    uint i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        for (uint j = 0; j < 4; ++j)
+        {
+            const unsigned char *p = buffer + ((i + j) * static_cast<size_t>(TSPacket::kSize));
+            hdrin[j] = load_header(p);
+            afsin[j] = p[4];
+        }
+        uint32x4_t hdr = vld1q_u32(hdrin.data());
+        uint32x4_t afs = vld1q_u32(afsin.data());
+
+        uint32x4_t nosync = vandq_u32(vmvnq_u32(vceqq_u32(vandq_u32(hdr, ff),
+                                                          vdupq_n_u32(SYNC_BYTE))), one);
+        uint32x4_t tei    = vandq_u32(vshrq_n_u32(hdr, 14), vdupq_n_u32(kPacketTransportError));
+        uint32x4_t scr    = vandq_u32(vshrq_n_u32(hdr, 29), vdupq_n_u32(kPacketScrambled));
+        uint32x4_t hasaf  = vceqq_u32(vandq_u32(vshrq_n_u32(hdr, 29), one), one);
+        uint32x4_t haspl  = vceqq_u32(vandq_u32(vshrq_n_u32(hdr, 28), one), one);
+        uint32x4_t toobig = vcgtq_u32(afs, vdupq_n_u32(182));
+        uint32x4_t not183 = vmvnq_u32(vceqq_u32(afs, vdupq_n_u32(183)));
+        uint32x4_t badaf  = vbslq_u32(haspl, toobig, not183);
+        badaf = vandq_u32(vandq_u32(badaf, hasaf), vdupq_n_u32(kPacketBadAdaptation));
+
+        uint32x4_t flg = vorrq_u32(vorrq_u32(nosync, tei), vorrq_u32(scr, badaf));
+        uint32x4_t pid = vorrq_u32(vandq_u32(hdr, vdupq_n_u32(0x1f00)),
+                                   vandq_u32(vshrq_n_u32(hdr, 16), ff));
+
+        vst1q_u32(pidout.data(), pid);
+        vst1q_u32(flagout.data(), flg);
+        for (uint j = 0; j < 4; ++j)
+        {
+            pids[i + j]  = static_cast<uint16_t>(pidout[j]);
+            flags[i + j] = static_cast<uint8_t>(flagout[j]);
+            if (flagout[j])
+                bad++;
+        }
+    }
+
+    size_t done = i * static_cast<size_t>(TSPacket::kSize);
+    return bad + ValidateScalar(buffer + done, count - i, pids + i, flags + i);
+#else
+    return ValidateScalar(buffer, count, pids, flags);
+#endif
+}
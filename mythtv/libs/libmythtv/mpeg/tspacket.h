@@ -275,6 +275,52 @@ static_assert(sizeof(TSPacket) == 188,
 
 // NOLINTEND(cppcoreguidelines-pro-type-member-init)
 
+/** \class TSPacketScanner
+ *  \brief Checks a whole buffer of Transport Stream packets at once.
+ *
+ *  The sync byte search and the per packet header checks done by the
+ *  stream data classes are the hottest loops of every recorder. These
+ *  helpers work on many packets per call using SSE2/AVX2 or NEON where
+ *  available and fall back to plain C++ elsewhere. The results are
+ *  identical on every code path.
+ *
+ *  \sa MPEGStreamData::ProcessData()
+ */
+class MTV_PUBLIC TSPacketScanner
+{
+  public:
+    /// Problems found in a packet by Validate()
+    enum PacketFlag : std::uint8_t
+    {
+        kPacketOK                = 0x00,
+        kPacketNoSync            = 0x01,
+        kPacketTransportError    = 0x02,
+        kPacketScrambled         = 0x04,
+        kPacketBadAdaptation     = 0x08,
+    };
+
+    /** \brief Find two sync bytes TSPacket::kSize bytes apart.
+     *  \return offset of the first sync byte, -1 if there are not enough
+     *          bytes to check, -2 if no sync point was found.
+     */
+    static int FindSync(const unsigned char *buffer, int pos, int len);
+
+    /** \brief Classify \a count consecutive packets starting at \a buffer.
+     *
+     *  For each packet the PID is stored in \a pids and a combination
+     *  of PacketFlag values in \a flags.
+     *
+     *  \return number of packets with at least one flag set
+     */
+    static uint Validate(const unsigned char *buffer, uint count,
+                         uint16_t *pids, uint8_t *flags);
+
+    /// Plain C++ versions, used for short buffers and for testing.
+    static int  FindSyncScalar(const unsigned char *buffer, int pos, int len);
+    static uint ValidateScalar(const unsigned char *buffer, uint count,
+                               uint16_t *pids, uint8_t *flags);
+};
+
 #if 0 /* not used yet */
 /** \class TSDVBEmissionPacket
  *  \brief Adds DVB forward error correction data to size of packet.
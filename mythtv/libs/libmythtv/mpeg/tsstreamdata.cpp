@@ -15,6 +15,8 @@
 
 TSStreamData::TSStreamData(int cardnum) : MPEGStreamData(-1, cardnum, false)
 {
+    // Every packet must go through our ProcessTSPacket()
+    SetBatchedDispatch(false);
 }
 
 /** \fn TSStreamData::ProcessTSPacket(const TSPacket& tspacket)
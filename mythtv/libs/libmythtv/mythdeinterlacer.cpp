@@ -1,12 +1,15 @@
 // MythTV
+#include "libmythbase/mthreadpool.h"
 #include "libmythbase/mythconfig.h"
 #include "libmythbase/mythlogging.h"
 
 #include "mythavutil.h"
 #include "mythdeinterlacer.h"
+#include "mythframepool.h"
 #include "mythvideoprofile.h"
 
 #include <algorithm>
+#include <array>
 #include <thread>
 
 extern "C" {
@@ -15,11 +18,18 @@ extern "C" {
 #include "libavutil/cpu.h"
 }
 
+#include <QRunnable>
 #include <QtGlobal>
 
 #ifdef Q_PROCESSOR_X86_64
 #   include <emmintrin.h>
 static const bool s_haveSIMD = true;
+#   if defined(__GNUC__) || defined(__clang__)
+#       include <immintrin.h>
+#       define DEINT_HAVE_AVX2 1
+#       define DEINT_TARGET_AVX2 __attribute__((target("avx2")))
+static const bool s_haveAVX2 = (av_get_cpu_flags() & AV_CPU_FLAG_AVX2) != 0;
+#   endif
 #elif HAVE_INTRINSICS_NEON
 #   include <arm_neon.h>
 static const bool s_haveSIMD = av_get_cpu_flags() & AV_CPU_FLAG_NEON;
@@ -35,9 +45,14 @@ static const bool s_haveSIMD = av_get_cpu_flags() & AV_CPU_FLAG_NEON;
  * quality and using single or double frame rate.
  *
  * The following deinterlacers are used:
- * Basic - onefield/bob using libswcale
- * Medium - linearblend with custom code (SSE2 and Neon assisted where available)
- * High - libavfilter's yadif (with multithreading)
+ * Basic - onefield/bob with custom code
+ * Medium - linearblend with custom code
+ * High - bwdif style motion adaptive with custom code for 8bit formats,
+ * libavfilter's yadif for higher bit depths. Both delay the output by a frame.
+ *
+ * The custom code is SSE2/AVX2 and Neon assisted where available and the
+ * frame is split into slices processed in parallel, using up to the number of
+ * CPUs allowed by the video profile.
  *
  * \note libavfilter frame doubling filters expect frames to be presented
  * in the correct order and will break if they do not receive a frame followed
@@ -47,6 +62,7 @@ static const bool s_haveSIMD = av_get_cpu_flags() & AV_CPU_FLAG_NEON;
 MythDeinterlacer::~MythDeinterlacer()
 {
     Cleanup();
+    delete m_threadPool;
 }
 
 /*! \brief Deinterlace Frame if needed
@@ -111,8 +127,9 @@ void MythDeinterlacer::Filter(MythVideoFrame *Frame, FrameScanType Scan,
     }
 
     // libavfilter will not deinterlace NV12 frames. Allow shaders in this case.
-    // libswscale (for bob/onefield) is fine, as is our linearblend.
-    if ((deinterlacer == DEINT_HIGH) && MythVideoFrame::FormatIsNV12(Frame->m_type))
+    // Our onefield, linearblend and 8bit motion adaptive are fine.
+    if ((deinterlacer == DEINT_HIGH) && MythVideoFrame::FormatIsNV12(Frame->m_type) &&
+        !UseNativeHigh(Frame->m_type))
     {
         Cleanup();
         Frame->m_deinterlaceSingle = Frame->m_deinterlaceSingle | DEINT_SHADER;
@@ -125,8 +142,9 @@ void MythDeinterlacer::Filter(MythVideoFrame *Frame, FrameScanType Scan,
     // destroyed and recreated. Using 'auto' for the field order breaks user
     // override of the interlacing order - so track switches in the field order
     // and switch to auto if it is too frequent
+    bool yadif = (deinterlacer == DEINT_HIGH) && !UseNativeHigh(Frame->m_type);
     bool fieldorderchanged = topfieldfirst != m_topFirst;
-    if (fieldorderchanged && deinterlacer != DEINT_HIGH)
+    if (fieldorderchanged && !yadif)
     {
         fieldorderchanged = false;
         m_topFirst = topfieldfirst;
@@ -136,7 +154,7 @@ void MythDeinterlacer::Filter(MythVideoFrame *Frame, FrameScanType Scan,
                         deinterlacer != m_deintType || doublerate     != m_doubleRate ||
                         Frame->m_type != m_inputType;
 
-    if ((deinterlacer == DEINT_HIGH) && fieldorderchanged)
+    if (yadif && fieldorderchanged)
     {
         bool alreadyauto = m_autoFieldOrder;
         bool change = m_lastFieldChange && (qAbs(m_lastFieldChange - Frame->m_frameCounter) < 10);
@@ -174,7 +192,11 @@ void MythDeinterlacer::Filter(MythVideoFrame *Frame, FrameScanType Scan,
     }
     else if ((m_deintType == DEINT_HIGH) && (qAbs(Frame->m_frameCounter - m_discontinuityCounter) > 1))
     {
-        if (!Initialise(Frame, deinterlacer, doublerate, topfieldfirst, Profile))
+        if (!yadif)
+        {
+            m_prevValid = false;
+        }
+        else if (!Initialise(Frame, deinterlacer, doublerate, topfieldfirst, Profile))
         {
             Cleanup();
             return;
@@ -202,6 +224,15 @@ void MythDeinterlacer::Filter(MythVideoFrame *Frame, FrameScanType Scan,
         return;
     }
 
+    // motion adaptive
+    if (!yadif)
+    {
+        if (Force)
+            m_prevValid = false;
+        MotionAdaptive(Frame, Scan);
+        return;
+    }
+
     // We need a filter
     if (!m_graph)
         return;
@@ -272,12 +303,10 @@ void MythDeinterlacer::Filter(MythVideoFrame *Frame, FrameScanType Scan,
 
 void MythDeinterlacer::Cleanup()
 {
-    if (m_graph || m_swsContext)
+    if (m_deintType != DEINT_NONE)
         LOG(VB_PLAYBACK, LOG_INFO, LOC + "Removing CPU deinterlacer");
 
     avfilter_graph_free(&m_graph);
-    sws_freeContext(m_swsContext);
-    m_swsContext = nullptr;
     m_discontinuityCounter = 0;
     m_autoFieldOrder = false;
     m_lastFieldChange = 0;
@@ -289,9 +318,28 @@ void MythDeinterlacer::Cleanup()
         m_bobFrame = nullptr;
     }
 
+    delete m_prevFrame;
+    delete m_curFrame;
+    delete m_nextFrame;
+    m_prevFrame = nullptr;
+    m_curFrame  = nullptr;
+    m_nextFrame = nullptr;
+    m_prevValid = false;
+    m_history   = 0;
+
     m_deintType = DEINT_NONE;
 }
 
+/*! \brief Limit the threads used by our own deinterlacers.
+ *
+ * Overrides the number of CPUs of the video profile when non-zero. Takes
+ * effect when the deinterlacer is next (re)initialised.
+*/
+void MythDeinterlacer::SetMaxThreads(uint Threads)
+{
+    m_maxThreads = Threads;
+}
+
 ///\brief Initialise deinterlacing using the given MythDeintType
 bool MythDeinterlacer::Initialise(MythVideoFrame *Frame, MythDeintType Deinterlacer,
                                   bool DoubleRate, bool TopFieldFirst, MythVideoProfile *Profile)
@@ -311,21 +359,28 @@ bool MythDeinterlacer::Initialise(MythVideoFrame *Frame, MythDeintType Deinterla
     m_inputFmt  = MythAVUtil::FrameTypeToPixelFormat(Frame->m_type);
     auto name   = MythVideoFrame::DeinterlacerName(Deinterlacer | DEINT_CPU, DoubleRate);
 
-    // simple onefield/bob?
-    if (Deinterlacer == DEINT_BASIC || Deinterlacer == DEINT_MEDIUM)
+    uint threads = m_maxThreads ? m_maxThreads : 1;
+    if (Profile && !m_maxThreads)
+    {
+        threads = std::clamp(Profile->GetMaxCPUs(), 1U, std::max(8U, std::thread::hardware_concurrency()));
+    }
+
+    // our own onefield/bob, linearblend or motion adaptive?
+    if (Deinterlacer == DEINT_BASIC || Deinterlacer == DEINT_MEDIUM ||
+        (Deinterlacer == DEINT_HIGH && UseNativeHigh(m_inputType)))
     {
         m_deintType  = Deinterlacer;
         m_doubleRate = DoubleRate;
         m_topFirst   = TopFieldFirst;
-        if (Deinterlacer == DEINT_BASIC)
-        {
-            m_swsContext = sws_getCachedContext(m_swsContext, m_width, m_height >> 1, m_inputFmt,
-                                                m_width, m_height, m_inputFmt, SWS_FAST_BILINEAR,
-                                                nullptr, nullptr, nullptr);
-            if (m_swsContext == nullptr)
-                return false;
-        }
-        LOG(VB_PLAYBACK, LOG_INFO, LOC + QString("Using deinterlacer '%1'").arg(name));
+        m_threads    = static_cast<int>(threads);
+        if ((m_threads > 1) && !m_threadPool)
+            m_threadPool = new MThreadPool("MythDeint");
+        if (m_threadPool)
+            m_threadPool->setMaxThreadCount(std::max(m_threads - 1, 1));
+        if (Deinterlacer == DEINT_HIGH)
+            name = QString("%1CPU Bwdif").arg(DoubleRate ? "2x " : "");
+        LOG(VB_PLAYBACK, LOG_INFO, LOC + QString("Using deinterlacer '%1' (%2 threads)")
+            .arg(name).arg(m_threads));
         return true;
     }
 
@@ -340,12 +395,6 @@ bool MythDeinterlacer::Initialise(MythVideoFrame *Frame, MythDeintType Deinterla
     if (!m_graph)
         return false;
 
-    uint threads = 1;
-    if (Profile)
-    {
-        threads = std::clamp(Profile->GetMaxCPUs(), 1U, std::max(8U, std::thread::hardware_concurrency()));
-    }
-
     AVFilterInOut* inputs = nullptr;
     AVFilterInOut* outputs = nullptr;
 
@@ -390,79 +439,510 @@ bool MythDeinterlacer::Initialise(MythVideoFrame *Frame, MythDeintType Deinterla
     return false;
 }
 
-bool MythDeinterlacer::SetUpCache(MythVideoFrame *Frame)
+/// \brief Returns true if DEINT_HIGH is handled by MotionAdaptive() rather than yadif.
+bool MythDeinterlacer::UseNativeHigh(VideoFrameType Type)
+{
+    return MythVideoFrame::ColorDepth(Type) == 8;
+}
+
+bool MythDeinterlacer::SetUpCache(MythVideoFrame *Frame, MythVideoFrame *&Cache)
 {
     if (!Frame)
         return false;
 
-    if (m_bobFrame && !((m_bobFrame->m_bufferSize == Frame->m_bufferSize)) && (m_bobFrame->m_width == Frame->m_width) &&
-                        (m_bobFrame->m_height == Frame->m_height) && (m_bobFrame->m_type == Frame->m_type))
+    if (Cache && ((Cache->m_bufferSize != Frame->m_bufferSize) || (Cache->m_width != Frame->m_width) ||
+                  (Cache->m_height != Frame->m_height) || (Cache->m_type != Frame->m_type)))
     {
-        delete m_bobFrame;
-        m_bobFrame = nullptr;
+        delete Cache;
+        Cache = nullptr;
     }
 
-    if (!m_bobFrame)
+    if (!Cache)
     {
-        m_bobFrame = new MythVideoFrame(Frame->m_type, MythVideoFrame::GetAlignedBuffer(Frame->m_bufferSize),
-                                        Frame->m_bufferSize, Frame->m_width, Frame->m_height);
+        Cache = new MythVideoFrame(Frame->m_type, MythFramePool::Instance().Acquire(Frame->m_bufferSize),
+                                   Frame->m_bufferSize, Frame->m_width, Frame->m_height);
         LOG(VB_PLAYBACK, LOG_INFO, "Created new 'bob' cache frame");
     }
 
-    return m_bobFrame && m_bobFrame->m_buffer != nullptr;
+    // The cache is a straight copy of the frame buffer, so it must use the same layout
+    Cache->m_pitches = Frame->m_pitches;
+    Cache->m_offsets = Frame->m_offsets;
+    return Cache->m_buffer != nullptr;
 }
 
-void MythDeinterlacer::OneField(MythVideoFrame *Frame, FrameScanType Scan)
+/*! \brief Run Work over Rows rows, split into slices processed in parallel.
+ *
+ * Each slice starts at a multiple of Align rows. The calling thread processes
+ * the first slice and waits for the others.
+*/
+void MythDeinterlacer::RunSliced(int Rows, int Align, const std::function<void(int,int)>& Work)
 {
-    if (!m_swsContext)
+    static constexpr int kMinSliceRows { 64 };
+    int slices = m_threadPool ? std::min(m_threads, Rows / kMinSliceRows) : 1;
+    if (slices < 2)
+    {
+        Work(0, Rows);
         return;
+    }
 
-    // we need a frame for caching - both to preserve the second field if
-    // needed and ensure we are not filtering in place (i.e. from src to src).
-    if (!SetUpCache(Frame))
-        return;
+    int size = ((((Rows + slices - 1) / slices) + Align - 1) / Align) * Align;
+    for (int first = size; first < Rows; first += size)
+    {
+        int last = std::min(first + size, Rows);
+        m_threadPool->start(QRunnable::create([&Work, first, last]() { Work(first, last); }),
+                            "MythDeintSlice");
+    }
+    Work(0, std::min(size, Rows));
+    m_threadPool->waitForDone();
+}
 
-    // copy/cache on first pass
-    if (kScan_Interlaced == Scan)
-        memcpy(m_bobFrame->m_buffer, Frame->m_buffer, m_bobFrame->m_bufferSize);
+/// A plane to deinterlace, see DeintRows()
+struct DeintPlane
+{
+    uint8_t       *m_dst      { nullptr };
+    const uint8_t *m_src      { nullptr }; ///< contains the field to keep
+    ptrdiff_t      m_pitch    { 0 };
+    int            m_width    { 0 };       ///< in bytes
+    int            m_height   { 0 };
+    bool           m_top      { true };    ///< keep the top field
+    bool           m_hidepth  { false };
+};
+
+static void DeintRowC(uint8_t *Dst, const uint8_t *Above, const uint8_t *Below, int Start, int Width)
+{
+    for (int x = Start; x < Width; ++x)
+        Dst[x] = static_cast<uint8_t>((Above[x] + Below[x] + 1) >> 1);
+}
 
-    // Convert VideoFrame to AVFrame - no copy
-    AVFrame dstframe;
-    if ((MythAVUtil::FillAVFrame(m_frame, m_bobFrame, m_inputFmt) < 1) ||
-        (MythAVUtil::FillAVFrame(&dstframe, Frame, m_inputFmt) < 1))
+static void DeintRow16C(uint16_t *Dst, const uint16_t *Above, const uint16_t *Below,
+                        int Start, int Width)
+{
+    for (int x = Start; x < Width; ++x)
+        Dst[x] = static_cast<uint16_t>((Above[x] + Below[x] + 1) >> 1);
+}
+
+#if defined(Q_PROCESSOR_X86_64)
+static int DeintRowSSE2(uint8_t *Dst, const uint8_t *Above, const uint8_t *Below, int Width)
+{
+    auto load = [](const uint8_t *Src) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(Src)); };
+    int x = 0;
+    for ( ; x + 16 <= Width; x += 16)
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(Dst + x), _mm_avg_epu8(load(Above + x), load(Below + x)));
+    return x;
+}
+
+static int DeintRow16SSE2(uint8_t *Dst, const uint8_t *Above, const uint8_t *Below, int Width)
+{
+    int x = 0;
+    for ( ; x + 16 <= Width; x += 16)
     {
-        LOG(VB_GENERAL, LOG_ERR, LOC + "Error converting frame");
-        return;
+        __m128i result = _mm_avg_epu16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(Above + x)),
+                                       _mm_loadu_si128(reinterpret_cast<const __m128i*>(Below + x)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(Dst + x), result);
+    }
+    return x;
+}
+#endif
+
+#if DEINT_HAVE_AVX2
+DEINT_TARGET_AVX2
+static int DeintRowAVX2(uint8_t *Dst, const uint8_t *Above, const uint8_t *Below, int Width)
+{
+    int x = 0;
+    for ( ; x + 32 <= Width; x += 32)
+    {
+        __m256i above = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(Above + x));
+        __m256i below = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(Below + x));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(Dst + x), _mm256_avg_epu8(above, below));
+    }
+    return x;
+}
+#endif
+
+#if HAVE_INTRINSICS_NEON
+static int DeintRowNEON(uint8_t *Dst, const uint8_t *Above, const uint8_t *Below, int Width)
+{
+    int x = 0;
+    for ( ; x + 16 <= Width; x += 16)
+        vst1q_u8(Dst + x, vrhaddq_u8(vld1q_u8(Above + x), vld1q_u8(Below + x)));
+    return x;
+}
+
+static int DeintRow16NEON(uint8_t *Dst, const uint8_t *Above, const uint8_t *Below, int Width)
+{
+    int x = 0;
+    for ( ; x + 16 <= Width; x += 16)
+    {
+        uint16x8_t result = vrhaddq_u16(vld1q_u16(reinterpret_cast<const uint16_t*>(Above + x)),
+                                        vld1q_u16(reinterpret_cast<const uint16_t*>(Below + x)));
+        vst1q_u16(reinterpret_cast<uint16_t*>(Dst + x), result);
+    }
+    return x;
+}
+#endif
+
+/*! \brief Deinterlace rows FirstRow to LastRow (exclusive) of a plane.
+ *
+ * Lines of the field to keep are copied if the source is not the destination,
+ * the other lines are the average of the lines above and below.
+*/
+static void DeintRows(const DeintPlane &Plane, int FirstRow, int LastRow)
+{
+    for (int row = FirstRow; row < LastRow; ++row)
+    {
+        uint8_t *dst = Plane.m_dst + (row * Plane.m_pitch);
+        if (((row & 1) == 0) == Plane.m_top)
+        {
+            if (Plane.m_src != Plane.m_dst)
+                memcpy(dst, Plane.m_src + (row * Plane.m_pitch), static_cast<size_t>(Plane.m_width));
+            continue;
+        }
+
+        const uint8_t *above = Plane.m_src + (((row > 0) ? row - 1 : row + 1) * Plane.m_pitch);
+        const uint8_t *below = (row + 1 < Plane.m_height) ? Plane.m_src + ((row + 1) * Plane.m_pitch) : above;
+
+        int done = 0;
+        if (Plane.m_hidepth)
+        {
+#if defined(Q_PROCESSOR_X86_64)
+            done = DeintRow16SSE2(dst, above, below, Plane.m_width);
+#elif HAVE_INTRINSICS_NEON
+            if (s_haveSIMD)
+                done = DeintRow16NEON(dst, above, below, Plane.m_width);
+#endif
+            DeintRow16C(reinterpret_cast<uint16_t*>(dst), reinterpret_cast<const uint16_t*>(above),
+                        reinterpret_cast<const uint16_t*>(below), done / 2, Plane.m_width / 2);
+            continue;
+        }
+
+#if DEINT_HAVE_AVX2
+        if (s_haveAVX2)
+            done = DeintRowAVX2(dst, above, below, Plane.m_width);
+        else
+#endif
+        {
+#if defined(Q_PROCESSOR_X86_64)
+            done = DeintRowSSE2(dst, above, below, Plane.m_width);
+#elif HAVE_INTRINSICS_NEON
+            if (s_haveSIMD)
+                done = DeintRowNEON(dst, above, below, Plane.m_width);
+#endif
+        }
+        DeintRowC(dst, above, below, done, Plane.m_width);
+    }
+}
+
+void MythDeinterlacer::OneField(MythVideoFrame *Frame, FrameScanType Scan)
+{
+    // For double rate we need a frame for caching - to preserve the second
+    // field. Single rate can work in place, as only the lines of the field
+    // being kept are read.
+    MythVideoFrame *src = Frame;
+    if (m_doubleRate)
+    {
+        if (!SetUpCache(Frame, m_bobFrame))
+            return;
+        // copy/cache on first pass
+        if (kScan_Interlaced == Scan)
+            memcpy(m_bobFrame->m_buffer, Frame->m_buffer, m_bobFrame->m_bufferSize);
+        src = m_bobFrame;
+    }
+
+    bool hidepth = MythVideoFrame::ColorDepth(Frame->m_type) > 8;
+    bool topfield = Scan == kScan_Interlaced ? m_topFirst : !m_topFirst;
+    uint count = MythVideoFrame::GetNumPlanes(Frame->m_type);
+    for (uint plane = 0; plane < count; plane++)
+    {
+        DeintPlane deint;
+        deint.m_dst     = Frame->m_buffer + Frame->m_offsets[plane];
+        deint.m_src     = src->m_buffer + src->m_offsets[plane];
+        deint.m_pitch   = Frame->m_pitches[plane];
+        deint.m_width   = MythVideoFrame::GetPitchForPlane(Frame->m_type, Frame->m_width, plane);
+        deint.m_height  = MythVideoFrame::GetHeightForPlane(Frame->m_type, Frame->m_height, plane);
+        deint.m_top     = topfield;
+        deint.m_hidepth = hidepth;
+        RunSliced(deint.m_height, 2, [&deint](int First, int Last) { DeintRows(deint, First, Last); });
+    }
+    Frame->m_alreadyDeinterlaced = true;
+}
+
+/// Rows around a missing line used by BwdifRowC(), relative to that line
+struct BwdifLines
+{
+    std::array<const uint8_t*,4> m_cur   {}; ///< current frame, rows -3, -1, +1 and +3
+    std::array<const uint8_t*,2> m_prev  {}; ///< previous frame, rows -1 and +1
+    std::array<const uint8_t*,2> m_next  {}; ///< next frame, rows -1 and +1
+    std::array<const uint8_t*,5> m_prev2 {}; ///< earlier field, rows -4, -2, 0, +2 and +4
+    std::array<const uint8_t*,5> m_next2 {}; ///< later field, rows -4, -2, 0, +2 and +4
+};
+
+// Filter coefficients (Q13) of bwdif, from w3fdif
+static constexpr int kLF0 { 4309 };
+static constexpr int kLF1 { 213 };
+static constexpr int kHF0 { 5570 };
+static constexpr int kHF1 { 3801 };
+static constexpr int kHF2 { 1016 };
+static constexpr int kSP0 { 5077 };
+static constexpr int kSP1 { 981 };
+
+static void BwdifRowC(uint8_t *Dst, const BwdifLines &Lines, int Start, int Width)
+{
+    const auto & cur   = Lines.m_cur;
+    const auto & prev2 = Lines.m_prev2;
+    const auto & next2 = Lines.m_next2;
+    for (int x = Start; x < Width; ++x)
+    {
+        int c  = cur[1][x];
+        int e  = cur[2][x];
+        int p0 = prev2[2][x];
+        int n0 = next2[2][x];
+        int d  = (p0 + n0) >> 1;
+        int temporal0 = std::abs(p0 - n0);
+        int temporal1 = (std::abs(Lines.m_prev[0][x] - c) + std::abs(Lines.m_prev[1][x] - e)) >> 1;
+        int temporal2 = (std::abs(Lines.m_next[0][x] - c) + std::abs(Lines.m_next[1][x] - e)) >> 1;
+        int diff = std::max({ temporal0 >> 1, temporal1, temporal2 });
+        if (!diff)
+        {
+            Dst[x] = static_cast<uint8_t>(d);
+            continue;
+        }
+
+        // Spatial check, limits the temporal change by the vertical detail
+        int above2 = prev2[1][x] + next2[1][x];
+        int below2 = prev2[3][x] + next2[3][x];
+        int b  = (above2 >> 1) - c;
+        int f  = (below2 >> 1) - e;
+        int dc = d - c;
+        int de = d - e;
+        int hi = std::max({ de, dc, std::min(b, f) });
+        int lo = std::min({ de, dc, std::max(b, f) });
+        diff = std::max({ diff, lo, -hi });
+
+        int outer = cur[0][x] + cur[3][x];
+        int interpol = 0;
+        if (std::abs(c - e) > temporal0)
+        {
+            int far = prev2[0][x] + next2[0][x] + prev2[4][x] + next2[4][x];
+            interpol = (((kHF0 * (p0 + n0) - kHF1 * (above2 + below2) + kHF2 * far) >> 2) +
+                        kLF0 * (c + e) - kLF1 * outer) >> 13;
+        }
+        else
+        {
+            interpol = (kSP0 * (c + e) - kSP1 * outer) >> 13;
+        }
+        interpol = std::clamp(interpol, d - diff, d + diff);
+        Dst[x] = static_cast<uint8_t>(std::clamp(interpol, 0, 255));
     }
+}
 
-    bool topfield   = Scan == kScan_Interlaced ? m_topFirst : !m_topFirst;
-    dstframe.width  = Frame->m_width;
-    dstframe.height = Frame->m_height;
-    dstframe.format = Frame->m_pixFmt;
+#if defined(Q_PROCESSOR_X86_64)
+static int BwdifRowSSE2(uint8_t *Dst, const BwdifLines &Lines, int Width)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i hf01 = _mm_set_epi16(-kHF1, kHF0, -kHF1, kHF0, -kHF1, kHF0, -kHF1, kHF0);
+    const __m128i hf2  = _mm_set_epi16(0, kHF2, 0, kHF2, 0, kHF2, 0, kHF2);
+    const __m128i lf   = _mm_set_epi16(-kLF1, kLF0, -kLF1, kLF0, -kLF1, kLF0, -kLF1, kLF0);
+    const __m128i sp   = _mm_set_epi16(-kSP1, kSP0, -kSP1, kSP0, -kSP1, kSP0, -kSP1, kSP0);
+    auto load = [&zero](const uint8_t *Src)
+        { return _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(Src)), zero); };
+    auto absdiff = [&zero](__m128i A, __m128i B)
+        { __m128i diff = _mm_sub_epi16(A, B); return _mm_max_epi16(diff, _mm_sub_epi16(zero, diff)); };
+    // Q13 filters of two 16 bit inputs each, on 32 bit lanes
+    auto filter = [](__m128i A, __m128i B, __m128i Coefs, bool High)
+    {
+        __m128i pairs = High ? _mm_unpackhi_epi16(A, B) : _mm_unpacklo_epi16(A, B);
+        return _mm_madd_epi16(pairs, Coefs);
+    };
+
+    const auto & cur   = Lines.m_cur;
+    const auto & prev2 = Lines.m_prev2;
+    const auto & next2 = Lines.m_next2;
+    int x = 0;
+    for ( ; x + 8 <= Width; x += 8)
+    {
+        __m128i c    = load(cur[1] + x);
+        __m128i e    = load(cur[2] + x);
+        __m128i p0   = load(prev2[2] + x);
+        __m128i n0   = load(next2[2] + x);
+        __m128i sum0 = _mm_add_epi16(p0, n0);
+        __m128i d    = _mm_srli_epi16(sum0, 1);
+        __m128i temporal0 = absdiff(p0, n0);
+        __m128i temporal1 = _mm_srli_epi16(_mm_add_epi16(absdiff(load(Lines.m_prev[0] + x), c),
+                                                         absdiff(load(Lines.m_prev[1] + x), e)), 1);
+        __m128i temporal2 = _mm_srli_epi16(_mm_add_epi16(absdiff(load(Lines.m_next[0] + x), c),
+                                                         absdiff(load(Lines.m_next[1] + x), e)), 1);
+        __m128i static0 = _mm_max_epi16(_mm_srli_epi16(temporal0, 1), _mm_max_epi16(temporal1, temporal2));
+        __m128i isstatic = _mm_cmpeq_epi16(static0, zero);
+
+        __m128i above2 = _mm_add_epi16(load(prev2[1] + x), load(next2[1] + x));
+        __m128i below2 = _mm_add_epi16(load(prev2[3] + x), load(next2[3] + x));
+        __m128i b  = _mm_sub_epi16(_mm_srli_epi16(above2, 1), c);
+        __m128i f  = _mm_sub_epi16(_mm_srli_epi16(below2, 1), e);
+        __m128i dc = _mm_sub_epi16(d, c);
+        __m128i de = _mm_sub_epi16(d, e);
+        __m128i hi = _mm_max_epi16(_mm_max_epi16(de, dc), _mm_min_epi16(b, f));
+        __m128i lo = _mm_min_epi16(_mm_min_epi16(de, dc), _mm_max_epi16(b, f));
+        __m128i diff = _mm_max_epi16(_mm_max_epi16(static0, lo), _mm_sub_epi16(zero, hi));
+
+        __m128i ce    = _mm_add_epi16(c, e);
+        __m128i outer = _mm_add_epi16(load(cur[0] + x), load(cur[3] + x));
+        __m128i near2 = _mm_add_epi16(above2, below2);
+        __m128i far   = _mm_add_epi16(_mm_add_epi16(load(prev2[0] + x), load(next2[0] + x)),
+                                      _mm_add_epi16(load(prev2[4] + x), load(next2[4] + x)));
+        auto highfreq = [&](bool High)
+        {
+            __m128i temporal = _mm_add_epi32(filter(sum0, near2, hf01, High), filter(far, zero, hf2, High));
+            return _mm_srai_epi32(_mm_add_epi32(_mm_srai_epi32(temporal, 2), filter(ce, outer, lf, High)), 13);
+        };
+        auto spatial = [&](bool High) { return _mm_srai_epi32(filter(ce, outer, sp, High), 13); };
+        __m128i usehf = _mm_cmpgt_epi16(absdiff(c, e), temporal0);
+        __m128i interpol = _mm_or_si128(_mm_and_si128(usehf, _mm_packs_epi32(highfreq(false), highfreq(true))),
+                                        _mm_andnot_si128(usehf, _mm_packs_epi32(spatial(false), spatial(true))));
+        interpol = _mm_min_epi16(_mm_max_epi16(interpol, _mm_sub_epi16(d, diff)), _mm_add_epi16(d, diff));
+        interpol = _mm_or_si128(_mm_and_si128(isstatic, d), _mm_andnot_si128(isstatic, interpol));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(Dst + x), _mm_packus_epi16(interpol, interpol));
+    }
+    return x;
+}
+#endif
 
-    m_frame->width  = m_bobFrame->m_width;
-    m_frame->format = m_bobFrame->m_pixFmt;
+/// Clamp Row to the plane, keeping its field
+static inline int FieldRow(int Row, int Height)
+{
+    while (Row < 0)
+        Row += 2;
+    while (Row >= Height)
+        Row -= 2;
+    return std::max(Row, 0);
+}
+
+/// A plane to deinterlace with bwdif, see BwdifRows()
+struct BwdifPlane
+{
+    uint8_t       *m_dst    { nullptr };
+    const uint8_t *m_prev   { nullptr };
+    const uint8_t *m_cur    { nullptr }; ///< the frame being deinterlaced
+    const uint8_t *m_next   { nullptr };
+    ptrdiff_t      m_pitch  { 0 };
+    int            m_width  { 0 };       ///< in bytes
+    int            m_height { 0 };
+    bool           m_top    { true };    ///< keep the top field
+    bool           m_first  { true };    ///< the field kept is the first field of the frame
+};
+
+/*! \brief Deinterlace rows FirstRow to LastRow (exclusive) of a plane with bwdif.
+ *
+ * Lines of the field to keep are copied from the current frame. The missing
+ * lines lie in time between the other field of the previous and the current
+ * frame (first field) or of the current and the next frame (second field).
+*/
+static void BwdifRows(const BwdifPlane &Plane, int FirstRow, int LastRow)
+{
+    const uint8_t *prev2 = Plane.m_first ? Plane.m_prev : Plane.m_cur;
+    const uint8_t *next2 = Plane.m_first ? Plane.m_cur  : Plane.m_next;
+    auto line = [&Plane](const uint8_t *Src, int Row)
+        { return Src + (FieldRow(Row, Plane.m_height) * Plane.m_pitch); };
 
-    // Fake the frame height and stride to simulate a single field
-    m_frame->height = Frame->m_height >> 1;
-    m_frame->flags &= ~AV_FRAME_FLAG_INTERLACED;
-    uint nbplanes = MythVideoFrame::GetNumPlanes(m_inputType);
-    for (uint i = 0; i < nbplanes; i++)
+    for (int row = FirstRow; row < LastRow; ++row)
     {
-        if (!topfield)
-            m_frame->data[i] = m_frame->data[i] + m_frame->linesize[i];
-        m_frame->linesize[i] = m_frame->linesize[i] << 1;
+        uint8_t *dst = Plane.m_dst + (row * Plane.m_pitch);
+        if (((row & 1) == 0) == Plane.m_top)
+        {
+            memcpy(dst, Plane.m_cur + (row * Plane.m_pitch), static_cast<size_t>(Plane.m_width));
+            continue;
+        }
+
+        BwdifLines lines;
+        lines.m_cur   = { line(Plane.m_cur, row - 3), line(Plane.m_cur, row - 1),
+                          line(Plane.m_cur, row + 1), line(Plane.m_cur, row + 3) };
+        lines.m_prev  = { line(Plane.m_prev, row - 1), line(Plane.m_prev, row + 1) };
+        lines.m_next  = { line(Plane.m_next, row - 1), line(Plane.m_next, row + 1) };
+        lines.m_prev2 = { line(prev2, row - 4), line(prev2, row - 2), line(prev2, row),
+                          line(prev2, row + 2), line(prev2, row + 4) };
+        lines.m_next2 = { line(next2, row - 4), line(next2, row - 2), line(next2, row),
+                          line(next2, row + 2), line(next2, row + 4) };
+        int done = 0;
+#if defined(Q_PROCESSOR_X86_64)
+        done = BwdifRowSSE2(dst, lines, Plane.m_width);
+#endif
+        BwdifRowC(dst, lines, done, Plane.m_width);
     }
+}
 
-    // and scale to full height
-    int result = sws_scale(m_swsContext, m_frame->data, m_frame->linesize, 0, m_frame->height,
-                           dstframe.data, dstframe.linesize);
+/*! \brief Motion adaptive (bwdif) deinterlacing of 8bit formats.
+ *
+ * Uses the previous, the current and the next frame, so the output is delayed
+ * by one frame, as with yadif. The lines of the field being shown are kept and
+ * each missing line is interpolated from both the other fields around it in
+ * time and the lines above and below, limited by the motion seen there. Static
+ * areas therefore keep the full vertical resolution. Until there is a previous
+ * frame (start, seek or a discontinuity) the frame is interpolated spatially
+ * without delay.
+*/
+void MythDeinterlacer::MotionAdaptive(MythVideoFrame *Frame, FrameScanType Scan)
+{
+    bool second = m_doubleRate && (kScan_Interlaced != Scan);
+    if (!second)
+    {
+        // Frame becomes the next frame, the last next frame the current one
+        std::swap(m_prevFrame, m_curFrame);
+        std::swap(m_curFrame, m_nextFrame);
+        if (!SetUpCache(Frame, m_nextFrame))
+            return;
+        memcpy(m_nextFrame->m_buffer, Frame->m_buffer, m_nextFrame->m_bufferSize);
+        m_nextFrame->m_timecode = Frame->m_timecode;
+        if (!m_prevValid)
+            m_history = 0;
+        m_history = std::min(m_history + 1, 3);
+        m_prevValid = true;
+    }
+    else if (!m_nextFrame || (m_nextFrame->m_bufferSize != Frame->m_bufferSize))
+    {
+        return;
+    }
 
-    if (result != Frame->m_height)
+    auto usable = [Frame](const MythVideoFrame *Cache)
+        { return Cache && (Cache->m_bufferSize == Frame->m_bufferSize); };
+    bool delayed = (m_history > 1) && usable(m_curFrame) && ((m_history < 3) || usable(m_prevFrame));
+    bool topfield = second ? !m_topFirst : m_topFirst;
+    uint count = MythVideoFrame::GetNumPlanes(Frame->m_type);
+    for (uint plane = 0; plane < count; plane++)
     {
-        LOG(VB_GENERAL, LOG_INFO, LOC + QString("Error scaling frame: height %1 expected %2")
-            .arg(result).arg(Frame->m_height));
+        int width  = MythVideoFrame::GetPitchForPlane(Frame->m_type, Frame->m_width, plane);
+        int height = MythVideoFrame::GetHeightForPlane(Frame->m_type, Frame->m_height, plane);
+        uint8_t *dst = Frame->m_buffer + Frame->m_offsets[plane];
+        if (!delayed)
+        {
+            // The first pass works in place, only lines of the field being
+            // kept are read
+            DeintPlane deint;
+            deint.m_dst     = dst;
+            deint.m_src     = second ? m_nextFrame->m_buffer + m_nextFrame->m_offsets[plane] : dst;
+            deint.m_pitch   = Frame->m_pitches[plane];
+            deint.m_width   = width;
+            deint.m_height  = height;
+            deint.m_top     = topfield;
+            RunSliced(height, 2, [&deint](int First, int Last) { DeintRows(deint, First, Last); });
+            continue;
+        }
+
+        // Without an earlier frame yet, the current frame stands in for it
+        const MythVideoFrame *prev = (m_history < 3) ? m_curFrame : m_prevFrame;
+        BwdifPlane deint;
+        deint.m_dst    = dst;
+        deint.m_prev   = prev->m_buffer + prev->m_offsets[plane];
+        deint.m_cur    = m_curFrame->m_buffer + m_curFrame->m_offsets[plane];
+        deint.m_next   = m_nextFrame->m_buffer + m_nextFrame->m_offsets[plane];
+        deint.m_pitch  = Frame->m_pitches[plane];
+        deint.m_width  = width;
+        deint.m_height = height;
+        deint.m_top    = topfield;
+        deint.m_first  = !second;
+        RunSliced(height, 2, [&deint](int First, int Last) { BwdifRows(deint, First, Last); });
     }
+
+    if (delayed)
+        Frame->m_timecode = m_curFrame->m_timecode;
     Frame->m_alreadyDeinterlaced = true;
 }
 
@@ -638,7 +1118,7 @@ void MythDeinterlacer::Blend(MythVideoFrame *Frame, FrameScanType Scan)
 
     if (m_doubleRate)
     {
-        if (!SetUpCache(Frame))
+        if (!SetUpCache(Frame, m_bobFrame))
             return;
         // copy/cache on first pass.
         if (kScan_Interlaced == Scan)
@@ -655,6 +1135,10 @@ void MythDeinterlacer::Blend(MythVideoFrame *Frame, FrameScanType Scan)
     {
         int  height  = MythVideoFrame::GetHeightForPlane(src->m_type, src->m_height, plane);
         int firstrow = top ? 1 : 2;
+        // Slices start at multiples of 4 rows, the last one ends where the
+        // unsliced version would
+        auto lastrow = [height, firstrow](int Last)
+            { return (Last >= height) ? height : firstrow + Last + 3; };
         bool height4 = (height % 4) == 0;
         bool width4  = (src->m_pitches[plane] % 4) == 0;
         // N.B. all frames allocated by MythTV should have 16 byte alignment
@@ -664,22 +1148,25 @@ void MythDeinterlacer::Blend(MythVideoFrame *Frame, FrameScanType Scan)
         // profiling SSE2 suggests it is usually 4x faster - as expected
         if (s_haveSIMD && height4 && width16)
         {
-            if (hidepth)
-            {
-                BlendSIMD8x4(src->m_buffer + src->m_offsets[plane],
-                             MythVideoFrame::GetPitchForPlane(src->m_type, src->m_width, plane),
-                             firstrow, height, src->m_pitches[plane],
-                             Frame->m_buffer + Frame->m_offsets[plane], Frame->m_pitches[plane],
-                             second);
-            }
-            else
+            RunSliced(height, 4, [&](int First, int Last)
             {
-                BlendSIMD16x4(src->m_buffer + src->m_offsets[plane],
-                              MythVideoFrame::GetWidthForPlane(src->m_type, src->m_width, plane),
-                              firstrow, height, src->m_pitches[plane],
-                              Frame->m_buffer + Frame->m_offsets[plane], Frame->m_pitches[plane],
-                              second);
-            }
+                if (hidepth)
+                {
+                    BlendSIMD8x4(src->m_buffer + src->m_offsets[plane],
+                                 MythVideoFrame::GetPitchForPlane(src->m_type, src->m_width, plane),
+                                 firstrow + First, lastrow(Last), src->m_pitches[plane],
+                                 Frame->m_buffer + Frame->m_offsets[plane], Frame->m_pitches[plane],
+                                 second);
+                }
+                else
+                {
+                    BlendSIMD16x4(src->m_buffer + src->m_offsets[plane],
+                                  MythVideoFrame::GetWidthForPlane(src->m_type, src->m_width, plane),
+                                  firstrow + First, lastrow(Last), src->m_pitches[plane],
+                                  Frame->m_buffer + Frame->m_offsets[plane], Frame->m_pitches[plane],
+                                  second);
+                }
+            });
         }
         else
 #endif
@@ -688,11 +1175,14 @@ void MythDeinterlacer::Blend(MythVideoFrame *Frame, FrameScanType Scan)
         // is virtually unheard of.
         if (width4 && height4 && !hidepth)
         {
-            BlendC4x4(src->m_buffer + src->m_offsets[plane],
-                      MythVideoFrame::GetWidthForPlane(src->m_type, src->m_width, plane),
-                      firstrow, height, src->m_pitches[plane],
-                      Frame->m_buffer + Frame->m_offsets[plane], Frame->m_pitches[plane],
-                      second);
+            RunSliced(height, 4, [&](int First, int Last)
+            {
+                BlendC4x4(src->m_buffer + src->m_offsets[plane],
+                          MythVideoFrame::GetWidthForPlane(src->m_type, src->m_width, plane),
+                          firstrow + First, lastrow(Last), src->m_pitches[plane],
+                          Frame->m_buffer + Frame->m_offsets[plane], Frame->m_pitches[plane],
+                          second);
+            });
         }
     }
     Frame->m_alreadyDeinterlaced = true;
@@ -1,9 +1,13 @@
 #ifndef MYTHDEINTERLACER_H
 #define MYTHDEINTERLACER_H
 
+// C++
+#include <functional>
+
 // MythTV
 #include "libmyth/mythavframe.h"
 
+#include "mythtvexp.h"
 #include "videoouttypes.h"
 #include "mythavutil.h"
 
@@ -13,8 +17,9 @@ extern "C" {
 }
 
 class MythVideoProfile;
+class MThreadPool;
 
-class MythDeinterlacer
+class MTV_PUBLIC MythDeinterlacer
 {
   public:
     MythDeinterlacer() = default;
@@ -22,6 +27,7 @@ class MythDeinterlacer
 
     void             Filter       (MythVideoFrame *Frame, FrameScanType Scan,
                                    MythVideoProfile *Profile, bool Force = false);
+    void             SetMaxThreads(uint Threads);
 
   private:
     Q_DISABLE_COPY(MythDeinterlacer)
@@ -31,7 +37,10 @@ class MythDeinterlacer
     inline void      Cleanup      ();
     void             OneField     (MythVideoFrame *Frame, FrameScanType Scan);
     void             Blend        (MythVideoFrame *Frame, FrameScanType Scan);
-    bool             SetUpCache   (MythVideoFrame *Frame);
+    void             MotionAdaptive(MythVideoFrame *Frame, FrameScanType Scan);
+    void             RunSliced    (int Rows, int Align, const std::function<void(int,int)>& Work);
+    static bool      SetUpCache   (MythVideoFrame *Frame, MythVideoFrame *&Cache);
+    static bool      UseNativeHigh(VideoFrameType Type);
 
     VideoFrameType   m_inputType  { FMT_NONE };
     AVPixelFormat    m_inputFmt   { AV_PIX_FMT_NONE };
@@ -45,7 +54,14 @@ class MythDeinterlacer
     AVFilterContext* m_source     { nullptr };
     AVFilterContext* m_sink       { nullptr };
     MythVideoFrame*  m_bobFrame   { nullptr };
-    SwsContext*      m_swsContext { nullptr };
+    MythVideoFrame*  m_prevFrame  { nullptr };
+    MythVideoFrame*  m_curFrame   { nullptr };
+    MythVideoFrame*  m_nextFrame  { nullptr };
+    bool             m_prevValid  { false };
+    int              m_history    { 0 };
+    int              m_threads    { 1 };
+    uint             m_maxThreads { 0 };
+    MThreadPool*     m_threadPool { nullptr };
     uint64_t         m_discontinuityCounter { 0 };
     bool             m_autoFieldOrder  { false };
     uint64_t         m_lastFieldChange { 0 };
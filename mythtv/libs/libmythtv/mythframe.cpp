@@ -1,6 +1,7 @@
 // MythTV
 #include "libmythbase/mythlogging.h"
 #include "mythframe.h"
+#include "mythframepool.h"
 #include "mythvideoprofile.h"
 
 // FFmpeg - for av_malloc/av_free
@@ -24,7 +25,7 @@ MythVideoFrame::~MythVideoFrame()
     if (m_buffer && HardwareFormat(m_type))
         LOG(VB_GENERAL, LOG_ERR, LOC + "Frame still contains a hardware buffer!");
     else if (m_buffer)
-        av_freep(reinterpret_cast<void*>(&m_buffer));
+        MythFramePool::Instance().Release(m_buffer);
 }
 
 MythVideoFrame::MythVideoFrame(VideoFrameType Type, int Width, int Height, const VideoFrameTypes* RenderFormats)
@@ -47,7 +48,7 @@ void MythVideoFrame::Init(VideoFrameType Type, int Width, int Height, const Vide
     {
         newsize = GetBufferSize(Type, Width, Height);
         bool reallocate = (Width != m_width) || (Height != m_height) || (newsize != m_bufferSize) || (Type != m_type);
-        newbuffer = reallocate ? GetAlignedBuffer(newsize) : m_buffer;
+        newbuffer = reallocate ? MythFramePool::Instance().Acquire(newsize) : m_buffer;
         newsize   = reallocate ? newsize : m_bufferSize;
     }
     Init(Type, newbuffer, newsize, Width, Height, (RenderFormats == nullptr) ? &kDefaultRenderFormats : RenderFormats);
@@ -76,8 +77,9 @@ void MythVideoFrame::Init(VideoFrameType Type, uint8_t *Buffer, size_t BufferSiz
 
     if (m_buffer && (m_buffer != Buffer))
     {
-        LOG(VB_GENERAL, LOG_DEBUG, LOC + "Deleting old frame buffer");
-        av_freep(reinterpret_cast<void*>(&m_buffer));
+        LOG(VB_GENERAL, LOG_DEBUG, LOC + "Releasing old frame buffer");
+        MythFramePool::Instance().Release(m_buffer);
+        m_buffer = nullptr;
     }
 
     m_type         = Type;
@@ -0,0 +1,221 @@
+// MythTV
+#include "libmythbase/mythlogging.h"
+#include "mythframepool.h"
+
+// Std
+#include <algorithm>
+
+#ifdef Q_OS_LINUX
+#include <sys/mman.h>
+#endif
+
+// FFmpeg - for av_malloc/av_free
+extern "C" {
+#include "libavutil/mem.h"
+}
+
+#define LOC QString("FramePool: ")
+
+/*! \class MythFramePool
+ * \brief Recycles the memory of software video frames.
+ *
+ * Requests are rounded up to a multiple of kSizeClass and released buffers are
+ * kept for reuse by a later request of the same class. A change of video size
+ * or format (channel changes, adverts in a different resolution) therefore
+ * only allocates once per distinct size and switching back costs nothing.
+ *
+ * Idle memory is limited to the peak amount handed out at once, i.e. one
+ * complete set of buffers for another format, with the oldest idle buffers
+ * freed first. Trim() releases everything idle. Trim(Bytes) releases the share
+ * of one user, e.g. a player that ends while others keep decoding.
+ *
+ * On Linux, buffers of kHugePageSize or more are mapped directly and advised
+ * for transparent huge pages, which cuts TLB misses when copying and
+ * deinterlacing large frames.
+ *
+ * Buffers released here that were not allocated by the pool are freed with
+ * av_free, so the pool can be used for any frame buffer from GetAlignedBuffer().
+*/
+MythFramePool& MythFramePool::Instance()
+{
+    static MythFramePool s_pool;
+    return s_pool;
+}
+
+MythFramePool::~MythFramePool()
+{
+    for (const auto & block : m_idle)
+        Free(block);
+}
+
+/// \brief Return a buffer of at least Size bytes (plus padding), 64 byte aligned.
+uint8_t* MythFramePool::Acquire(size_t Size)
+{
+    if (!Size)
+        return nullptr;
+
+    size_t capacity = Capacity(Size);
+
+    QMutexLocker locker(&m_lock);
+    Block block;
+    auto match = std::find_if(m_idle.rbegin(), m_idle.rend(),
+                              [capacity](const Block& Idle) { return Idle.m_capacity == capacity; });
+    if (match != m_idle.rend())
+    {
+        block = *match;
+        m_idle.erase(std::next(match).base());
+        m_stats.m_idle -= capacity;
+        m_stats.m_hits++;
+    }
+    else
+    {
+        block = Allocate(capacity);
+        if (!block.m_buffer)
+        {
+            LOG(VB_GENERAL, LOG_ERR, LOC + QString("Failed to allocate %1 bytes").arg(capacity));
+            return nullptr;
+        }
+        m_stats.m_misses++;
+    }
+
+    m_inUse.insert(block.m_buffer, block);
+    m_stats.m_inUse += capacity;
+    m_stats.m_peak = std::max(m_stats.m_peak, m_stats.m_inUse);
+    return block.m_buffer;
+}
+
+/// \brief Give Buffer back for reuse. Buffers not from Acquire() are freed.
+void MythFramePool::Release(uint8_t* Buffer)
+{
+    if (!Buffer)
+        return;
+
+    QMutexLocker locker(&m_lock);
+    auto it = m_inUse.find(Buffer);
+    if (it == m_inUse.end())
+    {
+        av_free(Buffer);
+        return;
+    }
+
+    m_idle.push_back(it.value());
+    m_stats.m_inUse -= it->m_capacity;
+    m_stats.m_idle  += it->m_capacity;
+    m_inUse.erase(it);
+    Limit();
+}
+
+/// \brief Free all idle buffers and restart peak tracking.
+void MythFramePool::Trim()
+{
+    QMutexLocker locker(&m_lock);
+    if (!m_idle.empty())
+    {
+        LOG(VB_PLAYBACK, LOG_INFO, LOC + QString("Freeing %1 idle buffers (%2)")
+            .arg(m_idle.size()).arg(m_stats.toString()));
+    }
+    for (const auto & block : m_idle)
+        Free(block);
+    m_idle.clear();
+    m_stats.m_idle = 0;
+    m_stats.m_peak = m_stats.m_inUse;
+}
+
+/*! \brief Free up to Bytes of idle memory and lower the peak by the same amount.
+ *
+ * The most recently released buffers go first, which are those of the user
+ * that just handed its buffers back. Idle buffers kept for other users stay.
+*/
+void MythFramePool::Trim(size_t Bytes)
+{
+    QMutexLocker locker(&m_lock);
+    size_t freed = 0;
+    while (!m_idle.empty() && (freed < Bytes))
+    {
+        const Block newest = m_idle.back();
+        m_idle.pop_back();
+        Free(newest);
+        m_stats.m_idle -= newest.m_capacity;
+        freed += newest.m_capacity;
+    }
+    if (freed)
+    {
+        LOG(VB_PLAYBACK, LOG_INFO, LOC + QString("Freed %1 bytes of idle buffers (%2)")
+            .arg(freed).arg(m_stats.toString()));
+    }
+    size_t peak = (m_stats.m_peak > Bytes) ? m_stats.m_peak - Bytes : 0;
+    m_stats.m_peak = std::max(peak, m_stats.m_inUse);
+}
+
+/// \brief The amount of memory Acquire() sets aside for a request of Size bytes.
+size_t MythFramePool::Capacity(size_t Size)
+{
+    // Same padding as MythVideoFrame::GetAlignedBuffer
+    return ((Size + 64 + kSizeClass - 1) / kSizeClass) * kSizeClass;
+}
+
+MythFramePool::Stats MythFramePool::GetStats() const
+{
+    QMutexLocker locker(&m_lock);
+    return m_stats;
+}
+
+QString MythFramePool::Stats::toString() const
+{
+    static constexpr double kMB { 1024.0 * 1024.0 };
+    return QString("hits %1 misses %2 trimmed %3 in use %4MB idle %5MB peak %6MB huge pages %7MB")
+        .arg(m_hits).arg(m_misses).arg(m_trimmed)
+        .arg(m_inUse / kMB, 0, 'f', 1).arg(m_idle / kMB, 0, 'f', 1)
+        .arg(m_peak / kMB, 0, 'f', 1).arg(m_hugePages / kMB, 0, 'f', 1);
+}
+
+MythFramePool::Block MythFramePool::Allocate(size_t Capacity)
+{
+    Block block;
+    block.m_capacity = Capacity;
+#if defined(Q_OS_LINUX) && defined(MADV_HUGEPAGE)
+    if (Capacity >= kHugePageSize)
+    {
+        void* mapped = mmap(nullptr, Capacity, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mapped != MAP_FAILED)
+        {
+            block.m_buffer = static_cast<uint8_t*>(mapped);
+            block.m_mapped = true;
+            // Not fatal - transparent huge pages may be disabled
+            block.m_huge = madvise(mapped, Capacity, MADV_HUGEPAGE) == 0;
+            if (block.m_huge)
+                m_stats.m_hugePages += Capacity;
+            return block;
+        }
+    }
+#endif
+    block.m_buffer = static_cast<uint8_t*>(av_malloc(Capacity));
+    return block;
+}
+
+void MythFramePool::Free(const Block& Old)
+{
+    if (Old.m_huge)
+        m_stats.m_hugePages -= Old.m_capacity;
+#ifdef Q_OS_LINUX
+    if (Old.m_mapped)
+    {
+        munmap(Old.m_buffer, Old.m_capacity);
+        return;
+    }
+#endif
+    av_free(Old.m_buffer);
+}
+
+/// \brief Free the oldest idle buffers until idle memory is no more than the peak in use.
+void MythFramePool::Limit()
+{
+    auto oldest = m_idle.begin();
+    for ( ; (oldest != m_idle.end()) && (m_stats.m_idle > m_stats.m_peak); ++oldest)
+    {
+        Free(*oldest);
+        m_stats.m_idle -= oldest->m_capacity;
+        m_stats.m_trimmed++;
+    }
+    m_idle.erase(m_idle.begin(), oldest);
+}
@@ -0,0 +1,69 @@
+#ifndef MYTHFRAMEPOOL_H
+#define MYTHFRAMEPOOL_H
+
+// Qt
+#include <QHash>
+#include <QMutex>
+#include <QString>
+
+// MythTV
+#include "libmythtv/mythtvexp.h"
+
+// Std
+#include <cstdint>
+#include <vector>
+
+class MTV_PUBLIC MythFramePool
+{
+  public:
+    struct Stats
+    {
+        uint64_t m_hits      { 0 }; ///< requests served from an idle buffer
+        uint64_t m_misses    { 0 }; ///< requests that needed a fresh allocation
+        uint64_t m_trimmed   { 0 }; ///< idle buffers freed to honour the limit
+        size_t   m_inUse     { 0 }; ///< bytes currently handed out
+        size_t   m_idle      { 0 }; ///< bytes held for reuse
+        size_t   m_peak      { 0 }; ///< most bytes handed out at once
+        size_t   m_hugePages { 0 }; ///< bytes (in use or idle) advised for huge pages
+
+        QString toString() const;
+    };
+
+    static MythFramePool& Instance();
+
+    MythFramePool() = default;
+   ~MythFramePool();
+
+    uint8_t* Acquire (size_t Size);
+    void     Release (uint8_t* Buffer);
+    void     Trim    ();
+    void     Trim    (size_t Bytes);
+    Stats    GetStats() const;
+
+    static size_t Capacity(size_t Size);
+
+    static constexpr size_t kSizeClass    { 64 * 1024 };
+    static constexpr size_t kHugePageSize { 2 * 1024 * 1024 };
+
+  private:
+    Q_DISABLE_COPY(MythFramePool)
+
+    struct Block
+    {
+        uint8_t* m_buffer   { nullptr };
+        size_t   m_capacity { 0 };
+        bool     m_mapped   { false };
+        bool     m_huge     { false };
+    };
+
+    Block        Allocate(size_t Capacity);
+    void         Free(const Block& Old);
+    void         Limit();
+
+    mutable QMutex        m_lock;
+    QHash<uint8_t*,Block> m_inUse;
+    std::vector<Block>    m_idle;   ///< oldest first
+    Stats                 m_stats;
+};
+
+#endif
@@ -825,6 +825,7 @@ void MythPlayerUI::GetPlaybackData(InfoMap& Map)
     Map.insert("decoderrate", m_playerCtx->m_buffer->GetDecoderRate());
     Map.insert("storagerate", m_playerCtx->m_buffer->GetStorageRate());
     Map.insert("bufferavail", m_playerCtx->m_buffer->GetAvailableBuffer());
+    Map.insert("bufferstats", m_playerCtx->m_buffer->GetReadAheadStats());
     Map.insert("buffersize",  QString::number(m_playerCtx->m_buffer->GetBufferSize() >> 20));
     m_avSync.GetAVSyncData(Map);
 
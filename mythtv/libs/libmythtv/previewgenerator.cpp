@@ -16,6 +16,7 @@
 #include <QImage>
 #include <QMetaType>
 #include <QTemporaryFile>
+#include <QThread>
 #include <QUrl>
 
 // MythTV headers
@@ -213,9 +214,10 @@ bool PreviewGenerator::Run(void)
     QElapsedTimer te; te.start();
     bool ok = false;
     QString command = GetAppBinDir() + "mythpreviewgen";
+    bool in_process = (m_mode & kInProcess) != 0;
     bool local_ok = ((IsLocal() || ((m_mode & kForceLocal) != 0)) &&
                      ((m_mode & kLocal) != 0) &&
-                     QFileInfo(command).isExecutable());
+                     (in_process || QFileInfo(command).isExecutable()));
     if (!local_ok)
     {
         if (!!(m_mode & kRemote))
@@ -237,6 +239,26 @@ bool PreviewGenerator::Run(void)
             msg = "Failed, local preview requested for remote file.";
         }
     }
+    else if (in_process)
+    {
+        // Decode in this thread instead of paying for a new process,
+        // database connection and player setup for every preview.
+        if (QThread::currentThread() == qthread())
+            qthread()->setPriority(QThread::LowPriority);
+
+        ok = LocalPreviewRun();
+        if (ok)
+        {
+            msg = QString("Generated on %1 in %2 seconds, starting at %3")
+                .arg(gCoreContext->GetHostName())
+                .arg(te.elapsed()*0.001)
+                .arg(tm.toString(Qt::ISODate));
+        }
+        else
+        {
+            msg = "Failed to generate preview in process.";
+        }
+    }
     else
     {
         // This is where we fork and run mythpreviewgen to actually make preview
@@ -45,6 +45,7 @@ class MTV_PUBLIC PreviewGenerator : public QObject, public MThread
         kLocalAndRemote = 0x3,
         kForceLocal     = 0x5,
         kModeMask       = 0x7,
+        kInProcess      = 0x8, ///< generate local previews without forking
     };
 
   public:
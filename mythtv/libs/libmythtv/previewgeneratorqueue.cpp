@@ -87,6 +87,10 @@ PreviewGeneratorQueue::PreviewGeneratorQueue(
     {
         int idealThreads = QThread::idealThreadCount();
         m_maxThreads = (idealThreads >= 1) ? idealThreads * 2 : 2;
+        // In process generators all decode inside this process, so don't
+        // oversubscribe the CPUs with them.
+        if ((PreviewGenerator::kInProcess & mode) && (idealThreads >= 1))
+            m_maxThreads = idealThreads;
     }
 
     moveToThread(qthread());
@@ -335,6 +339,27 @@ bool PreviewGeneratorQueue::event(QEvent *e)
             }
 
             m_running = (m_running > 0) ? m_running - 1 : 0;
+
+            if (me->Message() == "PREVIEW_SUCCESS")
+                m_generated++;
+            else
+                m_failed++;
+
+            if (m_queue.empty() && (m_running == 0) && m_busyTimer.isValid())
+            {
+                auto secs = m_busyTimer.elapsed() * 0.001;
+                LOG(VB_PLAYBACK, LOG_INFO, LOC +
+                    QString("Generated %1 previews (%2 failed) in %3 seconds, "
+                            "%4 per minute, peak queue depth %5")
+                        .arg(m_generated).arg(m_failed).arg(secs, 0, 'f', 1)
+                        .arg((secs > 0) ? (m_generated + m_failed) * 60 / secs : 0,
+                             0, 'f', 1)
+                        .arg(m_peakQueue));
+                m_generated = 0;
+                m_failed = 0;
+                m_peakQueue = 0;
+                m_busyTimer.invalidate();
+            }
         }
 
         UpdatePreviewGeneratorThreads();
@@ -656,7 +681,13 @@ void PreviewGeneratorQueue::UpdatePreviewGeneratorThreads(void)
 {
     QMutexLocker locker(&m_lock);
     QStringList &q = m_queue;
-    if (!q.empty() && (m_running < m_maxThreads))
+    if (!q.empty() && !m_busyTimer.isValid())
+        m_busyTimer.start();
+    m_peakQueue = std::max(m_peakQueue, static_cast<uint>(q.size()));
+
+    // Fill every free slot, not just one, so a burst of requests
+    // doesn't wait for earlier previews to finish before starting.
+    while (!q.empty() && (m_running < m_maxThreads))
     {
         QString fn = q.back();
         q.pop_back();
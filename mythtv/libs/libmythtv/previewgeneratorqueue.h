@@ -4,6 +4,7 @@
 
 #include <QStringList>
 #include <QDateTime>
+#include <QElapsedTimer>
 #include <QMutex>
 #include <QMap>
 #include <QSet>
@@ -148,6 +149,13 @@ class MTV_PUBLIC PreviewGeneratorQueue : public QObject, public MThread
     /// The maximum number of threads that may concurrently generate
     /// previews.
     uint                   m_maxThreads {2};
+    /// Previews generated, and failed, since the queue last ran dry.
+    uint                   m_generated  {0};
+    uint                   m_failed     {0};
+    /// The longest the queue got since it last ran dry.
+    uint                   m_peakQueue  {0};
+    /// Started when the queue goes from idle to busy.
+    QElapsedTimer          m_busyTimer;
     /// How many times total will the code attempt to generate a
     /// preview for a specific file, before giving up and ignoring all
     /// future requests.
@@ -6,6 +6,8 @@
 #include <utility>
 
 // Qt includes
+#include <QHash>
+#include <QMutex>
 #include <QtGlobal> // for qAbs
 
 // MythTV headers
@@ -18,6 +20,31 @@
 
 #define LOC      QString("ProgramData: ")
 
+// Maximum number of rows in one multi-row INSERT
+static constexpr int kMaxRowsPerInsert { 100 };
+
+// People and roles are never renumbered, so remember the ids that were
+// already looked up instead of asking the database for every credit.
+static constexpr int kMaxCachedNames { 100000 };
+static QMutex              s_nameCacheLock;
+static QHash<QString,uint> s_personCache; // protected by s_nameCacheLock
+static QHash<QString,uint> s_roleCache;   // protected by s_nameCacheLock
+
+static uint get_cached_id(const QHash<QString,uint> &cache, const QString &name)
+{
+    QMutexLocker locker(&s_nameCacheLock);
+    return cache.value(name, 0);
+}
+
+static void set_cached_id(QHash<QString,uint> &cache, const QString &name,
+                          uint id)
+{
+    QMutexLocker locker(&s_nameCacheLock);
+    if (cache.size() >= kMaxCachedNames)
+        cache.clear();
+    cache.insert(name, id);
+}
+
 static const std::array<const std::string,DBPerson::kGuest+1> roles
 {
     "",
@@ -40,21 +67,55 @@ static void add_genres(MSqlQuery &query, const QStringList &genres,
                 uint chanid, const QDateTime &starttime)
 {
     QString relevance = QString("0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ");
-    for (auto it = genres.constBegin(); (it != genres.constEnd()) &&
-             ((it - genres.constBegin()) < relevance.size()); ++it)
+    int count = std::min<int>(genres.size(), relevance.size());
+    if (count <= 0)
+        return;
+
+    QStringList rows;
+    for (int i = 0; i < count; ++i)
+        rows << QString("(:CHANID, :START, :GENRE%1, :RELEVANCE%1)").arg(i);
+
+    query.prepare(
+       "INSERT INTO programgenres "
+       "       ( chanid,  starttime, genre,  relevance) "
+       "VALUES " + rows.join(", "));
+    query.bindValue(":CHANID",    chanid);
+    query.bindValue(":START",     starttime);
+    for (int i = 0; i < count; ++i)
     {
-        query.prepare(
-           "INSERT INTO programgenres "
-           "       ( chanid,  starttime, genre,  relevance) "
-           "VALUES (:CHANID, :START,    :genre, :relevance)");
-        query.bindValue(":CHANID",    chanid);
-        query.bindValue(":START",     starttime);
-        query.bindValue(":genre",     *it);
-        query.bindValue(":relevance", relevance.at(it - genres.constBegin()));
+        query.bindValue(QString(":GENRE%1").arg(i),     genres[i]);
+        query.bindValue(QString(":RELEVANCE%1").arg(i), relevance.at(i));
+    }
 
-        if (!query.exec())
-            MythDB::DBError("programgenres insert", query);
+    if (!query.exec())
+        MythDB::DBError("programgenres insert", query);
+}
+
+static void add_ratings(MSqlQuery &query, const QString &table,
+                        const QList<EventRating> &ratings,
+                        uint chanid, const QDateTime &starttime)
+{
+    if (ratings.isEmpty())
+        return;
+
+    QStringList rows;
+    for (int i = 0; i < ratings.size(); ++i)
+        rows << QString("(:CHANID, :START, :SYS%1, :RATING%1)").arg(i);
+
+    query.prepare(QString(
+        "INSERT IGNORE INTO %1 "
+        "       ( chanid, starttime, `system`, rating) "
+        "VALUES ").arg(table) + rows.join(", "));
+    query.bindValue(":CHANID", chanid);
+    query.bindValue(":START",  starttime);
+    for (int i = 0; i < ratings.size(); ++i)
+    {
+        query.bindValue(QString(":SYS%1").arg(i),    ratings[i].m_system);
+        query.bindValue(QString(":RATING%1").arg(i), ratings[i].m_rating);
     }
+
+    if (!query.exec())
+        MythDB::DBError(QString("%1 insert").arg(table), query);
 }
 
 DBPerson::DBPerson(const DBPerson &other)
@@ -143,8 +204,83 @@ uint DBPerson::InsertDB(MSqlQuery &query, uint chanid,
                            starttime, recording);
 }
 
+/** \brief Inserts all \a credits of one program with a single query.
+ *
+ *  The person and role ids are looked up as in InsertDB(), but are
+ *  usually found in the in-memory cache.
+ *
+ *  \return number of credits inserted
+ */
+uint DBPerson::InsertDB(MSqlQuery &query, const DBCredits &credits,
+                        uint chanid, const QDateTime &starttime,
+                        bool recording)
+{
+    QString table = recording ? "recordedcredits" : "credits";
+    uint count = 0;
+
+    for (size_t first = 0; first < credits.size(); first += kMaxRowsPerInsert)
+    {
+        size_t last = std::min(credits.size(), first + kMaxRowsPerInsert);
+
+        struct Row { const DBPerson *credit; uint personid; uint roleid; };
+        std::vector<Row> rows;
+        for (size_t i = first; i < last; ++i)
+        {
+            const DBPerson &credit = credits[i];
+            uint personid = credit.GetPersonDB(query);
+            if (!personid && credit.InsertPersonDB(query))
+                personid = credit.GetPersonDB(query);
+            if (!personid)
+                continue;
+
+            uint roleid = 0;
+            if (!credit.m_character.isEmpty())
+            {
+                roleid = credit.GetRoleDB(query);
+                if (!roleid && credit.InsertRoleDB(query))
+                    roleid = credit.GetRoleDB(query);
+            }
+            rows.push_back({&credit, personid, roleid});
+        }
+
+        if (rows.empty())
+            continue;
+
+        QStringList values;
+        for (size_t i = 0; i < rows.size(); ++i)
+        {
+            values << QString("(:PERSON%1, :ROLEID%1, :CHANID, :STARTTIME, "
+                              ":ROLE%1, :PRIORITY%1)").arg(i);
+        }
+
+        query.prepare(QString("REPLACE INTO %1 "
+            "       ( person,  roleid,  chanid,  starttime,  role, priority) "
+            "VALUES ").arg(table) + values.join(", "));
+        query.bindValue(":CHANID",    chanid);
+        query.bindValue(":STARTTIME", starttime);
+        for (size_t i = 0; i < rows.size(); ++i)
+        {
+            query.bindValue(QString(":PERSON%1").arg(i),   rows[i].personid);
+            query.bindValue(QString(":ROLEID%1").arg(i),   rows[i].roleid);
+            query.bindValue(QString(":ROLE%1").arg(i),     rows[i].credit->GetRole());
+            query.bindValue(QString(":PRIORITY%1").arg(i), rows[i].credit->m_priority);
+        }
+
+        if (query.exec())
+            count += rows.size();
+        else
+            MythDB::DBError("insert_credits", query);
+    }
+
+    return count;
+}
+
 uint DBPerson::GetPersonDB(MSqlQuery &query) const
 {
+    uint personid = get_cached_id(s_personCache, m_name);
+    if (personid)
+        return personid;
+
     query.prepare(
         "SELECT person "
         "FROM people "
@@ -152,9 +288,15 @@ uint DBPerson::GetPersonDB(MSqlQuery &query) const
     query.bindValue(":NAME", m_name);
 
     if (!query.exec())
+    {
         MythDB::DBError("get_person", query);
+    }
     else if (query.next())
-        return query.value(0).toUInt();
+    {
+        personid = query.value(0).toUInt();
+        set_cached_id(s_personCache, m_name, personid);
+        return personid;
+    }
 
     return 0;
 }
@@ -175,6 +317,10 @@ uint DBPerson::InsertPersonDB(MSqlQuery &query) const
 
 uint DBPerson::GetRoleDB(MSqlQuery &query) const
 {
+    uint roleid = get_cached_id(s_roleCache, m_character);
+    if (roleid)
+        return roleid;
+
     query.prepare(
         "SELECT roleid "
         "FROM roles "
@@ -182,7 +328,11 @@ uint DBPerson::GetRoleDB(MSqlQuery &query) const
     query.bindValue(":NAME", m_character);
 
     if (query.exec() && query.next())
-        return query.value(0).toUInt();
+    {
+        roleid = query.value(0).toUInt();
+        set_cached_id(s_roleCache, m_character, roleid);
+        return roleid;
+    }
 
     return 0;
 }
@@ -893,25 +1043,9 @@ uint DBEvent::UpdateDB(
     }
 
     if (m_credits)
-    {
-        for (auto & credit : *m_credits)
-            credit.InsertDB(query, chanid, m_starttime);
-    }
+        DBPerson::InsertDB(query, *m_credits, chanid, m_starttime);
 
-    for (const auto & rating : std::as_const(m_ratings))
-    {
-        query.prepare(
-            "INSERT IGNORE INTO programrating "
-            "       ( chanid, starttime, `system`, rating) "
-            "VALUES (:CHANID, :START,    :SYS,  :RATING)");
-        query.bindValue(":CHANID", chanid);
-        query.bindValue(":START",  m_starttime);
-        query.bindValue(":SYS",    rating.m_system);
-        query.bindValue(":RATING", rating.m_rating);
-
-        if (!query.exec())
-            MythDB::DBError("programrating insert", query);
-    }
+    add_ratings(query, "programrating", m_ratings, chanid, m_starttime);
 
     add_genres(query, m_genres, chanid, m_starttime);
 
@@ -1203,26 +1337,10 @@ uint DBEvent::InsertDB(MSqlQuery &query, uint chanid,
     }
 
     table = recording ? "recordedrating" : "programrating";
-    for (const auto & rating : std::as_const(m_ratings))
-    {
-        query.prepare(QString(
-            "INSERT IGNORE INTO %1 "
-            "       ( chanid, starttime, `system`, rating) "
-            "VALUES (:CHANID, :START,    :SYS,  :RATING)").arg(table));
-        query.bindValue(":CHANID", chanid);
-        query.bindValue(":START",  m_starttime);
-        query.bindValue(":SYS",    rating.m_system);
-        query.bindValue(":RATING", rating.m_rating);
-
-        if (!query.exec())
-            MythDB::DBError("programrating insert", query);
-    }
+    add_ratings(query, table, m_ratings, chanid, m_starttime);
 
     if (m_credits)
-    {
-        for (auto & credit : *m_credits)
-            credit.InsertDB(query, chanid, m_starttime, recording);
-    }
+        DBPerson::InsertDB(query, *m_credits, chanid, m_starttime, recording);
 
     add_genres(query, m_genres, chanid, m_starttime);
 
@@ -1375,26 +1493,10 @@ uint ProgInfo::InsertDB(MSqlQuery &query, uint chanid,
     }
 
     table = recording ? "recordedrating" : "programrating";
-    for (const auto & rating : m_ratings)
-    {
-        query.prepare(QString("INSERT IGNORE INTO %1 "
-                              "       ( chanid, starttime, `system`, rating) "
-                              "VALUES (:CHANID, :START,    :SYS,  :RATING)")
-                      .arg(table));
-        query.bindValue(":CHANID", chanid);
-        query.bindValue(":START",  m_starttime);
-        query.bindValue(":SYS",    rating.m_system);
-        query.bindValue(":RATING", rating.m_rating);
-
-        if (!query.exec())
-            MythDB::DBError(QString("%1 insert").arg(table), query);
-    }
+    add_ratings(query, table, m_ratings, chanid, m_starttime);
 
     if (m_credits)
-    {
-        for (auto & credit : *m_credits)
-            credit.InsertDB(query, chanid, m_starttime, recording);
-    }
+        DBPerson::InsertDB(query, *m_credits, chanid, m_starttime, recording);
 
     add_genres(query, m_genres, chanid, m_starttime);
 
@@ -1620,9 +1722,25 @@ void ProgramData::HandlePrograms(MSqlQuery             &query,
                                  uint &unchanged,
                                  uint &updated)
 {
+    // Compare against what is already in the database with one query
+    // per channel, and only fall back to a query per program on error.
+    QHash<QDateTime,QString> existing;
+    bool haveExisting = GetExisting(query, chanid, sortlist, existing);
+
     for (auto *pinfo : std::as_const(sortlist))
     {
-        if (IsUnchanged(query, chanid, *pinfo))
+        bool same = false;
+        if (haveExisting)
+        {
+            auto it = existing.constFind(pinfo->m_starttime);
+            same = (it != existing.constEnd()) && (*it == Signature(*pinfo));
+        }
+        else
+        {
+            same = IsUnchanged(query, chanid, *pinfo);
+        }
+
+        if (same)
         {
             unchanged++;
             continue;
@@ -1696,6 +1814,117 @@ int ProgramData::fix_end_times(void)
     return count;
 }
 
+/// Returns the fields compared by IsUnchanged() as a single string
+QString ProgramData::Signature(const ProgInfo &pi)
+{
+    return QStringList {
+        QString::number(pi.m_endtime.toSecsSinceEpoch()),
+        denullify(pi.m_title),
+        denullify(pi.m_subtitle),
+        denullify(pi.m_description),
+        denullify(pi.m_category),
+        myth_category_type_to_string(pi.m_categoryType),
+        QString::number(pi.m_airdate),
+        QString::number(pi.m_stars, 'f', 3),
+        QString::number(static_cast<int>(pi.m_previouslyshown)),
+        denullify(pi.m_title_pronounce),
+        QString::number(pi.m_audioProps),
+        QString::number(pi.m_videoProps),
+        QString::number(pi.m_subtitleType),
+        QString::number(pi.m_partnumber),
+        QString::number(pi.m_parttotal),
+        denullify(pi.m_seriesId),
+        denullify(pi.m_showtype),
+        denullify(pi.m_colorcode),
+        denullify(pi.m_syndicatedepisodenumber),
+        denullify(pi.m_programId),
+        QString::number(pi.m_season),
+        QString::number(pi.m_episode),
+        QString::number(pi.m_totalepisodes),
+        denullify(pi.m_inetref) }.join(QChar(0x1f));
+}
+
+/**
+ *  \brief Loads the signatures of the programs already in the database
+ *  for \a chanid in the time span covered by \a sortlist.
+ *
+ *  \return false if the query failed
+ */
+bool ProgramData::GetExisting(MSqlQuery &query, uint chanid,
+                              const QList<ProgInfo*> &sortlist,
+                              QHash<QDateTime,QString> &existing)
+{
+    if (sortlist.isEmpty())
+        return true;
+
+    QDateTime first = sortlist.front()->m_starttime;
+    QDateTime last = first;
+    for (const auto *pinfo : std::as_const(sortlist))
+    {
+        first = std::min(first, pinfo->m_starttime);
+        last = std::max(last, pinfo->m_starttime);
+    }
+
+    query.prepare(
+        "SELECT starttime,       endtime,       title, "
+        "       subtitle,        description,   category, "
+        "       category_type,   airdate,       stars, "
+        "       previouslyshown, title_pronounce, "
+        "       audioprop+0,     videoprop+0,   subtitletypes+0, "
+        "       partnumber,      parttotal,     seriesid, "
+        "       showtype,        colorcode,     syndicatedepisodenumber, "
+        "       programid,       season,        episode, "
+        "       totalepisodes,   inetref "
+        "FROM program "
+        "WHERE chanid     = :CHANID AND "
+        "      manualid   = 0       AND "
+        "      starttime >= :FIRST  AND "
+        "      starttime <= :LAST");
+    query.bindValue(":CHANID", chanid);
+    query.bindValue(":FIRST",  first);
+    query.bindValue(":LAST",   last);
+
+    if (!query.exec())
+    {
+        MythDB::DBError("ProgramData::GetExisting", query);
+        return false;
+    }
+
+    while (query.next())
+    {
+        ProgInfo pi;
+        pi.m_starttime       = MythDate::as_utc(query.value(0).toDateTime());
+        pi.m_endtime         = MythDate::as_utc(query.value(1).toDateTime());
+        pi.m_title           = query.value(2).toString();
+        pi.m_subtitle        = query.value(3).toString();
+        pi.m_description     = query.value(4).toString();
+        pi.m_category        = query.value(5).toString();
+        pi.m_categoryType    =
+            string_to_myth_category_type(query.value(6).toString());
+        pi.m_airdate         = query.value(7).toUInt();
+        pi.m_stars           = query.value(8).toFloat();
+        pi.m_previouslyshown = query.value(9).toBool();
+        pi.m_title_pronounce = query.value(10).toString();
+        pi.m_audioProps      = query.value(11).toUInt();
+        pi.m_videoProps      = query.value(12).toUInt();
+        pi.m_subtitleType    = query.value(13).toUInt();
+        pi.m_partnumber      = query.value(14).toUInt();
+        pi.m_parttotal       = query.value(15).toUInt();
+        pi.m_seriesId        = query.value(16).toString();
+        pi.m_showtype        = query.value(17).toString();
+        pi.m_colorcode       = query.value(18).toString();
+        pi.m_syndicatedepisodenumber = query.value(19).toString();
+        pi.m_programId       = query.value(20).toString();
+        pi.m_season          = query.value(21).toUInt();
+        pi.m_episode         = query.value(22).toUInt();
+        pi.m_totalepisodes   = query.value(23).toUInt();
+        pi.m_inetref         = query.value(24).toString();
+        existing.insert(pi.m_starttime, Signature(pi));
+    }
+
+    return true;
+}
+
 bool ProgramData::IsUnchanged(
     MSqlQuery &query, uint chanid, const ProgInfo &pi)
 {
@@ -9,6 +9,7 @@
 // Qt headers
 #include <QString>
 #include <QDateTime>
+#include <QHash>
 #include <QList>
 #include <QMap>
 #include <QStringList>
@@ -54,6 +55,9 @@ class MTV_PUBLIC DBPerson
     uint InsertDB(MSqlQuery &query, uint chanid,
                   const QDateTime &starttime,
                   bool recording = false) const;
+    static uint InsertDB(MSqlQuery &query, const std::vector<DBPerson> &credits,
+                         uint chanid, const QDateTime &starttime,
+                         bool recording = false);
 
   private:
     uint GetPersonDB(MSqlQuery &query) const;
@@ -276,6 +280,10 @@ class MTV_PUBLIC ProgramData
         uint &unchanged, uint &updated);
     static bool IsUnchanged(
         MSqlQuery &query, uint chanid, const ProgInfo &pi);
+    static bool GetExisting(
+        MSqlQuery &query, uint chanid, const QList<ProgInfo*> &sortlist,
+        QHash<QDateTime,QString> &existing);
+    static QString Signature(const ProgInfo &pi);
     static bool DeleteOverlaps(
         MSqlQuery &query, uint chanid, const ProgInfo &pi);
 };
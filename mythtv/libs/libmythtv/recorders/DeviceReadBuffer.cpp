@@ -18,6 +18,11 @@
 #include <sys/poll.h>
 #endif
 
+#if defined(__linux__) && !defined(Q_OS_ANDROID)
+#include <sys/mman.h>
+#define USING_MIRRORED_RING 1 // NOLINT(cppcoreguidelines-macro-usage)
+#endif
+
 #ifdef _WIN32
 void DeviceReadBuffer::setup_pipe(pipe_fd_array&, pipe_flag_array&) {}
 #else
@@ -82,11 +87,84 @@ DeviceReadBuffer::DeviceReadBuffer(
 DeviceReadBuffer::~DeviceReadBuffer()
 {
     Stop();
-    if (m_buffer)
+    FreeBuffer();
+}
+
+/** \fn DeviceReadBuffer::AllocateBuffer(size_t, size_t)
+ *  \brief Allocates the ring memory.
+ *
+ *   Where possible the ring is built from two adjacent mappings of the
+ *   same memory, so that the bytes past m_endPtr are the bytes at the
+ *   start of the ring. Otherwise a plain allocation with \a overflow
+ *   spare bytes at the end is used, and writes past the end of the ring
+ *   are copied back to the start.
+ *
+ *  \note m_size may be rounded up to a page multiple for the mirrored ring.
+ */
+bool DeviceReadBuffer::AllocateBuffer(size_t size, size_t overflow)
+{
+    FreeBuffer();
+
+#ifdef USING_MIRRORED_RING
+    auto page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t mirror_size = ((size + page - 1) / page) * page;
+    int memfd = memfd_create("DeviceReadBuffer", MFD_CLOEXEC);
+    if (memfd >= 0)
     {
-        delete[] m_buffer;
-        m_buffer = nullptr;
+        void *base = MAP_FAILED;
+        if (ftruncate(memfd, static_cast<off_t>(mirror_size)) == 0)
+        {
+            // Reserve the address range, then map the memory twice into it
+            base = mmap(nullptr, 2 * mirror_size, PROT_NONE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        }
+        if (base != MAP_FAILED)
+        {
+            auto *lower = static_cast<unsigned char*>(base);
+            void *first = mmap(lower, mirror_size, PROT_READ | PROT_WRITE,
+                               MAP_SHARED | MAP_FIXED, memfd, 0);
+            void *second = mmap(lower + mirror_size, mirror_size,
+                                PROT_READ | PROT_WRITE,
+                                MAP_SHARED | MAP_FIXED, memfd, 0);
+            if (first != MAP_FAILED && second != MAP_FAILED)
+            {
+                ::close(memfd);
+                m_buffer    = lower;
+                m_size      = mirror_size;
+                m_allocSize = 2 * mirror_size;
+                m_mirrored  = true;
+                return true;
+            }
+            munmap(base, 2 * mirror_size);
+        }
+        ::close(memfd);
     }
+    LOG(VB_RECORD, LOG_INFO, LOC +
+        "Could not map mirrored ring, using plain buffer" + ENO);
+#endif
+
+    m_buffer    = new (std::nothrow) unsigned char[size + overflow];
+    m_size      = size;
+    m_allocSize = size + overflow;
+    m_mirrored  = false;
+    return m_buffer != nullptr;
+}
+
+void DeviceReadBuffer::FreeBuffer(void)
+{
+    if (!m_buffer)
+        return;
+
+#ifdef USING_MIRRORED_RING
+    if (m_mirrored)
+        munmap(m_buffer, m_allocSize);
+    else
+#endif
+        delete[] m_buffer;
+
+    m_buffer    = nullptr;
+    m_allocSize = 0;
+    m_mirrored  = false;
 }
 
 bool DeviceReadBuffer::Setup(const QString &streamName, int streamfd,
@@ -95,8 +173,6 @@ bool DeviceReadBuffer::Setup(const QString &streamName, int streamfd,
 {
     QMutexLocker locker(&m_lock);
 
-    delete[] m_buffer;
-
     m_videoDevice   = streamName;
     m_videoDevice   = m_videoDevice.isNull() ? "" : m_videoDevice;
     m_streamFd      = streamfd;
@@ -109,7 +185,7 @@ bool DeviceReadBuffer::Setup(const QString &streamName, int streamfd,
 
     m_readQuanta   = (readQuanta) ? readQuanta : m_readQuanta;
     m_devBufferCount = deviceBufferCount;
-    m_size          = gCoreContext->GetNumSetting(
+    size_t size     = gCoreContext->GetNumSetting(
         "HDRingbufferSize", static_cast<int>(50 * m_readQuanta)) * 1024_UZ;
     m_used          = 0;
     m_devReadSize = m_readQuanta * (m_usingPoll ? 256 : 48);
@@ -117,21 +193,21 @@ bool DeviceReadBuffer::Setup(const QString &streamName, int streamfd,
         std::min(m_devReadSize, (size_t)deviceBufferSize) : m_devReadSize;
     m_readThreshold = m_readQuanta * 128;
 
-    m_buffer        = new (std::nothrow) unsigned char[m_size + m_devReadSize];
-    m_readPtr       = m_buffer;
-    m_writePtr      = m_buffer;
-
     // Initialize buffer, if it exists
-    if (!m_buffer)
+    if (!AllocateBuffer(size, m_devReadSize))
     {
-        m_endPtr = nullptr;
+        m_readPtr  = nullptr;
+        m_writePtr = nullptr;
+        m_endPtr   = nullptr;
         LOG(VB_GENERAL, LOG_ERR, LOC +
             QString("Failed to allocate buffer of size %1 = %2 + %3")
-                .arg(m_size+m_devReadSize).arg(m_size).arg(m_devReadSize));
+                .arg(size+m_devReadSize).arg(size).arg(m_devReadSize));
         return false;
     }
-    m_endPtr = m_buffer + m_size;
-    memset(m_buffer, 0xFF, m_size + m_readQuanta);
+    m_readPtr       = m_buffer;
+    m_writePtr      = m_buffer;
+    m_endPtr        = m_buffer + m_size;
+    memset(m_buffer, 0xFF, m_mirrored ? m_size : m_size + m_readQuanta);
 
     // Initialize statistics
     m_maxUsed        = 0;
@@ -141,7 +217,8 @@ bool DeviceReadBuffer::Setup(const QString &streamName, int streamfd,
     m_avgBufSleepCnt = 0;
     m_lastReport.start();
 
-    LOG(VB_RECORD, LOG_INFO, LOC + QString("buffer size %1 KB").arg(m_size/1024));
+    LOG(VB_RECORD, LOG_INFO, LOC + QString("buffer size %1 KB%2")
+        .arg(m_size/1024).arg(m_mirrored ? " (mirrored)" : ""));
 
     return true;
 }
@@ -302,42 +379,50 @@ bool DeviceReadBuffer::IsRunning(void) const
 
 uint DeviceReadBuffer::GetUnused(void) const
 {
-    QMutexLocker locker(&m_lock);
-    return m_size - m_used;
+    return m_size - m_used.load();
 }
 
 uint DeviceReadBuffer::GetUsed(void) const
 {
-    QMutexLocker locker(&m_lock);
-    return m_used;
+    return m_used.load();
 }
 
 uint DeviceReadBuffer::GetContiguousUnused(void) const
 {
-    QMutexLocker locker(&m_lock);
+    if (m_mirrored)
+        return GetUnused();
     return m_endPtr - m_writePtr;
 }
 
+/// Publishes \a len bytes written at m_writePtr to the reader.
+/// Only called from the device thread.
 void DeviceReadBuffer::IncrWritePointer(uint len)
 {
-    QMutexLocker locker(&m_lock);
-    m_used     += len;
     m_writePtr += len;
     m_writePtr  = (m_writePtr >= m_endPtr) ? m_buffer + (m_writePtr - m_endPtr) : m_writePtr;
+    size_t used = m_used.fetch_add(len) + len;
 #if REPORT_RING_STATS
-    m_maxUsed = std::max(m_used, m_maxUsed);
-    m_avgUsed = ((m_avgUsed * m_avgBufWriteCnt) + m_used) / (m_avgBufWriteCnt+1);
+    m_maxUsed = std::max(used, m_maxUsed);
+    m_avgUsed = ((m_avgUsed * m_avgBufWriteCnt) + used) / (m_avgBufWriteCnt+1);
     ++m_avgBufWriteCnt;
+#else
+    (void)used;
 #endif
-    m_dataWait.wakeAll();
+    // Only take the lock if the reader is actually sleeping
+    if (m_readerWaiting.load())
+    {
+        QMutexLocker locker(&m_lock);
+        m_dataWait.wakeAll();
+    }
 }
 
+/// Releases \a len bytes at m_readPtr back to the writer.
+/// Only called from the reading thread.
 void DeviceReadBuffer::IncrReadPointer(uint len)
 {
-    QMutexLocker locker(&m_lock);
-    m_used    -= len;
     m_readPtr += len;
-    m_readPtr  = (m_readPtr == m_endPtr) ? m_buffer : m_readPtr;
+    m_readPtr  = (m_readPtr >= m_endPtr) ? m_buffer + (m_readPtr - m_endPtr) : m_readPtr;
+    m_used.fetch_sub(len);
 #if REPORT_RING_STATS
     ++m_avgBufReadCnt;
 #endif
@@ -401,8 +486,8 @@ void DeviceReadBuffer::run(void)
                 errcnt = 0;
 
                 // if we wrote past the official end of the buffer,
-                // copy to start
-                if (m_writePtr + read_len > m_endPtr)
+                // copy to start (the mirrored ring does this for us)
+                if (!m_mirrored && m_writePtr + read_len > m_endPtr)
                     memcpy(m_buffer, m_endPtr, m_writePtr + read_len - m_endPtr);
                 IncrWritePointer(read_len);
                 total += read_len;
@@ -664,7 +749,7 @@ uint DeviceReadBuffer::Read(unsigned char *buf, const uint count)
     if (!cnt)
         return 0;
 
-    if (m_readPtr + cnt > m_endPtr)
+    if (!m_mirrored && m_readPtr + cnt > m_endPtr)
     {
         // Process as two pieces
         size_t len = m_endPtr - m_readPtr;
@@ -729,15 +814,25 @@ uint DeviceReadBuffer::WaitForUsed(uint needed, std::chrono::milliseconds max_wa
     MythTimer timer;
     timer.start();
 
+    // Fast path, enough data is already buffered
+    size_t avail = GetUsed();
+    if (needed <= avail)
+        return avail;
+
     QMutexLocker locker(&m_lock);
-    size_t avail = m_used;
+    m_readerWaiting = true;
+    avail = GetUsed();
     while ((needed > avail) && isRunning() &&
            !m_requestPause && !m_error && !m_eof &&
            (timer.elapsed() < max_wait))
     {
+#if REPORT_RING_STATS
+        ++m_avgBufSleepCnt;
+#endif
         m_dataWait.wait(locker.mutex(), 10);
-        avail = m_used;
+        avail = GetUsed();
     }
+    m_readerWaiting = false;
     return avail;
 }
 
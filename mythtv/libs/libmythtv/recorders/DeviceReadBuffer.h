@@ -5,6 +5,7 @@
 #define DEVICEREADBUFFER_H
 
 #include <array>
+#include <atomic>
 #include <unistd.h>
 
 #include <QMutex>
@@ -31,6 +32,13 @@ class DeviceReaderCB
  *  This allows us to read the device regularly even in the presence
  *  of long blocking conditions on writing to disk or accessing the
  *  database.
+ *
+ *  The ring is a lock-free single producer (the device thread) single
+ *  consumer (Read()) queue. Only the side that runs out of data or space
+ *  ever sleeps, and the other side only touches the mutex to wake it up
+ *  when it is known to be waiting. Where the OS allows it the ring memory
+ *  is mapped twice back to back, so reads and writes that cross the end
+ *  of the ring never need to be split or copied.
  */
 class DeviceReadBuffer : protected MThread
 {
@@ -68,6 +76,8 @@ class DeviceReadBuffer : protected MThread
     void SetPaused(bool val);
     void IncrWritePointer(uint len);
     void IncrReadPointer(uint len);
+    bool AllocateBuffer(size_t size, size_t overflow);
+    void FreeBuffer(void);
 
     bool HandlePausing(void);
     bool Poll(void) const;
@@ -95,7 +105,8 @@ class DeviceReadBuffer : protected MThread
 
     DeviceReaderCB         *m_readerCB              {nullptr};
 
-    // Data for managing the device ringbuffer
+    // Data for managing the device ringbuffer. m_lock protects the
+    // state flags and the wait conditions, not the ring itself.
     mutable QMutex          m_lock;
     volatile bool           m_doRun                 {false};
     bool                    m_eof                   {false};
@@ -107,16 +118,19 @@ class DeviceReadBuffer : protected MThread
     std::chrono::milliseconds m_maxPollWait         {2500ms};
 
     size_t                  m_size                  {0};
-    size_t                  m_used                  {0};
+    std::atomic<size_t>     m_used                  {0};
     size_t                  m_readQuanta            {0};
     size_t                  m_devBufferCount        {1};
     size_t                  m_devReadSize           {0};
     size_t                  m_readThreshold         {0};
+    size_t                  m_allocSize             {0};
+    bool                    m_mirrored              {false};
     unsigned char          *m_buffer                {nullptr};
-    unsigned char          *m_readPtr               {nullptr};
-    unsigned char          *m_writePtr              {nullptr};
+    unsigned char          *m_readPtr               {nullptr}; // consumer only
+    unsigned char          *m_writePtr              {nullptr}; // producer only
     unsigned char          *m_endPtr                {nullptr};
 
+    mutable std::atomic<bool> m_readerWaiting       {false};
     mutable QWaitCondition  m_dataWait;
     QWaitCondition          m_runWait;
     QWaitCondition          m_pauseWait;
@@ -127,7 +141,7 @@ class DeviceReadBuffer : protected MThread
     size_t                  m_avgUsed               {0};
     size_t                  m_avgBufWriteCnt        {0};
     size_t                  m_avgBufReadCnt         {0};
-    size_t                  m_avgBufSleepCnt        {0};
+    mutable size_t          m_avgBufSleepCnt        {0}; // bumped by WaitForUsed()
     MythTimer               m_lastReport;
 };
 
@@ -227,9 +227,7 @@ void ASIStreamHandler::run(void)
             continue;
         }
 
-        for (auto sit = m_streamDataList.cbegin();
-             sit != m_streamDataList.cend(); ++sit)
-            remainder = sit.key()->ProcessData(buffer, len);
+        remainder = ProcessStreamData(buffer, len);
 
         WriteMPTS(buffer, len - remainder);
 
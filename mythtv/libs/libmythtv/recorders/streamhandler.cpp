@@ -353,6 +353,45 @@ PIDPriority StreamHandler::GetPIDPriority(uint pid) const
     return tmp;
 }
 
+/** \brief Hands a buffer read from the device to every listener.
+ *
+ *  With a single listener the buffer is simply passed to its
+ *  MPEGStreamData::ProcessData(). When several recordings share the
+ *  multiplex the sync search and the packet header checks are done once
+ *  here, and each listener is only given the packets on the PIDs it
+ *  actually uses. Listeners which need the complete buffer still get it.
+ *
+ *  \note m_listenerLock must be held when this is called.
+ *  \return number of bytes left unprocessed at the end of the buffer
+ */
+int StreamHandler::ProcessStreamData(const unsigned char *buffer, int len)
+{
+    int remainder = 0;
+
+    if (m_streamDataList.size() < 2)
+    {
+        for (auto sit = m_streamDataList.cbegin(); sit != m_streamDataList.cend(); ++sit)
+            remainder = sit.key()->ProcessData(buffer, len);
+        return remainder;
+    }
+
+    remainder = MPEGStreamData::DemuxData(buffer, len,
+                                          m_demuxPackets, m_demuxPids,
+                                          m_demuxFlags);
+
+    for (auto sit = m_streamDataList.cbegin(); sit != m_streamDataList.cend(); ++sit)
+    {
+        MPEGStreamData *sd = sit.key();
+        if (sd->CanProcessDemuxed())
+            sd->ProcessDemuxedPackets(m_demuxPackets, m_demuxPids,
+                                      m_demuxFlags);
+        else
+            remainder = sd->ProcessData(buffer, len);
+    }
+
+    return remainder;
+}
+
 void StreamHandler::WriteMPTS(const unsigned char * buffer, uint len)
 {
     if (m_mptsTfw == nullptr)
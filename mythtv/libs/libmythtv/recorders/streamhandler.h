@@ -101,6 +101,8 @@ class StreamHandler : protected MThread, public DeviceReaderCB
         { return new PIDInfo(pid, stream_type, pes_type); }
 
   protected:
+    /// Feeds a read buffer to all listeners, m_listenerLock must be held
+    int ProcessStreamData(const unsigned char *buffer, int len);
     /// Write out a copy of the raw MPTS
     void WriteMPTS(const unsigned char * buffer, uint len);
     /// At minimum this sets _running_desired, this may also send
@@ -144,6 +146,11 @@ class StreamHandler : protected MThread, public DeviceReaderCB
     using StreamDataList = QHash<MPEGStreamData*,QString>;
     mutable QRecursiveMutex m_listenerLock;
     StreamDataList      m_streamDataList;
+
+    // Shared demux, see ProcessStreamData()
+    std::vector<const TSPacket*> m_demuxPackets;
+    std::vector<uint16_t> m_demuxPids;
+    std::vector<uint8_t> m_demuxFlags;
 };
 
 #endif // STREAM_HANDLER_H
@@ -14,6 +14,7 @@
 #include "libmythbase/mythdb.h"
 #include "libmythbase/mythlogging.h"
 #include "libmythbase/programinfoupdater.h"
+#include "libmythbase/seekindexfile.h"
 
 #include "jobqueue.h"
 #include "recordinginfo.h"
@@ -563,6 +564,8 @@ void RecordingInfo::ApplyRecordRecID(void)
 
     if (!query.exec())
         MythDB::DBError(LOC + "RecordID update", query);
+
+    SendUpdateEvent();
 }
 
 /**
@@ -840,6 +843,8 @@ void RecordingInfo::ApplyTranscoderProfileChangeById(int id)
     if (!query.exec())
         MythDB::DBError(LOC + "unable to update transcoder "
                 "in recorded table", query);
+
+    SendUpdateEvent();
 }
 
 /** \brief Sets the transcoder profile for a recording
@@ -900,6 +905,8 @@ void RecordingInfo::ApplyTranscoderProfileChange(const QString &profile) const
                 "ProgramInfo: unable to query transcoder profile ID");
         }
     }
+
+    SendUpdateEvent();
 }
 
 /**
@@ -1003,6 +1010,8 @@ void RecordingInfo::StartedRecording(const QString& ext)
 
     if (!query.exec() || !query.isActive())
         MythDB::DBError("Clear seek info on record", query);
+    else
+        SeekIndexFile::Create(m_pathname);
 
     query.prepare("DELETE FROM recordedmarkup WHERE chanid = :CHANID"
                   " AND starttime = :START;");
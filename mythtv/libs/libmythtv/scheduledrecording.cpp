@@ -23,16 +23,34 @@ void ScheduledRecording::SendReschedule(const QStringList &request)
     }
 }
 
+/** \brief Builds a MATCH request for the scheduler.
+ *
+ *  The first entry is "MATCH recordid sourceid mplexid maxstarttime why".
+ *  If \a chanids is not empty it is followed by the earliest changed
+ *  start time (or "-") and the comma separated list of channel ids.
+ *  Backends that do not know about these entries ignore them.
+ */
 QStringList ScheduledRecording::BuildMatchRequest(uint recordid,
                 uint sourceid, uint mplexid, const QDateTime &maxstarttime,
-                const QString &why)
+                const QString &why, const QDateTime &minstarttime,
+                const QList<uint> &chanids)
 {
-    return QStringList(QString("MATCH %1 %2 %3 %4 %5")
-                       .arg(recordid).arg(sourceid).arg(mplexid)
-                       .arg(maxstarttime.isValid()
-                            ? maxstarttime.toString(Qt::ISODate)
-                            : "-",
-                            why));
+    QStringList request(QString("MATCH %1 %2 %3 %4 %5")
+                        .arg(recordid).arg(sourceid).arg(mplexid)
+                        .arg(maxstarttime.isValid()
+                             ? maxstarttime.toString(Qt::ISODate)
+                             : "-",
+                             why));
+    if (!chanids.isEmpty())
+    {
+        QStringList ids;
+        for (uint chanid : chanids)
+            ids << QString::number(chanid);
+        request << (minstarttime.isValid()
+                    ? minstarttime.toString(Qt::ISODate) : QString("-"))
+                << ids.join(",");
+    }
+    return request;
 };
 
 QStringList ScheduledRecording::BuildCheckRequest(const RecordingInfo &recinfo,
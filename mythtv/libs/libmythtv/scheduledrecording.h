@@ -18,6 +18,16 @@ class MTV_PUBLIC ScheduledRecording
                              const QDateTime &maxstarttime, const QString &why)
         { SendReschedule(BuildMatchRequest(recordid, sourceid, mplexid,
                                            maxstarttime, why)); };
+    // Use when program data changed only on the listed channels, for
+    // programs starting or ending between minstarttime and maxstarttime.
+    static void RescheduleMatch(uint sourceid, uint mplexid,
+                                const QList<uint> &chanids,
+                                const QDateTime &minstarttime,
+                                const QDateTime &maxstarttime,
+                                const QString &why)
+        { SendReschedule(BuildMatchRequest(0, sourceid, mplexid,
+                                           maxstarttime, why,
+                                           minstarttime, chanids)); };
 
     // Use when previous or current recorded duplicate status changes.
     static void RescheduleCheck(const RecordingInfo &recinfo, 
@@ -39,7 +49,9 @@ class MTV_PUBLIC ScheduledRecording
 
     static void SendReschedule(const QStringList &request);
     static QStringList BuildMatchRequest(uint recordid, uint sourceid, 
-              uint mplexid, const QDateTime &maxstarttime, const QString &why);
+              uint mplexid, const QDateTime &maxstarttime, const QString &why,
+              const QDateTime &minstarttime = QDateTime(),
+              const QList<uint> &chanids = QList<uint>());
     static QStringList BuildCheckRequest(const RecordingInfo &recinfo,
                                          const QString &why);
     static QStringList BuildPlaceRequest(const QString &why);
@@ -0,0 +1,243 @@
+/*
+ *  Class TestDeinterlacer
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include "test_deinterlacer.h"
+
+#include <cstring>
+#include <functional>
+#include <memory>
+
+#include "libmythtv/mythdeinterlacer.h"
+#include "libmythtv/mythframe.h"
+
+static constexpr int kWidth  { 64 };
+static constexpr int kHeight { 64 };
+
+static std::unique_ptr<MythVideoFrame> CreateFrame(MythDeintType Deint, bool DoubleRate,
+                                                   int Width = kWidth, int Height = kHeight)
+{
+    size_t size = MythVideoFrame::GetBufferSize(FMT_YV12, Width, Height);
+    auto frame = std::make_unique<MythVideoFrame>(FMT_YV12, MythVideoFrame::GetAlignedBuffer(size),
+                                                  size, Width, Height);
+    memset(frame->m_buffer, 128, size);
+    frame->m_deinterlaceAllowed = DEINT_ALL;
+    frame->m_deinterlaceSingle  = DoubleRate ? DEINT_NONE : (Deint | DEINT_CPU);
+    frame->m_deinterlaceDouble  = DoubleRate ? (Deint | DEINT_CPU) : DEINT_NONE;
+    frame->m_topFieldFirst      = true;
+    return frame;
+}
+
+/// Sets every luma row to Value(row)
+static void FillLuma(MythVideoFrame *Frame, const std::function<uint8_t(int)>& Value)
+{
+    for (int row = 0; row < Frame->m_height; ++row)
+    {
+        memset(Frame->m_buffer + Frame->m_offsets[0] + (row * Frame->m_pitches[0]),
+               Value(row), static_cast<size_t>(Frame->m_width));
+    }
+}
+
+/// Returns the row of the first luma sample that differs from Value(row), -1 if none
+static int CheckLuma(const MythVideoFrame *Frame, const std::function<uint8_t(int)>& Value)
+{
+    for (int row = 0; row < Frame->m_height; ++row)
+    {
+        const uint8_t *line = Frame->m_buffer + Frame->m_offsets[0] + (row * Frame->m_pitches[0]);
+        for (int col = 0; col < Frame->m_width; ++col)
+            if (line[col] != Value(row))
+                return row;
+    }
+    return -1;
+}
+
+void TestDeinterlacer::OneFieldTest(void)
+{
+    MythDeinterlacer deint;
+    auto frame = CreateFrame(DEINT_BASIC, false);
+
+    // Top field is a ramp, the bottom field is garbage
+    FillLuma(frame.get(), [](int Row) { return (Row & 1) ? 255 : Row * 2; });
+    deint.Filter(frame.get(), kScan_Interlaced, nullptr);
+    QVERIFY(frame->m_alreadyDeinterlaced);
+
+    // Interpolated rows are the average of their neighbours, the last row
+    // has no neighbour below and repeats the one above
+    int bad = CheckLuma(frame.get(), [](int Row)
+        { return (Row == kHeight - 1) ? (Row - 1) * 2 : Row * 2; });
+    QCOMPARE(bad, -1);
+}
+
+void TestDeinterlacer::BobSecondFieldTest(void)
+{
+    MythDeinterlacer deint;
+    auto frame = CreateFrame(DEINT_BASIC, true);
+
+    // Bottom field is a ramp, the top field is constant
+    FillLuma(frame.get(), [](int Row) { return (Row & 1) ? Row * 2 : 10; });
+    deint.Filter(frame.get(), kScan_Interlaced, nullptr);
+    QCOMPARE(CheckLuma(frame.get(), [](int /*Row*/) { return 10; }), -1);
+
+    // The second field must come from the cached original
+    frame->m_alreadyDeinterlaced = false;
+    deint.Filter(frame.get(), kScan_Intr2ndField, nullptr);
+    int bad = CheckLuma(frame.get(), [](int Row) { return (Row == 0) ? 2 : Row * 2; });
+    QCOMPARE(bad, -1);
+}
+
+void TestDeinterlacer::MotionAdaptiveStaticTest(void)
+{
+    MythDeinterlacer deint;
+    auto fill = [](int Row) { return (Row & 1) ? 50 : 100; };
+
+    // Without a previous frame the missing field is interpolated, undelayed
+    auto frame = CreateFrame(DEINT_HIGH, false);
+    frame->m_frameCounter = 1;
+    frame->m_timecode = 40ms;
+    FillLuma(frame.get(), fill);
+    deint.Filter(frame.get(), kScan_Interlaced, nullptr);
+    QCOMPARE(CheckLuma(frame.get(), [](int /*Row*/) { return 100; }), -1);
+    QVERIFY(frame->m_timecode == 40ms);
+
+    // From now on the output is a frame late. Nothing moved, so the full
+    // vertical resolution is kept
+    frame->m_alreadyDeinterlaced = false;
+    frame->m_frameCounter = 2;
+    frame->m_timecode = 80ms;
+    FillLuma(frame.get(), fill);
+    deint.Filter(frame.get(), kScan_Interlaced, nullptr);
+    QCOMPARE(CheckLuma(frame.get(), fill), -1);
+    QVERIFY(frame->m_timecode == 40ms);
+}
+
+void TestDeinterlacer::MotionAdaptiveMotionTest(void)
+{
+    MythDeinterlacer deint;
+    auto frame = CreateFrame(DEINT_HIGH, false);
+    frame->m_frameCounter = 1;
+    FillLuma(frame.get(), [](int Row) { return (Row & 1) ? 200 : 20; });
+    deint.Filter(frame.get(), kScan_Interlaced, nullptr);
+
+    // The next frame changed a lot, so the other field of the first frame
+    // must not be woven in
+    frame->m_alreadyDeinterlaced = false;
+    frame->m_frameCounter = 2;
+    FillLuma(frame.get(), [](int Row) { return (Row & 1) ? 0 : 220; });
+    deint.Filter(frame.get(), kScan_Interlaced, nullptr);
+    QCOMPARE(CheckLuma(frame.get(), [](int /*Row*/) { return 20; }), -1);
+
+    // A discontinuity discards the earlier frames and the delay
+    frame->m_alreadyDeinterlaced = false;
+    frame->m_frameCounter = 10;
+    FillLuma(frame.get(), [](int Row) { return (Row & 1) ? 220 : 40; });
+    deint.Filter(frame.get(), kScan_Interlaced, nullptr);
+    QCOMPARE(CheckLuma(frame.get(), [](int /*Row*/) { return 40; }), -1);
+}
+
+void TestDeinterlacer::SlicedTest_data(void)
+{
+    QTest::addColumn<int>("deint");
+    QTest::addColumn<bool>("doublerate");
+
+    QTest::newRow("onefield")         << static_cast<int>(DEINT_BASIC)  << false;
+    QTest::newRow("bob")              << static_cast<int>(DEINT_BASIC)  << true;
+    QTest::newRow("linearblend")      << static_cast<int>(DEINT_MEDIUM) << false;
+    QTest::newRow("linearblend 2x")   << static_cast<int>(DEINT_MEDIUM) << true;
+    QTest::newRow("motionadaptive")   << static_cast<int>(DEINT_HIGH)   << false;
+    QTest::newRow("motionadaptive 2x")<< static_cast<int>(DEINT_HIGH)   << true;
+}
+
+/// Slices processed by the thread pool must give the same result as one thread
+void TestDeinterlacer::SlicedTest(void)
+{
+    QFETCH(int, deint);
+    QFETCH(bool, doublerate);
+
+    MythDeinterlacer single;
+    MythDeinterlacer sliced;
+    single.SetMaxThreads(1);
+    sliced.SetMaxThreads(4);
+    auto type   = static_cast<MythDeintType>(deint);
+    auto frame1 = CreateFrame(type, doublerate, 720, 576);
+    auto frame2 = CreateFrame(type, doublerate, 720, 576);
+
+    uint32_t seed = 1;
+    for (uint64_t counter = 1; counter <= 4; ++counter)
+    {
+        for (size_t i = 0; i < frame1->m_bufferSize; ++i)
+        {
+            // Mostly static content with some noise, so that both the static
+            // and the motion paths are used
+            seed = (seed * 1103515245) + 12345;
+            if ((counter == 1) || ((seed >> 16) % 4) == 0)
+                frame1->m_buffer[i] = static_cast<uint8_t>(seed >> 24);
+        }
+        frame1->m_frameCounter = frame2->m_frameCounter = counter;
+        frame1->m_alreadyDeinterlaced = frame2->m_alreadyDeinterlaced = false;
+        memcpy(frame2->m_buffer, frame1->m_buffer, frame1->m_bufferSize);
+        single.Filter(frame1.get(), kScan_Interlaced, nullptr);
+        sliced.Filter(frame2.get(), kScan_Interlaced, nullptr);
+        QVERIFY(frame2->m_alreadyDeinterlaced);
+        QCOMPARE(memcmp(frame1->m_buffer, frame2->m_buffer, frame1->m_bufferSize), 0);
+        if (doublerate)
+        {
+            frame1->m_alreadyDeinterlaced = frame2->m_alreadyDeinterlaced = false;
+            single.Filter(frame1.get(), kScan_Intr2ndField, nullptr);
+            sliced.Filter(frame2.get(), kScan_Intr2ndField, nullptr);
+            QCOMPARE(memcmp(frame1->m_buffer, frame2->m_buffer, frame1->m_bufferSize), 0);
+        }
+    }
+}
+
+void TestDeinterlacer::BenchmarkDeinterlacer_data(void)
+{
+    QTest::addColumn<int>("deint");
+    QTest::addColumn<bool>("doublerate");
+
+    QTest::newRow("onefield")         << static_cast<int>(DEINT_BASIC)  << false;
+    QTest::newRow("bob")              << static_cast<int>(DEINT_BASIC)  << true;
+    QTest::newRow("linearblend")      << static_cast<int>(DEINT_MEDIUM) << false;
+    QTest::newRow("linearblend 2x")   << static_cast<int>(DEINT_MEDIUM) << true;
+    QTest::newRow("motionadaptive")   << static_cast<int>(DEINT_HIGH)   << false;
+    QTest::newRow("motionadaptive 2x")<< static_cast<int>(DEINT_HIGH)   << true;
+}
+
+void TestDeinterlacer::BenchmarkDeinterlacer(void)
+{
+    QFETCH(int, deint);
+    QFETCH(bool, doublerate);
+
+    MythDeinterlacer deinterlacer;
+    auto frame = CreateFrame(static_cast<MythDeintType>(deint), doublerate, 1920, 1080);
+    FillLuma(frame.get(), [](int Row) { return static_cast<uint8_t>(Row * 7); });
+
+    uint64_t counter = 0;
+    QBENCHMARK
+    {
+        frame->m_frameCounter = ++counter;
+        frame->m_alreadyDeinterlaced = false;
+        deinterlacer.Filter(frame.get(), kScan_Interlaced, nullptr);
+        if (doublerate)
+        {
+            frame->m_alreadyDeinterlaced = false;
+            deinterlacer.Filter(frame.get(), kScan_Intr2ndField, nullptr);
+        }
+    }
+    QVERIFY(frame->m_alreadyDeinterlaced);
+}
+
+QTEST_APPLESS_MAIN(TestDeinterlacer)
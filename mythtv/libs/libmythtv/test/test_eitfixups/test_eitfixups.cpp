@@ -18,6 +18,7 @@
  *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
  */
 
+#include <array>
 #include <cstdio>
 #include <iostream>
 
@@ -1212,6 +1213,80 @@ void TestEITFixups::testUKTitlePropsFixups()
     QCOMPARE(event_prop.m_subtitleType, (uint8_t)(SUB_NORMAL|SUB_SIGNED));
 }
 
+void TestEITFixups::testFixedEventCache()
+{
+    // The second event is answered from the cache of fixed events and
+    // must come out exactly like the first one.
+    uint64_t hits = EITFixUp::CacheHits();
+    for (uint64_t i = 0; i < 2; i++)
+    {
+        DBEventEIT event(7302, "New: Title", "",
+                         "This is a [AD,S]description. Followed by 60 Seconds.",
+                         "", ProgramInfo::kCategoryNone,
+                         QDateTime::fromString("2020-02-28T23:55:00Z", Qt::ISODate),
+                         QDateTime::fromString("2020-03-01T02:00:00Z", Qt::ISODate),
+                         EITFixUp::kFixGenericDVB | EITFixUp::kFixUK,
+                         SUB_UNKNOWN, AUD_STEREO, VID_UNKNOWN, 0.0F,
+                         "", "", 0, 0, 0);
+
+        EITFixUp::Fix(event);
+        PRINT_EVENT(event);
+        QCOMPARE(event.m_title,        QString("Title"));
+        QCOMPARE(event.m_description,  QString("This is a description"));
+        QCOMPARE(event.m_audioProps,   (uint8_t)(AUD_STEREO|AUD_VISUALIMPAIR));
+        QCOMPARE(event.m_subtitleType, (uint8_t)SUB_NORMAL);
+        QCOMPARE(EITFixUp::CacheHits(), hits + i);
+    }
+}
+
+void TestEITFixups::testFixupTiming_data()
+{
+    QTest::addColumn<bool>("repeated");
+
+    // Every pass fixes up new events, so the fixed event cache never hits
+    QTest::newRow("new events")      << false;
+    // Every pass fixes up the same events again, as after an EIT version bump
+    QTest::newRow("repeated events") << true;
+}
+
+void TestEITFixups::testFixupTiming()
+{
+    QFETCH(bool, repeated);
+
+    static const std::array<std::array<const char *,3>,4> kEvents {{
+        { "New: Doctor Who", "", "Brand New Series. The Doctor returns. (S2 Ep 3/13) [AD,S]" },
+        { "Film: The Title", "", "Also in HD. A description of the film. [HD,S]" },
+        { "Serie", "", "Folge 12: 'Der Anfang' Eine Beschreibung." },
+        { "Serie", "", "Wiederholung vom 01.02.2020 Noch eine Beschreibung." },
+    }};
+    static const std::array<FixupValue,4> kFixups {
+        EITFixUp::kFixGenericDVB | EITFixUp::kFixUK,
+        EITFixUp::kFixGenericDVB | EITFixUp::kFixUK,
+        EITFixUp::kFixGenericDVB | EITFixUp::kFixRTL,
+        EITFixUp::kFixGenericDVB | EITFixUp::kFixRTL,
+    };
+
+    const QDateTime start =
+        QDateTime::fromString("2020-02-28T23:55:00Z", Qt::ISODate);
+    const QDateTime end =
+        QDateTime::fromString("2020-03-01T02:00:00Z", Qt::ISODate);
+    int pass = 0;
+
+    QBENCHMARK {
+        // The start time is part of the cache key
+        int offset = repeated ? 0 : (pass++ * 60);
+        for (size_t i = 0; i < kEvents.size(); i++)
+        {
+            DBEventEIT event(7302, kEvents[i][0], kEvents[i][1], kEvents[i][2],
+                             "", ProgramInfo::kCategoryNone,
+                             start.addSecs(offset), end.addSecs(offset),
+                             kFixups[i], SUB_UNKNOWN, AUD_STEREO, VID_UNKNOWN, 0.0F,
+                             "", "", 0, 0, 0);
+            EITFixUp::Fix(event);
+        }
+    }
+}
+
 void TestEITFixups::testUKSubtitleFixups_data()
 {
     QTest::addColumn<QString>("title");
@@ -70,6 +70,9 @@ class TestEITFixups : public QObject
     static void testGenericTitle_data(void);
     static void testGenericTitle(void);
     static void testUKTitlePropsFixups();
+    static void testFixedEventCache();
+    static void testFixupTiming_data();
+    static void testFixupTiming();
     static void testUKTitleDescriptionFixups_data(void);
     static void testUKTitleDescriptionFixups(void);
     static void testUKSubtitleFixups_data(void);
@@ -0,0 +1,160 @@
+/*
+ *  Class TestFramePool
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include "test_framepool.h"
+
+#include <cstring>
+
+#include "libmythtv/mythframe.h"
+#include "libmythtv/mythframepool.h"
+
+static constexpr size_t kClass { MythFramePool::kSizeClass };
+
+void TestFramePool::ReuseTest(void)
+{
+    MythFramePool pool;
+    uint8_t* first = pool.Acquire(100000);
+    QVERIFY(first != nullptr);
+    QCOMPARE(reinterpret_cast<uintptr_t>(first) % 64, uintptr_t{0});
+    pool.Release(first);
+
+    uint8_t* second = pool.Acquire(100000);
+    QCOMPARE(second, first);
+    auto stats = pool.GetStats();
+    QCOMPARE(stats.m_hits, uint64_t{1});
+    QCOMPARE(stats.m_misses, uint64_t{1});
+    QCOMPARE(stats.m_inUse, 2 * kClass);
+    QCOMPARE(stats.m_idle, size_t{0});
+    pool.Release(second);
+}
+
+void TestFramePool::SizeClassTest(void)
+{
+    MythFramePool pool;
+    // Same size class, including the 64 bytes of padding
+    uint8_t* buffer = pool.Acquire(kClass - 64);
+    pool.Release(buffer);
+    QCOMPARE(pool.Acquire(kClass - 100), buffer);
+    pool.Release(buffer);
+
+    // Next size class
+    uint8_t* bigger = pool.Acquire(kClass - 63);
+    auto stats = pool.GetStats();
+    QCOMPARE(stats.m_misses, uint64_t{2});
+    QCOMPARE(stats.m_inUse, 2 * kClass);
+    QCOMPARE(stats.m_idle, kClass);
+    pool.Release(bigger);
+}
+
+void TestFramePool::LimitTest(void)
+{
+    MythFramePool pool;
+    uint8_t* a1 = pool.Acquire(kClass);
+    uint8_t* a2 = pool.Acquire(kClass);
+    pool.Release(a1);
+    pool.Release(a2);
+    auto stats = pool.GetStats();
+    QCOMPARE(stats.m_peak, 4 * kClass);
+    QCOMPARE(stats.m_idle, 4 * kClass);
+
+    // A bigger format - idle memory must not exceed the peak in use
+    uint8_t* b = pool.Acquire(5 * kClass);
+    pool.Release(b);
+    stats = pool.GetStats();
+    QCOMPARE(stats.m_peak, 6 * kClass);
+    QCOMPARE(stats.m_idle, 6 * kClass);
+    QCOMPARE(stats.m_trimmed, uint64_t{2});
+
+    // The bigger buffer is kept
+    QCOMPARE(pool.Acquire(5 * kClass), b);
+    pool.Release(b);
+
+    pool.Trim();
+    stats = pool.GetStats();
+    QCOMPARE(stats.m_idle, size_t{0});
+    QCOMPARE(stats.m_peak, size_t{0});
+}
+
+void TestFramePool::TrimShareTest(void)
+{
+    MythFramePool pool;
+    // Another user's buffer, released first
+    uint8_t* other = pool.Acquire((3 * kClass) - 64);
+    uint8_t* a1 = pool.Acquire(kClass);
+    uint8_t* a2 = pool.Acquire(kClass);
+    pool.Release(other);
+    pool.Release(a1);
+    pool.Release(a2);
+    auto stats = pool.GetStats();
+    QCOMPARE(stats.m_peak, 7 * kClass);
+    QCOMPARE(stats.m_idle, 7 * kClass);
+
+    // Only the share of the user that went away is freed
+    pool.Trim(2 * MythFramePool::Capacity(kClass));
+    stats = pool.GetStats();
+    QCOMPARE(stats.m_idle, 3 * kClass);
+    QCOMPARE(stats.m_peak, 3 * kClass);
+    QCOMPARE(pool.Acquire((3 * kClass) - 64), other);
+    pool.Release(other);
+}
+
+void TestFramePool::ForeignBufferTest(void)
+{
+    MythFramePool pool;
+    // Not from the pool - must be freed, not kept
+    pool.Release(MythVideoFrame::GetAlignedBuffer(1000));
+    pool.Release(nullptr);
+    auto stats = pool.GetStats();
+    QCOMPARE(stats.m_idle, size_t{0});
+    QCOMPARE(stats.m_inUse, size_t{0});
+}
+
+void TestFramePool::LargeBufferTest(void)
+{
+    MythFramePool pool;
+    size_t size = MythVideoFrame::GetBufferSize(FMT_YV12, 3840, 2160);
+    uint8_t* buffer = pool.Acquire(size);
+    QVERIFY(buffer != nullptr);
+    QCOMPARE(reinterpret_cast<uintptr_t>(buffer) % 64, uintptr_t{0});
+    memset(buffer, 0x55, size + 64);
+    QCOMPARE(buffer[size + 63], static_cast<uint8_t>(0x55));
+    auto stats = pool.GetStats();
+    QVERIFY(stats.m_hugePages == 0 || stats.m_hugePages == stats.m_inUse);
+    pool.Release(buffer);
+}
+
+void TestFramePool::FrameReinitTest(void)
+{
+    auto & pool = MythFramePool::Instance();
+    pool.Trim();
+    auto before = pool.GetStats();
+    {
+        MythVideoFrame frame(FMT_YV12, 1920, 1080);
+        QVERIFY(frame.m_buffer != nullptr);
+        frame.Init(FMT_YV12, 720, 576);
+        frame.Init(FMT_YV12, 1920, 1080);
+        frame.Init(FMT_YV12, 720, 576);
+    }
+    auto after = pool.GetStats();
+    QCOMPARE(after.m_misses - before.m_misses, uint64_t{2});
+    QCOMPARE(after.m_hits - before.m_hits, uint64_t{2});
+    QCOMPARE(after.m_inUse, before.m_inUse);
+    pool.Trim();
+}
+
+QTEST_APPLESS_MAIN(TestFramePool)
@@ -0,0 +1,118 @@
+/*
+ *  Class TestJobBudget
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include "test_jobbudget.h"
+#include "libmythtv/jobbudget.h"
+#include "libmythtv/jobqueue.h"
+
+static JobCost make_cost(double cpu, double diskMBps)
+{
+    JobCost cost;
+    cost.m_cpu = cpu;
+    cost.m_diskMBps = diskMBps;
+    return cost;
+}
+
+void TestJobBudget::testEstimate(void)
+{
+    // One hour of 1080i at about 13Mb/s
+    JobCost cost = JobBudget::EstimateJobCost(JOB_COMMFLAG, 1h, 1920, 1080,
+                                              6000000000ULL);
+    QCOMPARE(cost.m_cpu, 0.5 * 2.25);
+    QCOMPARE(cost.m_diskMBps, (6000.0 / 3600) * 4);
+
+    // Nothing known, 720p is assumed
+    cost = JobBudget::EstimateJobCost(JOB_TRANSCODE, 0s, 0, 0, 0);
+    QCOMPARE(cost.m_cpu, 1.0);
+    QCOMPARE(cost.m_diskMBps, 4.0);
+
+    // Tiny pictures are not free
+    cost = JobBudget::EstimateJobCost(JOB_TRANSCODE, 0s, 352, 288, 0);
+    QCOMPARE(cost.m_cpu, 0.5);
+
+    cost = JobBudget::EstimateJobCost(JOB_METADATA, 1h, 1920, 1080,
+                                      6000000000ULL);
+    QCOMPARE(cost.m_cpu, 0.1);
+    QCOMPARE(cost.m_diskMBps, 0.0);
+}
+
+void TestJobBudget::testSingleJob(void)
+{
+    JobBudget budget;
+    budget.SetCapacity(1, 10);
+    budget.SetRecordingLoad(4, 20);
+
+    // Too expensive, but nothing else is running
+    QVERIFY(budget.CanStart(make_cost(8, 100)));
+    QVERIFY(budget.ProtectRecordings());
+
+    budget.AddJob(1, make_cost(0.1, 0));
+    QString reason;
+    QVERIFY(!budget.CanStart(make_cost(0.1, 0), &reason));
+    QVERIFY(!reason.isEmpty());
+}
+
+void TestJobBudget::testCPU(void)
+{
+    JobBudget budget;
+    budget.SetCapacity(4, 0);
+    QVERIFY(!budget.ProtectRecordings());
+
+    budget.AddJob(1, make_cost(2, 1000));
+    QCOMPARE(budget.Available().m_cpu, 1.5);
+    QVERIFY(budget.CanStart(make_cost(1.5, 1000)));
+    QVERIFY(!budget.CanStart(make_cost(2, 0)));
+
+    // Each recording reserves some CPU
+    budget.SetRecordingLoad(4, 50);
+    QCOMPARE(budget.Available().m_cpu, 0.5);
+    QVERIFY(!budget.CanStart(make_cost(1, 0)));
+    QVERIFY(budget.CanStart(make_cost(0.5, 0)));
+}
+
+void TestJobBudget::testDisk(void)
+{
+    JobBudget budget;
+    budget.SetCapacity(16, 100);
+    budget.SetRecordingLoad(3, 60);
+    budget.AddJob(1, make_cost(1, 30));
+
+    QCOMPARE(budget.Available().m_diskMBps, 10.0);
+    QVERIFY(budget.CanStart(make_cost(1, 10)));
+    QVERIFY(!budget.CanStart(make_cost(1, 20)));
+
+    // No limit configured
+    budget.SetCapacity(16, 0);
+    QVERIFY(budget.CanStart(make_cost(1, 1000)));
+}
+
+void TestJobBudget::testRemoveJob(void)
+{
+    JobBudget budget;
+    budget.SetCapacity(2, 0);
+    budget.AddJob(1, make_cost(1.5, 0));
+    budget.AddJob(2, make_cost(0.5, 0));
+    QVERIFY(!budget.CanStart(make_cost(1, 0)));
+
+    budget.RemoveJob(1);
+    QVERIFY(!budget.HasJob(1));
+    QVERIFY(budget.HasJob(2));
+    QVERIFY(budget.CanStart(make_cost(1, 0)));
+}
+
+QTEST_APPLESS_MAIN(TestJobBudget)
@@ -0,0 +1,19 @@
+include ( ../../../../settings.pro )
+include ( ../../../../test.pro )
+
+QT += testlib
+
+TEMPLATE = app
+TARGET = test_jobbudget
+INCLUDEPATH += ../../..
+#LIBS += -L../.. -lmythtv-$$LIBVERSION
+#LIBS += -Wl,$$_RPATH_$${PWD}/../..
+
+# Input
+HEADERS += test_jobbudget.h
+SOURCES += test_jobbudget.cpp
+
+QMAKE_CLEAN += $(TARGET)
+QMAKE_CLEAN += ; ( cd $(OBJECTS_DIR) && rm -f *.gcov *.gcda *.gcno )
+
+#LIBS += $$EXTRA_LIBS $$LATE_LIBS
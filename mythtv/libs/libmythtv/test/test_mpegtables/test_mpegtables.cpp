@@ -25,6 +25,7 @@
 #include "libmythtv/mpeg/atsc_huffman.h"
 #include "libmythtv/mpeg/atsctables.h"
 #include "libmythtv/mpeg/dvbtables.h"
+#include "libmythtv/mpeg/mpegstreamdata.h"
 #include "libmythtv/mpeg/mpegtables.h"
 
 extern "C" {
@@ -2655,4 +2656,169 @@ void TestMPEGTables::atsc_huffman_test (void)
     QCOMPARE(uncompressed.trimmed(), e_uncompressed);
 }
 
+class PacketRecorder : public TSPacketListener, public TSPacketListenerAV
+{
+  public:
+    bool ProcessTSPacket(const TSPacket& tspacket) override
+        { m_seen.push_back(QString("w%1").arg(tspacket.PID())); return true; }
+    bool ProcessVideoTSPacket(const TSPacket& tspacket) override
+        { m_seen.push_back(QString("v%1").arg(tspacket.PID())); return true; }
+    bool ProcessAudioTSPacket(const TSPacket& tspacket) override
+        { m_seen.push_back(QString("a%1").arg(tspacket.PID())); return true; }
+    void ProcessTSPackets(const TSPacket *tspackets, uint count) override
+    {
+        m_runs++;
+        TSPacketListener::ProcessTSPackets(tspackets, count);
+    }
+
+    QStringList m_seen;
+    uint        m_runs {0};
+};
+
+static QStringList dispatch_packets(bool batched, uint *runs = nullptr)
+{
+    static const std::array<uint,8> kPids
+        { 0x100, 0x100, 0x101, 0x102, 0x100, 0x100, 0x103, 0x101 };
+
+    std::vector<uint8_t> buffer(kPids.size() * TSPacket::kSize, 0xff);
+    for (size_t i = 0; i < kPids.size(); ++i)
+    {
+        auto *pkt = reinterpret_cast<TSPacket*>(&buffer[i * TSPacket::kSize]);
+        pkt->InitHeader(TSHeader::kPayloadOnlyHeader.data());
+        pkt->SetPID(kPids[i]);
+        pkt->SetContinuityCounter(i);
+    }
+    // A packet with a transport error must be dropped in both modes
+    reinterpret_cast<TSPacket*>(&buffer[5 * TSPacket::kSize])->SetTransportError(true);
+
+    MPEGStreamData sd(-1, -1, false);
+    sd.SetBatchedDispatch(batched);
+    sd.AddWritingPID(0x100);
+    sd.AddWritingPID(0x101);
+    sd.AddAudioPID(0x102);
+    sd.AddAudioPID(0x103);
+
+    PacketRecorder rec;
+    sd.AddWritingListener(&rec);
+    sd.AddAVListener(&rec);
+    int left = sd.ProcessData(buffer.data(), buffer.size());
+    sd.RemoveAVListener(&rec);
+    sd.RemoveWritingListener(&rec);
+
+    if (left != 0)
+        rec.m_seen.push_back(QString("left%1").arg(left));
+    if (runs)
+        *runs = rec.m_runs;
+    return rec.m_seen;
+}
+
+void TestMPEGTables::batched_dispatch_test (void)
+{
+    uint runs = 0;
+    QStringList single = dispatch_packets(false);
+    QStringList batched = dispatch_packets(true, &runs);
+
+    QCOMPARE(batched, single);
+    QCOMPARE(single, QStringList({"w256", "w256", "w257", "a258", "w256",
+                                  "a259", "w257"}));
+    // 0x100 x2, 0x101, 0x100, 0x101
+    QCOMPARE(runs, 4U);
+}
+
+void TestMPEGTables::demuxed_dispatch_test (void)
+{
+    static const std::array<uint,7> kPids
+        { 0x100, 0x200, 0x102, 0x200, 0x201, 0x101, 0x100 };
+    static constexpr size_t kJunk { 5 };
+    static constexpr size_t kTail { 50 };
+
+    // Some junk in front to force a resync and a partial packet at the end
+    std::vector<uint8_t> buffer(kJunk + (kPids.size() * TSPacket::kSize) + kTail, 0xff);
+    for (size_t i = 0; i < kPids.size(); ++i)
+    {
+        auto *pkt = reinterpret_cast<TSPacket*>(&buffer[kJunk + (i * TSPacket::kSize)]);
+        pkt->InitHeader(TSHeader::kPayloadOnlyHeader.data());
+        pkt->SetPID(kPids[i]);
+        pkt->SetContinuityCounter(i);
+    }
+
+    size_t npackets = 0;
+    bool canDemux = false;
+    auto run = [&](bool demuxed, int &left)
+    {
+        MPEGStreamData sd(-1, -1, false);
+        sd.AddWritingPID(0x100);
+        sd.AddWritingPID(0x101);
+        sd.AddAudioPID(0x102);
+
+        PacketRecorder rec;
+        sd.AddWritingListener(&rec);
+        sd.AddAVListener(&rec);
+        if (demuxed)
+        {
+            std::vector<const TSPacket*> packets;
+            std::vector<uint16_t> pids;
+            std::vector<uint8_t> flags;
+            left = MPEGStreamData::DemuxData(buffer.data(), buffer.size(),
+                                             packets, pids, flags);
+            npackets = std::min({packets.size(), pids.size(), flags.size()});
+            canDemux = sd.CanProcessDemuxed();
+            sd.ProcessDemuxedPackets(packets, pids, flags);
+        }
+        else
+        {
+            left = sd.ProcessData(buffer.data(), buffer.size());
+        }
+        sd.RemoveAVListener(&rec);
+        sd.RemoveWritingListener(&rec);
+        return rec.m_seen;
+    };
+
+    int left1 = 0;
+    int left2 = 0;
+    QStringList full = run(false, left1);
+    QStringList demuxed = run(true, left2);
+
+    QVERIFY(canDemux);
+    QCOMPARE(npackets, kPids.size());
+    QCOMPARE(demuxed, full);
+    QCOMPARE(full, QStringList({"w256", "a258", "w257", "w256"}));
+    QCOMPARE(left2, left1);
+    QCOMPARE(left1, static_cast<int>(kTail));
+}
+
+void TestMPEGTables::ts_scanner_test (void)
+{
+    // Deterministic pseudo random data with plenty of sync bytes
+    uint32_t seed = 12345;
+    auto next = [&seed]() { seed = (seed * 1103515245) + 12345; return seed >> 16; };
+
+    for (int iter = 0; iter < 500; ++iter)
+    {
+        int len = static_cast<int>((TSPacket::kSize * (1 + (next() % 20))) + (next() % 200));
+        std::vector<uint8_t> buffer(len);
+        for (auto & byte : buffer)
+            byte = (next() % 8 == 0) ? SYNC_BYTE : static_cast<uint8_t>(next());
+        if (iter % 2)
+        {
+            for (int pos = next() % TSPacket::kSize; pos < len; pos += TSPacket::kSize)
+                buffer[pos] = SYNC_BYTE;
+        }
+
+        int start = next() % 100;
+        QCOMPARE(TSPacketScanner::FindSync(buffer.data(), start, len),
+                 TSPacketScanner::FindSyncScalar(buffer.data(), start, len));
+
+        uint count = len / TSPacket::kSize;
+        std::vector<uint16_t> pids1(count);
+        std::vector<uint16_t> pids2(count);
+        std::vector<uint8_t>  flags1(count);
+        std::vector<uint8_t>  flags2(count);
+        QCOMPARE(TSPacketScanner::Validate(buffer.data(), count, pids1.data(), flags1.data()),
+                 TSPacketScanner::ValidateScalar(buffer.data(), count, pids2.data(), flags2.data()));
+        QVERIFY(pids1 == pids2);
+        QVERIFY(flags1 == flags2);
+    }
+}
+
 QTEST_APPLESS_MAIN(TestMPEGTables)
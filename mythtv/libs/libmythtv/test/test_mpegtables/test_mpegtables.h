@@ -116,4 +116,16 @@ class TestMPEGTables: public QObject
     /** test atsc huffman1 decoding */
     static void atsc_huffman_test_data (void);
     static void atsc_huffman_test (void);
+
+    /** test that batched dispatch delivers the same packets in the
+     *  same order as per packet dispatch */
+    static void batched_dispatch_test (void);
+
+    /** test that packets split by a shared demux stage are handled
+     *  exactly like the complete buffer */
+    static void demuxed_dispatch_test (void);
+
+    /** test that the vectorised TS sync search and header checks agree
+     *  with the plain versions */
+    static void ts_scanner_test (void);
 };
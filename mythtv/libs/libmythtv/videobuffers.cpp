@@ -12,6 +12,7 @@
 
 #include "fourcc.h"
 #include "mythcodecid.h"
+#include "mythframepool.h"
 #include "videobuffers.h"
 
 // FFmpeg
@@ -132,6 +133,18 @@ static inline void DoDiscard(const std::vector<AVBufferRef *> &Discards)
  * \see VideoOutput
  */
 
+VideoBuffers::~VideoBuffers()
+{
+    // Playback is over - hand the frame memory back and release this
+    // player's share of it. Other players may still be using the pool.
+    size_t share = 0;
+    for (const auto & frame : m_buffers)
+        if (frame.m_buffer && !MythVideoFrame::HardwareFormat(frame.m_type))
+            share += MythFramePool::Capacity(frame.m_bufferSize);
+    m_buffers.clear();
+    MythFramePool::Instance().Trim(share);
+}
+
 uint VideoBuffers::GetNumBuffers(int PixelFormat, int MaxReferenceFrames, bool Decoder /*=false*/)
 {
     uint refs = static_cast<uint>(MaxReferenceFrames);
@@ -975,6 +988,8 @@ bool VideoBuffers::CreateBuffers(VideoFrameType Type, int Width, int Height, con
 
     LOG(VB_PLAYBACK, LOG_INFO, QString("Created %1 %2 (%3x%4) video buffers")
        .arg(Size()).arg(MythVideoFrame::FormatDescription(Type)).arg(Width).arg(Height));
+    LOG(VB_PLAYBACK, LOG_INFO, QString("Frame pool: %1")
+       .arg(MythFramePool::Instance().GetStats().toString()));
     return success;
 }
 
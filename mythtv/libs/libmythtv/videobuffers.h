@@ -39,7 +39,7 @@ class MTV_PUBLIC VideoBuffers
 {
   public:
     VideoBuffers() = default;
-   ~VideoBuffers() = default;
+   ~VideoBuffers();
 
     static uint GetNumBuffers(int PixelFormat, int MaxReferenceFrames = 16, bool Decoder = false);
     void Init(uint NumDecode,
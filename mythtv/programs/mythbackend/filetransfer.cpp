@@ -1,4 +1,6 @@
 // C++ headers
+#include <fcntl.h>
+#include <unistd.h>
 #include <utility>
 
 // Qt headers
@@ -7,6 +9,7 @@
 #include <QFileInfo>
 
 // MythTV
+#include "libmythbase/mythcorecontext.h"
 #include "libmythbase/mythdate.h"
 #include "libmythbase/mythlogging.h"
 #include "libmythbase/mythsocket.h"
@@ -55,6 +58,9 @@ BEFileTransfer::~BEFileTransfer()
         m_rbuffer = nullptr;
     }
 
+    if (m_directFd >= 0)
+        close(m_directFd);
+
     if (m_pginfo)
     {
         m_pginfo->MarkAsInUse(false, kFileTransferInUseID);
@@ -125,6 +131,62 @@ void BEFileTransfer::Unpause(void)
         m_pginfo->UpdateInUseMark();
 }
 
+/** \brief Returns true if blocks can be sent straight from the file
+ *         to the socket with MythSocket::SendFile().
+ *
+ *  This is only done for local files that are not being written to,
+ *  everything else (growing recordings, remote and optical sources)
+ *  still goes through the MythMediaBuffer.
+ */
+bool BEFileTransfer::UseDirectTransfer(void)
+{
+    if (!m_directChecked)
+    {
+        m_directChecked = true;
+
+        QString filename = m_rbuffer->GetFilename();
+        QFileInfo fileinfo(filename);
+        if (m_rbuffer->GetType() == kMythBufferFile &&
+            !filename.startsWith("myth://") && fileinfo.isFile())
+        {
+            m_directFd = open(filename.toLocal8Bit().constData(),
+                              O_RDONLY | O_CLOEXEC);
+        }
+
+        LOG(VB_FILE, LOG_INFO,
+            QString("BEFileTransfer: %1 transfer for '%2'")
+            .arg((m_directFd >= 0) ? "direct" : "buffered", filename));
+    }
+
+    if (m_directFd < 0)
+        return false;
+
+    // A recording in progress may still grow, so let the ringbuffer
+    // handle waiting for more data.
+    return !gCoreContext->IsRegisteredFileForWrite(m_rbuffer->GetFilename());
+}
+
+int BEFileTransfer::RequestBlockDirect(int size)
+{
+    if (m_directPos < 0)
+        m_directPos = m_rbuffer->GetReadPosition();
+
+    int tot = 0;
+    while (tot < size && !m_rbuffer->GetStopReads() && m_readthreadlive)
+    {
+        int ret = m_sock->SendFile(m_directFd, m_directPos, size - tot);
+        if (ret < 0)
+            return (tot > 0) ? tot : -1;
+        if (ret == 0)
+            break; // we hit eof
+
+        m_directPos += ret;
+        tot += ret;
+    }
+
+    return tot;
+}
+
 int BEFileTransfer::RequestBlock(int size)
 {
     if (!m_readthreadlive || !m_rbuffer)
@@ -137,6 +199,28 @@ int BEFileTransfer::RequestBlock(int size)
     while (m_readsLocked)
         m_readsUnlockedCond.wait(&m_lock, 100 /*ms*/);
 
+    if (UseDirectTransfer())
+    {
+        // Fall back to the buffered path if sendfile() is not
+        // available, before anything has been sent.
+        tot = RequestBlockDirect(size);
+        if (tot >= 0)
+        {
+            if (m_pginfo)
+                m_pginfo->UpdateInUseMark();
+            return tot;
+        }
+        close(m_directFd);
+        m_directFd = -1;
+    }
+
+    if (m_directPos >= 0)
+    {
+        m_rbuffer->Seek(m_directPos, SEEK_SET);
+        m_directPos = -1;
+    }
+    tot = 0;
+
     m_requestBuffer.resize(std::max((size_t)std::max(size,0) + 128, m_requestBuffer.size()));
     char *buf = (m_requestBuffer).data();
     while (tot < size && !m_rbuffer->GetStopReads() && m_readthreadlive)
@@ -240,6 +324,13 @@ long long BEFileTransfer::Seek(long long curpos, long long pos, int whence)
 
     Pause();
 
+    if (m_directPos >= 0)
+    {
+        // Blocks were sent with sendfile(), bring the ringbuffer up to date
+        m_rbuffer->Seek(m_directPos, SEEK_SET);
+        m_directPos = -1;
+    }
+
     if (whence == SEEK_CUR)
     {
         long long desired = curpos + pos;
@@ -48,6 +48,9 @@ class BEFileTransfer : public ReferenceCounter
   private:
    ~BEFileTransfer() override;
 
+    bool UseDirectTransfer(void);
+    int  RequestBlockDirect(int size);
+
     volatile bool   m_readthreadlive    {true};
     bool            m_readsLocked       {false};
     QWaitCondition  m_readsUnlockedCond;
@@ -62,6 +65,11 @@ class BEFileTransfer : public ReferenceCounter
     QMutex          m_lock;
 
     bool            m_writemode         {false};
+
+    // sendfile() fast path for complete local files, see RequestBlock()
+    int             m_directFd          {-1};
+    long long       m_directPos         {-1};
+    bool            m_directChecked     {false};
 };
 
 #endif // MYTHBACKEND_FILETRANSFER_H_
@@ -77,6 +77,7 @@
 // mythbackend headers
 #include "autoexpire.h"
 #include "backendcontext.h"
+#include "recordedlistcache.h"
 #include "scheduler.h"
 
 /** Milliseconds to wait for an existing thread from
@@ -241,8 +242,15 @@ MainServer::MainServer(bool master, int port,
     m_ismaster(master), m_threadPool("ProcessRequestPool"),
     m_sched(sched), m_expirer(_expirer)
 {
-    PreviewGeneratorQueue::CreatePreviewGeneratorQueue(
-        PreviewGenerator::kLocalAndRemote, ~0, 0s);
+    // Generating previews inside the backend saves starting a
+    // mythpreviewgen process for each one, at the cost of isolation.
+    auto previewMode = PreviewGenerator::kLocalAndRemote;
+    if (gCoreContext->GetBoolSetting("PreviewGeneratorInProcess", false))
+    {
+        previewMode = static_cast<PreviewGenerator::Mode>(
+            previewMode | PreviewGenerator::kInProcess);
+    }
+    PreviewGeneratorQueue::CreatePreviewGeneratorQueue(previewMode, ~0, 0s);
     PreviewGeneratorQueue::AddListener(this);
 
     m_threadPool.setMaxThreadCount(PRT_STARTUP_THREAD_COUNT);
@@ -538,6 +546,13 @@ void MainServer::ProcessRequestWork(MythSocket *sock)
         else
             HandleQueryRecordings(tokens[1], pbs);
     }
+    else if (command == "QUERY_RECORDINGS_SINCE")
+    {
+        if (tokens.size() != 2)
+            SendErrorResponse(pbs, "Bad QUERY_RECORDINGS_SINCE query");
+        else
+            HandleQueryRecordingsSince(tokens[1], pbs);
+    }
     else if (command == "QUERY_RECORDING")
     {
         HandleQueryRecording(tokens, pbs);
@@ -1141,6 +1156,8 @@ void MainServer::customEvent(QEvent *e)
         if (me == nullptr)
             return;
 
+        RecordedListCache::Instance().HandleEvent(*me);
+
         QString message = me->Message();
         QString error;
         if ((message == "PREVIEW_SUCCESS" || message == "PREVIEW_QUEUED") &&
@@ -2163,92 +2180,205 @@ void MainServer::HandleQueryRecordings(const QString& type, PlaybackSock *pbs)
 
     QStringList outputlist(QString::number(destination.size()));
     QMap<QString, int> backendPortMap;
-    int port = gCoreContext->GetBackendServerPort();
-    QString host = gCoreContext->GetHostName();
 
     for (auto* proginfo : destination)
     {
-        PlaybackSock *slave = nullptr;
+        PrepareRecordingForClient(proginfo, playbackhost, backendPortMap);
+        proginfo->ToStringList(outputlist);
+    }
 
-        if (proginfo->GetHostname() != gCoreContext->GetHostName())
-            slave = GetSlaveByHostname(proginfo->GetHostname());
+    SendResponse(pbssock, outputlist);
+}
 
-        if ((proginfo->GetHostname() == gCoreContext->GetHostName()) ||
-            (!slave && m_masterBackendOverride))
+/**
+ * \brief Fill in the pathname and file size of a recording as a client
+ *        at playbackhost needs them.
+ */
+void MainServer::PrepareRecordingForClient(ProgramInfo *proginfo,
+                                           const QString &playbackhost,
+                                           QMap<QString, int> &backendPortMap)
+{
+    int port = gCoreContext->GetBackendServerPort();
+    QString host = gCoreContext->GetHostName();
+    PlaybackSock *slave = nullptr;
+
+    if (proginfo->GetHostname() != gCoreContext->GetHostName())
+        slave = GetSlaveByHostname(proginfo->GetHostname());
+
+    if ((proginfo->GetHostname() == gCoreContext->GetHostName()) ||
+        (!slave && m_masterBackendOverride))
+    {
+        proginfo->SetPathname(MythCoreContext::GenMythURL(host,port,
+                                                          proginfo->GetBasename()));
+        if (!proginfo->GetFilesize())
         {
-            proginfo->SetPathname(MythCoreContext::GenMythURL(host,port,
-                                                              proginfo->GetBasename()));
-            if (!proginfo->GetFilesize())
+            QString tmpURL = GetPlaybackURL(proginfo);
+            if (tmpURL.startsWith('/'))
             {
-                QString tmpURL = GetPlaybackURL(proginfo);
-                if (tmpURL.startsWith('/'))
+                QFile checkFile(tmpURL);
+                if (!tmpURL.isEmpty() && checkFile.exists())
                 {
-                    QFile checkFile(tmpURL);
-                    if (!tmpURL.isEmpty() && checkFile.exists())
+                    proginfo->SetFilesize(checkFile.size());
+                    if (proginfo->GetRecordingEndTime() <
+                        MythDate::current())
                     {
-                        proginfo->SetFilesize(checkFile.size());
-                        if (proginfo->GetRecordingEndTime() <
-                            MythDate::current())
-                        {
-                            proginfo->SaveFilesize(proginfo->GetFilesize());
-                        }
+                        proginfo->SaveFilesize(proginfo->GetFilesize());
                     }
                 }
             }
         }
-        else if (!slave)
+    }
+    else if (!slave)
+    {
+        proginfo->SetPathname(GetPlaybackURL(proginfo));
+        if (proginfo->GetPathname().isEmpty())
         {
-            proginfo->SetPathname(GetPlaybackURL(proginfo));
-            if (proginfo->GetPathname().isEmpty())
-            {
-                LOG(VB_GENERAL, LOG_ERR, LOC +
-                    QString("HandleQueryRecordings() "
-                            "Couldn't find backend for:\n\t\t\t%1")
-                        .arg(proginfo->toString(ProgramInfo::kTitleSubtitle)));
+            LOG(VB_GENERAL, LOG_ERR, LOC +
+                QString("PrepareRecordingForClient() "
+                        "Couldn't find backend for:\n\t\t\t%1")
+                    .arg(proginfo->toString(ProgramInfo::kTitleSubtitle)));
 
-                proginfo->SetFilesize(0);
-                proginfo->SetPathname("file not found");
-            }
+            proginfo->SetFilesize(0);
+            proginfo->SetPathname("file not found");
         }
-        else
+    }
+    else
+    {
+        if (!proginfo->GetFilesize())
         {
-            if (!proginfo->GetFilesize())
+            if (!slave->FillProgramInfo(*proginfo, playbackhost))
             {
-                if (!slave->FillProgramInfo(*proginfo, playbackhost))
-                {
-                    LOG(VB_GENERAL, LOG_ERR, LOC +
-                        "MainServer::HandleQueryRecordings()"
-                        "\n\t\t\tCould not fill program info "
-                        "from backend");
-                }
-                else
-                {
-                    if (proginfo->GetRecordingEndTime() <
-                        MythDate::current())
-                    {
-                        proginfo->SaveFilesize(proginfo->GetFilesize());
-                    }
-                }
+                LOG(VB_GENERAL, LOG_ERR, LOC +
+                    "MainServer::PrepareRecordingForClient()"
+                    "\n\t\t\tCould not fill program info "
+                    "from backend");
             }
             else
             {
-                ProgramInfo *p      = proginfo;
-                QString hostname    = p->GetHostname();
+                if (proginfo->GetRecordingEndTime() <
+                    MythDate::current())
+                {
+                    proginfo->SaveFilesize(proginfo->GetFilesize());
+                }
+            }
+        }
+        else
+        {
+            ProgramInfo *p      = proginfo;
+            QString hostname    = p->GetHostname();
 
-                if (!backendPortMap.contains(hostname))
-                    backendPortMap[hostname] = gCoreContext->GetBackendServerPort(hostname);
+            if (!backendPortMap.contains(hostname))
+                backendPortMap[hostname] = gCoreContext->GetBackendServerPort(hostname);
 
-                p->SetPathname(MythCoreContext::GenMythURL(hostname,
-                                                           backendPortMap[hostname],
-                                                           p->GetBasename()));
-            }
+            p->SetPathname(MythCoreContext::GenMythURL(hostname,
+                                                       backendPortMap[hostname],
+                                                       p->GetBasename()));
         }
+    }
 
-        if (slave)
-            slave->DecrRef();
+    if (slave)
+        slave->DecrRef();
+}
 
-        proginfo->ToStringList(outputlist);
+/**
+ * \addtogroup myth_network_protocol
+ * \par        QUERY_RECORDINGS_SINCE \e generation
+ * Returns the recordings that changed since the list with the given
+ * \e generation, or all recordings if \e generation is 0 or too old.
+ * The reply is the new generation, "FULL" or "DELTA", the number of
+ * recordings, a comma separated list of deleted recording ids and the
+ * recordings as written by ProgramInfo::ToBinary(), followed by the state
+ * that changes without a change event (program flags, recording status and
+ * file size) of every recording, compressed with qCompress() and base64
+ * encoded.
+ */
+void MainServer::HandleQueryRecordingsSince(const QString& since,
+                                            PlaybackSock *pbs)
+{
+    MythSocket *pbssock = pbs->getSocket();
+    QString playbackhost = pbs->getHostname();
+
+    QMap<QString,ProgramInfo*> recMap;
+    if (m_sched)
+        recMap = m_sched->GetRecording();
+
+    QMap<QString,uint32_t> inUseMap = ProgramInfo::QueryInUseMap();
+    QMap<QString,bool> isJobRunning =
+        ProgramInfo::QueryJobsRunning(JOB_COMMFLAG);
+
+    // Take the changes first. The list may then include later changes that
+    // are not in them, those are sent again with the next delta, but it can
+    // not miss a recording that is in them and so report it as deleted.
+    uint64_t generation = 0;
+    QSet<uint> changed;
+    bool full = !RecordedListCache::Instance().GetChangesSince(
+        since.toULongLong(), changed, generation);
+
+    uint64_t listGeneration = 0;
+    RecordedListCache::ProgramVect cached =
+        RecordedListCache::Instance().GetList(0, QString(), false, false,
+                                              inUseMap, isJobRunning, recMap,
+                                              listGeneration);
+
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream.setVersion(ProgramInfo::kBinaryStreamVersion);
+
+    QDateTime rectime = MythDate::current().addSecs(
+        -gCoreContext->GetNumSetting("RecordOverTime"));
+    QMap<QString, int> backendPortMap;
+    uint count = 0;
+
+    QByteArray states;
+    QDataStream stateStream(&states, QIODevice::WriteOnly);
+    stateStream.setVersion(ProgramInfo::kBinaryStreamVersion);
+
+    for (const auto &pCached : cached)
+    {
+        // Apply the current in-use, job and recording state, the cache
+        // does not keep track of those.
+        ProgramInfo info(*pCached);
+        QString key = info.MakeUniqueKey();
+        info.SetInUseFlags(inUseMap.value(key, 0));
+        info.SetCommFlagJobRunning(isJobRunning.contains(key));
+        info.SetRecordingStatus(
+            (info.GetRecordingEndTime() > rectime && recMap.contains(key))
+            ? RecStatus::Recording : RecStatus::Recorded);
+
+        if (full || changed.remove(info.GetRecordingID()))
+        {
+            PrepareRecordingForClient(&info, playbackhost, backendPortMap);
+            info.ToBinary(stream);
+            ++count;
+        }
+
+        // The client's copies of unchanged recordings still need this
+        stateStream << quint32(info.GetRecordingID())
+                    << quint32(info.GetProgramFlags())
+                    << qint8(info.GetRecordingStatus())
+                    << quint64(info.GetFilesize());
     }
+    stream << quint32(cached.size());
+    stream.writeRawData(states.constData(), states.size());
+
+    for (auto *pInfo : std::as_const(recMap))
+        delete pInfo;
+
+    // Whatever changed and is no longer listed has been deleted
+    QStringList deleted;
+    for (uint recordedid : std::as_const(changed))
+        deleted << QString::number(recordedid);
+
+    QStringList outputlist;
+    outputlist << QString::number(generation)
+               << (full ? "FULL" : "DELTA")
+               << QString::number(count)
+               << deleted.join(",")
+               << QString::fromLatin1(qCompress(data).toBase64());
+
+    LOG(VB_NETWORK, LOG_INFO, LOC +
+        QString("QUERY_RECORDINGS_SINCE %1: %2 %3 recordings, %4 deleted")
+            .arg(since, outputlist[1]).arg(count).arg(deleted.size()));
 
     SendResponse(pbssock, outputlist);
 }
@@ -2466,6 +2596,7 @@ void MainServer::DoDeleteThread(DeleteStruct *ds)
     nameFilters.push_back(fInfo.fileName() + ".old");
     nameFilters.push_back(fInfo.fileName() + ".map");
     nameFilters.push_back(fInfo.fileName() + ".tmp.map");
+    nameFilters.push_back(fInfo.fileName() + ".seek");
     nameFilters.push_back(fInfo.baseName() + ".srt");  // e.g. 1234_20150213165800.srt
 
     QDir dir (fInfo.path());
@@ -177,6 +177,10 @@ class MainServer : public QObject, public MythSocketCBs
     bool HandleDeleteFile(const QString& filename, const QString& storagegroup,
                           PlaybackSock *pbs = nullptr);
     void HandleQueryRecordings(const QString& type, PlaybackSock *pbs);
+    void HandleQueryRecordingsSince(const QString& since, PlaybackSock *pbs);
+    void PrepareRecordingForClient(ProgramInfo *proginfo,
+                                   const QString &playbackhost,
+                                   QMap<QString, int> &backendPortMap);
     void HandleQueryRecording(QStringList &slist, PlaybackSock *pbs);
     void HandleStopRecording(QStringList &slist, PlaybackSock *pbs);
     void DoHandleStopRecording(RecordingInfo &recinfo, PlaybackSock *pbs);
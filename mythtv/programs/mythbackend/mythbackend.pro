@@ -28,7 +28,7 @@ HEADERS += playbacksock.h scheduler.h backendhousekeeper.h
 HEADERS += upnpcdstv.h upnpcdsmusic.h upnpcdsvideo.h mediaserver.h
 HEADERS += internetContent.h mythbackend_main_helpers.h backendcontext.h
 HEADERS += httpconfig.h mythsettings.h mythbackend_commandlineparser.h
-HEADERS += recordingextender.h
+HEADERS += recordedlistcache.h recordingextender.h
 
 SOURCES += autoexpire.cpp encoderlink.cpp filetransfer.cpp httpstatus.cpp
 SOURCES += mythbackend.cpp mainserver.cpp playbacksock.cpp scheduler.cpp
@@ -36,7 +36,7 @@ SOURCES += backendhousekeeper.cpp
 SOURCES += upnpcdstv.cpp upnpcdsmusic.cpp upnpcdsvideo.cpp mediaserver.cpp
 SOURCES += internetContent.cpp mythbackend_main_helpers.cpp backendcontext.cpp
 SOURCES += httpconfig.cpp mythsettings.cpp mythbackend_commandlineparser.cpp
-SOURCES += recordingextender.cpp
+SOURCES += recordedlistcache.cpp recordingextender.cpp
 
 HEADERS += servicesv2/v2myth.h servicesv2/v2connectionInfo.h servicesv2/v2wolInfo.h
 HEADERS += servicesv2/v2databaseInfo.h servicesv2/v2versionInfo.h
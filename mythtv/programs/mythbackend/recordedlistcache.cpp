@@ -0,0 +1,337 @@
+// C++
+#include <algorithm>
+
+// Qt
+#include <QDateTime>
+
+// MythTV
+#include "libmythbase/mythevent.h"
+#include "libmythbase/mythlogging.h"
+#include "libmythbase/programinfo.h"
+
+// MythBackend
+#include "recordedlistcache.h"
+
+#define LOC QString("RecordedListCache: ")
+
+RecordedListCache &RecordedListCache::Instance(void)
+{
+    static RecordedListCache s_cache;
+    return s_cache;
+}
+
+/// Generations start from the start time of the backend, so that
+/// generations handed out by a previous run are never mistaken for
+/// generations of this one.
+RecordedListCache::RecordedListCache()
+  : m_generation(static_cast<uint64_t>(QDateTime::currentSecsSinceEpoch()) << 32),
+    m_changesFrom(m_generation)
+{
+}
+
+bool RecordedListCache::View::Accepts(const ProgramInfo &pginfo) const
+{
+    if (m_ignoreLiveTV && pginfo.GetRecordingGroup() == "LiveTV")
+        return false;
+    if (m_ignoreDeleted && pginfo.GetRecordingGroup() == "Deleted")
+        return false;
+    return true;
+}
+
+/// True if nothing the recorded list can be sorted by differs.
+static bool same_sort_keys(const ProgramInfo &a, const ProgramInfo &b,
+                           bool withFilesize)
+{
+    return a.GetRecordingStartTime() == b.GetRecordingStartTime() &&
+        a.GetRecordingEndTime()      == b.GetRecordingEndTime()   &&
+        a.GetTitle()                 == b.GetTitle()              &&
+        a.GetSubtitle()              == b.GetSubtitle()           &&
+        a.GetSeason()                == b.GetSeason()             &&
+        a.GetEpisode()               == b.GetEpisode()            &&
+        a.GetCategory()              == b.GetCategory()           &&
+        a.IsWatched()                == b.IsWatched()             &&
+        a.GetStars()                 == b.GetStars()              &&
+        a.GetOriginalAirDate()       == b.GetOriginalAirDate()    &&
+        a.GetRecordingGroup()        == b.GetRecordingGroup()     &&
+        a.GetStorageGroup()          == b.GetStorageGroup()       &&
+        a.GetChanID()                == b.GetChanID()             &&
+        (!withFilesize || (a.GetFilesize() == b.GetFilesize()));
+}
+
+/** \brief Queues the changes announced by a backend event.
+ *
+ *  Called for every event MainServer sees, anything that does not
+ *  concern the recorded table is ignored.
+ */
+void RecordedListCache::HandleEvent(const MythEvent &event)
+{
+    const QString& message = event.Message();
+    if (!message.startsWith("RECORDING_LIST_CHANGE") &&
+        !message.startsWith("MASTER_UPDATE_REC_INFO") &&
+        !message.startsWith("UPDATE_FILE_SIZE"))
+        return;
+
+    QStringList tokens = message.simplified().split(" ");
+    uint recordedid = 0;
+    uint64_t filesize = 0;
+    bool sizeOnly = false;
+
+    if (tokens[0] == "RECORDING_LIST_CHANGE")
+    {
+        if (tokens.size() >= 3 &&
+            (tokens[1] == "ADD" || tokens[1] == "DELETE"))
+        {
+            recordedid = tokens[2].toUInt();
+        }
+        else if (tokens.size() >= 2 && tokens[1] == "UPDATE")
+        {
+            ProgramInfo pginfo(event.ExtraDataList());
+            recordedid = pginfo.GetRecordingID();
+        }
+    }
+    else if (tokens[0] == "MASTER_UPDATE_REC_INFO" && tokens.size() >= 2)
+    {
+        recordedid = tokens[1].toUInt();
+    }
+    else if (tokens[0] == "UPDATE_FILE_SIZE" && tokens.size() >= 3)
+    {
+        recordedid = tokens[1].toUInt();
+        filesize = tokens[2].toULongLong();
+        sizeOnly = true;
+    }
+    else
+    {
+        return;
+    }
+
+    QMutexLocker locker(&m_pendingLock);
+    ++m_generation;
+
+    if (recordedid == 0 || m_changedAt.size() >= kMaxChanges)
+    {
+        m_changedAt.clear();
+        m_changesFrom = m_generation;
+    }
+    else
+    {
+        m_changedAt[recordedid] = m_generation;
+    }
+
+    if (m_invalid)
+        return;
+
+    // A bare RECORDING_LIST_CHANGE means anything may have changed.
+    if (recordedid == 0)
+    {
+        m_invalid = true;
+    }
+    else if (sizeOnly)
+    {
+        if (!m_pendingReload.contains(recordedid))
+            m_pendingSize[recordedid] = filesize;
+    }
+    else
+    {
+        m_pendingReload.insert(recordedid);
+        m_pendingSize.remove(recordedid);
+        if (m_pendingReload.size() > kMaxPending)
+            m_invalid = true;
+    }
+}
+
+void RecordedListCache::Remove(View &view, uint recordedid)
+{
+    auto it = std::find_if(view.m_programs.begin(), view.m_programs.end(),
+                           [recordedid](const ProgramPtr &p)
+                               { return p->GetRecordingID() == recordedid; });
+    if (it != view.m_programs.end())
+        view.m_programs.erase(it);
+}
+
+/// Inserts into a view sorted by recording start time, as LoadFromRecorded()
+/// does without an explicit sort order.
+void RecordedListCache::Insert(View &view, const ProgramPtr &pginfo)
+{
+    if (view.m_sort == 0)
+    {
+        view.m_programs.push_back(pginfo);
+        return;
+    }
+
+    bool descending = view.m_sort < 0;
+    auto it = std::upper_bound(
+        view.m_programs.begin(), view.m_programs.end(), pginfo,
+        [descending](const ProgramPtr &a, const ProgramPtr &b)
+        {
+            return descending
+                ? a->GetRecordingStartTime() > b->GetRecordingStartTime()
+                : a->GetRecordingStartTime() < b->GetRecordingStartTime();
+        });
+    view.m_programs.insert(it, pginfo);
+}
+
+/// Brings the views up to date with the queued events. Requires m_lock.
+void RecordedListCache::ApplyPending(const QSet<uint> &reload,
+                                     const QHash<uint,uint64_t> &sizes)
+{
+    for (uint recordedid : reload)
+    {
+        auto pginfo = std::make_shared<ProgramInfo>(recordedid);
+        bool exists = pginfo->GetChanID() != 0;
+
+        for (auto vit = m_views.begin(); vit != m_views.end(); )
+        {
+            View &view = *vit;
+            if (view.SortedByStartTime())
+            {
+                Remove(view, recordedid);
+                if (exists && view.Accepts(*pginfo))
+                    Insert(view, pginfo);
+                ++vit;
+                continue;
+            }
+
+            // Other sort orders are done by the database, so only patch
+            // a program in place if its position cannot have changed.
+            auto it = std::find_if(view.m_programs.begin(), view.m_programs.end(),
+                                   [recordedid](const ProgramPtr &p)
+                                       { return p->GetRecordingID() == recordedid; });
+            bool present = it != view.m_programs.end();
+            bool accepted = exists && view.Accepts(*pginfo);
+            if (!present && !accepted)
+            {
+                ++vit;
+            }
+            else if (present && accepted &&
+                     same_sort_keys(**it, *pginfo,
+                                    view.m_sortBy.contains("filesize")))
+            {
+                *it = pginfo;
+                ++vit;
+            }
+            else
+            {
+                vit = m_views.erase(vit);
+            }
+        }
+    }
+
+    for (auto sit = sizes.cbegin(); sit != sizes.cend(); ++sit)
+    {
+        for (auto vit = m_views.begin(); vit != m_views.end(); )
+        {
+            View &view = *vit;
+            uint recordedid = sit.key();
+            auto it = std::find_if(view.m_programs.begin(), view.m_programs.end(),
+                                   [recordedid](const ProgramPtr &p)
+                                       { return p->GetRecordingID() == recordedid; });
+            if (it == view.m_programs.end())
+            {
+                ++vit;
+                continue;
+            }
+            if (view.m_sortBy.contains("filesize"))
+            {
+                vit = m_views.erase(vit);
+                continue;
+            }
+            auto pginfo = std::make_shared<ProgramInfo>(**it);
+            pginfo->SetFilesize(sit.value());
+            *it = pginfo;
+            ++vit;
+        }
+    }
+}
+
+/** \brief Returns the recordings changed after generation since.
+ *
+ *  Recordings that have been deleted are included, they are simply missing
+ *  from the list returned by GetList(). Call this before GetList(), so the
+ *  list is at least as new as the changes.
+ *  \param generation set to the generation the changes are complete up to,
+ *                    which is what the caller's list is current as of.
+ *  \return false if the changes are not known that far back, or since is
+ *          not a generation of this backend run, and a full list is needed.
+ */
+bool RecordedListCache::GetChangesSince(uint64_t since, QSet<uint> &changed,
+                                        uint64_t &generation)
+{
+    QMutexLocker locker(&m_pendingLock);
+    generation = m_generation;
+    if (since < m_changesFrom || since > m_generation)
+        return false;
+
+    for (auto it = m_changedAt.cbegin(); it != m_changedAt.cend(); ++it)
+    {
+        if (it.value() > since)
+            changed.insert(it.key());
+    }
+    return true;
+}
+
+/** \brief Returns the recorded list for the given LoadFromRecorded() arguments.
+ *
+ *  The maps are only used if the view has to be loaded from the database.
+ *  \param generation set to a number that changes with every event that
+ *                    may have changed any recorded list.
+ */
+RecordedListCache::ProgramVect RecordedListCache::GetList(
+    int sort, const QString &sortBy, bool ignoreLiveTV, bool ignoreDeleted,
+    const QMap<QString,uint32_t> &inUseMap,
+    const QMap<QString,bool> &isJobRunning,
+    const QMap<QString,ProgramInfo*> &recMap,
+    uint64_t &generation)
+{
+    QMutexLocker locker(&m_lock);
+
+    QSet<uint> reload;
+    QHash<uint,uint64_t> sizes;
+    bool invalid = false;
+    {
+        QMutexLocker pendingLocker(&m_pendingLock);
+        reload.swap(m_pendingReload);
+        sizes.swap(m_pendingSize);
+        std::swap(invalid, m_invalid);
+        generation = m_generation;
+    }
+
+    if (invalid)
+    {
+        LOG(VB_GENERAL, LOG_DEBUG, LOC + "Dropping all views");
+        m_views.clear();
+    }
+    else if (!m_views.isEmpty())
+    {
+        ApplyPending(reload, sizes);
+    }
+
+    QString key = QString("%1|%2|%3|%4").arg(sort).arg(sortBy.toLower())
+        .arg(ignoreLiveTV).arg(ignoreDeleted);
+
+    auto vit = m_views.constFind(key);
+    if (vit != m_views.constEnd())
+        return vit->m_programs;
+
+    if (m_views.size() >= kMaxViews)
+        m_views.clear();
+
+    ProgramList progList;
+    LoadFromRecorded(progList, false, inUseMap, isJobRunning, recMap, sort,
+                     sortBy, ignoreLiveTV, ignoreDeleted);
+
+    View view;
+    view.m_sort          = sort;
+    view.m_sortBy        = sortBy.toLower();
+    view.m_ignoreLiveTV  = ignoreLiveTV;
+    view.m_ignoreDeleted = ignoreDeleted;
+    view.m_programs.reserve(progList.size());
+
+    progList.setAutoDelete(false);
+    for (auto *pginfo : progList)
+        view.m_programs.emplace_back(pginfo);
+
+    LOG(VB_GENERAL, LOG_DEBUG, LOC + QString("Loaded %1 recordings for '%2'")
+        .arg(view.m_programs.size()).arg(key));
+
+    return m_views.insert(key, view)->m_programs;
+}
@@ -0,0 +1,100 @@
+#ifndef RECORDEDLISTCACHE_H
+#define RECORDEDLISTCACHE_H
+
+// C++
+#include <memory>
+#include <vector>
+
+// Qt
+#include <QHash>
+#include <QMap>
+#include <QMutex>
+#include <QSet>
+#include <QString>
+
+class MythEvent;
+class ProgramInfo;
+
+/** \class RecordedListCache
+ *  \brief Keeps sorted lists of the recorded table in memory.
+ *
+ *  Every distinct sort order and LiveTV/Deleted filter asked for becomes
+ *  a view that is loaded once with LoadFromRecorded(). Afterwards the
+ *  views are patched from the recording list change events the backend
+ *  already distributes, only the recordings named in those events are
+ *  read again from the database.
+ *
+ *  Events are merely queued, they are applied by the next GetList() so
+ *  the event thread never touches the database or waits for a load. The
+ *  programs handed out are never modified, a changed recording is
+ *  replaced by a new object.
+ *
+ *  The in-use, commercial flagging job and currently-recording state is
+ *  not part of the cache, callers apply it to the programs they actually
+ *  return.
+ *
+ *  The recordings named by recent events are remembered along with the
+ *  generation of the event, so clients can ask for just the recordings
+ *  changed since the generation of the list they already have.
+ */
+class RecordedListCache
+{
+  public:
+    using ProgramPtr  = std::shared_ptr<const ProgramInfo>;
+    using ProgramVect = std::vector<ProgramPtr>;
+
+    static RecordedListCache &Instance(void);
+
+    void HandleEvent(const MythEvent &event);
+
+    ProgramVect GetList(int sort, const QString &sortBy,
+                        bool ignoreLiveTV, bool ignoreDeleted,
+                        const QMap<QString,uint32_t> &inUseMap,
+                        const QMap<QString,bool> &isJobRunning,
+                        const QMap<QString,ProgramInfo*> &recMap,
+                        uint64_t &generation);
+    bool GetChangesSince(uint64_t since, QSet<uint> &changed,
+                         uint64_t &generation);
+
+  private:
+    RecordedListCache();
+
+    struct View
+    {
+        int         m_sort          { 0 };
+        QString     m_sortBy;
+        bool        m_ignoreLiveTV  { false };
+        bool        m_ignoreDeleted { false };
+        ProgramVect m_programs;
+
+        bool Accepts(const ProgramInfo &pginfo) const;
+        bool SortedByStartTime(void) const { return m_sortBy.isEmpty(); }
+    };
+
+    void ApplyPending(const QSet<uint> &reload,
+                      const QHash<uint,uint64_t> &sizes);
+    static void Remove(View &view, uint recordedid);
+    static void Insert(View &view, const ProgramPtr &pginfo);
+
+    /// Past this many queued reloads a full reload is cheaper.
+    static constexpr int    kMaxPending { 500 };
+    /// Number of differently sorted/filtered views kept at a time.
+    static constexpr int    kMaxViews   { 8 };
+    /// Number of changed recordings remembered for GetChangesSince().
+    static constexpr int    kMaxChanges { 5000 };
+
+    QMutex                  m_lock;         ///< protects m_views
+    QHash<QString,View>     m_views;
+
+    QMutex                  m_pendingLock;  ///< protects everything below
+    QSet<uint>              m_pendingReload;
+    QHash<uint,uint64_t>    m_pendingSize;
+    bool                    m_invalid    { false };
+    uint64_t                m_generation { 1 };
+    /// Generation at which each recently changed recording last changed
+    QHash<uint,uint64_t>    m_changedAt;
+    /// Changes before this generation are unknown
+    uint64_t                m_changesFrom { 1 };
+};
+
+#endif // RECORDEDLISTCACHE_H
@@ -70,6 +70,8 @@ Scheduler::Scheduler(bool runthread, QMap<int, EncoderLink *> *_tvList,
     m_doRun(runthread)
 {
     debugConflicts = qEnvironmentVariableIsSet("DEBUG_CONFLICTS");
+    // For comparing reschedule times against the unindexed search
+    m_useConflictIndex = !qEnvironmentVariableIsSet("SCHED_NO_CONFLICT_INDEX");
 
     if (master_sched)
         master_sched->GetAllPending(m_recList);
@@ -464,9 +466,18 @@ bool Scheduler::FillRecordList(void)
     LOG(VB_SCHEDULE, LOG_INFO, "BuildListMaps...");
     BuildListMaps();
     LOG(VB_SCHEDULE, LOG_INFO, "SchedNewRecords...");
+    auto schedstart = nowAsDuration<std::chrono::microseconds>();
+    m_conflictChecks = 0;
     SchedNewRecords();
     LOG(VB_SCHEDULE, LOG_INFO, "SchedLiveTV...");
     SchedLiveTV();
+    auto schedTime = nowAsDuration<std::chrono::microseconds>() - schedstart;
+    LOG(VB_SCHEDULE, LOG_INFO,
+        QString("Placed %1 showings in %2 ms with %3 conflict checks%4")
+        .arg(m_workList.size())
+        .arg(duration_cast<std::chrono::milliseconds>(schedTime).count())
+        .arg(m_conflictChecks)
+        .arg(m_useConflictIndex ? "" : " (unindexed)"));
     LOG(VB_SCHEDULE, LOG_INFO, "ClearListMaps...");
     ClearListMaps();
 
@@ -1041,6 +1052,12 @@ void Scheduler::BuildListMaps(void)
         }
     }
 
+    if (m_useConflictIndex)
+    {
+        for (auto *conflictlist : m_conflictLists)
+            m_conflictIndexes[conflictlist].Build(*conflictlist);
+    }
+
     QMap<uint, uint>::iterator it;
     for (it = badinputs.begin(); it != badinputs.end(); ++it)
     {
@@ -1054,6 +1071,7 @@ void Scheduler::ClearListMaps(void)
 {
     for (auto & conflict : m_conflictLists)
         conflict->clear();
+    m_conflictIndexes.clear();
     m_titleListMap.clear();
     m_recordIdListMap.clear();
     m_cacheIsSameProgram.clear();
@@ -1084,100 +1102,188 @@ bool Scheduler::FindNextConflict(
     bool              ignoreinput) const
 {
     uint affinity = 0;
-    for ( ; iter != cardlist.end(); ++iter)
-    {
-        const RecordingInfo *q = *iter;
-        QString msg;
-
-        if (p == q)
-            continue;
 
-        if (!Recording(q))
-            continue;
-
-        if (debugConflicts)
-        {
-            msg = QString("comparing '%1' on %2 with '%3' on %4")
-                .arg(p->GetTitle(), p->GetChanNum(),
-                     q->GetTitle(), q->GetChanNum());
+    // Only look at the showings that overlap p if the list is indexed.
+    // The debug output covers every comparison, so use the full walk then.
+    // m_recList is searched by other threads while the scheduler thread
+    // builds the indexes, and is never indexed, so don't look it up.
+    auto index = m_conflictIndexes.constEnd();
+    if (&cardlist != &m_recList && !debugConflicts)
+        index = m_conflictIndexes.constFind(&cardlist);
+    if (index != m_conflictIndexes.constEnd())
+    {
+        std::vector<uint> positions;
+        index->FindOverlapping(
+            p->GetRecordingStartTime().toSecsSinceEpoch(),
+            p->GetRecordingEndTime().toSecsSinceEpoch(), positions);
+
+        auto first = static_cast<uint>(iter - cardlist.begin());
+        auto pos = std::lower_bound(positions.cbegin(), positions.cend(),
+                                    first);
+        for ( ; pos != positions.cend(); ++pos)
+        {
+            if (IsConflicting(p, cardlist[*pos], openEnd, affinity,
+                              ignoreinput))
+            {
+                iter = cardlist.begin() + *pos;
+                if (paffinity)
+                    *paffinity += affinity;
+                return true;
+            }
         }
-
-        if (p->GetInputID() != q->GetInputID() && !ignoreinput)
+        iter = cardlist.end();
+    }
+    else
+    {
+        for ( ; iter != cardlist.end(); ++iter)
         {
-            const std::vector<unsigned int> &conflicting_inputs =
-                m_sinputInfoMap[p->GetInputID()].m_conflictingInputs;
-            if (find(conflicting_inputs.begin(), conflicting_inputs.end(),
-                     q->GetInputID()) == conflicting_inputs.end())
+            if (IsConflicting(p, *iter, openEnd, affinity, ignoreinput))
             {
-                if (debugConflicts)
-                    msg += "  cardid== ";
-                continue;
+                if (paffinity)
+                    *paffinity += affinity;
+                return true;
             }
         }
+    }
 
-        if (p->GetRecordingEndTime() < q->GetRecordingStartTime() ||
-            p->GetRecordingStartTime() > q->GetRecordingEndTime())
-        {
-            if (debugConflicts)
-                msg += "  no-overlap ";
-            continue;
-        }
+    if (debugConflicts)
+        LOG(VB_SCHEDULE, LOG_INFO, "No conflict");
+
+    if (paffinity)
+        *paffinity += affinity;
+    return false;
+}
+
+/// Returns true if \a q is recording and conflicts with \a p. Showings
+/// that can share a multiplex with \a p are counted in \a affinity.
+bool Scheduler::IsConflicting(
+    const RecordingInfo *p,
+    const RecordingInfo *q,
+    OpenEndType        openEnd,
+    uint              &affinity,
+    bool               ignoreinput) const
+{
+    QString msg;
+
+    if (p == q)
+        return false;
 
-        bool mplexid_ok =
-            (p->m_sgroupId != q->m_sgroupId ||
-             m_sinputInfoMap[p->m_sgroupId].m_schedGroup) &&
-            (((p->m_mplexId != 0U) && p->m_mplexId == q->m_mplexId) ||
-             ((p->m_mplexId == 0U) && p->GetChanID() == q->GetChanID()));
+    if (!Recording(q))
+        return false;
+
+    ++m_conflictChecks;
 
-        if (p->GetRecordingEndTime() == q->GetRecordingStartTime() ||
-            p->GetRecordingStartTime() == q->GetRecordingEndTime())
+    if (debugConflicts)
+    {
+        msg = QString("comparing '%1' on %2 with '%3' on %4")
+            .arg(p->GetTitle(), p->GetChanNum(),
+                 q->GetTitle(), q->GetChanNum());
+    }
+
+    if (p->GetInputID() != q->GetInputID() && !ignoreinput)
+    {
+        const std::vector<unsigned int> &conflicting_inputs =
+            m_sinputInfoMap[p->GetInputID()].m_conflictingInputs;
+        if (find(conflicting_inputs.begin(), conflicting_inputs.end(),
+                 q->GetInputID()) == conflicting_inputs.end())
         {
-            if (openEnd == openEndNever ||
-                (openEnd == openEndDiffChannel &&
-                 p->GetChanID() == q->GetChanID()) ||
-                (openEnd == openEndAlways &&
-                 mplexid_ok))
-            {
-                if (debugConflicts)
-                    msg += "  no-overlap ";
-                if (mplexid_ok)
-                    ++affinity;
-                continue;
-            }
+            if (debugConflicts)
+                msg += "  cardid== ";
+            return false;
         }
+    }
 
+    if (p->GetRecordingEndTime() < q->GetRecordingStartTime() ||
+        p->GetRecordingStartTime() > q->GetRecordingEndTime())
+    {
         if (debugConflicts)
-        {
-            LOG(VB_SCHEDULE, LOG_INFO, msg);
-            LOG(VB_SCHEDULE, LOG_INFO,
-                QString("  cardid's: [%1], [%2] Share an input group, "
-                        "mplexid's: %3, %4")
-                     .arg(p->GetInputID()).arg(q->GetInputID())
-                     .arg(p->m_mplexId).arg(q->m_mplexId));
-        }
+            msg += "  no-overlap ";
+        return false;
+    }
+
+    bool mplexid_ok =
+        (p->m_sgroupId != q->m_sgroupId ||
+         m_sinputInfoMap[p->m_sgroupId].m_schedGroup) &&
+        (((p->m_mplexId != 0U) && p->m_mplexId == q->m_mplexId) ||
+         ((p->m_mplexId == 0U) && p->GetChanID() == q->GetChanID()));
 
-        // if two inputs are in the same input group we have a conflict
-        // unless the programs are on the same multiplex.
-        if (mplexid_ok)
+    if (p->GetRecordingEndTime() == q->GetRecordingStartTime() ||
+        p->GetRecordingStartTime() == q->GetRecordingEndTime())
+    {
+        if (openEnd == openEndNever ||
+            (openEnd == openEndDiffChannel &&
+             p->GetChanID() == q->GetChanID()) ||
+            (openEnd == openEndAlways &&
+             mplexid_ok))
         {
-            ++affinity;
-            continue;
+            if (debugConflicts)
+                msg += "  no-overlap ";
+            if (mplexid_ok)
+                ++affinity;
+            return false;
         }
+    }
 
-        if (debugConflicts)
-            LOG(VB_SCHEDULE, LOG_INFO, "Found conflict");
+    if (debugConflicts)
+    {
+        LOG(VB_SCHEDULE, LOG_INFO, msg);
+        LOG(VB_SCHEDULE, LOG_INFO,
+            QString("  cardid's: [%1], [%2] Share an input group, "
+                    "mplexid's: %3, %4")
+                 .arg(p->GetInputID()).arg(q->GetInputID())
+                 .arg(p->m_mplexId).arg(q->m_mplexId));
+    }
 
-        if (paffinity)
-            *paffinity += affinity;
-        return true;
+    // if two inputs are in the same input group we have a conflict
+    // unless the programs are on the same multiplex.
+    if (mplexid_ok)
+    {
+        ++affinity;
+        return false;
     }
 
     if (debugConflicts)
-        LOG(VB_SCHEDULE, LOG_INFO, "No conflict");
+        LOG(VB_SCHEDULE, LOG_INFO, "Found conflict");
 
-    if (paffinity)
-        *paffinity += affinity;
-    return false;
+    return true;
+}
+
+void SchedConflictIndex::Build(const RecList &list)
+{
+    m_entries.clear();
+    m_entries.reserve(list.size());
+    m_maxLength = 0;
+
+    for (uint pos = 0; pos < list.size(); ++pos)
+    {
+        const RecordingInfo *p = list[pos];
+        qint64 start = p->GetRecordingStartTime().toSecsSinceEpoch();
+        qint64 end = p->GetRecordingEndTime().toSecsSinceEpoch();
+        m_entries.push_back({start, end, pos});
+        m_maxLength = std::max(m_maxLength, end - start);
+    }
+
+    std::sort(m_entries.begin(), m_entries.end(),
+              [](const Entry &a, const Entry &b)
+              { return a.m_start < b.m_start; });
+}
+
+void SchedConflictIndex::FindOverlapping(
+    qint64 start, qint64 end, std::vector<uint> &positions) const
+{
+    positions.clear();
+
+    // Nothing that starts before start - m_maxLength can reach start
+    auto it = std::lower_bound(
+        m_entries.cbegin(), m_entries.cend(), start - m_maxLength,
+        [](const Entry &e, qint64 t) { return e.m_start < t; });
+    for ( ; it != m_entries.cend() && it->m_start <= end; ++it)
+    {
+        if (it->m_end >= start)
+            positions.push_back(it->m_pos);
+    }
+
+    std::sort(positions.begin(), positions.end());
 }
 
 const RecordingInfo *Scheduler::FindConflict(
@@ -2373,11 +2479,24 @@ bool Scheduler::HandleReschedule(void)
             uint sourceid = tokens[2].toUInt();
             uint mplexid = tokens[3].toUInt();
             QDateTime maxstarttime = MythDate::fromString(tokens[4]);
+            // Optional list of changed channels, see BuildMatchRequest()
+            QDateTime minstarttime;
+            QList<uint> chanids;
+            if (request.size() >= 3)
+            {
+                minstarttime = MythDate::fromString(request[1]);
+                for (const QString &id : request[2].split(',', Qt::SkipEmptyParts))
+                {
+                    if (id.toUInt())
+                        chanids << id.toUInt();
+                }
+            }
             deleteFuture = true;
             runCheck = true;
             m_schedLock.unlock();
             m_recordMatchLock.lock();
-            UpdateMatches(recordid, sourceid, mplexid, maxstarttime);
+            UpdateMatches(recordid, sourceid, mplexid, maxstarttime,
+                          minstarttime, chanids);
             m_recordMatchLock.unlock();
             m_schedLock.lock();
         }
@@ -4038,14 +4157,25 @@ static QString progfindid = QString(
         .arg(kWeeklyRecord)
         .arg(kOverrideRecord);
 
+/** \fn Scheduler::UpdateMatches(uint,uint,uint,const QDateTime&,const QDateTime&,const QList<uint>&)
+ *  \brief Rebuilds the recordmatch rows for the given rule and programs.
+ *
+ *  When \a chanids is given only the programs on those channels are
+ *  matched again, and if \a minstarttime is valid only those that end
+ *  after it. Matches for programs that were removed or moved out of
+ *  the way on those channels are dropped.
+ */
 void Scheduler::UpdateMatches(uint recordid, uint sourceid, uint mplexid,
-                              const QDateTime &maxstarttime)
+                              const QDateTime &maxstarttime,
+                              const QDateTime &minstarttime,
+                              const QList<uint> &chanids)
 {
     MSqlQuery query(m_dbConn);
     MSqlBindings bindings;
     QString deleteClause;
     QString filterClause = QString(" AND program.endtime > "
                                    "(NOW() - INTERVAL 480 MINUTE)");
+    QString deleteJoin;
 
     if (recordid)
     {
@@ -4070,10 +4200,42 @@ void Scheduler::UpdateMatches(uint recordid, uint sourceid, uint mplexid,
         filterClause += " AND program.starttime <= :MAXSTARTTIME";
         bindings[":MAXSTARTTIME"] = maxstarttime;
     }
+    if (!chanids.isEmpty())
+    {
+        QStringList ids;
+        for (uint chanid : chanids)
+            ids << QString::number(chanid);
+        deleteClause += QString(" AND recordmatch.chanid IN (%1)")
+            .arg(ids.join(","));
+        filterClause += QString(" AND program.chanid IN (%1)")
+            .arg(ids.join(","));
+
+        if (minstarttime.isValid())
+        {
+            // A changed program may have moved an earlier one out of
+            // the way, so keep the matches whose program ends before
+            // the change and still exists.
+            deleteJoin = " LEFT JOIN program ON "
+                "(program.chanid = recordmatch.chanid AND "
+                " program.starttime = recordmatch.starttime AND "
+                " program.manualid = recordmatch.manualid)";
+            deleteClause += " AND (program.chanid IS NULL OR "
+                "program.endtime >= :MINSTARTTIME)";
+            filterClause += " AND program.endtime >= :MINSTARTTIME";
+            bindings[":MINSTARTTIME"] = minstarttime;
+        }
+
+        LOG(VB_SCHEDULE, LOG_INFO,
+            QString("UpdateMatches: %1 changed channels from %2")
+            .arg(chanids.size())
+            .arg(minstarttime.isValid() ?
+                 minstarttime.toString(Qt::ISODate) : "-"));
+    }
 
-    query.prepare(QString("DELETE recordmatch FROM recordmatch, channel "
-                          "WHERE recordmatch.chanid = channel.chanid")
-                  + deleteClause);
+    query.prepare(QString("DELETE recordmatch FROM recordmatch "
+                          "INNER JOIN channel ON "
+                          "(recordmatch.chanid = channel.chanid)")
+                  + deleteJoin + " WHERE 1" + deleteClause);
     MSqlBindings::const_iterator it;
     for (it = bindings.cbegin(); it != bindings.cend(); ++it)
         query.bindValue(it.key(), it.value());
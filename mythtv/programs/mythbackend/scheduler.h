@@ -42,6 +42,33 @@ class SchedInputInfo
     RecList      *m_conflictList {nullptr};
 };
 
+/** \brief Time ordered index over a conflict list.
+ *
+ *  Lets the scheduler find the showings that overlap a given time
+ *  span without walking the whole conflict list. Entries refer to
+ *  positions in the list, so the list must not be reordered while
+ *  the index is in use.
+ */
+class SchedConflictIndex
+{
+  public:
+    void Build(const RecList &list);
+
+    // Positions of the entries touching [start, end], in list order
+    void FindOverlapping(qint64 start, qint64 end,
+                         std::vector<uint> &positions) const;
+
+  private:
+    struct Entry
+    {
+        qint64 m_start;
+        qint64 m_end;
+        uint   m_pos;
+    };
+    std::vector<Entry> m_entries; // sorted by m_start
+    qint64             m_maxLength {0};
+};
+
 class Scheduler : public MThread, public MythScheduler
 {
   public:
@@ -143,7 +170,9 @@ class Scheduler : public MThread, public MythScheduler
     void UpdateDuplicates(void);
     bool FillRecordList(void);
     void UpdateMatches(uint recordid, uint sourceid, uint mplexid,
-                       const QDateTime &maxstarttime);
+                       const QDateTime &maxstarttime,
+                       const QDateTime &minstarttime = QDateTime(),
+                       const QList<uint> &chanids = QList<uint>());
     void UpdateManuals(uint recordid);
     void BuildWorkList(void);
     bool ClearWorkList(void);
@@ -164,6 +193,9 @@ class Scheduler : public MThread, public MythScheduler
                           OpenEndType openEnd = openEndNever,
                           uint *paffinity = nullptr,
                           bool ignoreinput = false) const;
+    bool IsConflicting(const RecordingInfo *p, const RecordingInfo *q,
+                       OpenEndType openEnd, uint &affinity,
+                       bool ignoreinput) const;
     const RecordingInfo *FindConflict(const RecordingInfo *p,
                                       OpenEndType openEnd = openEndNever,
                                       uint *affinity = nullptr,
@@ -248,6 +280,9 @@ class Scheduler : public MThread, public MythScheduler
     RecList                m_livetvList;
     QMap<uint, SchedInputInfo> m_sinputInfoMap;
     std::vector<RecList *> m_conflictLists;
+    QMap<const RecList *, SchedConflictIndex> m_conflictIndexes;
+    bool                   m_useConflictIndex {true};
+    mutable uint64_t       m_conflictChecks   {0};
     QMap<uint, RecList>    m_recordIdListMap;
     QMap<QString, RecList> m_titleListMap;
 
@@ -24,6 +24,7 @@
 //////////////////////////////////////////////////////////////////////////////
 
 // Qt
+#include <QCryptographicHash>
 #include <QJsonArray>
 #include <QJsonDocument>
 
@@ -47,6 +48,7 @@
 #include "autoexpire.h"
 #include "backendcontext.h"
 #include "encoderlink.h"
+#include "recordedlistcache.h"
 #include "scheduler.h"
 #include "v2dvr.h"
 #include "v2serviceUtil.h"
@@ -174,8 +176,6 @@ V2ProgramList* V2Dvr::GetRecordedList( bool           bDescending,
     QMap< QString, uint32_t > inUseMap    = ProgramInfo::QueryInUseMap();
     QMap< QString, bool >     isJobRunning= ProgramInfo::QueryJobsRunning(JOB_COMMFLAG);
 
-    ProgramList progList;
-
     int desc = 1;
     if (bDescending)
         desc = -1;
@@ -194,23 +194,49 @@ V2ProgramList* V2Dvr::GetRecordedList( bool           bDescending,
                                          .arg(sRecGroup));
     }
 
-    LoadFromRecorded( progList, false, inUseMap, isJobRunning, recMap, desc,
-                      sSort, bIgnoreLiveTV, bIgnoreDeleted );
+    uint64_t generation = 0;
+    RecordedListCache::ProgramVect progList =
+        RecordedListCache::Instance().GetList( desc, sSort, bIgnoreLiveTV,
+                                               bIgnoreDeleted, inUseMap,
+                                               isJobRunning, recMap,
+                                               generation );
 
-    QMap< QString, ProgramInfo* >::iterator mit = recMap.begin();
+    // ----------------------------------------------------------------------
+    // The cached list only changes with the generation, everything else
+    // that goes into the response is covered by the ETag as well.
+    // ----------------------------------------------------------------------
 
-    for (; mit != recMap.end(); mit = recMap.erase(mit))
-        delete *mit;
+    QCryptographicHash etag(QCryptographicHash::Sha1);
+    etag.addData(QByteArray::number(static_cast<qulonglong>(generation)));
+    etag.addData(MythHTTP::GetHeader(m_request->m_headers, "accept").toUtf8());
+    for (auto it = m_request->m_queries.cbegin(); it != m_request->m_queries.cend(); ++it)
+        etag.addData(QString("&%1=%2").arg(it.key(), it.value()).toUtf8());
+    for (auto it = inUseMap.cbegin(); it != inUseMap.cend(); ++it)
+        etag.addData(QString("&%1:%2").arg(it.key()).arg(*it).toUtf8());
+    for (auto it = isJobRunning.cbegin(); it != isJobRunning.cend(); ++it)
+        etag.addData(QString("&job:%1").arg(it.key()).toUtf8());
+    for (auto it = recMap.cbegin(); it != recMap.cend(); ++it)
+        etag.addData(QString("&%1").arg(it.key()).toUtf8());
+
+    auto *pPrograms = new V2ProgramList();
+
+    if (CheckETag(etag.result().toHex()))
+    {
+        for (auto *pInfo : std::as_const(recMap))
+            delete pInfo;
+        pPrograms->setAsOf          ( MythDate::current() );
+        pPrograms->setVersion       ( MYTH_BINARY_VERSION );
+        pPrograms->setProtoVer      ( MYTH_PROTO_VERSION  );
+        return pPrograms;
+    }
 
     // ----------------------------------------------------------------------
     // Build Response
     // ----------------------------------------------------------------------
 
-    auto *pPrograms = new V2ProgramList();
-
     int nAvailable = 0;
 
-    int nMax      = (nCount > 0) ? nCount : progList.size();
+    int nMax      = (nCount > 0) ? nCount : static_cast<int>(progList.size());
 
     nAvailable = 0;
     nCount = 0;
@@ -218,13 +244,16 @@ V2ProgramList* V2Dvr::GetRecordedList( bool           bDescending,
     QRegularExpression rTitleRegEx
         { sTitleRegEx, QRegularExpression::CaseInsensitiveOption };
 
-    for (auto *pInfo : progList)
+    QDateTime rectime = MythDate::current().addSecs(
+        -gCoreContext->GetNumSetting("RecordOverTime"));
+
+    for (const auto &pCached : progList)
     {
-        if (pInfo->IsDeletePending() ||
-            (!sTitleRegEx.isEmpty() && !pInfo->GetTitle().contains(rTitleRegEx)) ||
-            (!sRecGroup.isEmpty() && sRecGroup != pInfo->GetRecordingGroup()) ||
-            (!sStorageGroup.isEmpty() && sStorageGroup != pInfo->GetStorageGroup()) ||
-            (!sCategory.isEmpty() && sCategory != pInfo->GetCategory()))
+        if (pCached->IsDeletePending() ||
+            (!sTitleRegEx.isEmpty() && !pCached->GetTitle().contains(rTitleRegEx)) ||
+            (!sRecGroup.isEmpty() && sRecGroup != pCached->GetRecordingGroup()) ||
+            (!sStorageGroup.isEmpty() && sStorageGroup != pCached->GetStorageGroup()) ||
+            (!sCategory.isEmpty() && sCategory != pCached->GetCategory()))
             continue;
 
         if ((nAvailable < nStartIndex) ||
@@ -237,10 +266,25 @@ V2ProgramList* V2Dvr::GetRecordedList( bool           bDescending,
         ++nAvailable;
         ++nCount;
 
+        // Apply the current in-use, job and recording state, the cache
+        // does not keep track of those.
+        ProgramInfo info(*pCached);
+        QString key = info.MakeUniqueKey();
+        info.SetInUseFlags(inUseMap.value(key, 0));
+        info.SetCommFlagJobRunning(isJobRunning.contains(key));
+        info.SetRecordingStatus(
+            (info.GetRecordingEndTime() > rectime && recMap.contains(key))
+            ? RecStatus::Recording : RecStatus::Recorded);
+
         V2Program *pProgram = pPrograms->AddNewProgram();
-        V2FillProgramInfo( pProgram, pInfo, bIncChannel, bDetails, bIncCast, bIncArtWork, bIncRecording );
+        V2FillProgramInfo( pProgram, &info, bIncChannel, bDetails, bIncCast, bIncArtWork, bIncRecording );
     }
 
+    QMap< QString, ProgramInfo* >::iterator mit = recMap.begin();
+
+    for (; mit != recMap.end(); mit = recMap.erase(mit))
+        delete *mit;
+
     // ----------------------------------------------------------------------
 
     pPrograms->setStartIndex    ( nStartIndex     );
@@ -1,5 +1,6 @@
 // C++ headers
 #include <algorithm> // for min/max, clamp
+#include <array>
 #include <cmath>
 #include <iostream> // for cerr
 #include <thread> // for sleep_for
@@ -21,6 +22,10 @@
 #include "ClassicLogoDetector.h"
 #include "ClassicSceneChangeDetector.h"
 
+#ifdef Q_PROCESSOR_X86_64
+#   include <emmintrin.h>
+#endif
+
 enum frameAspects : std::uint8_t {
     COMM_ASPECT_NORMAL = 0,
     COMM_ASPECT_WIDE
@@ -118,6 +123,37 @@ QString FrameInfoEntry::toString(uint64_t frame, bool verbose) const
              toStringFrameMaskValues(flagMask, verbose));
 }
 
+FrameInfoEntry &FrameInfoList::operator[](long long frame)
+{
+    if (frame < 0)
+    {
+        m_invalid = FrameInfoEntry {};
+        return m_invalid;
+    }
+
+    if (frame >= static_cast<long long>(m_entries.size()))
+    {
+        m_entries.resize(frame + 1, FrameInfoEntry {});
+        m_present.resize(frame + 1, false);
+    }
+    m_present[frame] = true;
+    return m_entries[frame];
+}
+
+void FrameInfoList::reserve(long long frames)
+{
+    if (frames <= 0)
+        return;
+    m_entries.reserve(frames);
+    m_present.reserve(frames);
+}
+
+void FrameInfoList::clear(void)
+{
+    m_entries.clear();
+    m_present.clear();
+}
+
 ClassicCommDetector::ClassicCommDetector(SkipType commDetectMethod_in,
                                          bool showProgress_in,
                                          bool fullSpeed_in,
@@ -229,6 +265,13 @@ void ClassicCommDetector::Init()
     m_totalMinBrightness = 0;
     m_blankFrameCount = 0;
 
+    m_rowMax.assign(m_height, 0);
+    m_colMax.assign(m_width, 0);
+    m_decodeTime = 0us;
+    m_sceneTime = 0us;
+    m_blankTime = 0us;
+    m_logoTime = 0us;
+
     m_aggressiveDetection = true;
     m_currentAspect = COMM_ASPECT_WIDE;
     m_decoderFoundAspectChanges = false;
@@ -391,6 +434,7 @@ bool ClassicCommDetector::go()
     else
         myTotalFrames = (long long)(m_player->GetFrameRate() *
                         (m_recordingStartedAt.secsTo(m_recordingStopsAt)));
+    m_frameInfo.reserve(myTotalFrames + 1);
 
     if (m_showProgress)
     {
@@ -416,8 +460,10 @@ bool ClassicCommDetector::go()
         if (m_stillRecording)
             startTime = nowAsDuration<std::chrono::microseconds>();
 
+        auto decodeStart = nowAsDuration<std::chrono::microseconds>();
         MythVideoFrame* currentFrame = m_player->GetRawVideoFrame();
         long long currentFrameNumber = currentFrame->m_frameNumber;
+        m_decodeTime += nowAsDuration<std::chrono::microseconds>() - decodeStart;
 
         //Lucas: maybe we should make the nuppelvideoplayer send out a signal
         //when the aspect ratio changes.
@@ -740,6 +786,68 @@ void ClassicCommDetector::SetVideoParams(float aspect)
     }
 }
 
+/** \brief Luma statistics of one row of samples.
+ *
+ *  Lowers \a min, raises \a max and the per column maximums in \a colMax
+ *  and adds the samples to \a sum. Uses SSE2 where available, the plain
+ *  loop is simple enough for the compiler to vectorise elsewhere.
+ *  \return the maximum of the row
+ */
+static unsigned char luma_row_stats(const unsigned char *samples, int count,
+                                    unsigned char *colMax, int &min, int &max,
+                                    long long &sum)
+{
+    int i = 0;
+    unsigned char lo = 255;
+    unsigned char hi = 0;
+    uint64_t total = 0;
+
+#ifdef Q_PROCESSOR_X86_64
+    if (count >= 16)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        __m128i vlo  = _mm_set1_epi8(-1);
+        __m128i vhi  = zero;
+        __m128i vsum = zero;
+        for (; i + 16 <= count; i += 16)
+        {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(samples + i));
+            auto *col = reinterpret_cast<__m128i*>(colMax + i);
+            vlo  = _mm_min_epu8(vlo, v);
+            vhi  = _mm_max_epu8(vhi, v);
+            vsum = _mm_add_epi64(vsum, _mm_sad_epu8(v, zero));
+            _mm_storeu_si128(col, _mm_max_epu8(_mm_loadu_si128(col), v));
+        }
+
+        std::array<unsigned char,16> los {};
+        std::array<unsigned char,16> his {};
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(los.data()), vlo);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(his.data()), vhi);
+        lo = *std::min_element(los.cbegin(), los.cend());
+        hi = *std::max_element(his.cbegin(), his.cend());
+        total = _mm_cvtsi128_si64(vsum) +
+                _mm_cvtsi128_si64(_mm_unpackhi_epi64(vsum, vsum));
+    }
+#endif
+
+    for (; i < count; i++)
+    {
+        unsigned char pixel = samples[i];
+        lo = std::min(lo, pixel);
+        hi = std::max(hi, pixel);
+        total += pixel;
+        colMax[i] = std::max(colMax[i], pixel);
+    }
+
+    if (count > 0)
+    {
+        min = std::min<int>(min, lo);
+        max = std::max<int>(max, hi);
+        sum += total;
+    }
+    return hi;
+}
+
 void ClassicCommDetector::ProcessFrame(MythVideoFrame *frame,
                                        long long frame_number)
 {
@@ -747,10 +855,6 @@ void ClassicCommDetector::ProcessFrame(MythVideoFrame *frame,
     int min = 255;
     int blankPixelsChecked = 0;
     long long totBrightness = 0;
-    auto *rowMax = new unsigned char[m_height];
-    auto *colMax = new unsigned char[m_width];
-    memset(rowMax, 0, sizeof(*rowMax)*m_height);
-    memset(colMax, 0, sizeof(*colMax)*m_width);
     int topDarkRow = m_commDetectBorder;
     int bottomDarkRow = m_height - m_commDetectBorder - 1;
     int leftDarkCol = m_commDetectBorder;
@@ -762,8 +866,6 @@ void ClassicCommDetector::ProcessFrame(MythVideoFrame *frame,
     {
         LOG(VB_COMMFLAG, LOG_ERR, "CommDetect: Invalid video frame or codec, "
                                   "unable to process frame.");
-        delete[] rowMax;
-        delete[] colMax;
         return;
     }
 
@@ -771,8 +873,6 @@ void ClassicCommDetector::ProcessFrame(MythVideoFrame *frame,
     {
         LOG(VB_COMMFLAG, LOG_ERR, "CommDetect: Width or Height is 0, "
                                   "unable to process frame.");
-        delete[] rowMax;
-        delete[] colMax;
         return;
     }
 
@@ -813,43 +913,72 @@ void ClassicCommDetector::ProcessFrame(MythVideoFrame *frame,
     if (m_commDetectMethod & COMM_DETECT_BLANKS)
         m_frameIsBlank = false;
 
+    auto stageStart = nowAsDuration<std::chrono::microseconds>();
     if (m_commDetectMethod & COMM_DETECT_SCENE)
     {
         m_sceneChangeDetector->processFrame(frame);
     }
+    auto stageEnd = nowAsDuration<std::chrono::microseconds>();
+    m_sceneTime += stageEnd - stageStart;
+    stageStart = stageEnd;
 
     m_stationLogoPresent = false;
 
-    for(int y = m_commDetectBorder; y < (m_height - m_commDetectBorder);
-            y += m_vertSpacing)
+    unsigned char *rowMax = m_rowMax.data();
+    unsigned char *colMax = m_colMax.data();
+    if (m_commDetectMethod & COMM_DETECT_BLANKS)
     {
-        for(int x = m_commDetectBorder; x < (m_width - m_commDetectBorder);
-                x += m_horizSpacing)
+        std::fill(m_rowMax.begin(), m_rowMax.end(), 0);
+        std::fill(m_colMax.begin(), m_colMax.end(), 0);
+
+        // The sampled columns, the samples of a row and their maximums are
+        // kept packed so the statistics can be gathered a vector at a time.
+        int firstCol = m_commDetectBorder;
+        int columns = std::max(0, (m_width - (2 * m_commDetectBorder) +
+                                   m_horizSpacing - 1) / m_horizSpacing);
+        m_rowSamples.resize(columns);
+        m_sampleColMax.assign(columns, 0);
+        unsigned char *samples = m_rowSamples.data();
+        unsigned char *sampleColMax = m_sampleColMax.data();
+
+        // Only look the logo up per pixel when it has to be skipped.
+        bool skipLogo = m_commDetectBlankCanHaveLogo && m_logoInfoAvailable;
+
+        for(int y = m_commDetectBorder; y < (m_height - m_commDetectBorder);
+                y += m_vertSpacing)
         {
-            uchar pixel = framePtr[(y * bytesPerLine) + x];
+            const unsigned char *row = framePtr + (y * bytesPerLine);
+
+            if (!skipLogo)
+            {
+                for (int i = 0, x = firstCol; i < columns; i++, x += m_horizSpacing)
+                    samples[i] = row[x];
+                rowMax[y] = luma_row_stats(samples, columns, sampleColMax,
+                                           min, max, totBrightness);
+                blankPixelsChecked += columns;
+                continue;
+            }
 
-            if (m_commDetectMethod & COMM_DETECT_BLANKS)
+            unsigned char rowPeak = 0;
+            for (int i = 0, x = firstCol; i < columns; i++, x += m_horizSpacing)
             {
-                 bool checkPixel = false;
-                 if (!m_commDetectBlankCanHaveLogo)
-                     checkPixel = true;
-
-                 if (!m_logoInfoAvailable ||
-                     !m_logoDetector->pixelInsideLogo(x,y))
-                     checkPixel=true;
-
-                 if (checkPixel)
-                 {
-                     blankPixelsChecked++;
-                     totBrightness += pixel;
-
-                     min = std::min<int>(pixel, min);
-                     max = std::max<int>(pixel, max);
-                     rowMax[y] = std::max(pixel, rowMax[y]);
-                     colMax[x] = std::max(pixel, colMax[x]);
-                 }
+                if (m_logoDetector->pixelInsideLogo(x,y))
+                    continue;
+
+                unsigned char pixel = row[x];
+                blankPixelsChecked++;
+                totBrightness += pixel;
+
+                min = std::min<int>(pixel, min);
+                max = std::max<int>(pixel, max);
+                rowPeak = std::max(pixel, rowPeak);
+                sampleColMax[i] = std::max(pixel, sampleColMax[i]);
             }
+            rowMax[y] = rowPeak;
         }
+
+        for (int i = 0, x = firstCol; i < columns; i++, x += m_horizSpacing)
+            colMax[x] = sampleColMax[i];
     }
 
     if ((m_commDetectMethod & COMM_DETECT_BLANKS) && blankPixelsChecked)
@@ -867,8 +996,6 @@ void ClassicCommDetector::ProcessFrame(MythVideoFrame *frame,
             if (rowMax[y] >= m_commDetectBoxBrightness)
                 bottomDarkRow = y;
 
-        delete[] rowMax;
-        rowMax = nullptr;
 
         for(int x = m_commDetectBorder; x < (m_width - m_commDetectBorder);
                 x += m_horizSpacing)
@@ -883,8 +1010,6 @@ void ClassicCommDetector::ProcessFrame(MythVideoFrame *frame,
             if (colMax[x] >= m_commDetectBoxBrightness)
                 rightDarkCol = x;
 
-        delete[] colMax;
-        colMax = nullptr;
 
         m_frameInfo[m_curFrameNumber].format = COMM_FORMAT_NORMAL;
         if ((topDarkRow > m_commDetectBorder) &&
@@ -929,11 +1054,16 @@ void ClassicCommDetector::ProcessFrame(MythVideoFrame *frame,
             m_frameIsBlank = true;
     }
 
+    stageEnd = nowAsDuration<std::chrono::microseconds>();
+    m_blankTime += stageEnd - stageStart;
+    stageStart = stageEnd;
+
     if ((m_logoInfoAvailable) && (m_commDetectMethod & COMM_DETECT_LOGO))
     {
         m_stationLogoPresent =
             m_logoDetector->doesThisFrameContainTheFoundLogo(frame);
     }
+    m_logoTime += nowAsDuration<std::chrono::microseconds>() - stageStart;
 
 #if 0
     if ((m_commDetectMethod == COMM_DETECT_ALL) &&
@@ -975,8 +1105,6 @@ void ClassicCommDetector::ProcessFrame(MythVideoFrame *frame,
     }
 
     m_framesProcessed++;
-    delete[] rowMax;
-    delete[] colMax;
 }
 
 void ClassicCommDetector::ClearAllMaps(void)
@@ -2479,11 +2607,10 @@ void ClassicCommDetector::PrintFullMap(
 
     for (long long i = 1; i < m_curFrameNumber; i++)
     {
-        QMap<long long, FrameInfoEntry>::const_iterator it = m_frameInfo.find(i);
-        if (it == m_frameInfo.end())
+        if (!m_frameInfo.contains(i))
             continue;
 
-        QByteArray atmp = (*it).toString(i, verbose).toLatin1();
+        QByteArray atmp = m_frameInfo.at(i).toString(i, verbose).toLatin1();
         out << atmp.constData() << " ";
         if (comm_breaks)
         {
@@ -2503,4 +2630,25 @@ void ClassicCommDetector::PrintFullMap(
     out << std::flush;
 }
 
+void ClassicCommDetector::PrintBenchmark(std::ostream &out) const
+{
+    auto fps = [this](std::chrono::microseconds elapsed)
+    {
+        if (elapsed <= 0us)
+            return QString("-");
+        return QString::number(m_framesProcessed * 1000000.0 / elapsed.count(),
+                               'f', 1);
+    };
+
+    QString tmp = QString("Processed %1 frames\n"
+                          "  decode      %2 fps\n"
+                          "  scene       %3 fps\n"
+                          "  blank/luma  %4 fps\n"
+                          "  logo        %5 fps\n")
+        .arg(m_framesProcessed)
+        .arg(fps(m_decodeTime), fps(m_sceneTime),
+             fps(m_blankTime), fps(m_logoTime));
+    out << qPrintable(tmp) << std::flush;
+}
+
 /* vim: set expandtab tabstop=4 shiftwidth=4: */
@@ -3,6 +3,7 @@
 
 // C++ headers
 #include <cstdint>
+#include <vector>
 
 // Qt headers
 #include <QObject>
@@ -11,6 +12,7 @@
 #include <QElapsedTimer>
 
 // MythTV headers
+#include "libmythbase/mythchrono.h"
 #include "libmythbase/programinfo.h"
 #include "libmythtv/mythframe.h"
 
@@ -44,6 +46,32 @@ class FrameInfoEntry
     QString toString(uint64_t frame, bool verbose) const;
 };
 
+/** \class FrameInfoList
+ *  \brief Per frame analysis results, stored contiguously by frame number.
+ *
+ *  Drop-in replacement for a QMap<long long, FrameInfoEntry>: operator[]
+ *  creates missing entries and contains() tells whether a frame has been
+ *  stored, but lookups are plain array indexing.
+ */
+class FrameInfoList
+{
+  public:
+    FrameInfoEntry &operator[](long long frame);
+    const FrameInfoEntry &at(long long frame) const { return m_entries[frame]; }
+    bool contains(long long frame) const
+    {
+        return (frame >= 0) && (frame < static_cast<long long>(m_present.size())) &&
+            m_present[frame];
+    }
+    void reserve(long long frames);
+    void clear(void);
+
+  private:
+    std::vector<FrameInfoEntry> m_entries;
+    std::vector<bool>           m_present;
+    FrameInfoEntry              m_invalid {};
+};
+
 class ClassicCommDetector : public CommDetectorBase
 {
     Q_OBJECT
@@ -65,6 +93,7 @@ class ClassicCommDetector : public CommDetectorBase
         void PrintFullMap(
             std::ostream &out, const frm_dir_map_t *comm_breaks,
             bool verbose) const override; // CommDetectorBase
+        void PrintBenchmark(std::ostream &out) const override; // CommDetectorBase
 
         void logoDetectorBreathe();
 
@@ -184,6 +213,18 @@ class ClassicCommDetector : public CommDetectorBase
 
         SceneChangeDetectorBase* m_sceneChangeDetector {nullptr};
 
+        // Scratch space for ProcessFrame(), sized once in Init()
+        std::vector<unsigned char> m_rowMax;
+        std::vector<unsigned char> m_colMax;
+        std::vector<unsigned char> m_rowSamples;   // one row, packed
+        std::vector<unsigned char> m_sampleColMax; // column maximums, packed
+
+        // Time spent in each stage, reported by PrintBenchmark()
+        std::chrono::microseconds m_decodeTime {0us};
+        std::chrono::microseconds m_sceneTime  {0us};
+        std::chrono::microseconds m_blankTime  {0us};
+        std::chrono::microseconds m_logoTime   {0us};
+
 protected:
         MythCommFlagPlayer *m_player       {nullptr};
         QDateTime m_startedAt;
@@ -203,7 +244,7 @@ protected:
         void Init();
         void SetVideoParams(float aspect);
         void ProcessFrame(MythVideoFrame *frame, long long frame_number);
-        QMap<long long, FrameInfoEntry> m_frameInfo;
+        FrameInfoList m_frameInfo;
 
 public slots:
         void sceneChangeDetectorHasNewInformation(unsigned int framenum, bool isSceneChange,float debugValue);
@@ -41,6 +41,7 @@ public:
 
     virtual void PrintFullMap(
         std::ostream &out, const frm_dir_map_t *comm_breaks, bool verbose) const = 0;
+    virtual void PrintBenchmark([[maybe_unused]] std::ostream &out) const {}
 
 signals:
     void statusUpdate(const QString& a) ;
@@ -417,6 +417,9 @@ static int DoFlagCommercials(
     bool result = commDetector->go();
     int comms_found = 0;
 
+    if (cmdline.toBool("benchmark"))
+        commDetector->PrintBenchmark(std::cout);
+
     if (result)
     {
         cfp->SaveTotalDuration();
@@ -77,6 +77,10 @@ void MythCommFlagCommandLineParser::LoadArguments(void)
     add("--noprogress", "noprogress", false,
         "Don't print progress on stdout.", "")
             ->SetGroup("Logging");
+    add("--benchmark", "benchmark", false,
+        "Print the frames per second reached by each stage of "
+        "the commercial detector when done.", "")
+            ->SetGroup("Commflagging");
     add("--force", "force", false,
         "Force operation, even if program appears to be in use.", "")
             ->SetGroup("Advanced");
@@ -0,0 +1,219 @@
+// C++ headers
+#include <algorithm>
+
+// Qt headers
+#include <QStringList>
+
+// MythTV headers
+#include "libmythbase/mythdate.h"
+#include "libmythbase/mythlogging.h"
+
+// MythFrontend
+#include "guidedatacache.h"
+
+#define LOC QString("GuideDataCache: ")
+
+/// Loads what GuideGrid used to load for every row, one channel and the
+/// exact times shown.
+static void load_channel(ProgramList &proglist, uint chanid,
+                         const QDateTime &start, const QDateTime &end,
+                         const ProgramList &schedList)
+{
+    MSqlBindings bindings;
+    QString querystr = "WHERE program.chanid = :CHANID "
+                       "  AND program.endtime >= :STARTTS "
+                       "  AND program.starttime <= :ENDTS "
+                       "  AND program.starttime >= :STARTLIMITTS "
+                       "  AND program.manualid = 0 ";
+    bindings[":CHANID"]  = chanid;
+    bindings[":STARTTS"] = start;
+    bindings[":STARTLIMITTS"] = start.addDays(-1);
+    bindings[":ENDTS"] = end;
+
+    LoadFromProgram(proglist, querystr, bindings, schedList,
+                    ProgGroupBy::ChanNum);
+}
+
+qint64 GuideDataCache::WindowStart(const QDateTime &start)
+{
+    qint64 secs = start.toSecsSinceEpoch();
+    return secs - (secs % kWindowStep);
+}
+
+/** \brief Returns the programs of chanid between start and end.
+ *
+ *  The result is the same as that of the per channel query GuideGrid used
+ *  before. If the channel is not cached yet, it is loaded together with the
+ *  neighbours that are not cached either.
+ *  \param neighbours channels that are likely to be asked for next, usually
+ *                    the rows on the current and adjacent pages
+ *  \return a new list owned by the caller
+ */
+ProgramList *GuideDataCache::GetPrograms(uint chanid,
+                                         const QDateTime &start,
+                                         const QDateTime &end,
+                                         const std::vector<uint> &neighbours,
+                                         const ProgramList &schedList)
+{
+    auto *proglist = new ProgramList();
+    qint64 windowStart = WindowStart(start);
+
+    // Guides this wide are unusual, don't bother caching them
+    if (end.toSecsSinceEpoch() > windowStart + kWindowSecs)
+    {
+        load_channel(*proglist, chanid, start, end, schedList);
+        return proglist;
+    }
+
+    for (int attempt = 0; attempt < 2; ++attempt)
+    {
+        {
+            QMutexLocker locker(&m_lock);
+            const ChannelPrograms *programs = nullptr;
+            auto wit = m_windows.constFind(windowStart);
+            if (wit != m_windows.constEnd())
+            {
+                auto cit = wit->constFind(chanid);
+                if (cit != wit->constEnd())
+                    programs = &cit.value();
+            }
+            if (programs)
+            {
+                QDateTime startLimit = start.addDays(-1);
+                for (const auto & pginfo : *programs)
+                {
+                    if (pginfo.GetScheduledEndTime()   >= start &&
+                        pginfo.GetScheduledStartTime() <= end   &&
+                        pginfo.GetScheduledStartTime() >= startLimit)
+                    {
+                        proglist->push_back(new ProgramInfo(pginfo));
+                    }
+                }
+                m_lru.remove(windowStart);
+                m_lru.push_front(windowStart);
+                return proglist;
+            }
+        }
+
+        if (attempt == 0)
+        {
+            std::vector<uint> chanids { chanid };
+            chanids.insert(chanids.end(), neighbours.cbegin(), neighbours.cend());
+            Load(windowStart, chanids, schedList);
+        }
+    }
+
+    // The load failed or was thrown away by Clear()
+    load_channel(*proglist, chanid, start, end, schedList);
+    return proglist;
+}
+
+/// \brief Loads chanids for the windows around start, so that paging in
+///        any direction finds the programs in memory.
+void GuideDataCache::Prefetch(const std::vector<uint> &chanids,
+                              const QDateTime &start,
+                              const ProgramList &schedList)
+{
+    qint64 windowStart = WindowStart(start);
+    Load(windowStart, chanids, schedList);
+    Load(windowStart + kWindowStep, chanids, schedList);
+    Load(windowStart - kWindowStep, chanids, schedList);
+}
+
+void GuideDataCache::Clear(void)
+{
+    QMutexLocker locker(&m_lock);
+    m_windows.clear();
+    m_lru.clear();
+    ++m_generation;
+}
+
+/// Loads the channels of chanids that the window does not have yet.
+void GuideDataCache::Load(qint64 windowStart, const std::vector<uint> &chanids,
+                          const ProgramList &schedList)
+{
+    QMutexLocker loadLocker(&m_loadLock);
+
+    uint64_t generation = 0;
+    std::vector<uint> missing;
+    {
+        QMutexLocker locker(&m_lock);
+        generation = m_generation;
+        auto wit = m_windows.constFind(windowStart);
+        for (uint chanid : chanids)
+        {
+            if ((wit == m_windows.constEnd() || !wit->contains(chanid)) &&
+                std::find(missing.cbegin(), missing.cend(), chanid) == missing.cend())
+            {
+                missing.push_back(chanid);
+            }
+        }
+    }
+    if (missing.empty())
+        return;
+
+    QDateTime from = MythDate::fromSecsSinceEpoch(windowStart);
+    QDateTime to = from.addSecs(kWindowSecs);
+    Window loaded;
+
+    for (size_t first = 0; first < missing.size(); first += kQueryChannels)
+    {
+        size_t last = std::min(first + kQueryChannels, missing.size());
+        QStringList ids;
+        for (size_t i = first; i < last; ++i)
+        {
+            ids << QString::number(missing[i]);
+            loaded[missing[i]];
+        }
+
+        // The program table's key includes the channel, so unlike the guide's
+        // old per channel query this needs no ProgGroupBy::ChanNum.
+        MSqlBindings bindings;
+        QString querystr = QString(
+            "WHERE program.chanid IN (%1) "
+            "  AND program.endtime >= :STARTTS "
+            "  AND program.starttime <= :ENDTS "
+            "  AND program.starttime >= :STARTLIMITTS "
+            "  AND program.manualid = 0 "
+            "ORDER BY program.chanid, program.starttime ").arg(ids.join(","));
+        bindings[":STARTTS"] = from;
+        bindings[":STARTLIMITTS"] = from.addDays(-1);
+        bindings[":ENDTS"] = to;
+
+        ProgramList proglist;
+        if (!LoadFromProgram(proglist, querystr, bindings, schedList,
+                             ProgGroupBy::None))
+        {
+            return;
+        }
+
+        for (auto *pginfo : proglist)
+            loaded[pginfo->GetChanID()].push_back(*pginfo);
+    }
+
+    for (auto & programs : loaded)
+    {
+        std::stable_sort(programs.begin(), programs.end(),
+                         [](const ProgramInfo &a, const ProgramInfo &b)
+                         { return a.GetScheduledStartTime() < b.GetScheduledStartTime(); });
+    }
+
+    LOG(VB_GUI, LOG_DEBUG, LOC + QString("Loaded %1 channels from %2")
+        .arg(missing.size()).arg(MythDate::toString(from, MythDate::ISODate)));
+
+    QMutexLocker locker(&m_lock);
+    if (generation != m_generation)
+        return;
+
+    Window &window = m_windows[windowStart];
+    for (auto it = loaded.begin(); it != loaded.end(); ++it)
+        window.insert(it.key(), std::move(it.value()));
+
+    m_lru.remove(windowStart);
+    m_lru.push_front(windowStart);
+    while (m_lru.size() > static_cast<size_t>(kMaxWindows))
+    {
+        m_windows.remove(m_lru.back());
+        m_lru.pop_back();
+    }
+}
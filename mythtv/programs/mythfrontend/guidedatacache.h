@@ -0,0 +1,68 @@
+// -*- Mode: c++ -*-
+#ifndef GUIDE_DATA_CACHE_H
+#define GUIDE_DATA_CACHE_H
+
+// C++ headers
+#include <cstdint>
+#include <list>
+#include <vector>
+
+// Qt headers
+#include <QDateTime>
+#include <QHash>
+#include <QMutex>
+
+// MythTV headers
+#include "libmythbase/programinfo.h"
+
+/** \class GuideDataCache
+ *  \brief Programs of the channels shown by GuideGrid, loaded in bulk.
+ *
+ *  Instead of one query per channel row, the programs of a whole block of
+ *  channels are loaded with one query for a time window that is wider than
+ *  the guide shows, so scrolling and paging mostly only copies programs
+ *  that are already in memory. Prefetch() loads the neighbouring pages
+ *  ahead of time.
+ *
+ *  The recording status of the programs depends on the schedule list
+ *  passed in, so Clear() must be called when the schedule changes.
+ *
+ *  All methods are thread safe.
+ */
+class GuideDataCache
+{
+  public:
+    ProgramList *GetPrograms(uint chanid,
+                             const QDateTime &start, const QDateTime &end,
+                             const std::vector<uint> &neighbours,
+                             const ProgramList &schedList);
+    void Prefetch(const std::vector<uint> &chanids, const QDateTime &start,
+                  const ProgramList &schedList);
+    void Clear(void);
+
+  private:
+    using ChannelPrograms = std::vector<ProgramInfo>;
+    using Window          = QHash<uint,ChannelPrograms>;
+
+    static qint64 WindowStart(const QDateTime &start);
+    void Load(qint64 windowStart, const std::vector<uint> &chanids,
+              const ProgramList &schedList);
+
+    /// Length of a window, any guide page fits into one window.
+    static constexpr qint64 kWindowSecs    { 12LL * 60 * 60 };
+    /// Windows start at multiples of this.
+    static constexpr qint64 kWindowStep    { 6LL * 60 * 60 };
+    /// Number of windows kept, the least recently used is dropped.
+    static constexpr int    kMaxWindows    { 4 };
+    /// Channels per query, keeps the result well below the 20000 rows
+    /// LoadFromProgram() returns at most.
+    static constexpr int    kQueryChannels { 100 };
+
+    QMutex                  m_loadLock;  ///< serializes Load()
+    QMutex                  m_lock;      ///< protects everything below
+    QHash<qint64,Window>    m_windows;
+    std::list<qint64>       m_lru;       ///< most recently used first
+    uint64_t                m_generation { 0 }; ///< incremented by Clear()
+};
+
+#endif // GUIDE_DATA_CACHE_H
@@ -340,6 +340,33 @@ public:
     QVector<bool> m_unavailables;
 };
 
+/// Loads the programs of the pages around the one shown into the
+/// GuideDataCache, so that scrolling does not have to wait for the database.
+class GuidePrefetch : public GuideUpdaterBase
+{
+public:
+    GuidePrefetch(GuideGrid *guide, std::vector<uint> chanids,
+                  QDateTime start, uint startChan)
+        : GuideUpdaterBase(guide), m_chanids(std::move(chanids)),
+          m_currentStartTime(std::move(start)),
+          m_currentStartChannel(startChan) {}
+    bool ExecuteNonUI(void) override // GuideUpdaterBase
+    {
+        if (m_currentStartChannel == m_guide->GetCurrentStartChannel() &&
+            m_currentStartTime == m_guide->GetCurrentStartTime())
+        {
+            m_guide->prefetchPrograms(m_chanids, m_currentStartTime);
+        }
+        return false;
+    }
+    void ExecuteUI(void) override {} // GuideUpdaterBase
+
+private:
+    const std::vector<uint> m_chanids;
+    const QDateTime m_currentStartTime;
+    const uint m_currentStartChannel;
+};
+
 class UpdateGuideEvent : public QEvent
 {
 public:
@@ -498,6 +525,7 @@ GuideGrid::GuideGrid(MythScreenStack *parent,
     m_channelOrdering(gCoreContext->GetSetting("ChannelOrdering", "channum")),
     m_updateTimer(new QTimer(this)),
     m_threadPool("GuideGridHelperPool"),
+    m_prefetchPool("GuideGridPrefetchPool"),
     m_changrpid(changrpid),
     m_changrplist(ChannelGroup::GetChannelGroups(false)),
     m_channelGroupListManual(ChannelGroup::GetManualChannelGroups(true))
@@ -516,6 +544,7 @@ GuideGrid::GuideGrid(MythScreenStack *parent,
                         m_originalStartTime.time().second());
     m_currentStartTime = m_originalStartTime.addSecs(secsoffset);
     m_threadPool.setMaxThreadCount(1);
+    m_prefetchPool.setMaxThreadCount(1);
 
     if (m_player)
     {
@@ -1211,6 +1240,29 @@ int GuideGrid::GetStartChannelOffset(int row) const
     return (row + m_currentStartChannel) % cnt;
 }
 
+/// \brief Returns the chanids of count channels starting at index first,
+///        wrapping around at both ends of the channel list.
+std::vector<uint> GuideGrid::GetChanIds(int first, int count) const
+{
+    std::vector<uint> chanids;
+    int cnt = GetChannelCount();
+    if (!cnt)
+        return chanids;
+
+    count = std::min(count, cnt);
+    for (int i = 0; i < count; ++i)
+    {
+        int idx = (((first + i) % cnt) + cnt) % cnt;
+        const ChannelInfo *chinfo = GetChannelInfo(idx);
+        if (chinfo &&
+            std::find(chanids.cbegin(), chanids.cend(), chinfo->m_chanId) == chanids.cend())
+        {
+            chanids.push_back(chinfo->m_chanId);
+        }
+    }
+    return chanids;
+}
+
 ProgramList GuideGrid::GetProgramList(uint chanid) const
 {
     ProgramList proglist;
@@ -1568,27 +1620,20 @@ void GuideGrid::fillProgramInfos(bool useExistingData)
 
 ProgramList *GuideGrid::getProgramListFromProgram(int chanNum)
 {
-    auto *proglist = new ProgramList();
-
-    if (proglist)
-    {
-        MSqlBindings bindings;
-        QString querystr = "WHERE program.chanid = :CHANID "
-                           "  AND program.endtime >= :STARTTS "
-                           "  AND program.starttime <= :ENDTS "
-                           "  AND program.starttime >= :STARTLIMITTS "
-                           "  AND program.manualid = 0 ";
-        QDateTime starttime = m_currentStartTime.addSecs(0 - m_currentStartTime.time().second());
-        bindings[":CHANID"]  = GetChannelInfo(chanNum)->m_chanId;
-        bindings[":STARTTS"] = starttime;
-        bindings[":STARTLIMITTS"] = starttime.addDays(-1);
-        bindings[":ENDTS"] = m_currentEndTime.addSecs(0 - m_currentEndTime.time().second());
+    QDateTime starttime = m_currentStartTime.addSecs(0 - m_currentStartTime.time().second());
+    QDateTime endtime = m_currentEndTime.addSecs(0 - m_currentEndTime.time().second());
 
-        LoadFromProgram(*proglist, querystr, bindings, m_recList,
-                        ProgGroupBy::ChanNum);
-    }
+    // Load the whole page and the ones above and below along with this row
+    return m_guideData.GetPrograms(
+        GetChannelInfo(chanNum)->m_chanId, starttime, endtime,
+        GetChanIds((int)m_currentStartChannel - m_channelCount, 3 * m_channelCount),
+        m_recList);
+}
 
-    return proglist;
+void GuideGrid::prefetchPrograms(const std::vector<uint> &chanids,
+                                 const QDateTime &start)
+{
+    m_guideData.Prefetch(chanids, start, m_recList);
 }
 
 void GuideGrid::fillProgramRowInfos(int firstRow, bool useExistingData)
@@ -1655,6 +1700,15 @@ void GuideGrid::fillProgramRowInfos(int firstRow, bool useExistingData)
     auto *updater = new GuideUpdateProgramRow(this, gs, proglists);
     if (updater)
         m_threadPool.start(new GuideHelper(this, updater), "GuideHelper");
+
+    if (allRows)
+    {
+        auto *prefetch = new GuidePrefetch(
+            this, GetChanIds((int)m_currentStartChannel - m_channelCount,
+                             3 * m_channelCount),
+            m_currentStartTime, m_currentStartChannel);
+        m_prefetchPool.start(new GuideHelper(this, prefetch), "GuidePrefetch");
+    }
 }
 
 void GuideUpdateProgramRow::fillProgramRowInfosWith(int row,
@@ -1905,6 +1959,13 @@ void GuideGrid::customEvent(QEvent *event)
         {
             GuideHelper::Wait(this);
             LoadFromScheduler(m_recList);
+            m_guideData.Clear();
+            fillProgramInfos();
+        }
+        else if (message.startsWith("SYSTEM_EVENT MYTHFILLDATABASE_RAN"))
+        {
+            GuideHelper::Wait(this);
+            m_guideData.Clear();
             fillProgramInfos();
         }
     }
@@ -2275,6 +2336,7 @@ void GuideGrid::toggleGuideListing()
 
 void GuideGrid::generateListings()
 {
+    GuideHelper::Wait(this);
     m_currentStartChannel = 0;
     m_currentRow = 0;
 
@@ -2284,6 +2346,7 @@ void GuideGrid::generateListings()
     m_channelCount = std::min(m_guideGrid->getChannelCount(), maxchannel + 1);
 
     LoadFromScheduler(m_recList);
+    m_guideData.Clear();
     fillProgramInfos();
 }
 
@@ -22,6 +22,7 @@
 #include "libmythui/mythuiguidegrid.h"
 
 // MythFrontend
+#include "guidedatacache.h"
 #include "schedulecommon.h"
 
 class ProgramInfo;
@@ -214,6 +215,8 @@ class GuideGrid : public ScheduleCommon, public JumpToChannelListener
 public:
     // These need to be public so that the helper classes can operate.
     ProgramList *getProgramListFromProgram(int chanNum);
+    void prefetchPrograms(const std::vector<uint> &chanids,
+                          const QDateTime &start);
     void updateProgramsUI(unsigned int firstRow, unsigned int numRows,
                           int progPast,
                           const QVector<ProgramList*> &proglists,
@@ -231,6 +234,7 @@ private:
     const ChannelInfo *GetChannelInfo(uint chan_idx, int sel = -1) const;
     uint                 GetChannelCount(void) const;
     int                  GetStartChannelOffset(int row = -1) const;
+    std::vector<uint>    GetChanIds(int first, int count) const;
 
     ProgramList GetProgramList(uint chanid) const;
     uint GetAlternateChannelIndex(uint chan_idx, bool with_same_channum) const;
@@ -246,6 +250,7 @@ private:
     std::vector<ProgramList*> m_programs;
     ProgInfoGuideArray m_programInfos {};
     ProgramList  m_recList;
+    GuideDataCache m_guideData;
 
     QDateTime m_originalStartTime;
     QDateTime m_currentStartTime;
@@ -277,6 +282,7 @@ private:
     QTimer *m_updateTimer                 {nullptr}; // audited ref #5318
 
     MThreadPool       m_threadPool;
+    MThreadPool       m_prefetchPool;
 
     int               m_changrpid {-1};
     ChannelGroupList  m_changrplist;
@@ -9,12 +9,17 @@
 
 // Qt
 #include <QCoreApplication>
+#include <QDataStream>
+#include <QFile>
 #include <QRunnable>
+#include <QSaveFile>
 
 // MythTV
 #include "libmythbase/mconcurrent.h"
 #include "libmythbase/mthreadpool.h"
+#include "libmythbase/mythcorecontext.h"
 #include "libmythbase/mythdb.h"
+#include "libmythbase/mythdirs.h"
 #include "libmythbase/mythevent.h"
 #include "libmythbase/mythlogging.h"
 #include "libmythbase/programinfo.h"
@@ -35,6 +40,171 @@ static void free_vec(VPI_ptr &v)
     }
 }
 
+#define LOC QString("ProgramInfoCache: ")
+
+/** \brief The recorded list as of the last QUERY_RECORDINGS_SINCE.
+ *
+ *  Shared by all ProgramInfoCaches and kept in the remote cache directory
+ *  between runs, so that after the first time only the recordings that
+ *  changed are fetched from the backend. The in-use flags, recording status
+ *  and file size change without a change event, the backend sends them for
+ *  every recording each time and they are not saved.
+ */
+class RecordedListStore
+{
+  public:
+    static RecordedListStore &Instance(void)
+    {
+        static RecordedListStore s_store;
+        return s_store;
+    }
+
+    std::vector<ProgramInfo*> *Update(void);
+
+  private:
+    RecordedListStore() = default;
+    QString FileName(void) const;
+    void Read(void);
+    void Write(void) const;
+
+    static constexpr quint32 kFileMagic   { 0x4d524c53 }; // "MRLS"
+    static constexpr quint32 kFileVersion { 1 };
+
+    QMutex                  m_lock;
+    bool                    m_read       { false };
+    QString                 m_master;
+    uint64_t                m_generation { 0 };
+    QHash<uint,ProgramInfo> m_programs;
+};
+
+QString RecordedListStore::FileName(void) const
+{
+    return QString("%1/recordings-%2.bin").arg(GetRemoteCacheDir(), m_master);
+}
+
+void RecordedListStore::Read(void)
+{
+    QFile file(FileName());
+    if (!file.open(QIODevice::ReadOnly))
+        return;
+
+    QByteArray data = qUncompress(file.readAll());
+    QDataStream stream(data);
+    stream.setVersion(ProgramInfo::kBinaryStreamVersion);
+
+    quint32 magic {0};
+    quint32 version {0};
+    quint64 generation {0};
+    quint32 count {0};
+    stream >> magic >> version >> generation >> count;
+    if (stream.status() != QDataStream::Ok ||
+        magic != kFileMagic || version != kFileVersion)
+        return;
+
+    for (quint32 i = 0; i < count; i++)
+    {
+        ProgramInfo pginfo(stream);
+        if (stream.status() != QDataStream::Ok)
+        {
+            LOG(VB_GENERAL, LOG_WARNING, LOC + "Ignoring damaged " + FileName());
+            m_programs.clear();
+            return;
+        }
+        m_programs.insert(pginfo.GetRecordingID(), pginfo);
+    }
+    m_generation = generation;
+
+    LOG(VB_GENERAL, LOG_INFO, LOC + QString("Read %1 recordings from %2")
+        .arg(m_programs.size()).arg(FileName()));
+}
+
+void RecordedListStore::Write(void) const
+{
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream.setVersion(ProgramInfo::kBinaryStreamVersion);
+    stream << kFileMagic << kFileVersion << quint64(m_generation)
+           << quint32(m_programs.size());
+    for (const auto & pginfo : std::as_const(m_programs))
+    {
+        // Only valid until the next update
+        ProgramInfo saved(pginfo);
+        saved.SetInUseFlags(0);
+        saved.SetCommFlagJobRunning(false);
+        saved.SetRecordingStatus(RecStatus::Recorded);
+        saved.SetFilesize(0);
+        saved.ToBinary(stream);
+    }
+
+    QSaveFile file(FileName());
+    if (!file.open(QIODevice::WriteOnly) ||
+        file.write(qCompress(data)) < 0 || !file.commit())
+    {
+        LOG(VB_GENERAL, LOG_WARNING, LOC + "Unable to write " + FileName());
+    }
+}
+
+/** \brief Bring the list up to date with the backend.
+ *  \return a copy of the list, or nullptr if the backend can't send
+ *          changes, in which case the caller should use
+ *          RemoteGetRecordedList().
+ */
+std::vector<ProgramInfo*> *RecordedListStore::Update(void)
+{
+    QMutexLocker locker(&m_lock);
+
+    QString master = gCoreContext->GetMasterHostName();
+    if (!m_read || master != m_master)
+    {
+        m_programs.clear();
+        m_generation = 0;
+        m_master = master;
+        m_read = true;
+        Read();
+    }
+
+    uint64_t generation = m_generation;
+    bool full = false;
+    std::vector<ProgramInfo> changed;
+    std::vector<uint> deleted;
+    std::vector<RecordedState> states;
+    if (!RemoteGetRecordedListSince(generation, full, changed, deleted, states))
+        return nullptr;
+
+    if (full)
+        m_programs.clear();
+    for (uint recordedid : deleted)
+        m_programs.remove(recordedid);
+    for (const auto & pginfo : changed)
+        m_programs.insert(pginfo.GetRecordingID(), pginfo);
+    for (const auto & state : states)
+    {
+        auto it = m_programs.find(state.m_recordedId);
+        if (it == m_programs.end())
+            continue;
+        it->SetProgramFlags(state.m_flags);
+        it->SetRecordingStatus(state.m_recStatus);
+        it->SetFilesize(state.m_filesize);
+    }
+
+    LOG(VB_GENERAL, LOG_DEBUG, LOC +
+        QString("%1 list: %2 changed, %3 deleted, %4 recordings")
+        .arg(full ? "Full" : "Delta").arg(changed.size()).arg(deleted.size())
+        .arg(m_programs.size()));
+
+    if (generation != m_generation)
+    {
+        m_generation = generation;
+        Write();
+    }
+
+    auto *list = new std::vector<ProgramInfo*>;
+    list->reserve(m_programs.size());
+    for (const auto & pginfo : std::as_const(m_programs))
+        list->push_back(new ProgramInfo(pginfo));
+    return list;
+}
+
 class ProgramInfoLoader : public QRunnable
 {
   public:
@@ -80,9 +250,11 @@ void ProgramInfoCache::Load(const bool updateUI)
 
     locker.unlock();
 
-    // Get an unsorted list (sort = 0) from RemoteGetRecordedList
-    // we sort the list later anyway.
-    std::vector<ProgramInfo*> *tmp = RemoteGetRecordedList(0);
+    // Get an unsorted list, we sort the list later anyway. Only the changes
+    // since the last load are fetched unless the backend can't do that.
+    std::vector<ProgramInfo*> *tmp = RecordedListStore::Instance().Update();
+    if (!tmp)
+        tmp = RemoteGetRecordedList(0);
 
     // Calculate play positions for UI
     if (tmp)
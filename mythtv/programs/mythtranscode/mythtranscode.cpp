@@ -8,6 +8,7 @@
 #include <QtGlobal>
 #include <QCoreApplication>
 #include <QDir>
+#include <QFile>
 #include <utility>
 
 // MythTV headers
@@ -23,6 +24,7 @@
 #include "libmythbase/mythversion.h"
 #include "libmythbase/programinfo.h"
 #include "libmythbase/remotefile.h"
+#include "libmythbase/seekindexfile.h"
 #include "libmythtv/HLS/httplivestream.h"
 #include "libmythtv/jobqueue.h"
 #include "libmythtv/recordinginfo.h"
@@ -30,6 +32,7 @@
 // MythTranscode
 #include "mpeg2fix.h"
 #include "mythtranscode_commandlineparser.h"
+#include "smartcut.h"
 #include "transcode.h"
 
 static void CompleteJob(int jobID, ProgramInfo *pginfo, bool useCutlist,
@@ -91,6 +94,32 @@ static int BuildKeyframeIndex(MPEG2fixup *m2f, const QString &infile,
     return 0;
 }
 
+/// Losslessly cuts an H.264 or HEVC recording, using its position map to
+/// find the GOPs that can be copied.
+static int SmartCut(MPEG2fixup *m2f, ProgramInfo *pginfo,
+                    const QString &infile, const QString &outfile,
+                    const frm_dir_map_t &deleteMap, bool showprogress,
+                    void (*update_func)(float), int (*check_func)())
+{
+    frm_pos_map_t posMap;
+    frm_pos_map_t durMap;
+    pginfo->QueryPositionMap(posMap, MARK_GOP_BYFRAME);
+    pginfo->QueryPositionMap(durMap, MARK_DURATION_MS);
+    if (posMap.isEmpty())
+    {
+        LOG(VB_GENERAL, LOG_NOTICE,
+            "No position map for the recording, scanning it for keyframes");
+        durMap.clear();
+        int err = m2f->BuildKeyframeIndex(infile, posMap, durMap);
+        if (err)
+            return err;
+    }
+
+    SmartCutter cutter(infile, outfile, deleteMap, posMap, durMap,
+                       showprogress, update_func, check_func);
+    return cutter.Start();
+}
+
 static void UpdateJobQueue(float percent_done)
 {
     JobQueue::ChangeJobComment(glbl_jobID,
@@ -656,7 +685,18 @@ int main(int argc, char *argv[])
         }
         else
         {
-            result = m2f->Start();
+            bool smartCut = SmartCutter::IsSupported(infile);
+            if (smartCut)
+            {
+                LOG(VB_GENERAL, LOG_INFO,
+                    "Smart cutting, only the GOPs at cut points are re-encoded");
+                result = SmartCut(m2f, pginfo, infile, outfile, deleteMap,
+                                  showprogress, update_func, check_func);
+            }
+            else
+            {
+                result = m2f->Start();
+            }
             if (result == REENCODE_OK)
             {
                 result = BuildKeyframeIndex(m2f, outfile, posMap, durMap, jobID);
@@ -670,8 +710,9 @@ int main(int argc, char *argv[])
                 }
                 RecordingInfo recInfo(*pginfo);
                 RecordingFile *recFile = recInfo.GetRecordingFile();
-                if (otype == REPLEX_DVD || otype == REPLEX_MPEG2 ||
-                    otype == REPLEX_HDTV)
+                if (!smartCut &&
+                    (otype == REPLEX_DVD || otype == REPLEX_MPEG2 ||
+                     otype == REPLEX_HDTV))
                 {
                     recFile->m_containerFormat = formatMPEG2_PS;
                     JobQueue::ChangeJobArgs(jobID, "RENAME_TO_MPG");
@@ -928,6 +969,22 @@ static void CompleteJob(int jobID, ProgramInfo *pginfo, bool useCutlist,
                     .arg(tmpfile, newfile) + ENO);
         }
 
+        // The seek index file follows the database, not the file, so it
+        // moves along with a renamed recording
+        if ((newfile != filename) && SeekIndexFile::IsUsable(filename))
+        {
+            const QString oldindex = SeekIndexFile::FileName(filename);
+            const QString newindex = SeekIndexFile::FileName(newfile);
+            QFile::remove(newindex);
+            if (QFile::exists(oldindex) && !QFile::rename(oldindex, newindex))
+            {
+                LOG(VB_GENERAL, LOG_ERR,
+                    QString("mythtranscode: Error Renaming '%1' to '%2'")
+                        .arg(oldindex, newindex));
+                SeekIndexFile::Remove(filename);
+            }
+        }
+
         if (!gCoreContext->GetBoolSetting("SaveTranscoding", false) || forceDelete)
         {
             bool followLinks =
@@ -0,0 +1,771 @@
+// C++
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <utility>
+
+// Qt
+#include <QFileInfo>
+
+// MythTV
+#include "libmyth/mythaverror.h"
+#include "libmythbase/mythdate.h"
+#include "libmythbase/mythlogging.h"
+
+// MythTranscode
+#include "smartcut.h"
+
+extern "C" {
+#include "libavutil/opt.h"
+}
+
+#define LOC QString("SmartCut: ")
+
+static QString av_error(int err)
+{
+    return QString::fromStdString(av_make_error_stdstring(err));
+}
+
+/** \class SmartReencoder
+ *  \brief Decodes the video around a cut point and encodes the frames
+ *         between m_from and m_to again.
+ *
+ *  Every SmartReencoder starts its own encoder, so what it returns begins
+ *  with an IDR frame carrying its own parameter sets. It uses no B-frames
+ *  and gives its packets the decode delay of the original stream, which
+ *  keeps the decode timestamps in order when they are put between copied
+ *  GOPs.
+ */
+class SmartReencoder
+{
+  public:
+    SmartReencoder(AVStream *stream, int64_t from, int64_t to, int64_t frameDur)
+      : m_stream(stream), m_from(from), m_to(to),
+        m_delay(stream->codecpar->video_delay * frameDur) {}
+    ~SmartReencoder();
+
+    bool Open(void);
+    bool Feed(const AVPacket *pkt);
+    bool Finish(void);
+    void SetFrom(int64_t from) { m_from = from; }
+    void SetTo(int64_t to)     { m_to = to; }
+
+    std::deque<AVPacket*> m_output; ///< encoded packets, owned
+    uint64_t              m_encoded {0};
+
+  private:
+    bool ReceiveFrames(void);
+    bool OpenEncoder(const AVFrame *frame);
+    bool Encode(const AVFrame *frame);
+
+    AVStream       *m_stream  {nullptr};
+    AVCodecContext *m_decoder {nullptr};
+    AVCodecContext *m_encoder {nullptr};
+    AVFrame        *m_frame   {nullptr};
+    int64_t         m_from;
+    int64_t         m_to;
+    int64_t         m_delay;
+};
+
+SmartReencoder::~SmartReencoder()
+{
+    for (auto *pkt : m_output)
+        av_packet_free(&pkt);
+    av_frame_free(&m_frame);
+    avcodec_free_context(&m_decoder);
+    avcodec_free_context(&m_encoder);
+}
+
+bool SmartReencoder::Open(void)
+{
+    const AVCodec *codec = avcodec_find_decoder(m_stream->codecpar->codec_id);
+    m_decoder = codec ? avcodec_alloc_context3(codec) : nullptr;
+    m_frame = av_frame_alloc();
+    if (!m_decoder || !m_frame)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "Couldn't allocate the video decoder");
+        return false;
+    }
+
+    avcodec_parameters_to_context(m_decoder, m_stream->codecpar);
+    m_decoder->pkt_timebase = m_stream->time_base;
+    m_decoder->thread_count = 0;
+    int ret = avcodec_open2(m_decoder, codec, nullptr);
+    if (ret < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Couldn't open the video decoder: %1").arg(av_error(ret)));
+        return false;
+    }
+    return true;
+}
+
+bool SmartReencoder::OpenEncoder(const AVFrame *frame)
+{
+    const AVCodec *codec = avcodec_find_encoder(m_stream->codecpar->codec_id);
+    if (!codec)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("No %1 encoder, FFmpeg must be built with libx264 and "
+                    "libx265 for smart cutting")
+                .arg(avcodec_get_name(m_stream->codecpar->codec_id)));
+        return false;
+    }
+
+    m_encoder = avcodec_alloc_context3(codec);
+    if (!m_encoder)
+        return false;
+
+    m_encoder->width                  = frame->width;
+    m_encoder->height                 = frame->height;
+    m_encoder->pix_fmt                = static_cast<AVPixelFormat>(frame->format);
+    m_encoder->sample_aspect_ratio    = frame->sample_aspect_ratio;
+    m_encoder->color_range            = frame->color_range;
+    m_encoder->color_primaries        = frame->color_primaries;
+    m_encoder->color_trc              = frame->color_trc;
+    m_encoder->colorspace             = frame->colorspace;
+    m_encoder->chroma_sample_location = frame->chroma_location;
+    m_encoder->time_base              = m_stream->time_base;
+    m_encoder->framerate              = m_stream->avg_frame_rate;
+    m_encoder->max_b_frames           = 0;
+    m_encoder->gop_size               = 600;
+    m_encoder->thread_count           = 0;
+    if (frame->flags & AV_FRAME_FLAG_INTERLACED)
+    {
+        m_encoder->flags |= AV_CODEC_FLAG_INTERLACED_DCT |
+                            AV_CODEC_FLAG_INTERLACED_ME;
+        m_encoder->field_order = (frame->flags & AV_FRAME_FLAG_TOP_FIELD_FIRST) ?
+                                 AV_FIELD_TT : AV_FIELD_BB;
+    }
+
+    // A few frames at each cut point, quality matters more than size
+    av_opt_set(m_encoder->priv_data, "preset", "fast", 0);
+    av_opt_set(m_encoder->priv_data, "crf", "16", 0);
+
+    int ret = avcodec_open2(m_encoder, codec, nullptr);
+    if (ret < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + QString("Couldn't open the %1 encoder: %2")
+            .arg(codec->name, av_error(ret)));
+        return false;
+    }
+    return true;
+}
+
+/// Decodes pkt, or flushes the decoder if pkt is null.
+bool SmartReencoder::Feed(const AVPacket *pkt)
+{
+    int ret = avcodec_send_packet(m_decoder, pkt);
+    if (ret < 0 && ret != AVERROR_EOF)
+    {
+        // A damaged picture only costs that picture
+        LOG(VB_GENERAL, LOG_WARNING, LOC +
+            QString("Decoding failed: %1").arg(av_error(ret)));
+    }
+    return ReceiveFrames();
+}
+
+bool SmartReencoder::Finish(void)
+{
+    if (!Feed(nullptr))
+        return false;
+    return !m_encoder || Encode(nullptr);
+}
+
+bool SmartReencoder::ReceiveFrames(void)
+{
+    int ret = 0;
+    while ((ret = avcodec_receive_frame(m_decoder, m_frame)) >= 0)
+    {
+        int64_t pts = m_frame->best_effort_timestamp;
+        bool keep = (pts != AV_NOPTS_VALUE) && (pts >= m_from) && (pts < m_to);
+        if (keep)
+        {
+            m_frame->pts = pts;
+            m_frame->pict_type = AV_PICTURE_TYPE_NONE;
+            if ((!m_encoder && !OpenEncoder(m_frame)) || !Encode(m_frame))
+            {
+                av_frame_unref(m_frame);
+                return false;
+            }
+            m_encoded++;
+        }
+        av_frame_unref(m_frame);
+    }
+    return ret == AVERROR(EAGAIN) || ret == AVERROR_EOF;
+}
+
+/// Encodes frame, or flushes the encoder if frame is null.
+bool SmartReencoder::Encode(const AVFrame *frame)
+{
+    int ret = avcodec_send_frame(m_encoder, frame);
+    if (ret < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Encoding failed: %1").arg(av_error(ret)));
+        return false;
+    }
+
+    while (true)
+    {
+        AVPacket *pkt = av_packet_alloc();
+        ret = avcodec_receive_packet(m_encoder, pkt);
+        if (ret < 0)
+        {
+            av_packet_free(&pkt);
+            return ret == AVERROR(EAGAIN) || ret == AVERROR_EOF;
+        }
+        pkt->stream_index = m_stream->index;
+        pkt->dts = pkt->pts - m_delay;
+        m_output.push_back(pkt);
+    }
+}
+
+SmartCutter::SmartCutter(QString inf, QString outf,
+                         const frm_dir_map_t &deleteMap,
+                         frm_pos_map_t posMap, frm_pos_map_t durMap,
+                         bool showprog, void (*update_func)(float),
+                         int (*check_func)())
+  : m_infile(std::move(inf)), m_outfile(std::move(outf)),
+    m_deleteMap(deleteMap), m_posMap(std::move(posMap)),
+    m_durMap(std::move(durMap)), m_pkt(av_packet_alloc()),
+    m_checkAbort(check_func), m_updateStatus(update_func),
+    m_showProgress(showprog)
+{
+    //initialize progress stats
+    if (m_showProgress || m_updateStatus)
+    {
+        if (m_updateStatus)
+        {
+            m_statusUpdateTime = 20;
+            m_updateStatus(0);
+        }
+        m_statusTime = MythDate::current().addSecs(m_statusUpdateTime);
+
+        const QFileInfo finfo(m_infile);
+        m_fileSize = finfo.size();
+    }
+}
+
+SmartCutter::~SmartCutter()
+{
+    if (m_outputFC)
+    {
+        if (!(m_outputFC->oformat->flags & AVFMT_NOFILE))
+            avio_closep(&m_outputFC->pb);
+        avformat_free_context(m_outputFC);
+    }
+    avformat_close_input(&m_inputFC);
+    av_packet_free(&m_pkt);
+}
+
+AVFormatContext *SmartCutter::OpenInputFile(const QString &file)
+{
+    AVFormatContext *ctx = nullptr;
+    QByteArray fname = file.toLocal8Bit();
+    int ret = avformat_open_input(&ctx, fname.constData(), nullptr, nullptr);
+    if (ret < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + QString("Couldn't open %1: %2")
+            .arg(file, av_error(ret)));
+        return nullptr;
+    }
+    ret = avformat_find_stream_info(ctx, nullptr);
+    if (ret < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + QString("Couldn't get stream info: %1")
+            .arg(av_error(ret)));
+        avformat_close_input(&ctx);
+    }
+    return ctx;
+}
+
+/// \brief Returns true if file is a recording that SmartCutter can cut,
+///        one with H.264 or HEVC video.
+bool SmartCutter::IsSupported(const QString &file)
+{
+    AVFormatContext *ctx = OpenInputFile(file);
+    if (!ctx)
+        return false;
+
+    int vid = av_find_best_stream(ctx, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+    bool supported = (vid >= 0) &&
+        (ctx->streams[vid]->codecpar->codec_id == AV_CODEC_ID_H264 ||
+         ctx->streams[vid]->codecpar->codec_id == AV_CODEC_ID_HEVC);
+    avformat_close_input(&ctx);
+    return supported;
+}
+
+bool SmartCutter::OpenInput(void)
+{
+    LOG(VB_GENERAL, LOG_INFO, LOC + QString("Opening %1").arg(m_infile));
+    m_inputFC = OpenInputFile(m_infile);
+    if (!m_inputFC)
+        return false;
+
+    m_vidId = av_find_best_stream(m_inputFC, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+    if (m_vidId < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "No video stream found");
+        return false;
+    }
+
+    AVStream *video = m_inputFC->streams[m_vidId];
+    AVRational rate = video->avg_frame_rate.num ? video->avg_frame_rate
+                                                : video->r_frame_rate;
+    if (rate.num && rate.den)
+        m_frameDur = std::max(av_rescale_q(1, av_inv_q(rate), video->time_base),
+                              static_cast<int64_t>(1));
+    if (video->start_time != AV_NOPTS_VALUE)
+        m_videoStart = video->start_time;
+
+    // The position map counts frames in decode order from the start of the
+    // file, the duration map has their time in ms.
+    for (auto it = m_posMap.cbegin(); it != m_posMap.cend(); ++it)
+    {
+        Keyframe key { it.key(), it.value(), 0 };
+        auto dur = m_durMap.constFind(it.key());
+        if (dur != m_durMap.cend())
+            key.m_pts = m_videoStart + av_rescale_q(*dur, {1, 1000}, video->time_base);
+        else
+            key.m_pts = m_videoStart + (key.m_frame * m_frameDur);
+        m_keyframes.push_back(key);
+    }
+    if (m_keyframes.empty())
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "The position map is empty");
+        return false;
+    }
+    return true;
+}
+
+bool SmartCutter::OpenOutput(void)
+{
+    QByteArray fname = m_outfile.toLocal8Bit();
+    int ret = avformat_alloc_output_context2(&m_outputFC, nullptr, "mpegts",
+                                             fname.constData());
+    if (ret < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + QString("Couldn't create %1: %2")
+            .arg(m_outfile, av_error(ret)));
+        return false;
+    }
+
+    for (uint i = 0; i < m_inputFC->nb_streams; i++)
+    {
+        AVStream *in = m_inputFC->streams[i];
+        if ((static_cast<int>(i) != m_vidId &&
+             in->codecpar->codec_type != AVMEDIA_TYPE_AUDIO) ||
+            in->codecpar->codec_id == AV_CODEC_ID_NONE)
+        {
+            m_streamMap.push_back(-1);
+            continue;
+        }
+
+        AVStream *out = avformat_new_stream(m_outputFC, nullptr);
+        if (!out || avcodec_parameters_copy(out->codecpar, in->codecpar) < 0)
+            return false;
+        out->codecpar->codec_tag = 0;
+        out->time_base = in->time_base;
+        out->disposition = in->disposition;
+        av_dict_copy(&out->metadata, in->metadata, 0);
+        m_streamMap.push_back(out->index);
+    }
+    m_lastDts.assign(m_outputFC->nb_streams, AV_NOPTS_VALUE);
+
+    if (!(m_outputFC->oformat->flags & AVFMT_NOFILE))
+    {
+        ret = avio_open(&m_outputFC->pb, fname.constData(), AVIO_FLAG_WRITE);
+        if (ret < 0)
+        {
+            LOG(VB_GENERAL, LOG_ERR, LOC + QString("Couldn't open %1: %2")
+                .arg(m_outfile, av_error(ret)));
+            return false;
+        }
+    }
+    return true;
+}
+
+int64_t SmartCutter::FrameToPts(int64_t frame) const
+{
+    auto it = std::upper_bound(m_keyframes.cbegin(), m_keyframes.cend(), frame,
+                               [](int64_t f, const Keyframe &k)
+                               { return f < k.m_frame; });
+    if (it == m_keyframes.cbegin())
+        return m_videoStart + (frame * m_frameDur);
+    --it;
+    return it->m_pts + ((frame - it->m_frame) * m_frameDur);
+}
+
+/// Turns the cutlist into the parts that are kept, and finds the GOPs
+/// of each part that can be copied.
+std::vector<SmartCutter::Segment> SmartCutter::PlanSegments(void) const
+{
+    std::vector<std::pair<int64_t,int64_t>> keep;
+    bool cut = !m_deleteMap.isEmpty() && (*m_deleteMap.cbegin() == MARK_CUT_END);
+    int64_t from = 0;
+    for (auto it = m_deleteMap.cbegin(); it != m_deleteMap.cend(); ++it)
+    {
+        // Cut at the same frames as MPEG2fixup does
+        auto mark = static_cast<int64_t>(it.key() ? it.key() + 1 : 0);
+        if (*it == MARK_CUT_START && !cut)
+        {
+            if (mark > from)
+                keep.emplace_back(from, mark);
+            cut = true;
+        }
+        else if (*it == MARK_CUT_END && cut)
+        {
+            from = mark;
+            cut = false;
+        }
+    }
+    if (!cut)
+        keep.emplace_back(from, INT64_MAX);
+
+    std::vector<Segment> segments;
+    for (const auto & [first, last] : keep)
+    {
+        Segment seg;
+        seg.m_start = FrameToPts(first);
+        seg.m_end   = (last == INT64_MAX) ? INT64_MAX : FrameToPts(last);
+
+        // The first keyframe at or after the start, and the last at or before
+        // the end
+        auto k1 = std::lower_bound(m_keyframes.cbegin(), m_keyframes.cend(), first,
+                                   [](const Keyframe &k, int64_t f)
+                                   { return k.m_frame < f; });
+        auto klast = std::upper_bound(m_keyframes.cbegin(), m_keyframes.cend(), last,
+                                      [](int64_t f, const Keyframe &k)
+                                      { return f < k.m_frame; });
+        if (klast != m_keyframes.cbegin())
+            --klast;
+
+        if (k1 != m_keyframes.cend() &&
+            (last == INT64_MAX || k1->m_frame < klast->m_frame))
+        {
+            seg.m_copyFrom = k1->m_pts;
+            if (last != INT64_MAX)
+            {
+                seg.m_copyTo   = klast->m_pts;
+                seg.m_tailFrom = std::prev(klast)->m_pts;
+            }
+        }
+
+        if (k1 != m_keyframes.cend() && k1->m_frame == first)
+            seg.m_seekPos = k1->m_pos;
+        else if (k1 != m_keyframes.cbegin())
+            seg.m_seekPos = std::prev(k1)->m_pos;
+
+        LOG(VB_GENERAL, LOG_INFO, LOC +
+            QString("Keeping frames %1-%2, copying %3")
+                .arg(first)
+                .arg(last == INT64_MAX ? QString("end") : QString::number(last - 1))
+                .arg(seg.m_copyFrom == INT64_MAX ? QString("nothing") :
+                     QString("from frame %1").arg(k1->m_frame)));
+        segments.push_back(seg);
+    }
+    return segments;
+}
+
+int SmartCutter::Start(void)
+{
+    if (!m_pkt || !OpenInput() || !OpenOutput())
+        return REENCODE_ERROR;
+
+    std::vector<Segment> segments = PlanSegments();
+    if (segments.empty())
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "The cutlist removes everything");
+        return REENCODE_ERROR;
+    }
+
+    int ret = avformat_write_header(m_outputFC, nullptr);
+    if (ret < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + QString("Couldn't write header: %1")
+            .arg(av_error(ret)));
+        return REENCODE_ERROR;
+    }
+
+    // Every segment is moved back to where the previous one ended
+    int64_t outPos = segments.front().m_start;
+    for (const auto & seg : segments)
+    {
+        int result = CutSegment(seg, seg.m_start - outPos);
+        if (result != REENCODE_OK)
+            return result;
+        if (seg.m_end == INT64_MAX)
+            break;
+        outPos += seg.m_end - seg.m_start;
+    }
+
+    ret = av_write_trailer(m_outputFC);
+    if (ret < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + QString("Couldn't write trailer: %1")
+            .arg(av_error(ret)));
+        return REENCODE_ERROR;
+    }
+
+    LOG(VB_GENERAL, LOG_NOTICE, LOC +
+        QString("Copied %1 video frames, encoded %2")
+            .arg(m_copiedFrames).arg(m_encodedFrames));
+    return REENCODE_OK;
+}
+
+/** \brief Writes one kept part of the recording.
+ *
+ *  Reading starts at the keyframe before the part. Until the first copied
+ *  keyframe the video goes to the head SmartReencoder, which also gets the
+ *  leading pictures of that keyframe. The copied packets wait for the head
+ *  to be written. Decoding for the tail starts at the last copied GOP, so
+ *  the leading pictures of the keyframe after it can be decoded, but only
+ *  what comes after the copied frames is encoded.
+ */
+int SmartCutter::CutSegment(const Segment &seg, int64_t offset)
+{
+    AVStream *video = m_inputFC->streams[m_vidId];
+    int ret = av_seek_frame(m_inputFC, -1, seg.m_seekPos, AVSEEK_FLAG_BYTE);
+    if (ret < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + QString("Seeking to %1 failed: %2")
+            .arg(seg.m_seekPos).arg(av_error(ret)));
+        return REENCODE_ERROR;
+    }
+
+    std::unique_ptr<SmartReencoder> head;
+    std::unique_ptr<SmartReencoder> tail;
+    if (seg.m_start < seg.m_copyFrom)
+    {
+        head = std::make_unique<SmartReencoder>(
+            video, seg.m_start, std::min(seg.m_copyFrom, seg.m_end), m_frameDur);
+        if (!head->Open())
+            return REENCODE_ERROR;
+    }
+
+    const int64_t half = m_frameDur / 2;
+    const int64_t endLimit = (seg.m_end == INT64_MAX) ? INT64_MAX :
+        seg.m_end + av_rescale_q(5, {1, 1}, video->time_base);
+    int audioLeft = static_cast<int>(m_lastDts.size()) - 1;
+    State state = kHead;
+    bool sawKey = false;
+    bool videoDone = false;
+    int64_t copyKey = AV_NOPTS_VALUE;   // pts of the first copied keyframe
+    int64_t maxCopied = AV_NOPTS_VALUE;
+    int64_t endKey = AV_NOPTS_VALUE;    // pts of the keyframe at the end
+    std::deque<AVPacket*> pending;      // copied while the head is encoded
+    std::vector<bool> passedEnd(m_inputFC->nb_streams, false);
+    bool ok = true;
+
+    auto finish_head = [&]()
+    {
+        ok = FinishReencoder(head.get(), offset) && ok;
+        head.reset();
+        while (!pending.empty())
+        {
+            AVPacket *pkt = pending.front();
+            pending.pop_front();
+            ok = ok && WritePacket(pkt, offset);
+            av_packet_free(&pkt);
+        }
+    };
+
+    while (ok && av_read_frame(m_inputFC, m_pkt) >= 0)
+    {
+        AVPacket *pkt = m_pkt;
+        if ((m_showProgress || m_updateStatus) &&
+            MythDate::current() > m_statusTime && m_fileSize)
+        {
+            float percent_done = 100.0F * pkt->pos / m_fileSize;
+            if (m_updateStatus)
+                m_updateStatus(percent_done);
+            if (m_showProgress)
+                LOG(VB_GENERAL, LOG_INFO, QString("%1% complete")
+                        .arg(percent_done, 0, 'f', 1));
+            if (m_checkAbort && m_checkAbort())
+            {
+                av_packet_unref(pkt);
+                for (auto *p : pending)
+                    av_packet_free(&p);
+                return REENCODE_STOPPED;
+            }
+            m_statusTime = MythDate::current().addSecs(m_statusUpdateTime);
+        }
+
+        int idx = pkt->stream_index;
+        int64_t pts = (pkt->pts != AV_NOPTS_VALUE) ? pkt->pts : pkt->dts;
+        if (idx < 0 || idx >= static_cast<int>(m_streamMap.size()) ||
+            m_streamMap[idx] < 0 || pts == AV_NOPTS_VALUE)
+        {
+            av_packet_unref(pkt);
+            continue;
+        }
+        int64_t vpts = av_rescale_q(pts, m_inputFC->streams[idx]->time_base,
+                                    video->time_base);
+
+        if (idx != m_vidId)
+        {
+            if (vpts >= seg.m_start && vpts < seg.m_end)
+            {
+                ok = WritePacket(pkt, offset);
+            }
+            else if (vpts >= seg.m_end && !passedEnd[idx])
+            {
+                passedEnd[idx] = true;
+                audioLeft--;
+            }
+        }
+        else if (!videoDone && (sawKey || (pkt->flags & AV_PKT_FLAG_KEY)))
+        {
+            sawKey = true;
+            bool key = (pkt->flags & AV_PKT_FLAG_KEY) != 0;
+
+            // The head ends with the leading pictures of the first copied
+            // keyframe
+            if (head && copyKey != AV_NOPTS_VALUE && pts > copyKey)
+                finish_head();
+
+            // Everything up to the end of the part, including the leading
+            // pictures of the keyframe there, has been decoded
+            SmartReencoder *last = (state == kTail) ? tail.get() :
+                                   (state == kHead) ? head.get() : nullptr;
+            if (last && endKey != AV_NOPTS_VALUE && pts > endKey)
+            {
+                ok = ok && FinishReencoder(last, offset);
+                head.reset();
+                tail.reset();
+                videoDone = true;
+                av_packet_unref(pkt);
+                continue;
+            }
+
+            if (state == kHead && key && pts >= seg.m_copyFrom - half)
+            {
+                state = kCopy;
+                copyKey = pts;
+                if (head)
+                    head->SetTo(copyKey);
+            }
+            if (state == kCopy && !tail && key && pts >= seg.m_tailFrom - half)
+            {
+                tail = std::make_unique<SmartReencoder>(
+                    video, INT64_MAX, seg.m_end, m_frameDur);
+                ok = ok && tail->Open();
+            }
+            if (state == kCopy && key && pts >= seg.m_copyTo - half)
+            {
+                state = kTail;
+                if (!tail)
+                {
+                    tail = std::make_unique<SmartReencoder>(
+                        video, INT64_MAX, seg.m_end, m_frameDur);
+                    ok = ok && tail->Open();
+                }
+                tail->SetFrom((maxCopied != AV_NOPTS_VALUE) ? maxCopied + 1
+                                                            : seg.m_start);
+            }
+            if (state != kCopy && key && pts >= seg.m_end - half &&
+                endKey == AV_NOPTS_VALUE)
+            {
+                endKey = pts;
+                // The copied keyframe was not found, encode all of it
+                if (state == kHead && head)
+                    head->SetTo(seg.m_end);
+            }
+
+            // The decoders need every packet, including the copied ones, and
+            // need them before the muxer takes them
+            if (head)
+                ok = ok && head->Feed(pkt);
+            if (tail)
+                ok = ok && tail->Feed(pkt);
+            if (state == kCopy && pts >= copyKey)
+            {
+                if (head)
+                    pending.push_back(av_packet_clone(pkt));
+                else
+                    ok = ok && WritePacket(pkt, offset);
+                maxCopied = (maxCopied == AV_NOPTS_VALUE) ? pts :
+                            std::max(maxCopied, pts);
+                m_copiedFrames++;
+            }
+        }
+        av_packet_unref(pkt);
+
+        if (videoDone && (audioLeft <= 0 || vpts >= endLimit))
+            break;
+    }
+
+    // End of file
+    if (ok && head)
+        finish_head();
+    if (ok && tail && !videoDone)
+        ok = FinishReencoder(tail.get(), offset);
+    for (auto *pkt : pending)
+        av_packet_free(&pkt);
+
+    return ok ? REENCODE_OK : REENCODE_ERROR;
+}
+
+bool SmartCutter::FinishReencoder(SmartReencoder *reencoder, int64_t offset)
+{
+    if (!reencoder)
+        return true;
+
+    bool ok = reencoder->Finish();
+    while (!reencoder->m_output.empty())
+    {
+        AVPacket *pkt = reencoder->m_output.front();
+        reencoder->m_output.pop_front();
+        ok = ok && WritePacket(pkt, offset);
+        av_packet_free(&pkt);
+    }
+    m_encodedFrames += reencoder->m_encoded;
+    return ok;
+}
+
+/// Moves pkt back by offset, in video stream timestamps, and writes it.
+bool SmartCutter::WritePacket(AVPacket *pkt, int64_t offset)
+{
+    AVRational tb = m_inputFC->streams[pkt->stream_index]->time_base;
+    int out = m_streamMap[pkt->stream_index];
+    int64_t shift = av_rescale_q(offset, m_inputFC->streams[m_vidId]->time_base, tb);
+    if (pkt->pts != AV_NOPTS_VALUE)
+        pkt->pts -= shift;
+    if (pkt->dts != AV_NOPTS_VALUE)
+        pkt->dts -= shift;
+
+    int64_t &lastDts = m_lastDts[out];
+    if (pkt->dts != AV_NOPTS_VALUE && lastDts != AV_NOPTS_VALUE &&
+        pkt->dts <= lastDts)
+    {
+        pkt->dts = lastDts + 1;
+        if (pkt->pts != AV_NOPTS_VALUE && pkt->pts < pkt->dts)
+        {
+            LOG(VB_GENERAL, LOG_DEBUG, LOC +
+                QString("Dropping packet of stream %1 at %2, it overlaps")
+                    .arg(pkt->stream_index).arg(pkt->pts));
+            av_packet_unref(pkt);
+            return true;
+        }
+    }
+    if (pkt->dts != AV_NOPTS_VALUE)
+        lastDts = pkt->dts;
+
+    pkt->stream_index = out;
+    pkt->pos = -1;
+    av_packet_rescale_ts(pkt, tb, m_outputFC->streams[out]->time_base);
+    int ret = av_interleaved_write_frame(m_outputFC, pkt);
+    if (ret < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + QString("Writing failed: %1")
+            .arg(av_error(ret)));
+        return false;
+    }
+    return true;
+}
+
+/*
+ * vim:ts=4:sw=4:ai:et:si:sts=4
+ */
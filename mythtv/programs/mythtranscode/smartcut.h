@@ -0,0 +1,116 @@
+#ifndef SMARTCUT_H
+#define SMARTCUT_H
+
+// C++
+#include <cstdint>
+#include <vector>
+
+// Qt
+#include <QDateTime>
+#include <QString>
+
+// MythTV
+#include "libmythbase/programtypes.h"
+
+// MythTranscode
+#include "transcodedefs.h"
+
+extern "C" {
+#include "libavcodec/avcodec.h"
+#include "libavformat/avformat.h"
+}
+
+class SmartReencoder;
+
+/** \class SmartCutter
+ *  \brief Removes the cutlist from an H.264 or HEVC recording without
+ *         encoding all of its video again.
+ *
+ *  The GOPs that lie completely between two cut points are copied as they
+ *  are. Only the frames from a cut point up to the next copied keyframe,
+ *  and from the last copied GOP up to the next cut point, are decoded and
+ *  encoded again. Audio is copied. The keyframes, and the byte positions
+ *  to seek to, come from the recording's position map, so the parts that
+ *  are cut are not even read.
+ *
+ *  The output is always an MPEG-TS file.
+ */
+class SmartCutter
+{
+  public:
+    SmartCutter(QString inf, QString outf, const frm_dir_map_t &deleteMap,
+                frm_pos_map_t posMap, frm_pos_map_t durMap, bool showprog,
+                void (*update_func)(float) = nullptr,
+                int (*check_func)() = nullptr);
+    ~SmartCutter();
+    static bool IsSupported(const QString &file);
+    int Start(void);
+
+  private:
+    /// A keyframe from the position map
+    struct Keyframe
+    {
+        int64_t m_frame {0};
+        int64_t m_pos   {0};
+        int64_t m_pts   {0};
+    };
+
+    /// A part of the recording that is kept, in video stream timestamps
+    struct Segment
+    {
+        int64_t m_start    {0};         ///< first kept frame
+        int64_t m_end      {INT64_MAX}; ///< first frame that is cut again
+        int64_t m_seekPos  {0};         ///< byte position to start reading at
+        int64_t m_copyFrom {INT64_MAX}; ///< first copied keyframe
+        int64_t m_copyTo   {INT64_MAX}; ///< keyframe after the last copied GOP
+        int64_t m_tailFrom {INT64_MAX}; ///< keyframe of the last copied GOP
+    };
+
+    enum State : std::uint8_t {
+        kHead, ///< before the first copied keyframe
+        kCopy, ///< copying whole GOPs
+        kTail, ///< after the last copied GOP
+    };
+
+    static AVFormatContext *OpenInputFile(const QString &file);
+    bool OpenInput(void);
+    bool OpenOutput(void);
+    std::vector<Segment> PlanSegments(void) const;
+    int64_t FrameToPts(int64_t frame) const;
+    int CutSegment(const Segment &seg, int64_t offset);
+    bool FinishReencoder(SmartReencoder *reencoder, int64_t offset);
+    bool WritePacket(AVPacket *pkt, int64_t offset);
+
+    QString               m_infile;
+    QString               m_outfile;
+    frm_dir_map_t         m_deleteMap;
+    frm_pos_map_t         m_posMap;
+    frm_pos_map_t         m_durMap;
+    std::vector<Keyframe> m_keyframes;
+
+    AVFormatContext      *m_inputFC     {nullptr};
+    AVFormatContext      *m_outputFC    {nullptr};
+    AVPacket             *m_pkt         {nullptr};
+    int                   m_vidId       {-1};
+    std::vector<int>      m_streamMap;  ///< output stream of each input stream
+    std::vector<int64_t>  m_lastDts;    ///< of each output stream
+    int64_t               m_videoStart  {0};
+    int64_t               m_frameDur    {1};
+
+    uint64_t              m_copiedFrames  {0};
+    uint64_t              m_encodedFrames {0};
+
+    //progress indicators
+    int (*m_checkAbort)()                      {nullptr};
+    void (*m_updateStatus)(float percent_done) {nullptr};
+    QDateTime             m_statusTime;
+    bool                  m_showProgress      {false};
+    uint64_t              m_fileSize          {0};
+    int                   m_statusUpdateTime  {5};
+};
+
+#endif // SMARTCUT_H
+
+/*
+ * vim:ts=4:sw=4:ai:et:si:sts=4
+ */
@@ -311,6 +311,22 @@ static GlobalSpinBoxSetting *HDRingbufferSize()
     return bs;
 }
 
+static GlobalSpinBoxSetting *RecordWritebackWindow()
+{
+    auto *bs = new GlobalSpinBoxSetting(
+        "RecordWritebackWindow", 0, 256, 4);
+    bs->setLabel(QObject::tr("Recording writeback window (MB)"));
+    bs->setHelpText(QObject::tr("If set, each recording is written back "
+                    "to disk as soon as it is written, with at most this "
+                    "many megabytes per file waiting for the disk. This "
+                    "keeps many concurrent recordings from building up "
+                    "dirty pages that stall playback. "
+                    "0 leaves writeback to the operating system. "
+                    "Only supported on Linux."));
+    bs->setValue(0);
+    return bs;
+}
+
 static GlobalComboBoxSetting *StorageScheduler()
 {
     auto *gc = new GlobalComboBoxSetting("StorageScheduler");
@@ -353,6 +369,21 @@ static HostCheckBoxSetting *DisableFirewireReset()
     return hc;
 }
 
+static HostCheckBoxSetting *PreviewGeneratorInProcess()
+{
+    auto *hc = new HostCheckBoxSetting("PreviewGeneratorInProcess");
+    hc->setLabel(QObject::tr("Generate previews inside the backend"));
+    hc->setHelpText(
+        QObject::tr(
+            "If enabled, this backend generates preview images itself "
+            "instead of starting a mythpreviewgen process for each one. "
+            "This is faster, but a recording that crashes the decoder "
+            "takes the backend down with it. Takes effect when the "
+            "backend is restarted."));
+    hc->setValue(false);
+    return hc;
+}
+
 static HostTextEditSetting *MiscStatusScript()
 {
     auto *he = new HostTextEditSetting("MiscStatusScript");
@@ -653,6 +684,18 @@ static HostComboBoxSetting *JobQueueCPU()
     return gc;
 };
 
+static HostSpinBoxSetting *JobQueueDiskBandwidth()
+{
+    auto *gc = new HostSpinBoxSetting("JobQueueDiskBandwidth", 0, 2000, 10);
+    gc->setLabel(QObject::tr("Disk bandwidth for recordings and jobs (MB/s)"));
+    gc->setHelpText(QObject::tr("The Job Queue will not start another job "
+                    "if the recordings in progress and the running jobs "
+                    "would need more than this much disk bandwidth on "
+                    "this backend. Set to 0 for no limit."));
+    gc->setValue(0);
+    return gc;
+};
+
 static HostTimeBoxSetting *JobQueueWindowStart()
 {
     auto *gc = new HostTimeBoxSetting("JobQueueWindowStart", "00:00");
@@ -980,6 +1023,7 @@ BackendSettings::BackendSettings()
     fm->addChild(DeletesFollowLinks());
     fm->addChild(TruncateDeletes());
     fm->addChild(HDRingbufferSize());
+    fm->addChild(RecordWritebackWindow());
     fm->addChild(StorageScheduler());
     group2->addChild(fm);
     auto* upnp = new GroupSetting();
@@ -990,6 +1034,7 @@ BackendSettings::BackendSettings()
     group2->addChild(MiscStatusScript());
     group2->addChild(DisableAutomaticBackup());
     group2->addChild(DisableFirewireReset());
+    group2->addChild(PreviewGeneratorInProcess());
     addChild(group2);
 
     auto* group2a1 = new GroupSetting();
@@ -1044,6 +1089,7 @@ BackendSettings::BackendSettings()
     group5->addChild(JobQueueWindowStart());
     group5->addChild(JobQueueWindowEnd());
     group5->addChild(JobQueueCPU());
+    group5->addChild(JobQueueDiskBandwidth());
     group5->addChild(JobAllowMetadata());
     group5->addChild(JobAllowCommFlag());
     group5->addChild(JobAllowTranscode());